@@ -26,7 +26,10 @@ ivv-itc@lists.nasa.gov
 #include "crypto_config.h"
 #include "crypto_events.h"
 #include "crypto_structs.h"
+#include "crypto_pipeline.h"
 #include "crypto_print.h"
+#include "crypto_crc.h"
+#include "crypto_arc.h"
 
 #include <gcrypt.h>
 
@@ -40,18 +43,56 @@ ivv-itc@lists.nasa.gov
 */
 // Initialization
 extern int32 crypto_LibInit(void);
+extern int32 crypto_Init(void);
+extern int32 crypto_Init_Provider(uint8 provider_id);
 // Telecommand (TC)
-extern int32 Crypto_TC_ApplySecurity(char* ingest, int* len_ingest);
+extern int32 Crypto_TC_ApplySecurity(char* ingest, int* len_ingest, int max_ingest);
 extern int32 Crypto_TC_ProcessSecurity(char* ingest, int*  len_ingest);
+extern int32 Crypto_TC_ProcessSecurityBatch(char** ingest, int* len_ingest, int32* status, uint16 num_frames);
+extern int32 Crypto_TC_ProcessSecurityView(char* ingest, int len_ingest, uint8* out, int out_len, crypto_tc_view_t* view);
 // Telemetry (TM)
 extern int32 Crypto_TM_ApplySecurity(char* ingest, int* len_ingest);
 extern int32 Crypto_TM_ProcessSecurity(char* ingest, int* len_ingest);
+extern int32 Crypto_TM_ProcessSecurityView(char* ingest, int len_ingest, crypto_tm_view_t* view);
+extern int32 Crypto_TM_QueuePacket(char* packet, int len_packet);
+extern int32 Crypto_TM_NextFrame(char* frame, int* len_frame);
 // Advanced Orbiting Systems (AOS)
 extern int32 Crypto_AOS_ApplySecurity(char* ingest, int* len_ingest);
 extern int32 Crypto_AOS_ProcessSecurity(char* ingest, int* len_ingest);
+extern int32 Crypto_AOS_ProcessSecurityView(char* ingest, int len_ingest, crypto_aos_view_t* view);
 // Security Functions
 extern int32 Crypto_ApplySecurity(char* ingest, int* len_ingest);
 extern int32 Crypto_ProcessSecurity(char* ingest, int* len_ingest);
 
+/*
+** Instance Prototypes
+**
+** Reentrant forms of the above; each crypto_instance_t is caller owned and carries all
+** SA, key ring, frame and log state of one link. The functions above use a default instance.
+** Process-wide setup (providers, CRC engines) happens once in crypto_LibInit; call it before
+** instances are initialized or used from several threads. Crypto_Instance_Init frees an
+** instance it initialized before, any other instance storage must start zeroed.
+** Instances serving one link are kept in step with Crypto_Instance_SA_copy at setup and
+** Crypto_Instance_SDLS_replay after every TC that carried an SDLS command.
+*/
+extern int32 Crypto_Instance_Init(crypto_instance_t* inst, uint8 provider_id);
+extern int32 Crypto_Instance_Free(crypto_instance_t* inst);
+extern int32 Crypto_Instance_SA_copy(crypto_instance_t* inst, const crypto_instance_t* src);
+extern int32 Crypto_Instance_SDLS_replay(crypto_instance_t* inst, const crypto_instance_t* src);
+extern int32 Crypto_Instance_TC_ApplySecurity(crypto_instance_t* inst, char* ingest, int* len_ingest, int max_ingest);
+extern int32 Crypto_Instance_TC_ProcessSecurity(crypto_instance_t* inst, char* ingest, int* len_ingest);
+extern int32 Crypto_Instance_TC_ProcessSecurityBatch(crypto_instance_t* inst, char** ingest, int* len_ingest, int32* status, uint16 num_frames);
+extern int32 Crypto_Instance_TC_ProcessSecurityView(crypto_instance_t* inst, char* ingest, int len_ingest, uint8* out, int out_len, crypto_tc_view_t* view);
+extern int32 Crypto_Instance_TM_ApplySecurity(crypto_instance_t* inst, char* ingest, int* len_ingest);
+extern int32 Crypto_Instance_TM_ProcessSecurity(crypto_instance_t* inst, char* ingest, int* len_ingest);
+extern int32 Crypto_Instance_TM_ProcessSecurityView(crypto_instance_t* inst, char* ingest, int len_ingest, crypto_tm_view_t* view);
+extern int32 Crypto_Instance_TM_QueuePacket(crypto_instance_t* inst, char* packet, int len_packet);
+extern int32 Crypto_Instance_TM_NextFrame(crypto_instance_t* inst, char* frame, int* len_frame);
+extern int32 Crypto_Instance_AOS_ApplySecurity(crypto_instance_t* inst, char* ingest, int* len_ingest);
+extern int32 Crypto_Instance_AOS_ProcessSecurity(crypto_instance_t* inst, char* ingest, int* len_ingest);
+extern int32 Crypto_Instance_AOS_ProcessSecurityView(crypto_instance_t* inst, char* ingest, int len_ingest, crypto_aos_view_t* view);
+extern int32 Crypto_Instance_ApplySecurity(crypto_instance_t* inst, char* ingest, int* len_ingest);
+extern int32 Crypto_Instance_ProcessSecurity(crypto_instance_t* inst, char* ingest, int* len_ingest);
+
 
 #endif
\ No newline at end of file
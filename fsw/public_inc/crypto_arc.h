@@ -0,0 +1,50 @@
+/* Copyright (C) 2009 - 2017 National Aeronautics and Space Administration. All Foreign Rights are Reserved to the U.S. Government.
+
+This software is provided "as is" without any warranty of any, kind either express, implied, or statutory, including, but not
+limited to, any warranty that the software will conform to, specifications any implied warranties of merchantability, fitness
+for a particular purpose, and freedom from infringement, and any warranty that the documentation will conform to the program, or
+any warranty that the software will be error free.
+
+In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or consequential damages,
+arising out of, resulting from, or in any0 way connected with the software or its documentation.  Whether or not based upon warranty,
+contract, tort or otherwise, and whether or not loss was sustained from, or arose out of the results of, or use of, the software,
+documentation or services provided hereunder
+
+ITC Team
+NASA IV&V
+ivv-itc@lists.nasa.gov
+*/
+#ifndef _crypto_arc_h_
+#define _crypto_arc_h_
+
+/*
+** Includes
+*/
+#include "crypto_config.h"
+#include "crypto_structs.h"
+
+/*
+** Anti-Replay Counter window
+** Each SA keeps the next expected IV in sa->iv and a bitmap of the ARC_WINDOW_BITS counter
+** values below it. Crypto_ARC_check only tests a received IV, Crypto_ARC_update records it
+** once the frame has been authenticated. Encryption only (CTR) SAs bypass the window, their
+** IV is not authenticated, so they have no replay protection.
+*/
+
+/*
+** Prototypes
+*/
+// Adds one to a big endian counter, OS_ERROR when it wraps
+int32  Crypto_increment(uint8* num, int length);
+// Low 64 bits of a big endian IV, the part the window counts in
+uint64 Crypto_ARC_low(uint8* iv);
+// Moves the window forward by shift counter values
+void   Crypto_ARC_shift(SecurityAssociation_t* sa, uint64 shift);
+// Marks every counter below the expected IV as received, used whenever sa->iv is set directly
+void   Crypto_ARC_reset(SecurityAssociation_t* sa);
+// OS_SUCCESS, ARC_OUTSIDE_WINDOW or ARC_REPLAY for a received IV
+int32  Crypto_ARC_check(SecurityAssociation_t* sa, uint8* iv);
+// Records an IV accepted by Crypto_ARC_check
+void   Crypto_ARC_update(SecurityAssociation_t* sa, uint8* iv);
+
+#endif
@@ -54,12 +54,32 @@ ivv-itc@lists.nasa.gov
 // Spacecraft Defines
     #define SCID                        0x0003 // 0xC3D2
 
+// Cryptographic Provider - select 1
+    #define CRYPTO_PROVIDER             CRYPTO_PROVIDER_GCRYPT
+    //#define CRYPTO_PROVIDER             CRYPTO_PROVIDER_ITC
+
 // Functionality Defines
     #define INCREMENT
+    //#define TC_AAD                            // Authenticate the ABM masked TC headers, off for ESA testing
     #define FILL
     // TM Fill Types - select 1
         //#define TM_ZERO_FILL
         #define TM_IDLE_FILL
+    // TM Idle Packets - APID and total length in bytes, 7 to TM_PDU_MIN_SIZE
+        #define TM_IDLE_APID            0x7FF
+        #define TM_IDLE_LENGTH          64
+
+// Link End - TC and TM frames share TFVN 00; Crypto_ApplySecurity secures them as TM and
+// Crypto_ProcessSecurity as TC, or the reverse when CRYPTO_GROUND is defined
+    //#define CRYPTO_GROUND
+    #define TC_TM_TFVN                  0x00
+
+// TC Pipeline Defines - TC_PIPELINE builds the POSIX threads worker pool for ground and host
+// targets, flight builds leave it off so no pthread dependency reaches crypto.h
+    //#define TC_PIPELINE
+    #define TC_PIPELINE_MAX_WORKERS     16
+    #define TC_PIPELINE_QUEUE_DEPTH     32      /* frames per worker */
+    #define TC_PIPELINE_FRAME_SIZE      TC_MAX_FRAME_SIZE
 
 // GVCID Defines
     #define NUM_GVCID                   64
@@ -106,10 +126,23 @@ ivv-itc@lists.nasa.gov
     #define ABM_SIZE                    20      /* bytes */
     #define ARC_SIZE                    20      /* total messages */
     #define ARCW_SIZE                   1       /* bytes */
+    #define ARC_WINDOW_BITS             1024    /* received IVs tracked below the expected one, multiple of 64 */
+    #define ARC_WINDOW_WORDS            (ARC_WINDOW_BITS / 64)
+    #define ARC_HIGH_SIZE               (IV_SIZE - 8)   /* IV bytes above the 64-bit window counter */
     #define SN_SIZE                     0
     #define CHALLENGE_SIZE              16      /* bytes */
     #define CHALLENGE_MAC_SIZE          16      /* bytes */
 
+// Security Services - SA_SERVICE of an SA, (est << 1) | ast
+    #define SA_SVC_CLEAR                0
+    #define SA_SVC_AUTH                 1
+    #define SA_SVC_ENC                  2       /* no MAC, so no anti-replay check either */
+    #define SA_SVC_AEAD                 3
+
+// Anti-Replay Check Results
+    #define ARC_OUTSIDE_WINDOW          1
+    #define ARC_REPLAY                  2
+
 // Monitoring and Control Defines
     #define EMV_SIZE                    4       /* bytes */ 
     #define LOG_SIZE                    50     /* packets */
@@ -152,6 +185,7 @@ ivv-itc@lists.nasa.gov
     #define TC_SN_WINDOW				10		/* +/- value */
     #define	TC_PAD_SIZE					0
     #define	TC_FRAME_DATA_SIZE			1740 	/* bytes */
+    #define TC_MAX_FRAME_SIZE           1024    /* bytes, largest TC transfer frame */
 
 // CCSDS PUS Defines
     #define TLV_DATA_SIZE               494     /* bytes */
@@ -159,6 +193,20 @@ ivv-itc@lists.nasa.gov
 // TM Defines
     #define TM_FRAME_DATA_SIZE          1740 	/* bytes */
     #define TM_FILL_SIZE                1145    /* bytes */
+    #define TM_PDU_MIN_SIZE             (TM_FILL_SIZE - 6 - 2 - IV_SIZE - MAC_SIZE - FECF_SIZE - 4)  /* bytes, PDU of a clear TM frame */
     #define TM_PAD_SIZE                 2       /* bytes */
+    #define TM_MUX_SIZE                 4096    /* bytes, space packets queued for Crypto_TM_NextFrame */
+    #define TM_FHP_NO_HEADER            0x7FF   /* no packet starts in the frame */
+    #define TM_FHP_IDLE                 0x7FE   /* frame holds only idle data */
+    #if defined(TM_IDLE_FILL) && ((TM_IDLE_LENGTH < 7) || (TM_IDLE_LENGTH > TM_PDU_MIN_SIZE))
+    #error "TM_IDLE_LENGTH must be 7 to TM_PDU_MIN_SIZE bytes"
+    #endif
+
+// AOS Defines
+    #define AOS_TFVN                    0x01    /* Transfer Frame Version Number of AOS frames */
+    #define AOS_FRAME_SIZE              2048    /* bytes, fixed length of every AOS transfer frame */
+    #define AOS_INSERT_ZONE_SIZE        0       /* bytes, 0 when the insert zone is not used */
+    #define AOS_OCF                             // Comment out for frames without Operational Control Field
+    #define AOS_FECF                            // Comment out for frames without Frame Error Control Field
 
 #endif
\ No newline at end of file
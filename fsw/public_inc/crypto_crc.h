@@ -0,0 +1,68 @@
+/* Copyright (C) 2009 - 2017 National Aeronautics and Space Administration. All Foreign Rights are Reserved to the U.S. Government.
+
+This software is provided "as is" without any warranty of any, kind either express, implied, or statutory, including, but not
+limited to, any warranty that the software will conform to, specifications any implied warranties of merchantability, fitness
+for a particular purpose, and freedom from infringement, and any warranty that the documentation will conform to the program, or
+any warranty that the software will be error free.
+
+In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or consequential damages,
+arising out of, resulting from, or in any0 way connected with the software or its documentation.  Whether or not based upon warranty,
+contract, tort or otherwise, and whether or not loss was sustained from, or arose out of the results of, or use of, the software,
+documentation or services provided hereunder
+
+ITC Team
+NASA IV&V
+ivv-itc@lists.nasa.gov
+*/
+#ifndef _crypto_crc_h_
+#define _crypto_crc_h_
+
+/*
+** Includes
+*/
+#include "common_types.h"
+
+/*
+** Carry-less multiply (PCLMULQDQ) folding is built on x86 GCC/Clang targets
+** and selected at runtime by Crypto_CRC_Init when the CPU supports it.
+** Define CRYPTO_CRC_NO_CLMUL to build the portable table path only.
+*/
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(CRYPTO_CRC_NO_CLMUL)
+    #define CRYPTO_CRC_CLMUL
+#endif
+
+/*
+** CRC-16/CCITT (poly 0x1021, MSB first, no reflection, no final XOR)
+** Used for the Frame Error Control Field and space packet CRC; both start from 0xFFFF.
+*/
+#define CRC16_CCITT_INIT    0xFFFF
+
+/*
+** CRC-32 (poly 0x04C11DB7 reflected, zlib / IEEE 802.3)
+** Pre and post inverted like zlib: start from CRC32_INIT and feed the
+** previous result back in to continue a running CRC.
+*/
+#define CRC32_INIT          0x00000000
+
+/*
+** Prototypes
+*/
+// Selects the fastest engine supported by the CPU, safe to call more than once
+void   Crypto_CRC_Init(void);
+// Returns 1 if the carry-less multiply engines are in use
+uint8  Crypto_CRC_clmul_active(void);
+// Dispatched engines, continue from a previous crc value
+uint16 Crypto_CRC16_update(uint16 crc, const uint8* data, uint32 len);
+uint32 Crypto_CRC32_update(uint32 crc, const uint8* data, uint32 len);
+// Slicing-by-8 table engines, portable fallback
+uint16 Crypto_CRC16_table(uint16 crc, const uint8* data, uint32 len);
+uint32 Crypto_CRC32_table(uint32 crc, const uint8* data, uint32 len);
+// Bit-by-bit reference engine, same result as Crypto_CRC16_update
+uint16 Crypto_CRC16_bitwise(uint16 crc, const uint8* data, uint32 len);
+#ifdef CRYPTO_CRC_CLMUL
+// Folding engines, only valid when Crypto_CRC_clmul_active() is set
+uint16 Crypto_CRC16_clmul(uint16 crc, const uint8* data, uint32 len);
+uint32 Crypto_CRC32_clmul(uint32 crc, const uint8* data, uint32 len);
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+/* Copyright (C) 2009 - 2017 National Aeronautics and Space Administration. All Foreign Rights are Reserved to the U.S. Government.
+
+This software is provided "as is" without any warranty of any, kind either express, implied, or statutory, including, but not
+limited to, any warranty that the software will conform to, specifications any implied warranties of merchantability, fitness
+for a particular purpose, and freedom from infringement, and any warranty that the documentation will conform to the program, or
+any warranty that the software will be error free.
+
+In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or consequential damages,
+arising out of, resulting from, or in any0 way connected with the software or its documentation.  Whether or not based upon warranty,
+contract, tort or otherwise, and whether or not loss was sustained from, or arose out of the results of, or use of, the software,
+documentation or services provided hereunder
+
+ITC Team
+NASA IV&V
+ivv-itc@lists.nasa.gov
+*/
+#ifndef _crypto_pipeline_h_
+#define _crypto_pipeline_h_
+
+/*
+** Includes
+*/
+#include "crypto_config.h"
+#include "crypto_structs.h"
+
+#ifdef TC_PIPELINE
+
+#include <pthread.h>
+
+/*
+** TC Pipeline
+**
+** Worker pool front end for TC ingest. Each frame is hashed by its SPI onto one worker
+** queue, so frames of an SA are processed in order by the same worker and its anti-replay
+** state lives in exactly one place, while different SAs decrypt in parallel.
+**
+** Every worker owns a crypto_instance_t set up by Crypto_Instance_Init. Crypto_TC_Pipeline_Load
+** gives all of them the SAs and keys of a configured instance. When a worker processes an SDLS EP
+** command it stops the pool, replays the command on every other worker and only then releases
+** the frame to the callback and lets the workers continue. Frames of other SAs that were already
+** being processed when the command completed finish on the state before it.
+*/
+typedef void (*crypto_tc_pipeline_cb_t)(void* arg, uint8 worker, int32 status, 
+                                        const TC_t* tc_frame, char* ingest, int len_ingest);
+// Called from the worker thread once Crypto_TC_ProcessSecurity semantics have been applied,
+// ingest is only valid until the callback returns
+
+typedef struct
+{
+    uint32  frames;         // Frames processed
+    uint32  errors;         // Frames that did not return OS_SUCCESS
+    uint64  bytes;          // Ingest bytes processed
+    uint64  busy_ns;        // Time spent processing frames
+    uint64  elapsed_ns;     // Time since the pipeline started
+} crypto_tc_pipeline_stats_t;
+
+typedef struct
+{
+    char    frame[TC_PIPELINE_FRAME_SIZE];
+    int     len;
+} crypto_tc_pipeline_slot_t;
+
+typedef struct
+{
+    crypto_instance_t           inst;
+    crypto_tc_pipeline_slot_t   queue[TC_PIPELINE_QUEUE_DEPTH];
+    uint16                      head;
+    uint16                      tail;
+    uint16                      count;
+    uint8                       id;
+    uint8                       stop;
+    pthread_t                   thread;
+    pthread_mutex_t             lock;
+    pthread_cond_t              not_empty;
+    pthread_cond_t              not_full;
+    pthread_cond_t              drained;
+    crypto_tc_pipeline_stats_t  stats;
+    void*                       pipeline;   // Owning crypto_tc_pipeline_t
+} crypto_tc_pipeline_worker_t;
+
+typedef struct
+{
+    crypto_tc_pipeline_worker_t worker[TC_PIPELINE_MAX_WORKERS];
+    uint8                       num_workers;
+    crypto_tc_pipeline_cb_t     cb;
+    void*                       cb_arg;
+    uint64                      start_ns;
+    pthread_mutex_t             sync_lock;  // Guards busy and sync
+    pthread_cond_t              sync_cond;
+    uint8                       busy;       // Workers inside a frame
+    uint8                       sync;       // 1 while SA state is copied between workers
+} crypto_tc_pipeline_t;
+
+/*
+** Prototypes
+*/
+extern int32 Crypto_TC_Pipeline_Init(crypto_tc_pipeline_t* pl, uint8 num_workers, uint8 provider_id,
+                                     crypto_tc_pipeline_cb_t cb, void* cb_arg);
+extern int32 Crypto_TC_Pipeline_Load(crypto_tc_pipeline_t* pl, const crypto_instance_t* src);
+extern int32 Crypto_TC_Pipeline_Submit(crypto_tc_pipeline_t* pl, const char* ingest, int len_ingest);
+extern int32 Crypto_TC_Pipeline_Flush(crypto_tc_pipeline_t* pl);
+extern int32 Crypto_TC_Pipeline_Stats(crypto_tc_pipeline_t* pl, uint8 worker, crypto_tc_pipeline_stats_t* stats);
+extern int32 Crypto_TC_Pipeline_Free(crypto_tc_pipeline_t* pl);
+
+#endif
+
+#endif
@@ -32,5 +32,8 @@ void Crypto_clcwPrint(TM_FrameCLCW_t* clcw);
 void Crypto_fsrPrint(SDLS_FSR_t* report);
 void Crypto_ccsdsPrint(CCSDS_t* sdls_frame);
 void Crypto_saPrint(SecurityAssociation_t* sa);
+#ifdef TC_PIPELINE
+void Crypto_tcPipelinePrint(crypto_tc_pipeline_t* pl);
+#endif
 
 #endif 
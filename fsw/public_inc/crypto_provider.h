@@ -0,0 +1,91 @@
+/* Copyright (C) 2009 - 2017 National Aeronautics and Space Administration. All Foreign Rights are Reserved to the U.S. Government.
+
+This software is provided "as is" without any warranty of any, kind either express, implied, or statutory, including, but not
+limited to, any warranty that the software will conform to, specifications any implied warranties of merchantability, fitness
+for a particular purpose, and freedom from infringement, and any warranty that the documentation will conform to the program, or
+any warranty that the software will be error free.
+
+In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or consequential damages,
+arising out of, resulting from, or in any0 way connected with the software or its documentation.  Whether or not based upon warranty,
+contract, tort or otherwise, and whether or not loss was sustained from, or arose out of the results of, or use of, the software,
+documentation or services provided hereunder
+
+ITC Team
+NASA IV&V
+ivv-itc@lists.nasa.gov
+*/
+#ifndef _crypto_provider_h_
+#define _crypto_provider_h_
+
+/*
+** Includes
+*/
+#include "common_types.h"
+#include "itc_gcm128.h"
+
+#include <gcrypt.h>
+
+/*
+** Cryptographic provider interface
+**
+** Every cipher operation in crypto.c goes through one of these tables, so the
+** backend can be chosen per platform at crypto_Init_Provider time.
+** All operations are AES-GCM with the key length given to key_load, except ctr which is
+** AES-CTR over GCM's counter blocks (IV || 2, IV || 3, ...) for encryption only SAs.
+** in and out may be the same buffer.
+** Return OS_SUCCESS, OS_ERROR, or CRYPTO_PROVIDER_BAD_MAC when a tag fails to verify.
+*/
+#define CRYPTO_PROVIDER_GCRYPT      0
+#define CRYPTO_PROVIDER_ITC         1
+
+#define CRYPTO_PROVIDER_BAD_MAC     (-100)
+
+typedef struct
+{   // libgcrypt handles of one key
+    gcry_cipher_hd_t            gcm;     // AES-GCM, authenticated encryption and GMAC
+    gcry_cipher_hd_t            ctr;     // AES-CTR, encryption only
+} crypto_gcrypt_ctx_t;
+
+typedef union
+{   // Keyed state of one key, owned by whichever provider loaded it
+    crypto_gcrypt_ctx_t         gcry;
+    struct itc_gcm128_context   itc;
+} crypto_provider_ctx_t;
+
+typedef struct
+{
+    const char* name;
+
+    // One-time library initialization
+    int32 (*init)(void);
+
+    // Key a context; key_unload releases it again
+    int32 (*key_load)(crypto_provider_ctx_t* ctx, const uint8* key, uint16 key_len);
+    void  (*key_unload)(crypto_provider_ctx_t* ctx);
+
+    // Authenticated encryption: out = E(in), mac = tag over aad || out
+    int32 (*aead_encrypt)(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                          const uint8* aad, uint32 aad_len, const uint8* in, uint8* out, uint32 len,
+                          uint8* mac, uint16 mac_len);
+
+    // Authenticated decryption: out = D(in), checks mac over aad || in
+    int32 (*aead_decrypt)(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                          const uint8* aad, uint32 aad_len, const uint8* in, uint8* out, uint32 len,
+                          const uint8* mac, uint16 mac_len);
+
+    // Authentication only (GMAC): mac = tag over data
+    int32 (*mac)(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                 const uint8* data, uint32 len, uint8* mac, uint16 mac_len);
+
+    // Encryption only (CTR): out = in XOR keystream, no tag
+    int32 (*ctr)(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                 const uint8* in, uint8* out, uint32 len);
+} crypto_provider_t;
+
+/*
+** Providers
+*/
+extern const crypto_provider_t crypto_provider_gcrypt;
+extern const crypto_provider_t crypto_provider_itc;
+
+#endif
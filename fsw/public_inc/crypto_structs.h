@@ -18,6 +18,7 @@ ivv-itc@lists.nasa.gov
 #define _crypto_structs_h_
 
 #include "crypto_config.h"
+#include "crypto_provider.h"
 #include <gcrypt.h>
 
 /*
@@ -39,6 +40,14 @@ typedef struct
 } crypto_gvcid_t;
 #define CRYPTO_GVCID_SIZE 	(sizeof(crypto_gvcid_t))
 
+typedef struct
+{   // Operational SA of one virtual channel, kept by SA start and stop
+    uint16 spi;         // Security Parameter Index, 0 while no SA is mapped
+    uint16 scid;        // Spacecraft ID
+    uint8  tfvn;        // Transfer Frame Version Number
+} crypto_gvcid_map_t;
+#define CRYPTO_GVCID_MAP_SIZE	(sizeof(crypto_gvcid_map_t))
+
 /*
 ** Security Association
 */
@@ -48,8 +57,6 @@ typedef struct
     uint16 						ekid;    // Encryption Key ID
     uint16                      akid;    // Authentication Key ID
     uint8						sa_state:2;
-    crypto_gvcid_t				gvcid_tc_blk[NUM_GVCID];
-    crypto_gvcid_t				gvcid_tm_blk[NUM_GVCID];
     uint8                       lpid;
 
     // Configuration
@@ -71,9 +78,19 @@ typedef struct
     uint8		arc[ARC_SIZE];		// Anti-Replay Counter
     uint8		arcw_len:8;			// Anti-Replay Counter Window Length
     uint8		arcw[ARCW_SIZE];	// Anti-Replay Counter Window
+    uint64		arc_bitmap[ARC_WINDOW_WORDS];	// Anti-Replay Window, bit n set once IV (iv - 1 - n) is received
     
 } SecurityAssociation_t;
 #define SA_SIZE	(sizeof(SecurityAssociation_t))
+#define SA_SERVICE(sa)  (((sa)->est << 1) | (sa)->ast)   // Security service type, one of SA_SVC_*
+
+typedef struct
+{   // Keyed provider context kept between frames of the same SA
+    crypto_provider_ctx_t       ctx;     // Provider Context
+    uint16                      ekid;    // Encryption Key ID loaded into the context
+    uint8                       valid:1; // Context is keyed
+} crypto_cipher_cache_t;
+#define CRYPTO_CIPHER_CACHE_SIZE	(sizeof(crypto_cipher_cache_t))
 
 /*
 ** SDLS Definitions
@@ -270,6 +287,23 @@ typedef struct
 } TC_t;
 #define TC_SIZE     (sizeof(TC_t))
 
+typedef struct
+{   // Channel verified by the previous frame of a TC batch
+    uint8                   valid;
+    uint16                  scid;
+    uint8                   vcid;
+    uint16                  spi;
+    crypto_provider_ctx_t*  ctx;     // Keyed context of spi, NULL for clear SAs
+} crypto_tc_batch_t;
+
+typedef struct
+{   // Plaintext PDU of a TC processed by Crypto_TC_ProcessSecurityView
+    uint8*                  buf;     // ingest when decrypted in place, otherwise the caller's output buffer
+    uint16                  offset;  // Start of the PDU within buf
+    uint16                  len;     // Length of the PDU in bytes
+    uint8                   sdls;    // 1 when the TC was an SDLS command and buf holds its reply
+} crypto_tc_view_t;
+
 /*
 ** CCSDS Definitions
 */
@@ -388,4 +422,95 @@ typedef struct
 
 #define TM_MIN_SIZE (TM_FRAME_PRIMARYHEADER_SIZE + TM_FRAME_SECHEADER_SIZE + TM_FRAME_SECTRAILER_SIZE + TM_FRAME_CLCW_SIZE)
 
+typedef struct
+{   // Space packets queued for Crypto_TM_NextFrame, a byte ring of whole packets
+    uint8   buf[TM_MUX_SIZE];
+    uint32  head;               // Next byte to send
+    uint32  len;                // Bytes queued
+    uint32  cont;               // Bytes left of the packet cut at the end of the last frame
+} crypto_tm_mux_t;
+
+typedef struct
+{   // PDU of a TM frame verified by Crypto_TM_ProcessSecurityView
+    uint8*  buf;                // The frame, decrypted in place
+    uint16  offset;             // Start of the PDU within buf
+    uint16  len;                // Length of the PDU in bytes
+    uint16  spi;                // Security Parameter Index of the frame
+    uint8   vcid;               // Virtual Channel ID of the frame
+    uint16  fhp;                // First Header Pointer of the frame
+} crypto_tm_view_t;
+
+/*
+** Advanced Orbiting Systems (AOS) Definitions
+*/
+// Fixed frame layout: header, insert zone, SPI, IV, M_PDU, MAC, OCF, FECF
+// Clear SAs keep the IV and MAC fields zeroed, so the M_PDU does not move between SAs
+#define AOS_FRAME_PRIMARYHEADER_SIZE    6
+#define AOS_FRAME_SECHEADER_SIZE        (2 + IV_SIZE)
+#define AOS_MPDU_HEADER_SIZE            2       // Spare bits and First Header Pointer
+#ifdef AOS_OCF
+    #define AOS_OCF_SIZE                OCF_SIZE
+#else
+    #define AOS_OCF_SIZE                0
+#endif
+#ifdef AOS_FECF
+    #define AOS_FECF_SIZE               FECF_SIZE
+#else
+    #define AOS_FECF_SIZE               0
+#endif
+#define AOS_FRAME_SECTRAILER_SIZE       (MAC_SIZE + AOS_OCF_SIZE + AOS_FECF_SIZE)
+
+#define AOS_SPI_LOC     (AOS_FRAME_PRIMARYHEADER_SIZE + AOS_INSERT_ZONE_SIZE)
+#define AOS_PDU_LOC     (AOS_SPI_LOC + AOS_FRAME_SECHEADER_SIZE)
+#define AOS_PDU_SIZE    (AOS_FRAME_SIZE - AOS_PDU_LOC - AOS_FRAME_SECTRAILER_SIZE)
+#define AOS_MAC_LOC     (AOS_PDU_LOC + AOS_PDU_SIZE)
+#define AOS_OCF_LOC     (AOS_MAC_LOC + MAC_SIZE)
+#define AOS_FECF_LOC    (AOS_OCF_LOC + AOS_OCF_SIZE)
+
+typedef struct
+{   // Packet zone of an AOS frame verified by Crypto_AOS_ProcessSecurityView
+    uint8*  buf;                // The frame, decrypted in place
+    uint16  offset;             // Start of the packet zone within buf
+    uint16  len;                // Length of the packet zone in bytes
+    uint16  spi;                // Security Parameter Index of the frame
+    uint8   vcid;               // Virtual Channel ID of the frame
+    uint16  fhp;                // First Header Pointer of the M_PDU
+} crypto_aos_view_t;
+
+/*
+** Crypto Instance
+*/
+typedef struct
+{   // All state of one SDLS link; independent instances may run on separate threads
+    // Security
+    SecurityAssociation_t       sa[NUM_SA];             // Security Associations
+    crypto_cipher_cache_t       sa_cipher[NUM_SA];      // Keyed provider contexts per SA
+    crypto_gvcid_map_t          gvcid_tc_map[NUM_GVCID];    // SA of each TC virtual channel, by VCID
+    crypto_gvcid_map_t          gvcid_tm_map[NUM_GVCID];    // SA of each TM and AOS virtual channel, by VCID
+    const crypto_provider_t*    provider;               // Cryptographic Provider
+    crypto_key_t                ek_ring[NUM_KEYS];      // Encryption Key Ring
+    // Local Frames
+    TC_t                        tc_frame;
+    CCSDS_t                     sdls_frame;
+    TM_t                        tm_frame;
+    // OCF
+    uint8                       ocf;
+    SDLS_FSR_t                  report;
+    TM_FrameCLCW_t              clcw;
+    // Flags
+    SDLS_MC_LOG_RPLY_t          log_summary;
+    SDLS_MC_DUMP_BLK_RPLY_t     log;
+    uint8                       log_count;
+    uint8                       tc_sdls;                    // 1 when the last TC processed was an SDLS command
+    uint16                      tm_offset;
+    uint8                       tm_idle_fill[TM_FILL_SIZE]; // Back to back idle packets
+    crypto_tm_mux_t             tm_mux;                     // Packet queue of Crypto_TM_NextFrame
+    // ESA Testing - 0 = disabled, 1 = enabled
+    uint8                       badSPI;
+    uint8                       badIV;
+    uint8                       badMAC;
+    uint8                       badFECF;
+} crypto_instance_t;
+#define CRYPTO_INSTANCE_SIZE    (sizeof(crypto_instance_t))
+
 #endif
\ No newline at end of file
@@ -18,11 +18,42 @@
 #ifndef ITC_AES128_H
 #define ITC_AES128_H
 
-#define KS_LENGTH 176    /* key schedule length for 128-bit AES */
+#include <stddef.h>
+#include <stdint.h>
+
+#define KS_LENGTH 240    /* key schedule length, sized for 256-bit AES (128-bit uses 176, 192-bit 208) */
+
+#define ITC_AES128_SUCCESS              0
+#define ITC_AES128_BAD_KEY_LENGTH  -10021  /* key length is not 16, 24 or 32 bytes */
+
+/*******************************************************************************
+*
+* Implementation selection. Define one of the following at build time:
+*
+*   ITC_AES128_BYTE      - byte matrix implementation, smallest code and tables
+*   ITC_AES128_TTABLE    - 32-bit word implementation using combined
+*                          SubBytes/ShiftRows/MixColumns tables (default)
+*   ITC_AES128_BITSLICE  - bitsliced implementation with no table lookups or
+*                          secret dependent branches (constant time)
+*
+*******************************************************************************/
+#if !defined(ITC_AES128_BYTE) && !defined(ITC_AES128_BITSLICE)
+#define ITC_AES128_TTABLE
+#endif
+
+/* On x86-64 GCC/Clang builds the AES-NI instructions are used instead of the
+** selected implementation when cpuid reports them at itc_aes128_init time.
+** Define ITC_AES128_NO_AESNI to leave them out of the build.
+*/
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(ITC_AES128_NO_AESNI)
+#define ITC_AES128_AESNI
+#include <emmintrin.h>
+#endif
 
 /*******************************************************************************
 * 
-* A lightweight implementation of AES 128-bit encryption.
+* A lightweight implementation of the AES 128-bit block cipher, with 128,
+* 192 or 256-bit keys.
 *
 * This code is meant for prototyping, and has not undergone any efforts
 * to be safe from any side channel or timing attacks. It merely provides
@@ -35,6 +66,18 @@
 struct itc_aes128_context
 {
     unsigned char key_schedule[KS_LENGTH];
+    int nr;                                   /* number of rounds: 10, 12 or 14 */
+#if defined(ITC_AES128_TTABLE)
+    uint32_t enc_words[KS_LENGTH / 4];        /* round keys as big endian words */
+    uint32_t dec_words[KS_LENGTH / 4];        /* inverse cipher round keys, InvMixColumns applied */
+#elif defined(ITC_AES128_BITSLICE)
+    uint16_t bitsliced_keys[KS_LENGTH / 16][8]; /* round keys, one 16-bit slice per bit position */
+#endif
+#if defined(ITC_AES128_AESNI)
+    __m128i aesni_enc_keys[KS_LENGTH / 16];   /* 16-byte aligned round keys for AESENC */
+    __m128i aesni_dec_keys[KS_LENGTH / 16];   /* inverse cipher round keys for AESDEC */
+    int use_aesni;                            /* set by itc_aes128_init from cpuid */
+#endif
 };
 
 /* Takes a 128-bit key and creates the expanded key schedule.
@@ -42,6 +85,14 @@ struct itc_aes128_context
 */
 void itc_aes128_init(struct itc_aes128_context *ctx, const unsigned char *key);
 
+/* Same as itc_aes128_init for a 128, 192 or 256-bit key.
+** key_length is in bytes and the key pointer must reference that many bytes.
+**
+** \return ITC_AES128_SUCCESS if successful
+** \return ITC_AES128_BAD_KEY_LENGTH if key_length is not 16, 24 or 32
+*/
+int itc_aes128_init_key(struct itc_aes128_context *ctx, const unsigned char *key, size_t key_length);
+
 /* Methods for encrypting and decrypting a 128-bit (16 byte) block.
 ** The input and output pointers must reference a valid 16-byte block. Input same as output is allowed.
 ** The context pointer must have previously been initialized with a key.
@@ -23,6 +23,7 @@
 
 #define ITC_CMAC128_SUCCESS         0
 #define ITC_CMAC128_BAD_TAG    -10011
+#define ITC_CMAC128_BAD_KEY_LENGTH -10012  /* key length is not 16, 24 or 32 bytes */
 
 struct itc_cmac128_context
 {
@@ -33,6 +34,9 @@ struct itc_cmac128_context
 
 void itc_cmac128_init(struct itc_cmac128_context * ctx, const unsigned char * key);
 
+/* Same as itc_cmac128_init for a 128, 192 or 256-bit key (key_length 16, 24 or 32 bytes) */
+int itc_cmac128_init_key(struct itc_cmac128_context * ctx, const unsigned char * key, size_t key_length);
+
 int itc_cmac128_generate_tag( struct itc_cmac128_context *ctx, 
                               size_t length, 
                               const unsigned char * message, 
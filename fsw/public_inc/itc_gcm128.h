@@ -25,7 +25,7 @@
 
 /* A lightweight implementation of Galois Counter Mode Authenticated Encryption.
    Supports the following:
-    - 128-bit key
+    - 128, 192 or 256-bit key
     - AES block cipher
     - 96-bit IV
     - 128-bit MAC tag
@@ -45,6 +45,34 @@
 #define ITC_GCM128_SUCCESS              0  
 #define ITC_GCM128_BAD_TAG         -10001  /* Tag is invalid for message */
 #define ITC_GCM128_OUT_OF_RANGE    -10002  /* AAD/Data Length is too large */
+#define ITC_GCM128_BAD_KEY_LENGTH  -10003  /* Key length is not 16, 24 or 32 bytes */
+
+/**********************        Build Options         **************************/
+
+/* GHASH multiplies by H using per-key tables built in itc_gcm128_init.
+ * The table width is a memory/speed trade-off chosen at build time:
+ *   4 - two 16-entry tables of 64-bit words (256 bytes per context), default
+ *   8 - two 256-entry tables of 64-bit words (4 KB per context), about twice as fast
+*/
+#ifndef ITC_GCM128_TABLE_BITS
+#define ITC_GCM128_TABLE_BITS 4
+#endif
+
+#if (ITC_GCM128_TABLE_BITS != 4) && (ITC_GCM128_TABLE_BITS != 8)
+#error "ITC_GCM128_TABLE_BITS must be 4 or 8"
+#endif
+
+#define ITC_GCM128_TABLE_SIZE (1 << ITC_GCM128_TABLE_BITS)
+
+/* On x86-64 GCC/Clang builds GHASH uses the PCLMULQDQ carry-less multiply instead
+ * of the tables when cpuid reports it at itc_gcm128_init time. Powers H^1..H^8 are
+ * precomputed so 8 (or 4) blocks are hashed per reduction.
+ * Define ITC_GCM128_NO_CLMUL to leave it out of the build.
+*/
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(ITC_GCM128_NO_CLMUL)
+#define ITC_GCM128_CLMUL
+#include <emmintrin.h>
+#endif
 
 /**********************        Structs & Stuff        **************************/
 
@@ -54,9 +82,15 @@
 */
 struct itc_gcm128_context
 {
-    /* First two fields are constant for any fixed key */
+    /* First fields are constant for any fixed key */
     struct itc_aes128_context aes_ctx; /* for use with AES cipher */ 
     unsigned char h[16];               /* H subkey for use in GHASH */
+    uint64 hh[ITC_GCM128_TABLE_SIZE];  /* multiples of H, high 64 bits (see ITC_GCM128_TABLE_BITS) */
+    uint64 hl[ITC_GCM128_TABLE_SIZE];  /* multiples of H, low 64 bits */
+#if defined(ITC_GCM128_CLMUL)
+    __m128i h_powers[8];               /* H^1..H^8, byte-reversed, for PCLMULQDQ */
+    int use_clmul;                     /* set by itc_gcm128_init from cpuid */
+#endif
 
     /* Variable fields: */
     unsigned char iv_ctr[16];          /* IV (first 12 bytes) + Counter (last 4, Big-endian) */
@@ -76,6 +110,13 @@ struct itc_gcm128_context
 */
 void itc_gcm128_init(struct itc_gcm128_context *ctx, const unsigned char * key);
 
+/* Same as itc_gcm128_init for a 128, 192 or 256-bit key.
+ *
+ * \return ITC_GCM128_SUCCESS if successful
+ * \return ITC_GCM128_BAD_KEY_LENGTH if key_length is not 16, 24 or 32 bytes
+*/
+int itc_gcm128_init_key(struct itc_gcm128_context *ctx, const unsigned char * key, size_t key_length);
+
 /* All-in-one method for encryption and tagging.
  * 
  * \note One of AAD or the plaintext must have size greater than zero
@@ -106,6 +147,19 @@ int itc_gcm128_decrypt( struct itc_gcm128_context *ctx,
                         const unsigned char * tag,                /* tag input (128-bit) */
                         unsigned char * plaintext );              /* plaintext output */
 
+/* Encryption only: AES-CTR over the same counter blocks GCM uses for its data
+ * (IV || 2, IV || 3, ...); no tag is produced or checked. Decryption is the same call.
+ * Input same as output is allowed.
+ *
+ * \return ITC_GCM128_SUCCESS if successful
+ * \return ITC_GCM128_OUT_OF_RANGE if data length is too long
+*/
+int itc_gcm128_ctr( struct itc_gcm128_context *ctx,
+                    const unsigned char * iv,                     /* must be 96-bit */
+                    size_t length,                                /* length of data */
+                    const unsigned char * input,                  /* plaintext or ciphertext input */
+                    unsigned char * output );                     /* ciphertext or plaintext output */
+
 /* Streaming functions for encryption:
    - These are to provide flexibility when the plaintext for the message may be fragmented
    - Per message:
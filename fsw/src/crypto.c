@@ -33,176 +33,172 @@ ivv-itc@lists.nasa.gov
 ** Static Prototypes
 */
 // Initialization Functions
-static int32 Crypto_SA_init(void);
-static int32 Crypto_SA_config(void);
+static int32 Crypto_SA_init(crypto_instance_t* inst);
+static int32 Crypto_SA_config(crypto_instance_t* inst);
 // Assisting Functions
-static int32  Crypto_Get_tcPayloadLength(void);
+static int32  Crypto_Get_tcPayloadLength(crypto_instance_t* inst);
 static int32  Crypto_Get_tmLength(int len);
-static void   Crypto_TM_updatePDU(char* ingest, int len_ingest);
-static void   Crypto_TM_updateOCF(void);
+static void   Crypto_TM_initIdle(crypto_instance_t* inst);
+static void   Crypto_TM_updatePDU(crypto_instance_t* inst, uint8* pdu, char* ingest, int len_ingest, int pdu_len);
+static void   Crypto_TM_muxRead(crypto_tm_mux_t* mux, uint8* dest, uint32 len);
+static void   Crypto_TM_muxPDU(crypto_instance_t* inst, uint8* pdu, int pdu_len);
+static void   Crypto_TM_updateOCF(crypto_instance_t* inst);
 //static int32  Crypto_gcm_err(int gcm_err);
-static int32  Crypto_increment(uint8* num, int length);
-static int32 Crypto_window(uint8 *actual, uint8 *expected, int length, int window);
-static int32 Crypto_compare_less_equal(uint8 *actual, uint8 *expected, int length);
-static uint8  Crypto_Prep_Reply(char*, uint8);
-static int32  Crypto_FECF(int fecf, char* ingest, int len_ingest);
-static uint16 Crypto_Calc_FECF(char* ingest, int len_ingest);
-static void   Crypto_Calc_CRC_Init_Table(void);
+static uint8  Crypto_Prep_Reply(crypto_instance_t* inst, char*, uint8);
+static int32  Crypto_FECF(crypto_instance_t* inst, int fecf, char* ingest, int len_ingest);
+static uint16 Crypto_Calc_FECF(crypto_instance_t* inst, char* ingest, int len_ingest);
 static uint16 Crypto_Calc_CRC16(char* data, int size);
+// Cipher Cache Functions
+static int32 Crypto_Cipher_get(crypto_instance_t* inst, uint16 spi, crypto_provider_ctx_t** ctx);
+static void  Crypto_Cipher_invalidate_sa(crypto_instance_t* inst, uint16 spi);
+static void  Crypto_Cipher_invalidate_key(crypto_instance_t* inst, uint16 kid);
+// Authentication Functions
+static int32 Crypto_Auth_mac(crypto_instance_t* inst, uint16 spi, const uint8* iv, uint8* frame, int len, uint8* mac);
+static int32 Crypto_Auth_verify(crypto_instance_t* inst, uint16 spi, const uint8* iv, uint8* frame, int len, const uint8* mac);
 // Key Management Functions
-static int32 Crypto_Key_OTAR(void);
-static int32 Crypto_Key_update(uint8 state);
-static int32 Crypto_Key_inventory(char*);
-static int32 Crypto_Key_verify(char*);
+static int32 Crypto_Key_OTAR(crypto_instance_t* inst);
+static int32 Crypto_Key_update(crypto_instance_t* inst, uint8 state);
+static int32 Crypto_Key_inventory(crypto_instance_t* inst, char*);
+static int32 Crypto_Key_verify(crypto_instance_t* inst, char*);
 // Security Association Functions
-static int32 Crypto_SA_stop(void);
-static int32 Crypto_SA_start(void);
-static int32 Crypto_SA_expire(void);
-static int32 Crypto_SA_rekey(void);
-static int32 Crypto_SA_status(char*);
-static int32 Crypto_SA_create(void);
-static int32 Crypto_SA_setARSN(void);
-static int32 Crypto_SA_setARSNW(void);
-static int32 Crypto_SA_delete(void);
+static int32 Crypto_SA_stop(crypto_instance_t* inst);
+static void  Crypto_SA_release(crypto_instance_t* inst, crypto_gvcid_map_t* map, uint16 spi);
+static int32 Crypto_SA_start(crypto_instance_t* inst);
+static int32 Crypto_SA_expire(crypto_instance_t* inst);
+static int32 Crypto_SA_rekey(crypto_instance_t* inst);
+static int32 Crypto_SA_status(crypto_instance_t* inst, char*);
+static int32 Crypto_SA_create(crypto_instance_t* inst);
+static int32 Crypto_SA_setARSN(crypto_instance_t* inst);
+static int32 Crypto_SA_setARSNW(crypto_instance_t* inst);
+static int32 Crypto_SA_delete(crypto_instance_t* inst);
+static int32 Crypto_SA_find(crypto_instance_t* inst, uint8 type, uint8 tfvn, uint16 scid, uint8 vcid, uint16* spi);
 // Security Monitoring & Control Procedure
-static int32 Crypto_MC_ping(char* ingest);
-static int32 Crypto_MC_status(char* ingest);
-static int32 Crypto_MC_dump(char* ingest);
-static int32 Crypto_MC_erase(char* ingest);
-static int32 Crypto_MC_selftest(char* ingest);
-static int32 Crypto_SA_readARSN(char* ingest);
-static int32 Crypto_MC_resetalarm(void);
+static int32 Crypto_MC_ping(crypto_instance_t* inst, char* ingest);
+static int32 Crypto_MC_status(crypto_instance_t* inst, char* ingest);
+static int32 Crypto_MC_dump(crypto_instance_t* inst, char* ingest);
+static int32 Crypto_MC_erase(crypto_instance_t* inst, char* ingest);
+static int32 Crypto_MC_selftest(crypto_instance_t* inst, char* ingest);
+static int32 Crypto_SA_readARSN(crypto_instance_t* inst, char* ingest);
+static int32 Crypto_MC_resetalarm(crypto_instance_t* inst);
 // User Functions
-static int32 Crypto_User_IdleTrigger(char* ingest);
-static int32 Crypto_User_BadSPI(void);
-static int32 Crypto_User_BadIV(void);
-static int32 Crypto_User_BadMAC(void);
-static int32 Crypto_User_BadFECF(void);
-static int32 Crypto_User_ModifyKey(void);
-static int32 Crypto_User_ModifyActiveTM(void);
-static int32 Crypto_User_ModifyVCID(void);
+static int32 Crypto_User_IdleTrigger(crypto_instance_t* inst, char* ingest);
+static int32 Crypto_User_BadSPI(crypto_instance_t* inst);
+static int32 Crypto_User_BadIV(crypto_instance_t* inst);
+static int32 Crypto_User_BadMAC(crypto_instance_t* inst);
+static int32 Crypto_User_BadFECF(crypto_instance_t* inst);
+static int32 Crypto_User_ModifyKey(crypto_instance_t* inst);
+static int32 Crypto_User_ModifyActiveTM(crypto_instance_t* inst);
+static int32 Crypto_User_ModifyVCID(crypto_instance_t* inst);
 // Determine Payload Data Unit
-static int32 Crypto_PDU(char* ingest);
+static int32 Crypto_PDU(crypto_instance_t* inst, char* ingest);
+// Telecommand Functions
+static int32 Crypto_TC_process(crypto_instance_t* inst, char* ingest, int* len_ingest, crypto_tc_batch_t* batch,
+                               uint8* out, int out_len, crypto_tc_view_t* view);
+// Telemetry Functions
+static int32 Crypto_TM_frame(crypto_instance_t* inst, char* ingest, int* len_ingest, int frame_len, uint8 mux);
+static int32 Crypto_TM_process(crypto_instance_t* inst, char* ingest, int len_ingest, crypto_tm_view_t* view);
+// Advanced Orbiting Systems Functions
+static int32 Crypto_AOS_process(crypto_instance_t* inst, char* ingest, int len_ingest, crypto_aos_view_t* view);
 
 /*
 ** Global Variables
 */
-// Security
-static SecurityAssociation_t sa[NUM_SA];
-static crypto_key_t ek_ring[NUM_KEYS];
-//static crypto_key_t ak_ring[NUM_KEYS];
-// Local Frames
-static TC_t tc_frame;
-static CCSDS_t sdls_frame;
-static TM_t tm_frame;
-// OCF
-static uint8 ocf = 0;
-static SDLS_FSR_t report;
-static TM_FrameCLCW_t clcw;
-// Flags
-static SDLS_MC_LOG_RPLY_t log_summary;
-static SDLS_MC_DUMP_BLK_RPLY_t log;
-static uint8 log_count = 0;
-static uint16 tm_offset = 0;
-// ESA Testing - 0 = disabled, 1 = enabled
-static uint8 badSPI = 0;
-static uint8 badIV = 0;
-static uint8 badMAC = 0;
-static uint8 badFECF = 0;
-//  CRC
-static uint32 crc32Table[256];
-static uint16 crc16Table[256];
+// Default instance behind the single-link API
+static crypto_instance_t crypto_default;
+// Process-wide setup done by crypto_LibInit
+static uint8 crypto_lib_ready = 0;
 
 /*
 ** Initialization Functions
 */
-static int32 Crypto_SA_init(void)
+static int32 Crypto_SA_init(crypto_instance_t* inst)
 // General security association initialization
 {
     int32 status = OS_SUCCESS;
 
     for (int x = 0; x < NUM_SA; x++)
     {
-        sa[x].ekid = x;
-        sa[x].akid = x;
-        sa[x].sa_state = SA_NONE;
-        sa[x].ecs_len = 0;
-        sa[x].ecs[0] = 0;
-        sa[x].ecs[1] = 0;
-        sa[x].ecs[2] = 0;
-        sa[x].ecs[3] = 0;
-        sa[x].iv_len = IV_SIZE;
-        sa[x].acs_len = 0;
-        sa[x].acs = 0;
-        sa[x].arc_len = 0;
-        sa[x].arc[0] = 5;
+        inst->sa[x].ekid = x;
+        inst->sa[x].akid = x;
+        inst->sa[x].sa_state = SA_NONE;
+        inst->sa[x].ecs_len = 0;
+        inst->sa[x].ecs[0] = 0;
+        inst->sa[x].ecs[1] = 0;
+        inst->sa[x].ecs[2] = 0;
+        inst->sa[x].ecs[3] = 0;
+        inst->sa[x].iv_len = IV_SIZE;
+        inst->sa[x].acs_len = 0;
+        inst->sa[x].acs = 0;
+        inst->sa[x].arc_len = 0;
+        inst->sa[x].arc[0] = 5;
+        Crypto_ARC_reset(&inst->sa[x]);
     }
 
     // Initialize TM Frame
         // TM Header
-        tm_frame.tm_header.tfvn    = 0;	    // Shall be 00 for TM-/TC-SDLP
-        tm_frame.tm_header.scid    = SCID & 0x3FF; 
-        tm_frame.tm_header.vcid    = 0; 
-        tm_frame.tm_header.ocff    = 1;
-        tm_frame.tm_header.mcfc    = 1;
-        tm_frame.tm_header.vcfc    = 1;
-        tm_frame.tm_header.tfsh    = 0;
-        tm_frame.tm_header.sf      = 0;
-        tm_frame.tm_header.pof     = 0;	    // Shall be set to 0
-        tm_frame.tm_header.slid    = 3;	    // Shall be set to 11
-        tm_frame.tm_header.fhp     = 0;
+        inst->tm_frame.tm_header.tfvn    = 0;	    // Shall be 00 for TM-/TC-SDLP
+        inst->tm_frame.tm_header.scid    = SCID & 0x3FF; 
+        inst->tm_frame.tm_header.vcid    = 0; 
+        inst->tm_frame.tm_header.ocff    = 1;
+        inst->tm_frame.tm_header.mcfc    = 1;
+        inst->tm_frame.tm_header.vcfc    = 1;
+        inst->tm_frame.tm_header.tfsh    = 0;
+        inst->tm_frame.tm_header.sf      = 0;
+        inst->tm_frame.tm_header.pof     = 0;	    // Shall be set to 0
+        inst->tm_frame.tm_header.slid    = 3;	    // Shall be set to 11
+        inst->tm_frame.tm_header.fhp     = 0;
         // TM Security Header
-        tm_frame.tm_sec_header.spi = 0x0000;
+        inst->tm_frame.tm_sec_header.spi = 0x0000;
         for ( int x = 0; x < IV_SIZE; x++)
         { 	// Initialization Vector
-            tm_frame.tm_sec_header.iv[x] = 0x00;
+            inst->tm_frame.tm_sec_header.iv[x] = 0x00;
         }
         // TM Payload Data Unit
         for ( int x = 0; x < TM_FRAME_DATA_SIZE; x++)
         {	// Zero TM PDU
-            tm_frame.tm_pdu[x] = 0x00;
+            inst->tm_frame.tm_pdu[x] = 0x00;
         }
         // TM Security Trailer
         for ( int x = 0; x < MAC_SIZE; x++)
         { 	// Zero TM Message Authentication Code
-            tm_frame.tm_sec_trailer.mac[x] = 0x00;
+            inst->tm_frame.tm_sec_trailer.mac[x] = 0x00;
         }
         for ( int x = 0; x < OCF_SIZE; x++)
         { 	// Zero TM Operational Control Field
-            tm_frame.tm_sec_trailer.ocf[x] = 0x00;
+            inst->tm_frame.tm_sec_trailer.ocf[x] = 0x00;
         }
-        tm_frame.tm_sec_trailer.fecf = 0xFECF;
+        inst->tm_frame.tm_sec_trailer.fecf = 0xFECF;
 
     // Initialize CLCW
-        clcw.cwt 	= 0;			// Control Word Type "0"
-        clcw.cvn	= 0;			// CLCW Version Number "00"
-        clcw.sf  	= 0;    		// Status Field
-        clcw.cie 	= 1;			// COP In Effect
-        clcw.vci 	= 0;    		// Virtual Channel Identification
-        clcw.spare0 = 0;			// Reserved Spare
-        clcw.nrfa	= 0;			// No RF Avaliable Flag
-        clcw.nbl	= 0;			// No Bit Lock Flag
-        clcw.lo		= 0;			// Lock-Out Flag
-        clcw.wait	= 0;			// Wait Flag
-        clcw.rt		= 0;			// Retransmit Flag
-        clcw.fbc	= 0;			// FARM-B Counter
-        clcw.spare1 = 0;			// Reserved Spare
-        clcw.rv		= 0;        	// Report Value
+        inst->clcw.cwt 	= 0;			// Control Word Type "0"
+        inst->clcw.cvn	= 0;			// CLCW Version Number "00"
+        inst->clcw.sf  	= 0;    		// Status Field
+        inst->clcw.cie 	= 1;			// COP In Effect
+        inst->clcw.vci 	= 0;    		// Virtual Channel Identification
+        inst->clcw.spare0 = 0;			// Reserved Spare
+        inst->clcw.nrfa	= 0;			// No RF Avaliable Flag
+        inst->clcw.nbl	= 0;			// No Bit Lock Flag
+        inst->clcw.lo		= 0;			// Lock-Out Flag
+        inst->clcw.wait	= 0;			// Wait Flag
+        inst->clcw.rt		= 0;			// Retransmit Flag
+        inst->clcw.fbc	= 0;			// FARM-B Counter
+        inst->clcw.spare1 = 0;			// Reserved Spare
+        inst->clcw.rv		= 0;        	// Report Value
 
     // Initialize Frame Security Report
-        report.cwt   = 1;			// Control Word Type "0b1""
-        report.vnum  = 4;   		// FSR Version "0b100""
-        report.af    = 0;			// Alarm Field
-        report.bsnf  = 0;			// Bad SN Flag
-        report.bmacf = 0;			// Bad MAC Flag
-        report.ispif = 0;			// Invalid SPI Flag
-        report.lspiu = 0;	    	// Last SPI Used
-        report.snval = 0;			// SN Value (LSB)
+        inst->report.cwt   = 1;			// Control Word Type "0b1""
+        inst->report.vnum  = 4;   		// FSR Version "0b100""
+        inst->report.af    = 0;			// Alarm Field
+        inst->report.bsnf  = 0;			// Bad SN Flag
+        inst->report.bmacf = 0;			// Bad MAC Flag
+        inst->report.ispif = 0;			// Invalid SPI Flag
+        inst->report.lspiu = 0;	    	// Last SPI Used
+        inst->report.snval = 0;			// SN Value (LSB)
 
     return status;
 }
 
-static int32 Crypto_SA_config(void)
+static int32 Crypto_SA_config(crypto_instance_t* inst)
 // Initialize the mission specific security associations.
 // Only need to initialize non-zero values.
 {   
@@ -210,501 +206,495 @@ static int32 Crypto_SA_config(void)
     
     // Master Keys
         // 0 - 000102030405060708090A0B0C0D0E0F000102030405060708090A0B0C0D0E0F -> ACTIVE
-        ek_ring[0].value[0]  = 0x00;
-        ek_ring[0].value[1]  = 0x01;
-        ek_ring[0].value[2]  = 0x02;
-        ek_ring[0].value[3]  = 0x03;
-        ek_ring[0].value[4]  = 0x04;
-        ek_ring[0].value[5]  = 0x05;
-        ek_ring[0].value[6]  = 0x06;
-        ek_ring[0].value[7]  = 0x07;
-        ek_ring[0].value[8]  = 0x08;
-        ek_ring[0].value[9]  = 0x09;
-        ek_ring[0].value[10] = 0x0A;
-        ek_ring[0].value[11] = 0x0B;
-        ek_ring[0].value[12] = 0x0C;
-        ek_ring[0].value[13] = 0x0D;
-        ek_ring[0].value[14] = 0x0E;
-        ek_ring[0].value[15] = 0x0F;
-        ek_ring[0].value[16] = 0x00;
-        ek_ring[0].value[17] = 0x01;
-        ek_ring[0].value[18] = 0x02;
-        ek_ring[0].value[19] = 0x03;
-        ek_ring[0].value[20] = 0x04;
-        ek_ring[0].value[21] = 0x05;
-        ek_ring[0].value[22] = 0x06;
-        ek_ring[0].value[23] = 0x07;
-        ek_ring[0].value[24] = 0x08;
-        ek_ring[0].value[25] = 0x09;
-        ek_ring[0].value[26] = 0x0A;
-        ek_ring[0].value[27] = 0x0B;
-        ek_ring[0].value[28] = 0x0C;
-        ek_ring[0].value[29] = 0x0D;
-        ek_ring[0].value[30] = 0x0E;
-        ek_ring[0].value[31] = 0x0F;
-        ek_ring[0].key_state = KEY_ACTIVE;
+        inst->ek_ring[0].value[0]  = 0x00;
+        inst->ek_ring[0].value[1]  = 0x01;
+        inst->ek_ring[0].value[2]  = 0x02;
+        inst->ek_ring[0].value[3]  = 0x03;
+        inst->ek_ring[0].value[4]  = 0x04;
+        inst->ek_ring[0].value[5]  = 0x05;
+        inst->ek_ring[0].value[6]  = 0x06;
+        inst->ek_ring[0].value[7]  = 0x07;
+        inst->ek_ring[0].value[8]  = 0x08;
+        inst->ek_ring[0].value[9]  = 0x09;
+        inst->ek_ring[0].value[10] = 0x0A;
+        inst->ek_ring[0].value[11] = 0x0B;
+        inst->ek_ring[0].value[12] = 0x0C;
+        inst->ek_ring[0].value[13] = 0x0D;
+        inst->ek_ring[0].value[14] = 0x0E;
+        inst->ek_ring[0].value[15] = 0x0F;
+        inst->ek_ring[0].value[16] = 0x00;
+        inst->ek_ring[0].value[17] = 0x01;
+        inst->ek_ring[0].value[18] = 0x02;
+        inst->ek_ring[0].value[19] = 0x03;
+        inst->ek_ring[0].value[20] = 0x04;
+        inst->ek_ring[0].value[21] = 0x05;
+        inst->ek_ring[0].value[22] = 0x06;
+        inst->ek_ring[0].value[23] = 0x07;
+        inst->ek_ring[0].value[24] = 0x08;
+        inst->ek_ring[0].value[25] = 0x09;
+        inst->ek_ring[0].value[26] = 0x0A;
+        inst->ek_ring[0].value[27] = 0x0B;
+        inst->ek_ring[0].value[28] = 0x0C;
+        inst->ek_ring[0].value[29] = 0x0D;
+        inst->ek_ring[0].value[30] = 0x0E;
+        inst->ek_ring[0].value[31] = 0x0F;
+        inst->ek_ring[0].key_state = KEY_ACTIVE;
         // 1 - 101112131415161718191A1B1C1D1E1F101112131415161718191A1B1C1D1E1F -> ACTIVE
-        ek_ring[1].value[0]  = 0x10;
-        ek_ring[1].value[1]  = 0x11;
-        ek_ring[1].value[2]  = 0x12;
-        ek_ring[1].value[3]  = 0x13;
-        ek_ring[1].value[4]  = 0x14;
-        ek_ring[1].value[5]  = 0x15;
-        ek_ring[1].value[6]  = 0x16;
-        ek_ring[1].value[7]  = 0x17;
-        ek_ring[1].value[8]  = 0x18;
-        ek_ring[1].value[9]  = 0x19;
-        ek_ring[1].value[10] = 0x1A;
-        ek_ring[1].value[11] = 0x1B;
-        ek_ring[1].value[12] = 0x1C;
-        ek_ring[1].value[13] = 0x1D;
-        ek_ring[1].value[14] = 0x1E;
-        ek_ring[1].value[15] = 0x1F;
-        ek_ring[1].value[16] = 0x10;
-        ek_ring[1].value[17] = 0x11;
-        ek_ring[1].value[18] = 0x12;
-        ek_ring[1].value[19] = 0x13;
-        ek_ring[1].value[20] = 0x14;
-        ek_ring[1].value[21] = 0x15;
-        ek_ring[1].value[22] = 0x16;
-        ek_ring[1].value[23] = 0x17;
-        ek_ring[1].value[24] = 0x18;
-        ek_ring[1].value[25] = 0x19;
-        ek_ring[1].value[26] = 0x1A;
-        ek_ring[1].value[27] = 0x1B;
-        ek_ring[1].value[28] = 0x1C;
-        ek_ring[1].value[29] = 0x1D;
-        ek_ring[1].value[30] = 0x1E;
-        ek_ring[1].value[31] = 0x1F;
-        ek_ring[1].key_state = KEY_ACTIVE;
+        inst->ek_ring[1].value[0]  = 0x10;
+        inst->ek_ring[1].value[1]  = 0x11;
+        inst->ek_ring[1].value[2]  = 0x12;
+        inst->ek_ring[1].value[3]  = 0x13;
+        inst->ek_ring[1].value[4]  = 0x14;
+        inst->ek_ring[1].value[5]  = 0x15;
+        inst->ek_ring[1].value[6]  = 0x16;
+        inst->ek_ring[1].value[7]  = 0x17;
+        inst->ek_ring[1].value[8]  = 0x18;
+        inst->ek_ring[1].value[9]  = 0x19;
+        inst->ek_ring[1].value[10] = 0x1A;
+        inst->ek_ring[1].value[11] = 0x1B;
+        inst->ek_ring[1].value[12] = 0x1C;
+        inst->ek_ring[1].value[13] = 0x1D;
+        inst->ek_ring[1].value[14] = 0x1E;
+        inst->ek_ring[1].value[15] = 0x1F;
+        inst->ek_ring[1].value[16] = 0x10;
+        inst->ek_ring[1].value[17] = 0x11;
+        inst->ek_ring[1].value[18] = 0x12;
+        inst->ek_ring[1].value[19] = 0x13;
+        inst->ek_ring[1].value[20] = 0x14;
+        inst->ek_ring[1].value[21] = 0x15;
+        inst->ek_ring[1].value[22] = 0x16;
+        inst->ek_ring[1].value[23] = 0x17;
+        inst->ek_ring[1].value[24] = 0x18;
+        inst->ek_ring[1].value[25] = 0x19;
+        inst->ek_ring[1].value[26] = 0x1A;
+        inst->ek_ring[1].value[27] = 0x1B;
+        inst->ek_ring[1].value[28] = 0x1C;
+        inst->ek_ring[1].value[29] = 0x1D;
+        inst->ek_ring[1].value[30] = 0x1E;
+        inst->ek_ring[1].value[31] = 0x1F;
+        inst->ek_ring[1].key_state = KEY_ACTIVE;
         // 2 - 202122232425262728292A2B2C2D2E2F202122232425262728292A2B2C2D2E2F -> ACTIVE
-        ek_ring[2].value[0]  = 0x20;
-        ek_ring[2].value[1]  = 0x21;
-        ek_ring[2].value[2]  = 0x22;
-        ek_ring[2].value[3]  = 0x23;
-        ek_ring[2].value[4]  = 0x24;
-        ek_ring[2].value[5]  = 0x25;
-        ek_ring[2].value[6]  = 0x26;
-        ek_ring[2].value[7]  = 0x27;
-        ek_ring[2].value[8]  = 0x28;
-        ek_ring[2].value[9]  = 0x29;
-        ek_ring[2].value[10] = 0x2A;
-        ek_ring[2].value[11] = 0x2B;
-        ek_ring[2].value[12] = 0x2C;
-        ek_ring[2].value[13] = 0x2D;
-        ek_ring[2].value[14] = 0x2E;
-        ek_ring[2].value[15] = 0x2F;
-        ek_ring[2].value[16] = 0x20;
-        ek_ring[2].value[17] = 0x21;
-        ek_ring[2].value[18] = 0x22;
-        ek_ring[2].value[19] = 0x23;
-        ek_ring[2].value[20] = 0x24;
-        ek_ring[2].value[21] = 0x25;
-        ek_ring[2].value[22] = 0x26;
-        ek_ring[2].value[23] = 0x27;
-        ek_ring[2].value[24] = 0x28;
-        ek_ring[2].value[25] = 0x29;
-        ek_ring[2].value[26] = 0x2A;
-        ek_ring[2].value[27] = 0x2B;
-        ek_ring[2].value[28] = 0x2C;
-        ek_ring[2].value[29] = 0x2D;
-        ek_ring[2].value[30] = 0x2E;
-        ek_ring[2].value[31] = 0x2F;
-        ek_ring[2].key_state = KEY_ACTIVE;
+        inst->ek_ring[2].value[0]  = 0x20;
+        inst->ek_ring[2].value[1]  = 0x21;
+        inst->ek_ring[2].value[2]  = 0x22;
+        inst->ek_ring[2].value[3]  = 0x23;
+        inst->ek_ring[2].value[4]  = 0x24;
+        inst->ek_ring[2].value[5]  = 0x25;
+        inst->ek_ring[2].value[6]  = 0x26;
+        inst->ek_ring[2].value[7]  = 0x27;
+        inst->ek_ring[2].value[8]  = 0x28;
+        inst->ek_ring[2].value[9]  = 0x29;
+        inst->ek_ring[2].value[10] = 0x2A;
+        inst->ek_ring[2].value[11] = 0x2B;
+        inst->ek_ring[2].value[12] = 0x2C;
+        inst->ek_ring[2].value[13] = 0x2D;
+        inst->ek_ring[2].value[14] = 0x2E;
+        inst->ek_ring[2].value[15] = 0x2F;
+        inst->ek_ring[2].value[16] = 0x20;
+        inst->ek_ring[2].value[17] = 0x21;
+        inst->ek_ring[2].value[18] = 0x22;
+        inst->ek_ring[2].value[19] = 0x23;
+        inst->ek_ring[2].value[20] = 0x24;
+        inst->ek_ring[2].value[21] = 0x25;
+        inst->ek_ring[2].value[22] = 0x26;
+        inst->ek_ring[2].value[23] = 0x27;
+        inst->ek_ring[2].value[24] = 0x28;
+        inst->ek_ring[2].value[25] = 0x29;
+        inst->ek_ring[2].value[26] = 0x2A;
+        inst->ek_ring[2].value[27] = 0x2B;
+        inst->ek_ring[2].value[28] = 0x2C;
+        inst->ek_ring[2].value[29] = 0x2D;
+        inst->ek_ring[2].value[30] = 0x2E;
+        inst->ek_ring[2].value[31] = 0x2F;
+        inst->ek_ring[2].key_state = KEY_ACTIVE;
 
     // Session Keys
         // 128 - 0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF -> ACTIVE
-        ek_ring[128].value[0]  = 0x01;
-        ek_ring[128].value[1]  = 0x23;
-        ek_ring[128].value[2]  = 0x45;
-        ek_ring[128].value[3]  = 0x67;
-        ek_ring[128].value[4]  = 0x89;
-        ek_ring[128].value[5]  = 0xAB;
-        ek_ring[128].value[6]  = 0xCD;
-        ek_ring[128].value[7]  = 0xEF;
-        ek_ring[128].value[8]  = 0x01;
-        ek_ring[128].value[9]  = 0x23;
-        ek_ring[128].value[10] = 0x45;
-        ek_ring[128].value[11] = 0x67;
-        ek_ring[128].value[12] = 0x89;
-        ek_ring[128].value[13] = 0xAB;
-        ek_ring[128].value[14] = 0xCD;
-        ek_ring[128].value[15] = 0xEF;
-        ek_ring[128].value[16] = 0x01;
-        ek_ring[128].value[17] = 0x23;
-        ek_ring[128].value[18] = 0x45;
-        ek_ring[128].value[19] = 0x67;
-        ek_ring[128].value[20] = 0x89;
-        ek_ring[128].value[21] = 0xAB;
-        ek_ring[128].value[22] = 0xCD;
-        ek_ring[128].value[23] = 0xEF;
-        ek_ring[128].value[24] = 0x01;
-        ek_ring[128].value[25] = 0x23;
-        ek_ring[128].value[26] = 0x45;
-        ek_ring[128].value[27] = 0x67;
-        ek_ring[128].value[28] = 0x89;
-        ek_ring[128].value[29] = 0xAB;
-        ek_ring[128].value[30] = 0xCD;
-        ek_ring[128].value[31] = 0xEF;
-        ek_ring[128].key_state = KEY_ACTIVE;
+        inst->ek_ring[128].value[0]  = 0x01;
+        inst->ek_ring[128].value[1]  = 0x23;
+        inst->ek_ring[128].value[2]  = 0x45;
+        inst->ek_ring[128].value[3]  = 0x67;
+        inst->ek_ring[128].value[4]  = 0x89;
+        inst->ek_ring[128].value[5]  = 0xAB;
+        inst->ek_ring[128].value[6]  = 0xCD;
+        inst->ek_ring[128].value[7]  = 0xEF;
+        inst->ek_ring[128].value[8]  = 0x01;
+        inst->ek_ring[128].value[9]  = 0x23;
+        inst->ek_ring[128].value[10] = 0x45;
+        inst->ek_ring[128].value[11] = 0x67;
+        inst->ek_ring[128].value[12] = 0x89;
+        inst->ek_ring[128].value[13] = 0xAB;
+        inst->ek_ring[128].value[14] = 0xCD;
+        inst->ek_ring[128].value[15] = 0xEF;
+        inst->ek_ring[128].value[16] = 0x01;
+        inst->ek_ring[128].value[17] = 0x23;
+        inst->ek_ring[128].value[18] = 0x45;
+        inst->ek_ring[128].value[19] = 0x67;
+        inst->ek_ring[128].value[20] = 0x89;
+        inst->ek_ring[128].value[21] = 0xAB;
+        inst->ek_ring[128].value[22] = 0xCD;
+        inst->ek_ring[128].value[23] = 0xEF;
+        inst->ek_ring[128].value[24] = 0x01;
+        inst->ek_ring[128].value[25] = 0x23;
+        inst->ek_ring[128].value[26] = 0x45;
+        inst->ek_ring[128].value[27] = 0x67;
+        inst->ek_ring[128].value[28] = 0x89;
+        inst->ek_ring[128].value[29] = 0xAB;
+        inst->ek_ring[128].value[30] = 0xCD;
+        inst->ek_ring[128].value[31] = 0xEF;
+        inst->ek_ring[128].key_state = KEY_ACTIVE;
         // 129 - ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789 -> ACTIVE
-        ek_ring[129].value[0]  = 0xAB;
-        ek_ring[129].value[1]  = 0xCD;
-        ek_ring[129].value[2]  = 0xEF;
-        ek_ring[129].value[3]  = 0x01;
-        ek_ring[129].value[4]  = 0x23;
-        ek_ring[129].value[5]  = 0x45;
-        ek_ring[129].value[6]  = 0x67;
-        ek_ring[129].value[7]  = 0x89;
-        ek_ring[129].value[8]  = 0xAB;
-        ek_ring[129].value[9]  = 0xCD;
-        ek_ring[129].value[10] = 0xEF;
-        ek_ring[129].value[11] = 0x01;
-        ek_ring[129].value[12] = 0x23;
-        ek_ring[129].value[13] = 0x45;
-        ek_ring[129].value[14] = 0x67;
-        ek_ring[129].value[15] = 0x89;
-        ek_ring[129].value[16] = 0xAB;
-        ek_ring[129].value[17] = 0xCD;
-        ek_ring[129].value[18] = 0xEF;
-        ek_ring[129].value[19] = 0x01;
-        ek_ring[129].value[20] = 0x23;
-        ek_ring[129].value[21] = 0x45;
-        ek_ring[129].value[22] = 0x67;
-        ek_ring[129].value[23] = 0x89;
-        ek_ring[129].value[24] = 0xAB;
-        ek_ring[129].value[25] = 0xCD;
-        ek_ring[129].value[26] = 0xEF;
-        ek_ring[129].value[27] = 0x01;
-        ek_ring[129].value[28] = 0x23;
-        ek_ring[129].value[29] = 0x45;
-        ek_ring[129].value[30] = 0x67;
-        ek_ring[129].value[31] = 0x89;
-        ek_ring[129].key_state = KEY_ACTIVE;
+        inst->ek_ring[129].value[0]  = 0xAB;
+        inst->ek_ring[129].value[1]  = 0xCD;
+        inst->ek_ring[129].value[2]  = 0xEF;
+        inst->ek_ring[129].value[3]  = 0x01;
+        inst->ek_ring[129].value[4]  = 0x23;
+        inst->ek_ring[129].value[5]  = 0x45;
+        inst->ek_ring[129].value[6]  = 0x67;
+        inst->ek_ring[129].value[7]  = 0x89;
+        inst->ek_ring[129].value[8]  = 0xAB;
+        inst->ek_ring[129].value[9]  = 0xCD;
+        inst->ek_ring[129].value[10] = 0xEF;
+        inst->ek_ring[129].value[11] = 0x01;
+        inst->ek_ring[129].value[12] = 0x23;
+        inst->ek_ring[129].value[13] = 0x45;
+        inst->ek_ring[129].value[14] = 0x67;
+        inst->ek_ring[129].value[15] = 0x89;
+        inst->ek_ring[129].value[16] = 0xAB;
+        inst->ek_ring[129].value[17] = 0xCD;
+        inst->ek_ring[129].value[18] = 0xEF;
+        inst->ek_ring[129].value[19] = 0x01;
+        inst->ek_ring[129].value[20] = 0x23;
+        inst->ek_ring[129].value[21] = 0x45;
+        inst->ek_ring[129].value[22] = 0x67;
+        inst->ek_ring[129].value[23] = 0x89;
+        inst->ek_ring[129].value[24] = 0xAB;
+        inst->ek_ring[129].value[25] = 0xCD;
+        inst->ek_ring[129].value[26] = 0xEF;
+        inst->ek_ring[129].value[27] = 0x01;
+        inst->ek_ring[129].value[28] = 0x23;
+        inst->ek_ring[129].value[29] = 0x45;
+        inst->ek_ring[129].value[30] = 0x67;
+        inst->ek_ring[129].value[31] = 0x89;
+        inst->ek_ring[129].key_state = KEY_ACTIVE;
         // 130 - FEDCBA9876543210FEDCBA9876543210FEDCBA9876543210FEDCBA9876543210 -> ACTIVE
-        ek_ring[130].value[0]  = 0xFE;
-        ek_ring[130].value[1]  = 0xDC;
-        ek_ring[130].value[2]  = 0xBA;
-        ek_ring[130].value[3]  = 0x98;
-        ek_ring[130].value[4]  = 0x76;
-        ek_ring[130].value[5]  = 0x54;
-        ek_ring[130].value[6]  = 0x32;
-        ek_ring[130].value[7]  = 0x10;
-        ek_ring[130].value[8]  = 0xFE;
-        ek_ring[130].value[9]  = 0xDC;
-        ek_ring[130].value[10] = 0xBA;
-        ek_ring[130].value[11] = 0x98;
-        ek_ring[130].value[12] = 0x76;
-        ek_ring[130].value[13] = 0x54;
-        ek_ring[130].value[14] = 0x32;
-        ek_ring[130].value[15] = 0x10;
-        ek_ring[130].value[16] = 0xFE;
-        ek_ring[130].value[17] = 0xDC;
-        ek_ring[130].value[18] = 0xBA;
-        ek_ring[130].value[19] = 0x98;
-        ek_ring[130].value[20] = 0x76;
-        ek_ring[130].value[21] = 0x54;
-        ek_ring[130].value[22] = 0x32;
-        ek_ring[130].value[23] = 0x10;
-        ek_ring[130].value[24] = 0xFE;
-        ek_ring[130].value[25] = 0xDC;
-        ek_ring[130].value[26] = 0xBA;
-        ek_ring[130].value[27] = 0x98;
-        ek_ring[130].value[28] = 0x76;
-        ek_ring[130].value[29] = 0x54;
-        ek_ring[130].value[30] = 0x32;
-        ek_ring[130].value[31] = 0x10;
-        ek_ring[130].key_state = KEY_ACTIVE;
+        inst->ek_ring[130].value[0]  = 0xFE;
+        inst->ek_ring[130].value[1]  = 0xDC;
+        inst->ek_ring[130].value[2]  = 0xBA;
+        inst->ek_ring[130].value[3]  = 0x98;
+        inst->ek_ring[130].value[4]  = 0x76;
+        inst->ek_ring[130].value[5]  = 0x54;
+        inst->ek_ring[130].value[6]  = 0x32;
+        inst->ek_ring[130].value[7]  = 0x10;
+        inst->ek_ring[130].value[8]  = 0xFE;
+        inst->ek_ring[130].value[9]  = 0xDC;
+        inst->ek_ring[130].value[10] = 0xBA;
+        inst->ek_ring[130].value[11] = 0x98;
+        inst->ek_ring[130].value[12] = 0x76;
+        inst->ek_ring[130].value[13] = 0x54;
+        inst->ek_ring[130].value[14] = 0x32;
+        inst->ek_ring[130].value[15] = 0x10;
+        inst->ek_ring[130].value[16] = 0xFE;
+        inst->ek_ring[130].value[17] = 0xDC;
+        inst->ek_ring[130].value[18] = 0xBA;
+        inst->ek_ring[130].value[19] = 0x98;
+        inst->ek_ring[130].value[20] = 0x76;
+        inst->ek_ring[130].value[21] = 0x54;
+        inst->ek_ring[130].value[22] = 0x32;
+        inst->ek_ring[130].value[23] = 0x10;
+        inst->ek_ring[130].value[24] = 0xFE;
+        inst->ek_ring[130].value[25] = 0xDC;
+        inst->ek_ring[130].value[26] = 0xBA;
+        inst->ek_ring[130].value[27] = 0x98;
+        inst->ek_ring[130].value[28] = 0x76;
+        inst->ek_ring[130].value[29] = 0x54;
+        inst->ek_ring[130].value[30] = 0x32;
+        inst->ek_ring[130].value[31] = 0x10;
+        inst->ek_ring[130].key_state = KEY_ACTIVE;
         // 131 - 9876543210FEDCBA9876543210FEDCBA9876543210FEDCBA9876543210FEDCBA -> ACTIVE
-        ek_ring[131].value[0]  = 0x98;
-        ek_ring[131].value[1]  = 0x76;
-        ek_ring[131].value[2]  = 0x54;
-        ek_ring[131].value[3]  = 0x32;
-        ek_ring[131].value[4]  = 0x10;
-        ek_ring[131].value[5]  = 0xFE;
-        ek_ring[131].value[6]  = 0xDC;
-        ek_ring[131].value[7]  = 0xBA;
-        ek_ring[131].value[8]  = 0x98;
-        ek_ring[131].value[9]  = 0x76;
-        ek_ring[131].value[10] = 0x54;
-        ek_ring[131].value[11] = 0x32;
-        ek_ring[131].value[12] = 0x10;
-        ek_ring[131].value[13] = 0xFE;
-        ek_ring[131].value[14] = 0xDC;
-        ek_ring[131].value[15] = 0xBA;
-        ek_ring[131].value[16] = 0x98;
-        ek_ring[131].value[17] = 0x76;
-        ek_ring[131].value[18] = 0x54;
-        ek_ring[131].value[19] = 0x32;
-        ek_ring[131].value[20] = 0x10;
-        ek_ring[131].value[21] = 0xFE;
-        ek_ring[131].value[22] = 0xDC;
-        ek_ring[131].value[23] = 0xBA;
-        ek_ring[131].value[24] = 0x98;
-        ek_ring[131].value[25] = 0x76;
-        ek_ring[131].value[26] = 0x54;
-        ek_ring[131].value[27] = 0x32;
-        ek_ring[131].value[28] = 0x10;
-        ek_ring[131].value[29] = 0xFE;
-        ek_ring[131].value[30] = 0xDC;
-        ek_ring[131].value[31] = 0xBA;
-        ek_ring[131].key_state = KEY_ACTIVE;
+        inst->ek_ring[131].value[0]  = 0x98;
+        inst->ek_ring[131].value[1]  = 0x76;
+        inst->ek_ring[131].value[2]  = 0x54;
+        inst->ek_ring[131].value[3]  = 0x32;
+        inst->ek_ring[131].value[4]  = 0x10;
+        inst->ek_ring[131].value[5]  = 0xFE;
+        inst->ek_ring[131].value[6]  = 0xDC;
+        inst->ek_ring[131].value[7]  = 0xBA;
+        inst->ek_ring[131].value[8]  = 0x98;
+        inst->ek_ring[131].value[9]  = 0x76;
+        inst->ek_ring[131].value[10] = 0x54;
+        inst->ek_ring[131].value[11] = 0x32;
+        inst->ek_ring[131].value[12] = 0x10;
+        inst->ek_ring[131].value[13] = 0xFE;
+        inst->ek_ring[131].value[14] = 0xDC;
+        inst->ek_ring[131].value[15] = 0xBA;
+        inst->ek_ring[131].value[16] = 0x98;
+        inst->ek_ring[131].value[17] = 0x76;
+        inst->ek_ring[131].value[18] = 0x54;
+        inst->ek_ring[131].value[19] = 0x32;
+        inst->ek_ring[131].value[20] = 0x10;
+        inst->ek_ring[131].value[21] = 0xFE;
+        inst->ek_ring[131].value[22] = 0xDC;
+        inst->ek_ring[131].value[23] = 0xBA;
+        inst->ek_ring[131].value[24] = 0x98;
+        inst->ek_ring[131].value[25] = 0x76;
+        inst->ek_ring[131].value[26] = 0x54;
+        inst->ek_ring[131].value[27] = 0x32;
+        inst->ek_ring[131].value[28] = 0x10;
+        inst->ek_ring[131].value[29] = 0xFE;
+        inst->ek_ring[131].value[30] = 0xDC;
+        inst->ek_ring[131].value[31] = 0xBA;
+        inst->ek_ring[131].key_state = KEY_ACTIVE;
         // 132 - 0123456789ABCDEFABCDEF01234567890123456789ABCDEFABCDEF0123456789 -> PRE_ACTIVATION
-        ek_ring[132].value[0]  = 0x01;
-        ek_ring[132].value[1]  = 0x23;
-        ek_ring[132].value[2]  = 0x45;
-        ek_ring[132].value[3]  = 0x67;
-        ek_ring[132].value[4]  = 0x89;
-        ek_ring[132].value[5]  = 0xAB;
-        ek_ring[132].value[6]  = 0xCD;
-        ek_ring[132].value[7]  = 0xEF;
-        ek_ring[132].value[8]  = 0xAB;
-        ek_ring[132].value[9]  = 0xCD;
-        ek_ring[132].value[10] = 0xEF;
-        ek_ring[132].value[11] = 0x01;
-        ek_ring[132].value[12] = 0x23;
-        ek_ring[132].value[13] = 0x45;
-        ek_ring[132].value[14] = 0x67;
-        ek_ring[132].value[15] = 0x89;
-        ek_ring[132].value[16] = 0x01;
-        ek_ring[132].value[17] = 0x23;
-        ek_ring[132].value[18] = 0x45;
-        ek_ring[132].value[19] = 0x67;
-        ek_ring[132].value[20] = 0x89;
-        ek_ring[132].value[21] = 0xAB;
-        ek_ring[132].value[22] = 0xCD;
-        ek_ring[132].value[23] = 0xEF;
-        ek_ring[132].value[24] = 0xAB;
-        ek_ring[132].value[25] = 0xCD;
-        ek_ring[132].value[26] = 0xEF;
-        ek_ring[132].value[27] = 0x01;
-        ek_ring[132].value[28] = 0x23;
-        ek_ring[132].value[29] = 0x45;
-        ek_ring[132].value[30] = 0x67;
-        ek_ring[132].value[31] = 0x89;
-        ek_ring[132].key_state = KEY_PREACTIVE;
+        inst->ek_ring[132].value[0]  = 0x01;
+        inst->ek_ring[132].value[1]  = 0x23;
+        inst->ek_ring[132].value[2]  = 0x45;
+        inst->ek_ring[132].value[3]  = 0x67;
+        inst->ek_ring[132].value[4]  = 0x89;
+        inst->ek_ring[132].value[5]  = 0xAB;
+        inst->ek_ring[132].value[6]  = 0xCD;
+        inst->ek_ring[132].value[7]  = 0xEF;
+        inst->ek_ring[132].value[8]  = 0xAB;
+        inst->ek_ring[132].value[9]  = 0xCD;
+        inst->ek_ring[132].value[10] = 0xEF;
+        inst->ek_ring[132].value[11] = 0x01;
+        inst->ek_ring[132].value[12] = 0x23;
+        inst->ek_ring[132].value[13] = 0x45;
+        inst->ek_ring[132].value[14] = 0x67;
+        inst->ek_ring[132].value[15] = 0x89;
+        inst->ek_ring[132].value[16] = 0x01;
+        inst->ek_ring[132].value[17] = 0x23;
+        inst->ek_ring[132].value[18] = 0x45;
+        inst->ek_ring[132].value[19] = 0x67;
+        inst->ek_ring[132].value[20] = 0x89;
+        inst->ek_ring[132].value[21] = 0xAB;
+        inst->ek_ring[132].value[22] = 0xCD;
+        inst->ek_ring[132].value[23] = 0xEF;
+        inst->ek_ring[132].value[24] = 0xAB;
+        inst->ek_ring[132].value[25] = 0xCD;
+        inst->ek_ring[132].value[26] = 0xEF;
+        inst->ek_ring[132].value[27] = 0x01;
+        inst->ek_ring[132].value[28] = 0x23;
+        inst->ek_ring[132].value[29] = 0x45;
+        inst->ek_ring[132].value[30] = 0x67;
+        inst->ek_ring[132].value[31] = 0x89;
+        inst->ek_ring[132].key_state = KEY_PREACTIVE;
         // 133 - ABCDEF01234567890123456789ABCDEFABCDEF01234567890123456789ABCDEF -> ACTIVE
-        ek_ring[133].value[0]  = 0xAB;
-        ek_ring[133].value[1]  = 0xCD;
-        ek_ring[133].value[2]  = 0xEF;
-        ek_ring[133].value[3]  = 0x01;
-        ek_ring[133].value[4]  = 0x23;
-        ek_ring[133].value[5]  = 0x45;
-        ek_ring[133].value[6]  = 0x67;
-        ek_ring[133].value[7]  = 0x89;
-        ek_ring[133].value[8]  = 0x01;
-        ek_ring[133].value[9]  = 0x23;
-        ek_ring[133].value[10] = 0x45;
-        ek_ring[133].value[11] = 0x67;
-        ek_ring[133].value[12] = 0x89;
-        ek_ring[133].value[13] = 0xAB;
-        ek_ring[133].value[14] = 0xCD;
-        ek_ring[133].value[15] = 0xEF;
-        ek_ring[133].value[16] = 0xAB;
-        ek_ring[133].value[17] = 0xCD;
-        ek_ring[133].value[18] = 0xEF;
-        ek_ring[133].value[19] = 0x01;
-        ek_ring[133].value[20] = 0x23;
-        ek_ring[133].value[21] = 0x45;
-        ek_ring[133].value[22] = 0x67;
-        ek_ring[133].value[23] = 0x89;
-        ek_ring[133].value[24] = 0x01;
-        ek_ring[133].value[25] = 0x23;
-        ek_ring[133].value[26] = 0x45;
-        ek_ring[133].value[27] = 0x67;
-        ek_ring[133].value[28] = 0x89;
-        ek_ring[133].value[29] = 0xAB;
-        ek_ring[133].value[30] = 0xCD;
-        ek_ring[133].value[31] = 0xEF;
-        ek_ring[133].key_state = KEY_ACTIVE;
+        inst->ek_ring[133].value[0]  = 0xAB;
+        inst->ek_ring[133].value[1]  = 0xCD;
+        inst->ek_ring[133].value[2]  = 0xEF;
+        inst->ek_ring[133].value[3]  = 0x01;
+        inst->ek_ring[133].value[4]  = 0x23;
+        inst->ek_ring[133].value[5]  = 0x45;
+        inst->ek_ring[133].value[6]  = 0x67;
+        inst->ek_ring[133].value[7]  = 0x89;
+        inst->ek_ring[133].value[8]  = 0x01;
+        inst->ek_ring[133].value[9]  = 0x23;
+        inst->ek_ring[133].value[10] = 0x45;
+        inst->ek_ring[133].value[11] = 0x67;
+        inst->ek_ring[133].value[12] = 0x89;
+        inst->ek_ring[133].value[13] = 0xAB;
+        inst->ek_ring[133].value[14] = 0xCD;
+        inst->ek_ring[133].value[15] = 0xEF;
+        inst->ek_ring[133].value[16] = 0xAB;
+        inst->ek_ring[133].value[17] = 0xCD;
+        inst->ek_ring[133].value[18] = 0xEF;
+        inst->ek_ring[133].value[19] = 0x01;
+        inst->ek_ring[133].value[20] = 0x23;
+        inst->ek_ring[133].value[21] = 0x45;
+        inst->ek_ring[133].value[22] = 0x67;
+        inst->ek_ring[133].value[23] = 0x89;
+        inst->ek_ring[133].value[24] = 0x01;
+        inst->ek_ring[133].value[25] = 0x23;
+        inst->ek_ring[133].value[26] = 0x45;
+        inst->ek_ring[133].value[27] = 0x67;
+        inst->ek_ring[133].value[28] = 0x89;
+        inst->ek_ring[133].value[29] = 0xAB;
+        inst->ek_ring[133].value[30] = 0xCD;
+        inst->ek_ring[133].value[31] = 0xEF;
+        inst->ek_ring[133].key_state = KEY_ACTIVE;
         // 134 - ABCDEF0123456789FEDCBA9876543210ABCDEF0123456789FEDCBA9876543210 -> DEACTIVE
-        ek_ring[134].value[0]  = 0xAB;
-        ek_ring[134].value[1]  = 0xCD;
-        ek_ring[134].value[2]  = 0xEF;
-        ek_ring[134].value[3]  = 0x01;
-        ek_ring[134].value[4]  = 0x23;
-        ek_ring[134].value[5]  = 0x45;
-        ek_ring[134].value[6]  = 0x67;
-        ek_ring[134].value[7]  = 0x89;
-        ek_ring[134].value[8]  = 0xFE;
-        ek_ring[134].value[9]  = 0xDC;
-        ek_ring[134].value[10] = 0xBA;
-        ek_ring[134].value[11] = 0x98;
-        ek_ring[134].value[12] = 0x76;
-        ek_ring[134].value[13] = 0x54;
-        ek_ring[134].value[14] = 0x32;
-        ek_ring[134].value[15] = 0x10;
-        ek_ring[134].value[16] = 0xAB;
-        ek_ring[134].value[17] = 0xCD;
-        ek_ring[134].value[18] = 0xEF;
-        ek_ring[134].value[19] = 0x01;
-        ek_ring[134].value[20] = 0x23;
-        ek_ring[134].value[21] = 0x45;
-        ek_ring[134].value[22] = 0x67;
-        ek_ring[134].value[23] = 0x89;
-        ek_ring[134].value[24] = 0xFE;
-        ek_ring[134].value[25] = 0xDC;
-        ek_ring[134].value[26] = 0xBA;
-        ek_ring[134].value[27] = 0x98;
-        ek_ring[134].value[28] = 0x76;
-        ek_ring[134].value[29] = 0x54;
-        ek_ring[134].value[30] = 0x32;
-        ek_ring[134].value[31] = 0x10;
-        ek_ring[134].key_state = KEY_DEACTIVATED;
+        inst->ek_ring[134].value[0]  = 0xAB;
+        inst->ek_ring[134].value[1]  = 0xCD;
+        inst->ek_ring[134].value[2]  = 0xEF;
+        inst->ek_ring[134].value[3]  = 0x01;
+        inst->ek_ring[134].value[4]  = 0x23;
+        inst->ek_ring[134].value[5]  = 0x45;
+        inst->ek_ring[134].value[6]  = 0x67;
+        inst->ek_ring[134].value[7]  = 0x89;
+        inst->ek_ring[134].value[8]  = 0xFE;
+        inst->ek_ring[134].value[9]  = 0xDC;
+        inst->ek_ring[134].value[10] = 0xBA;
+        inst->ek_ring[134].value[11] = 0x98;
+        inst->ek_ring[134].value[12] = 0x76;
+        inst->ek_ring[134].value[13] = 0x54;
+        inst->ek_ring[134].value[14] = 0x32;
+        inst->ek_ring[134].value[15] = 0x10;
+        inst->ek_ring[134].value[16] = 0xAB;
+        inst->ek_ring[134].value[17] = 0xCD;
+        inst->ek_ring[134].value[18] = 0xEF;
+        inst->ek_ring[134].value[19] = 0x01;
+        inst->ek_ring[134].value[20] = 0x23;
+        inst->ek_ring[134].value[21] = 0x45;
+        inst->ek_ring[134].value[22] = 0x67;
+        inst->ek_ring[134].value[23] = 0x89;
+        inst->ek_ring[134].value[24] = 0xFE;
+        inst->ek_ring[134].value[25] = 0xDC;
+        inst->ek_ring[134].value[26] = 0xBA;
+        inst->ek_ring[134].value[27] = 0x98;
+        inst->ek_ring[134].value[28] = 0x76;
+        inst->ek_ring[134].value[29] = 0x54;
+        inst->ek_ring[134].value[30] = 0x32;
+        inst->ek_ring[134].value[31] = 0x10;
+        inst->ek_ring[134].key_state = KEY_DEACTIVATED;
 
     // Security Associations
         // SA 1 - CLEAR MODE
-        sa[1].sa_state = SA_OPERATIONAL;
-        sa[1].est = 0;
-        sa[1].ast = 0;
-        sa[1].arc_len = 1;
-        sa[1].arcw_len = 1;
-        sa[1].arcw[0] = 5;
-        sa[1].gvcid_tc_blk[0].tfvn  = 0;
-        sa[1].gvcid_tc_blk[0].scid  = SCID & 0x3FF;
-        sa[1].gvcid_tc_blk[0].vcid  = 0;
-        sa[1].gvcid_tc_blk[0].mapid = TYPE_TC;
-        sa[1].gvcid_tc_blk[1].tfvn  = 0;
-        sa[1].gvcid_tc_blk[1].scid  = SCID & 0x3FF;
-        sa[1].gvcid_tc_blk[1].vcid  = 1;
-        sa[1].gvcid_tc_blk[1].mapid = TYPE_TC;
+        inst->sa[1].sa_state = SA_OPERATIONAL;
+        inst->sa[1].est = 0;
+        inst->sa[1].ast = 0;
+        inst->sa[1].arc_len = 1;
+        inst->sa[1].arcw_len = 1;
+        inst->sa[1].arcw[0] = 5;
+        inst->gvcid_tc_map[0].spi  = 1;
+        inst->gvcid_tc_map[0].tfvn = 0;
+        inst->gvcid_tc_map[0].scid = SCID & 0x3FF;
+        inst->gvcid_tc_map[1].spi  = 1;
+        inst->gvcid_tc_map[1].tfvn = 0;
+        inst->gvcid_tc_map[1].scid = SCID & 0x3FF;
         // SA 2 - KEYED;  ARCW:5; AES-GCM; IV:00...00; IV-len:12; MAC-len:16; Key-ID: 128
-        sa[2].ekid = 128;
-        sa[2].sa_state = SA_KEYED;
-        sa[2].est = 1; 
-        sa[2].ast = 1;
-        sa[2].shivf_len = 12;
-        sa[2].iv_len = IV_SIZE;
-        sa[2].iv[IV_SIZE-1] = 0;
-        sa[2].abm_len = 0x14; // 20
-        for (int i = 0; i < sa[2].abm_len; i++)
+        inst->sa[2].ekid = 128;
+        inst->sa[2].sa_state = SA_KEYED;
+        inst->sa[2].est = 1; 
+        inst->sa[2].ast = 1;
+        inst->sa[2].shivf_len = 12;
+        inst->sa[2].iv_len = IV_SIZE;
+        inst->sa[2].iv[IV_SIZE-1] = 0;
+        inst->sa[2].abm_len = 0x14; // 20
+        for (int i = 0; i < inst->sa[2].abm_len; i++)
         {	// Zero AAD bit mask
-            sa[2].abm[i] = 0x00;
+            inst->sa[2].abm[i] = 0x00;
         }
-        sa[2].arcw_len = 1;   
-        sa[2].arcw[0] = 5;
-        sa[2].arc_len = (sa[2].arcw[0] * 2) + 1;
+        inst->sa[2].arcw_len = 1;   
+        inst->sa[2].arcw[0] = 5;
+        inst->sa[2].arc_len = (inst->sa[2].arcw[0] * 2) + 1;
         // SA 3 - KEYED;   ARCW:5; AES-GCM; IV:00...00; IV-len:12; MAC-len:16; Key-ID: 129
-        sa[3].ekid = 129;
-        sa[3].sa_state = SA_KEYED;
-        sa[3].est = 1; 
-        sa[3].ast = 1;
-        sa[3].shivf_len = 12;
-        sa[3].iv_len = IV_SIZE;
-        sa[3].iv[IV_SIZE-1] = 0;
-        sa[3].abm_len = 0x14; // 20
-        for (int i = 0; i < sa[3].abm_len; i++)
+        inst->sa[3].ekid = 129;
+        inst->sa[3].sa_state = SA_KEYED;
+        inst->sa[3].est = 1; 
+        inst->sa[3].ast = 1;
+        inst->sa[3].shivf_len = 12;
+        inst->sa[3].iv_len = IV_SIZE;
+        inst->sa[3].iv[IV_SIZE-1] = 0;
+        inst->sa[3].abm_len = 0x14; // 20
+        for (int i = 0; i < inst->sa[3].abm_len; i++)
         {	// Zero AAD bit mask
-            sa[3].abm[i] = 0x00;
+            inst->sa[3].abm[i] = 0x00;
         }
-        sa[3].arcw_len = 1;   
-        sa[3].arcw[0] = 5;
-        sa[3].arc_len = (sa[3].arcw[0] * 2) + 1;
+        inst->sa[3].arcw_len = 1;   
+        inst->sa[3].arcw[0] = 5;
+        inst->sa[3].arc_len = (inst->sa[3].arcw[0] * 2) + 1;
         // SA 4 - KEYED;  ARCW:5; AES-GCM; IV:00...00; IV-len:12; MAC-len:16; Key-ID: 130
-        sa[4].ekid = 130;
-        sa[4].sa_state = SA_KEYED;
-        sa[4].est = 1; 
-        sa[4].ast = 1;
-        sa[4].shivf_len = 12;
-        sa[4].iv_len = IV_SIZE;
-        sa[4].iv[IV_SIZE-1] = 0;
-        sa[4].abm_len = 0x14; // 20
-        for (int i = 0; i < sa[4].abm_len; i++)
+        inst->sa[4].ekid = 130;
+        inst->sa[4].sa_state = SA_KEYED;
+        inst->sa[4].est = 1; 
+        inst->sa[4].ast = 1;
+        inst->sa[4].shivf_len = 12;
+        inst->sa[4].iv_len = IV_SIZE;
+        inst->sa[4].iv[IV_SIZE-1] = 0;
+        inst->sa[4].abm_len = 0x14; // 20
+        for (int i = 0; i < inst->sa[4].abm_len; i++)
         {	// Zero AAD bit mask
-            sa[4].abm[i] = 0x00;
-        }
-        sa[4].arcw_len = 1;   
-        sa[4].arcw[0] = 5;
-        sa[4].arc_len = (sa[4].arcw[0] * 2) + 1;
-        sa[4].gvcid_tc_blk[0].tfvn  = 0;
-        sa[4].gvcid_tc_blk[0].scid  = SCID & 0x3FF;
-        sa[4].gvcid_tc_blk[0].vcid  = 0;
-        sa[4].gvcid_tc_blk[0].mapid = TYPE_TC;
-        sa[4].gvcid_tc_blk[1].tfvn  = 0;
-        sa[4].gvcid_tc_blk[1].scid  = SCID & 0x3FF;
-        sa[4].gvcid_tc_blk[1].vcid  = 1;
-        sa[4].gvcid_tc_blk[1].mapid = TYPE_TC;
+            inst->sa[4].abm[i] = 0x00;
+        }
+        inst->sa[4].arcw_len = 1;   
+        inst->sa[4].arcw[0] = 5;
+        inst->sa[4].arc_len = (inst->sa[4].arcw[0] * 2) + 1;
         // SA 5 - KEYED;   ARCW:5; AES-GCM; IV:00...00; IV-len:12; MAC-len:16; Key-ID: 131
-        sa[5].ekid = 131;
-        sa[5].sa_state = SA_KEYED;
-        sa[5].est = 1; 
-        sa[5].ast = 1;
-        sa[5].shivf_len = 12;
-        sa[5].iv_len = IV_SIZE;
-        sa[5].iv[IV_SIZE-1] = 0;
-        sa[5].abm_len = 0x14; // 20
-        for (int i = 0; i < sa[5].abm_len; i++)
+        inst->sa[5].ekid = 131;
+        inst->sa[5].sa_state = SA_KEYED;
+        inst->sa[5].est = 1; 
+        inst->sa[5].ast = 1;
+        inst->sa[5].shivf_len = 12;
+        inst->sa[5].iv_len = IV_SIZE;
+        inst->sa[5].iv[IV_SIZE-1] = 0;
+        inst->sa[5].abm_len = 0x14; // 20
+        for (int i = 0; i < inst->sa[5].abm_len; i++)
         {	// Zero AAD bit mask
-            sa[5].abm[i] = 0x00;
+            inst->sa[5].abm[i] = 0x00;
         }
-        sa[5].arcw_len = 1;   
-        sa[5].arcw[0] = 5;
-        sa[5].arc_len = (sa[5].arcw[0] * 2) + 1;
+        inst->sa[5].arcw_len = 1;   
+        inst->sa[5].arcw[0] = 5;
+        inst->sa[5].arc_len = (inst->sa[5].arcw[0] * 2) + 1;
         // SA 6 - UNKEYED; ARCW:5; AES-GCM; IV:00...00; IV-len:12; MAC-len:16; Key-ID: -
-        sa[6].sa_state = SA_UNKEYED;
-        sa[6].est = 1; 
-        sa[6].ast = 1;
-        sa[6].shivf_len = 12;
-        sa[6].iv_len = IV_SIZE;
-        sa[6].iv[IV_SIZE-1] = 0;
-        sa[6].abm_len = 0x14; // 20
-        for (int i = 0; i < sa[6].abm_len; i++)
+        inst->sa[6].sa_state = SA_UNKEYED;
+        inst->sa[6].est = 1; 
+        inst->sa[6].ast = 1;
+        inst->sa[6].shivf_len = 12;
+        inst->sa[6].iv_len = IV_SIZE;
+        inst->sa[6].iv[IV_SIZE-1] = 0;
+        inst->sa[6].abm_len = 0x14; // 20
+        for (int i = 0; i < inst->sa[6].abm_len; i++)
         {	// Zero AAD bit mask
-            sa[6].abm[i] = 0x00;
+            inst->sa[6].abm[i] = 0x00;
         }
-        sa[6].arcw_len = 1;   
-        sa[6].arcw[0] = 5;
-        sa[6].arc_len = (sa[6].arcw[0] * 2) + 1;
+        inst->sa[6].arcw_len = 1;   
+        inst->sa[6].arcw[0] = 5;
+        inst->sa[6].arc_len = (inst->sa[6].arcw[0] * 2) + 1;
         //itc_gcm128_init(&(sa[6].gcm_ctx), (unsigned char *)&(ek_ring[sa[6].ekid]));
 
     // Initial TM configuration
-        tm_frame.tm_sec_header.spi = 1;
+        inst->tm_frame.tm_sec_header.spi = 1;
 
     // Initialize Log
-        log_summary.num_se = 2;
-        log_summary.rs = LOG_SIZE;
+        inst->log_summary.num_se = 2;
+        inst->log_summary.rs = LOG_SIZE;
         // Add a two messages to the log
-        log_summary.rs--;
-        log.blk[log_count].emt = STARTUP;
-        log.blk[log_count].emv[0] = 0x4E;
-        log.blk[log_count].emv[1] = 0x41;
-        log.blk[log_count].emv[2] = 0x53;
-        log.blk[log_count].emv[3] = 0x41;
-        log.blk[log_count++].em_len = 4;
-        log_summary.rs--;
-        log.blk[log_count].emt = STARTUP;
-        log.blk[log_count].emv[0] = 0x4E;
-        log.blk[log_count].emv[1] = 0x41;
-        log.blk[log_count].emv[2] = 0x53;
-        log.blk[log_count].emv[3] = 0x41;
-        log.blk[log_count++].em_len = 4;
+        inst->log_summary.rs--;
+        inst->log.blk[inst->log_count].emt = STARTUP;
+        inst->log.blk[inst->log_count].emv[0] = 0x4E;
+        inst->log.blk[inst->log_count].emv[1] = 0x41;
+        inst->log.blk[inst->log_count].emv[2] = 0x53;
+        inst->log.blk[inst->log_count].emv[3] = 0x41;
+        inst->log.blk[inst->log_count++].em_len = 4;
+        inst->log_summary.rs--;
+        inst->log.blk[inst->log_count].emt = STARTUP;
+        inst->log.blk[inst->log_count].emv[0] = 0x4E;
+        inst->log.blk[inst->log_count].emv[1] = 0x41;
+        inst->log.blk[inst->log_count].emv[2] = 0x53;
+        inst->log.blk[inst->log_count].emv[3] = 0x41;
+        inst->log.blk[inst->log_count++].em_len = 4;
 
     return status;
 }
 
-int32 crypto_Init(void)
-{   
+int32 crypto_LibInit(void)
+// Process-wide setup shared by every instance: provider libraries and CRC engines
+// Call once before instances are used from several threads; Crypto_Instance_Init otherwise calls it
+{
     int32 status = OS_SUCCESS;
 
-    // Initialize libgcrypt
-    if (!gcry_check_version(GCRYPT_VERSION))
+    if (crypto_lib_ready == 1)
     {
-        OS_printf(KRED "ERROR: gcrypt version mismatch! \n" RESET);
+        return status;
     }
-    if (gcry_control(GCRYCTL_SELFTEST) != GPG_ERR_NO_ERROR)
+
+    // Initialize the cryptographic providers
+    if (crypto_provider_gcrypt.init() != OS_SUCCESS)
     {
-        OS_printf(KRED "ERROR: gcrypt self test failed\n" RESET);
+        OS_printf(KRED "ERROR: %s provider failed to initialize \n" RESET, crypto_provider_gcrypt.name);
+        status = OS_ERROR;
+    }
+    if (crypto_provider_itc.init() != OS_SUCCESS)
+    {
+        OS_printf(KRED "ERROR: %s provider failed to initialize \n" RESET, crypto_provider_itc.name);
+        status = OS_ERROR;
     }
-    gcry_control(GCRYCTL_INITIALIZATION_FINISHED, 0);
-
-    // Init Security Associations
-    status = Crypto_SA_init();
-    status = Crypto_SA_config();
 
-    // TODO - Add error checking
+    // Select CRC engines for this CPU
+    Crypto_CRC_Init();
 
-    // Init table for CRC calculations
-    Crypto_Calc_CRC_Init_Table();
+    crypto_lib_ready = 1;
 
     // cFS Standard Initialized Message
     OS_printf (KBLU "Crypto Lib Intialized.  Version %d.%d.%d.%d\n" RESET,
@@ -712,52 +702,134 @@ int32 crypto_Init(void)
                 CRYPTO_LIB_MINOR_VERSION, 
                 CRYPTO_LIB_REVISION, 
                 CRYPTO_LIB_MISSION_REV);
+
+    return status;
+}
+
+int32 crypto_Init(void)
+{   
+    return Crypto_Instance_Init(&crypto_default, CRYPTO_PROVIDER);
+}
+
+int32 crypto_Init_Provider(uint8 provider_id)
+{   
+    return Crypto_Instance_Init(&crypto_default, provider_id);
+}
+
+int32 Crypto_Instance_Init(crypto_instance_t* inst, uint8 provider_id)
+// Initialize caller owned instance state, nothing is shared with other instances
+// An instance initialized before is freed first; other storage must start zeroed or be freshly allocated
+{   
+    int32 status = OS_SUCCESS;
+
+    // Process-wide setup, a no-op once crypto_LibInit has run
+    if (crypto_lib_ready == 0)
+    {
+        crypto_LibInit();
+    }
+
+    // Release the keyed contexts of a previous initialization
+    if ((inst->provider == &crypto_provider_gcrypt) || (inst->provider == &crypto_provider_itc))
+    {
+        Crypto_Instance_Free(inst);
+    }
+
+    // Start from the same zeroed state a file-static would have
+    CFE_PSP_MemSet(inst, 0, CRYPTO_INSTANCE_SIZE);
+
+    // Select and initialize the cryptographic provider
+    switch (provider_id)
+    {
+        case CRYPTO_PROVIDER_GCRYPT:
+            inst->provider = &crypto_provider_gcrypt;
+            break;
+        case CRYPTO_PROVIDER_ITC:
+            inst->provider = &crypto_provider_itc;
+            break;
+        default:
+            OS_printf(KRED "ERROR: Unknown cryptographic provider %d \n" RESET, provider_id);
+            status = OS_ERROR;
+            return status;
+    }
+    #ifdef DEBUG
+        OS_printf("Cryptographic provider: %s \n", inst->provider->name);
+    #endif
+
+    // Init Security Associations
+    status = Crypto_SA_init(inst);
+    status = Crypto_SA_config(inst);
+
+    // Idle packet fill image
+    Crypto_TM_initIdle(inst);
+
+    // TODO - Add error checking
                                 
     return status; 
 }
 
-static void Crypto_Calc_CRC_Init_Table(void)
-{   
-    uint16 val;
-    uint32 poly = 0xEDB88320;
-    uint32 crc;
+int32 Crypto_Instance_Free(crypto_instance_t* inst)
+// Release the provider contexts held by an instance
+{
+    int32 status = OS_SUCCESS;
 
-    // http://create.stephan-brumme.com/crc32/
-    for (unsigned int i = 0; i <= 0xFF; i++)
+    for (int x = 0; x < NUM_SA; x++)
     {
-        crc = i;
-        for (unsigned int j = 0; j < 8; j++)
-        {
-            crc = (crc >> 1) ^ (-(int)(crc & 1) & poly);
-        }
-        crc32Table[i] = crc;
-        //OS_printf("crc32Table[%d] = 0x%08x \n", i, crc32Table[i]);
+        Crypto_Cipher_invalidate_sa(inst, x);
     }
-    
-    // Code provided by ESA
-    for (int i = 0; i < 256; i++)
+    inst->provider = NULL;
+
+    return status;
+}
+
+int32 Crypto_Instance_SA_copy(crypto_instance_t* inst, const crypto_instance_t* src)
+// Loads the SAs, key ring and channel index of src into inst, dropping the provider contexts inst held
+{
+    int32 status = OS_SUCCESS;
+
+    for (int x = 0; x < NUM_SA; x++)
+    {
+        Crypto_Cipher_invalidate_sa(inst, x);
+    }
+    CFE_PSP_MemCpy(inst->sa, src->sa, sizeof(inst->sa));
+    CFE_PSP_MemCpy(inst->ek_ring, src->ek_ring, sizeof(inst->ek_ring));
+    CFE_PSP_MemCpy(inst->gvcid_tc_map, src->gvcid_tc_map, sizeof(inst->gvcid_tc_map));
+    CFE_PSP_MemCpy(inst->gvcid_tm_map, src->gvcid_tm_map, sizeof(inst->gvcid_tm_map));
+
+    return status;
+}
+
+int32 Crypto_Instance_SDLS_replay(crypto_instance_t* inst, const crypto_instance_t* src)
+// Applies the SDLS EP command of the last TC processed by src to inst as well, the reply is discarded
+// Keeps the SA and key state of instances that share one link in step without copying the per SA
+// anti-replay state each of them owns
+{
+    int32 status = OS_SUCCESS;
+    char reply[TC_FRAME_DATA_SIZE];
+
+    if (src->tc_sdls == 0)
     {
-        val = 0;
-        if ( (i &   1) != 0 )  val ^= 0x1021;
-        if ( (i &   2) != 0 )  val ^= 0x2042;
-        if ( (i &   4) != 0 )  val ^= 0x4084;
-        if ( (i &   8) != 0 )  val ^= 0x8108;
-        if ( (i &  16) != 0 )  val ^= 0x1231;
-        if ( (i &  32) != 0 )  val ^= 0x2462;
-        if ( (i &  64) != 0 )  val ^= 0x48C4;
-        if ( (i & 128) != 0 )  val ^= 0x9188;
-        crc16Table[i] = val;
-        //OS_printf("crc16Table[%d] = 0x%04x \n", i, crc16Table[i]);
+        OS_printf(KRED "Error: Last TC was not an SDLS command! \n" RESET);
+        status = OS_ERROR;
+        return status;
     }
+
+    // SA start maps channels relative to the frame the command arrived on
+    inst->tc_frame.tc_header = src->tc_frame.tc_header;
+    inst->tc_frame.tc_sec_header = src->tc_frame.tc_sec_header;
+    inst->sdls_frame = src->sdls_frame;
+    CFE_PSP_MemSet(reply, 0, sizeof(reply));
+    Crypto_PDU(inst, reply);
+
+    return status;
 }
 
 /*
 ** Assisting Functions
 */
-static int32 Crypto_Get_tcPayloadLength(void)
+static int32 Crypto_Get_tcPayloadLength(crypto_instance_t* inst)
 // Returns the payload length of current tc_frame in BYTES!
 {
-    return (tc_frame.tc_header.fl - (5 + 2 + IV_SIZE ) - (MAC_SIZE + FECF_SIZE) );
+    return (inst->tc_frame.tc_header.fl - (5 + 2 + IV_SIZE ) - (MAC_SIZE + FECF_SIZE) );
 }
 
 static int32 Crypto_Get_tmLength(int len)
@@ -772,257 +844,191 @@ static int32 Crypto_Get_tmLength(int len)
     return len;
 }
 
-static void Crypto_TM_updatePDU(char* ingest, int len_ingest)
-// Update the Telemetry Payload Data Unit
-{	// Copy ingest to PDU
-    int x = 0;
-    int fill_size = 0;
-    
-    if ((sa[tm_frame.tm_sec_header.spi].est == 1) && (sa[tm_frame.tm_sec_header.spi].ast == 1))
-    {
-        fill_size = 1129 - MAC_SIZE - IV_SIZE + 2; // +2 for padding bytes
-    }
-    else
+static void Crypto_TM_initIdle(crypto_instance_t* inst)
+// Build the idle fill image, back to back idle packets starting at offset 0
+// Any run of fill, or the remainder of a packet cut at a frame boundary, is then a single copy
+{
+    // Primary header of an idle packet, data length is total length - 7
+    uint8 hdr[6] = {(uint8) ((TM_IDLE_APID & 0x700) >> 8), (uint8) (TM_IDLE_APID & 0x0FF), 0x00, 0x00,
+                    (uint8) (((TM_IDLE_LENGTH - 7) & 0xFF00) >> 8), (uint8) ((TM_IDLE_LENGTH - 7) & 0x00FF)};
+
+    for (int x = 0; x < TM_FILL_SIZE; x++)
     {
-        fill_size = 1129;
+        inst->tm_idle_fill[x] = ((x % TM_IDLE_LENGTH) < 6) ? hdr[x % TM_IDLE_LENGTH] : 0x00;
     }
+}
+
+static void Crypto_TM_updatePDU(crypto_instance_t* inst, uint8* pdu, char* ingest, int len_ingest, int pdu_len)
+// Update the Telemetry Payload Data Unit
+// Writes the pdu_len bytes of the PDU directly into the frame, the packet in ingest may overlap pdu
+{
+    int x = 0;
 
     #ifdef TM_ZERO_FILL
-        for (int x = 0; x < TM_FILL_SIZE; x++)
-        {
-            if (x < len_ingest)
-            {	// Fill
-                tm_frame.tm_pdu[x] = (uint8)ingest[x];
-            }
-            else
-            {	// Zero
-                tm_frame.tm_pdu[x] = 0x00;
-            }
-        }
+        x = (len_ingest < pdu_len) ? len_ingest : pdu_len;
+        memmove(pdu, ingest, x);
+        inst = inst;
     #else
-        // Pre-append remaining packet if exist
-        if (tm_offset == 63)
-        {
-            tm_frame.tm_pdu[x++] = 0xff;
-            tm_offset--;
-        }
-        if (tm_offset == 62)
-        {
-            tm_frame.tm_pdu[x++] = 0x00;
-            tm_offset--;
-        }
-        if (tm_offset == 61)
-        {
-            tm_frame.tm_pdu[x++] = 0x00;
-            tm_offset--;
-        }
-        if (tm_offset == 60)
-        {
-            tm_frame.tm_pdu[x++] = 0x00;
-            tm_offset--;
-        }
-        if (tm_offset == 59)
-        {
-            tm_frame.tm_pdu[x++] = 0x39;
-            tm_offset--;
-        }
-        while (x < tm_offset)
-        {
-            tm_frame.tm_pdu[x] = 0x00;
-            x++;
-        }
-        // Copy actual packet
-        while (x < len_ingest + tm_offset)
-        {
-            //OS_printf("ingest[x - tm_offset] = 0x%02x \n", (uint8)ingest[x - tm_offset]);
-            tm_frame.tm_pdu[x] = (uint8)ingest[x - tm_offset];
-            x++;
+        // Bytes of the idle packet cut at the end of the previous frame
+        int start = (inst->tm_offset < pdu_len) ? inst->tm_offset : pdu_len;
+
+        x = (len_ingest < (pdu_len - start)) ? len_ingest : (pdu_len - start);
+        if (x > 0)
+        {   // Move the packet first, the remainder may overwrite its start
+            memmove(&pdu[start], ingest, x);
         }
+        x = start + x;
         #ifdef TM_IDLE_FILL
+            // Pre-append remaining packet if exist, any part past this PDU stays for the next frame
+            CFE_PSP_MemCpy(pdu, &(inst->tm_idle_fill[TM_IDLE_LENGTH - inst->tm_offset]), start);
+            inst->tm_offset = inst->tm_offset - start;
+
             // Check for idle frame trigger
-            if (((uint8)ingest[0] == 0x08) && ((uint8)ingest[1] == 0x90))
+            if ((pdu[start] == 0x08) && (pdu[start + 1] == 0x90))
             { 
                 // Don't fill idle frames   
             }
-            else
-            {
-                while (x < (fill_size - 64) )
-                {
-                    tm_frame.tm_pdu[x++] = 0x07;
-                    tm_frame.tm_pdu[x++] = 0xff;
-                    tm_frame.tm_pdu[x++] = 0x00;
-                    tm_frame.tm_pdu[x++] = 0x00;
-                    tm_frame.tm_pdu[x++] = 0x00;
-                    tm_frame.tm_pdu[x++] = 0x39;
-                    for (int y = 0; y < 58; y++)
-                    {
-                        tm_frame.tm_pdu[x++] = 0x00;
-                    }
-                }
-                // Add partial packet, if possible, and set offset
-                if (x < fill_size)
-                {
-                    tm_frame.tm_pdu[x++] = 0x07;
-                    tm_offset = 63;
-                }
-                if (x < fill_size)
-                {
-                    tm_frame.tm_pdu[x++] = 0xff;
-                    tm_offset--;
-                }
-                if (x < fill_size)
-                {
-                    tm_frame.tm_pdu[x++] = 0x00;
-                    tm_offset--;
-                }
-                if (x < fill_size)
-                {
-                    tm_frame.tm_pdu[x++] = 0x00;
-                    tm_offset--;
-                }
-                if (x < fill_size)
-                {
-                    tm_frame.tm_pdu[x++] = 0x00;
-                    tm_offset--;
-                }
-                if (x < fill_size)
-                {
-                    tm_frame.tm_pdu[x++] = 0x39;
-                    tm_offset--;
-                }
-                for (int y = 0; x < fill_size; y++)
-                {
-                    tm_frame.tm_pdu[x++] = 00;
-                    tm_offset--;
-                }
-            }
-            while (x < TM_FILL_SIZE)
-            {
-                tm_frame.tm_pdu[x++] = 0x00;
+            else if (x < pdu_len)
+            {   // Idle packets to the end of the PDU, the last one continues in the next frame
+                CFE_PSP_MemCpy(&pdu[x], inst->tm_idle_fill, pdu_len - x);
+                inst->tm_offset = (TM_IDLE_LENGTH - ((pdu_len - x) % TM_IDLE_LENGTH)) % TM_IDLE_LENGTH;
+                x = pdu_len;
             }
+        #else
+            CFE_PSP_MemSet(pdu, 0, start);
         #endif 
     #endif
+    while (x < pdu_len)
+    {
+        pdu[x++] = 0x00;
+    }
 
     return;
 }
 
-static void Crypto_TM_updateOCF(void)
+static void Crypto_TM_muxRead(crypto_tm_mux_t* mux, uint8* dest, uint32 len)
+// Removes len bytes from the front of the packet queue
 {
-    if (ocf == 0)
-    {	// CLCW
-        clcw.vci = tm_frame.tm_header.vcid;
-
-        tm_frame.tm_sec_trailer.ocf[0] = (clcw.cwt << 7) | (clcw.cvn << 5) | (clcw.sf << 2) | (clcw.cie);
-        tm_frame.tm_sec_trailer.ocf[1] = (clcw.vci << 2) | (clcw.spare0);
-        tm_frame.tm_sec_trailer.ocf[2] = (clcw.nrfa << 7) | (clcw.nbl << 6) | (clcw.lo << 5) | (clcw.wait << 4) | (clcw.rt << 3) | (clcw.fbc << 1) | (clcw.spare1);
-        tm_frame.tm_sec_trailer.ocf[3] = (clcw.rv);
-        // Alternate OCF
-        ocf = 1;
-        #ifdef OCF_DEBUG
-            Crypto_clcwPrint(&clcw);
-        #endif
-    } 
-    else
-    {	// FSR
-        tm_frame.tm_sec_trailer.ocf[0] = (report.cwt << 7) | (report.vnum << 4) | (report.af << 3) | (report.bsnf << 2) | (report.bmacf << 1) | (report.ispif);
-        tm_frame.tm_sec_trailer.ocf[1] = (report.lspiu & 0xFF00) >> 8;
-        tm_frame.tm_sec_trailer.ocf[2] = (report.lspiu & 0x00FF);
-        tm_frame.tm_sec_trailer.ocf[3] = (report.snval);  
-        // Alternate OCF
-        ocf = 0;
-        #ifdef OCF_DEBUG
-            Crypto_fsrPrint(&report);
-        #endif
-    }
-}
+    uint32 first = TM_MUX_SIZE - mux->head;
 
-static int32 Crypto_increment(uint8 *num, int length)
-{
-    int i;
-    /* go from right (least significant) to left (most signifcant) */
-    for(i = length - 1; i >= 0; --i)
+    if (first > len)
     {
-        ++(num[i]); /* increment current byte */
-
-        if(num[i] != 0) /* if byte did not overflow, we're done! */
-           break;
+        first = len;
     }
-
-    if(i < 0) /* this means num[0] was incremented and overflowed */
-        return OS_ERROR;
-    else
-        return OS_SUCCESS;
+    CFE_PSP_MemCpy(dest, &(mux->buf[mux->head]), first);
+    CFE_PSP_MemCpy(&dest[first], &(mux->buf[0]), len - first);
+    mux->head = (mux->head + len) % TM_MUX_SIZE;
+    mux->len = mux->len - len;
 }
 
-static int32 Crypto_window(uint8 *actual, uint8 *expected, int length, int window)
+static void Crypto_TM_muxPDU(crypto_instance_t* inst, uint8* pdu, int pdu_len)
+// Packs queued packets into the PDU and sets the First Header Pointer
+// A packet that does not fit continues at the start of the next frame, idle packets fill the rest
 {
-    int status = OS_ERROR;
-    int result = 0;
-    uint8 temp[length];
+    crypto_tm_mux_t* mux = &(inst->tm_mux);
+    uint16 fhp = TM_FHP_NO_HEADER;
+    uint8 data = 0;
+    uint32 n = 0;
+    int x = 0;
 
-    CFE_PSP_MemCpy(temp, expected, length);
+    // Remainder of the idle packet cut at the end of the previous frame
+    if (inst->tm_offset > 0)
+    {
+        x = (inst->tm_offset < pdu_len) ? inst->tm_offset : pdu_len;
+        CFE_PSP_MemCpy(pdu, &(inst->tm_idle_fill[TM_IDLE_LENGTH - inst->tm_offset]), x);
+        inst->tm_offset = inst->tm_offset - x;
+    }
 
-    for (int i = 0; i < window; i++)
-    {   
-        result = 0;
-        /* go from right (least significant) to left (most signifcant) */
-        for (int j = length - 1; j >= 0; --j)
-        {
-            if (actual[j] == temp[j])
+    // Queued packets, starting with the rest of one cut at the end of the previous frame
+    while ((x < pdu_len) && (mux->len > 0))
+    {
+        if (mux->cont == 0)
+        {   // Next packet starts here, its length comes from its primary header
+            if (fhp == TM_FHP_NO_HEADER)
             {
-                result++;
+                fhp = x;
             }
-        }        
-        if (result == length)
+            mux->cont = ((mux->buf[(mux->head + 4) % TM_MUX_SIZE] << 8) | 
+                          mux->buf[(mux->head + 5) % TM_MUX_SIZE]) + 7;
+        }
+        n = ((uint32)(pdu_len - x) < mux->cont) ? (uint32)(pdu_len - x) : mux->cont;
+        Crypto_TM_muxRead(mux, &pdu[x], n);
+        mux->cont = mux->cont - n;
+        x = x + n;
+        data = 1;
+    }
+
+    // Idle packets to the end of the PDU, the last one continues in the next frame
+    if (x < pdu_len)
+    {
+        if (fhp == TM_FHP_NO_HEADER)
         {
-            status = OS_SUCCESS;
-            break;
+            fhp = x;
         }
-        Crypto_increment(&temp[0], length);
+        CFE_PSP_MemCpy(&pdu[x], inst->tm_idle_fill, pdu_len - x);
+        inst->tm_offset = (TM_IDLE_LENGTH - ((pdu_len - x) % TM_IDLE_LENGTH)) % TM_IDLE_LENGTH;
     }
-    return status;
+
+    if (data == 0)
+    {
+        fhp = TM_FHP_IDLE;
+    }
+    inst->tm_frame.tm_header.fhp = fhp;
+    #ifdef TM_DEBUG
+        OS_printf("fhp = %d, queued = %d \n", fhp, mux->len);
+    #endif
 }
 
-static int32 Crypto_compare_less_equal(uint8 *actual, uint8 *expected, int length)
+static void Crypto_TM_updateOCF(crypto_instance_t* inst)
 {
-    int status = OS_ERROR;
+    if (inst->ocf == 0)
+    {	// CLCW
+        inst->clcw.vci = inst->tm_frame.tm_header.vcid;
 
-    for(int i = 0; i < length - 1; i++)
-    {
-        if (actual[i] > expected[i])
-        {
-            status = OS_SUCCESS;
-            break;
-        }
-        else if (actual[i] < expected[i])
-        {
-            status = OS_ERROR;
-            break;
-        }
+        inst->tm_frame.tm_sec_trailer.ocf[0] = (inst->clcw.cwt << 7) | (inst->clcw.cvn << 5) | (inst->clcw.sf << 2) | (inst->clcw.cie);
+        inst->tm_frame.tm_sec_trailer.ocf[1] = (inst->clcw.vci << 2) | (inst->clcw.spare0);
+        inst->tm_frame.tm_sec_trailer.ocf[2] = (inst->clcw.nrfa << 7) | (inst->clcw.nbl << 6) | (inst->clcw.lo << 5) | (inst->clcw.wait << 4) | (inst->clcw.rt << 3) | (inst->clcw.fbc << 1) | (inst->clcw.spare1);
+        inst->tm_frame.tm_sec_trailer.ocf[3] = (inst->clcw.rv);
+        // Alternate OCF
+        inst->ocf = 1;
+        #ifdef OCF_DEBUG
+            Crypto_clcwPrint(&inst->clcw);
+        #endif
+    } 
+    else
+    {	// FSR
+        inst->tm_frame.tm_sec_trailer.ocf[0] = (inst->report.cwt << 7) | (inst->report.vnum << 4) | (inst->report.af << 3) | (inst->report.bsnf << 2) | (inst->report.bmacf << 1) | (inst->report.ispif);
+        inst->tm_frame.tm_sec_trailer.ocf[1] = (inst->report.lspiu & 0xFF00) >> 8;
+        inst->tm_frame.tm_sec_trailer.ocf[2] = (inst->report.lspiu & 0x00FF);
+        inst->tm_frame.tm_sec_trailer.ocf[3] = (inst->report.snval);  
+        // Alternate OCF
+        inst->ocf = 0;
+        #ifdef OCF_DEBUG
+            Crypto_fsrPrint(&inst->report);
+        #endif
     }
-    return status;
 }
 
-static uint8 Crypto_Prep_Reply(char* ingest, uint8 appID)
+static uint8 Crypto_Prep_Reply(crypto_instance_t* inst, char* ingest, uint8 appID)
 // Assumes that both the pkt_length and pdu_len are set properly
 {
     uint8 count = 0;
     
     // Prepare CCSDS for reply
-    sdls_frame.hdr.pvn   = 0;
-    sdls_frame.hdr.type  = 0;
-    sdls_frame.hdr.shdr  = 1;
-    sdls_frame.hdr.appID = appID;
+    inst->sdls_frame.hdr.pvn   = 0;
+    inst->sdls_frame.hdr.type  = 0;
+    inst->sdls_frame.hdr.shdr  = 1;
+    inst->sdls_frame.hdr.appID = appID;
 
-    sdls_frame.pdu.type	 = 1;
+    inst->sdls_frame.pdu.type	 = 1;
     
     // Fill ingest with reply header
-    ingest[count++] = (sdls_frame.hdr.pvn << 5) | (sdls_frame.hdr.type << 4) | (sdls_frame.hdr.shdr << 3) | ((sdls_frame.hdr.appID & 0x700 >> 8));	
-    ingest[count++] = (sdls_frame.hdr.appID & 0x00FF);
-    ingest[count++] = (sdls_frame.hdr.seq << 6) | ((sdls_frame.hdr.pktid & 0x3F00) >> 8);
-    ingest[count++] = (sdls_frame.hdr.pktid & 0x00FF);
-    ingest[count++] = (sdls_frame.hdr.pkt_length & 0xFF00) >> 8;
-    ingest[count++] = (sdls_frame.hdr.pkt_length & 0x00FF);
+    ingest[count++] = (inst->sdls_frame.hdr.pvn << 5) | (inst->sdls_frame.hdr.type << 4) | (inst->sdls_frame.hdr.shdr << 3) | ((inst->sdls_frame.hdr.appID & 0x700 >> 8));	
+    ingest[count++] = (inst->sdls_frame.hdr.appID & 0x00FF);
+    ingest[count++] = (inst->sdls_frame.hdr.seq << 6) | ((inst->sdls_frame.hdr.pktid & 0x3F00) >> 8);
+    ingest[count++] = (inst->sdls_frame.hdr.pktid & 0x00FF);
+    ingest[count++] = (inst->sdls_frame.hdr.pkt_length & 0xFF00) >> 8;
+    ingest[count++] = (inst->sdls_frame.hdr.pkt_length & 0x00FF);
 
     // Fill ingest with PUS
     //ingest[count++] = (sdls_frame.pus.shf << 7) | (sdls_frame.pus.pusv << 4) | (sdls_frame.pus.ack);
@@ -1031,18 +1037,18 @@ static uint8 Crypto_Prep_Reply(char* ingest, uint8 appID)
     //ingest[count++] = (sdls_frame.pus.sid << 4) | (sdls_frame.pus.spare);
     
     // Fill ingest with Tag and Length
-    ingest[count++] = (sdls_frame.pdu.type << 7) | (sdls_frame.pdu.uf << 6) | (sdls_frame.pdu.sg << 4) | (sdls_frame.pdu.pid);
-    ingest[count++] = (sdls_frame.pdu.pdu_len & 0xFF00) >> 8;
-    ingest[count++] = (sdls_frame.pdu.pdu_len & 0x00FF);
+    ingest[count++] = (inst->sdls_frame.pdu.type << 7) | (inst->sdls_frame.pdu.uf << 6) | (inst->sdls_frame.pdu.sg << 4) | (inst->sdls_frame.pdu.pid);
+    ingest[count++] = (inst->sdls_frame.pdu.pdu_len & 0xFF00) >> 8;
+    ingest[count++] = (inst->sdls_frame.pdu.pdu_len & 0x00FF);
 
     return count;
 }
 
-static int32 Crypto_FECF(int fecf, char* ingest, int len_ingest)
+static int32 Crypto_FECF(crypto_instance_t* inst, int fecf, char* ingest, int len_ingest)
 // Calculate the Frame Error Control Field (FECF), also known as a cyclic redundancy check (CRC)
 {
     int32 result = OS_SUCCESS;
-    uint16 calc_fecf = Crypto_Calc_FECF(ingest, len_ingest);
+    uint16 calc_fecf = Crypto_Calc_FECF(inst, ingest, len_ingest);
 
     if ( (fecf & 0xFFFF) != calc_fecf )
         {
@@ -1053,19 +1059,19 @@ static int32 Crypto_FECF(int fecf, char* ingest, int len_ingest)
             else
             {   // TODO: Error Correction
                 OS_printf(KRED "Error: FECF incorrect!\n" RESET);
-                if (log_summary.rs > 0)
+                if (inst->log_summary.rs > 0)
                 {
-                    Crypto_increment((uint8*)&log_summary.num_se, 4);
-                    log_summary.rs--;
-                    log.blk[log_count].emt = FECF_ERR_EID;
-                    log.blk[log_count].emv[0] = 0x4E;
-                    log.blk[log_count].emv[1] = 0x41;
-                    log.blk[log_count].emv[2] = 0x53;
-                    log.blk[log_count].emv[3] = 0x41;
-                    log.blk[log_count++].em_len = 4;
+                    Crypto_increment((uint8*)&inst->log_summary.num_se, 4);
+                    inst->log_summary.rs--;
+                    inst->log.blk[inst->log_count].emt = FECF_ERR_EID;
+                    inst->log.blk[inst->log_count].emv[0] = 0x4E;
+                    inst->log.blk[inst->log_count].emv[1] = 0x41;
+                    inst->log.blk[inst->log_count].emv[2] = 0x53;
+                    inst->log.blk[inst->log_count].emv[3] = 0x41;
+                    inst->log.blk[inst->log_count++].em_len = 4;
                 }
                 #ifdef FECF_DEBUG
-                    OS_printf("\t Calculated = 0x%04x \n\t Received   = 0x%04x \n", calc_fecf, tc_frame.tc_sec_trailer.fecf);
+                    OS_printf("\t Calculated = 0x%04x \n\t Received   = 0x%04x \n", calc_fecf, inst->tc_frame.tc_sec_trailer.fecf);
                 #endif
                 result = OS_ERROR;
             }
@@ -1074,30 +1080,17 @@ static int32 Crypto_FECF(int fecf, char* ingest, int len_ingest)
     return result;
 }
 
-static uint16 Crypto_Calc_FECF(char* ingest, int len_ingest)
+static uint16 Crypto_Calc_FECF(crypto_instance_t* inst, char* ingest, int len_ingest)
 // Calculate the Frame Error Control Field (FECF), also known as a cyclic redundancy check (CRC)
 {
-    uint16 fecf = 0xFFFF;
-    uint16 poly = 0x1021;	// TODO: This polynomial is (CRC-CCITT) for ESA testing, may not match standard protocol
-    uint8 bit;
-    uint8 c15;
-
-    for (int i = 0; i <= len_ingest; i++)
-    {	// Byte Logic
-        for (int j = 0; j < 8; j++)
-        {	// Bit Logic
-            bit = ((ingest[i] >> (7 - j) & 1) == 1); 
-            c15 = ((fecf >> 15 & 1) == 1); 
-            fecf <<= 1;
-            if (c15 ^ bit)
-            {
-                fecf ^= poly;
-            }
-        }
-    }
+    uint16 fecf;
+
+    // CRC-CCITT (poly 0x1021) for ESA testing, may not match standard protocol
+    // Callers pass the index of the last byte covered, hence len_ingest + 1
+    fecf = Crypto_CRC16_update(CRC16_CCITT_INIT, (uint8*) ingest, len_ingest + 1);
 
     // Check if Testing
-    if (badFECF == 1)
+    if (inst->badFECF == 1)
     {
         fecf++;
     }
@@ -1117,22 +1110,122 @@ static uint16 Crypto_Calc_FECF(char* ingest, int len_ingest)
 }
 
 static uint16 Crypto_Calc_CRC16(char* data, int size)
-{   // Code provided by ESA
-    uint16 crc = 0xFFFF;
+{   // Space packet CRC, same CRC-CCITT as the ESA table code
+    return Crypto_CRC16_update(CRC16_CCITT_INIT, (uint8*) data, size);
+}
+
+/*
+** Cipher Cache
+*/
+static int32 Crypto_Cipher_get(crypto_instance_t* inst, uint16 spi, crypto_provider_ctx_t** ctx)
+// Returns the keyed provider context of an SA.
+// The context is only keyed on first use or when the SA's key changed;
+// every other frame reuses it with a new IV.
+{
+    int32 status = OS_SUCCESS;
+    crypto_cipher_cache_t* cache = &inst->sa_cipher[spi];
+
+    if ((cache->valid == 1) && (cache->ekid == inst->sa[spi].ekid))
+    {
+        *ctx = &(cache->ctx);
+        return status;
+    }
+
+    Crypto_Cipher_invalidate_sa(inst, spi);
+    status = inst->provider->key_load(&(cache->ctx), &(inst->ek_ring[inst->sa[spi].ekid].value[0]), KEY_SIZE);
+    if (status != OS_SUCCESS)
+    {
+        return status;
+    }
+    cache->ekid = inst->sa[spi].ekid;
+    cache->valid = 1;
+    #ifdef DEBUG
+        OS_printf("SPI %d cipher handle keyed with Key ID %d \n", spi, cache->ekid);
+    #endif
+
+    *ctx = &(cache->ctx);
+    return status;
+}
+
+static void Crypto_Cipher_invalidate_sa(crypto_instance_t* inst, uint16 spi)
+// Releases the cached provider context of an SA so the next frame re-keys it
+{
+    if ((spi < NUM_SA) && (inst->sa_cipher[spi].valid == 1))
+    {
+        inst->provider->key_unload(&(inst->sa_cipher[spi].ctx));
+        inst->sa_cipher[spi].valid = 0;
+    }
+}
+
+static void Crypto_Cipher_invalidate_key(crypto_instance_t* inst, uint16 kid)
+// Releases every cached provider context keyed with the given key
+{
+    for (int x = 0; x < NUM_SA; x++)
+    {
+        if ((inst->sa_cipher[x].valid == 1) && (inst->sa_cipher[x].ekid == kid))
+        {
+            Crypto_Cipher_invalidate_sa(inst, x);
+        }
+    }
+}
+
+/*
+** Authentication
+*/
+static int32 Crypto_Auth_mac(crypto_instance_t* inst, uint16 spi, const uint8* iv, uint8* frame, int len, uint8* mac)
+// GMAC of an authentication only frame over frame[0..len), its headers masked with the SA's ABM.
+// The headers are masked in place for the provider and restored afterwards.
+{
+    int32 status = OS_SUCCESS;
+    uint8 hdr[ABM_SIZE];
+    uint8 nonce[IV_SIZE];
+    crypto_provider_ctx_t* cipher_ctx;
+    int x;
+
+    status = Crypto_Cipher_get(inst, spi, &cipher_ctx);
+    if (status != OS_SUCCESS)
+    {
+        return status;
+    }
+
+    // The IV may itself lie within the masked headers
+    CFE_PSP_MemCpy(nonce, iv, IV_SIZE);
+    for (x = 0; x < inst->sa[spi].abm_len; x++)
+    {
+        hdr[x] = frame[x];
+        frame[x] = frame[x] & inst->sa[spi].abm[x];
+    }
+    status = inst->provider->mac(cipher_ctx, nonce, inst->sa[spi].iv_len, frame, len, mac, MAC_SIZE);
+    CFE_PSP_MemCpy(frame, hdr, inst->sa[spi].abm_len);
+
+    return status;
+}
+
+static int32 Crypto_Auth_verify(crypto_instance_t* inst, uint16 spi, const uint8* iv, uint8* frame, int len, const uint8* mac)
+// Checks the MAC of an authentication only frame, returns CRYPTO_PROVIDER_BAD_MAC on mismatch
+{
+    int32 status = OS_SUCCESS;
+    uint8 tag[MAC_SIZE];
+    uint8 diff = 0;
 
-    for ( ; size > 0; size--)
-    {  
-        //OS_printf("*data = 0x%02x \n", (uint8) *data);
-        crc = ((crc << 8) & 0xFF00) ^ crc16Table[(crc >> 8) ^ *data++];
+    status = Crypto_Auth_mac(inst, spi, iv, frame, len, tag);
+    if (status != OS_SUCCESS)
+    {
+        return status;
+    }
+    // Constant time compare
+    for (int x = 0; x < MAC_SIZE; x++)
+    {
+        diff |= tag[x] ^ mac[x];
     }
-       
-   return crc;
+
+    return (diff == 0) ? OS_SUCCESS : CRYPTO_PROVIDER_BAD_MAC;
 }
 
 /*
 ** Key Management Services
 */
-static int32 Crypto_Key_OTAR(void)
+static int32 Crypto_Key_OTAR(crypto_instance_t* inst)
 // The OTAR Rekeying procedure shall have the following Service Parameters:
 //  a- Key ID of the Master Key (Integer, unmanaged)
 //  b- Size of set of Upload Keys (Integer, managed)
@@ -1147,27 +1240,26 @@ static int32 Crypto_Key_OTAR(void)
     int count = 0;
     int x = 0;
     int32 status = OS_SUCCESS;
-    int pdu_keys = (sdls_frame.pdu.pdu_len - 30) / (2 + KEY_SIZE);
+    int pdu_keys = (inst->sdls_frame.pdu.pdu_len - 30) / (2 + KEY_SIZE);
 
-    gcry_cipher_hd_t tmp_hd;
-    gcry_error_t gcry_error = GPG_ERR_NO_ERROR;
+    crypto_provider_ctx_t tmp_ctx;
 
     // Master Key ID
-    packet.mkid = (sdls_frame.pdu.data[0] << 8) | (sdls_frame.pdu.data[1]);
+    packet.mkid = (inst->sdls_frame.pdu.data[0] << 8) | (inst->sdls_frame.pdu.data[1]);
 
     if (packet.mkid >= 128)
     {
-        report.af = 1;
-        if (log_summary.rs > 0)
+        inst->report.af = 1;
+        if (inst->log_summary.rs > 0)
         {
-            Crypto_increment((uint8*)&log_summary.num_se, 4);
-            log_summary.rs--;
-            log.blk[log_count].emt = MKID_INVALID_EID;
-            log.blk[log_count].emv[0] = 0x4E;
-            log.blk[log_count].emv[1] = 0x41;
-            log.blk[log_count].emv[2] = 0x53;
-            log.blk[log_count].emv[3] = 0x41;
-            log.blk[log_count++].em_len = 4;
+            Crypto_increment((uint8*)&inst->log_summary.num_se, 4);
+            inst->log_summary.rs--;
+            inst->log.blk[inst->log_count].emt = MKID_INVALID_EID;
+            inst->log.blk[inst->log_count].emv[0] = 0x4E;
+            inst->log.blk[inst->log_count].emv[1] = 0x41;
+            inst->log.blk[inst->log_count].emv[2] = 0x53;
+            inst->log.blk[inst->log_count].emv[3] = 0x41;
+            inst->log.blk[inst->log_count++].em_len = 4;
         }
         OS_printf(KRED "Error: MKID is not valid! \n" RESET);
         status = OS_ERROR;
@@ -1176,94 +1268,59 @@ static int32 Crypto_Key_OTAR(void)
 
     for (int count = 2; count < (2 + IV_SIZE); count++)
     {	// Initialization Vector
-        packet.iv[count-2] = sdls_frame.pdu.data[count];
+        packet.iv[count-2] = inst->sdls_frame.pdu.data[count];
         //OS_printf("packet.iv[%d] = 0x%02x\n", count-2, packet.iv[count-2]);
     }
     
-    count = sdls_frame.pdu.pdu_len - MAC_SIZE; 
+    count = inst->sdls_frame.pdu.pdu_len - MAC_SIZE; 
     for (int w = 0; w < 16; w++)
     {	// MAC
-        packet.mac[w] = sdls_frame.pdu.data[count + w];
+        packet.mac[w] = inst->sdls_frame.pdu.data[count + w];
         //OS_printf("packet.mac[%d] = 0x%02x\n", w, packet.mac[w]);
     }
 
-    gcry_error = gcry_cipher_open(
-        &(tmp_hd), 
-        GCRY_CIPHER_AES256, 
-        GCRY_CIPHER_MODE_GCM, 
-        GCRY_CIPHER_CBC_MAC
-    );
-    if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    status = inst->provider->key_load(&tmp_ctx, &(inst->ek_ring[packet.mkid].value[0]), KEY_SIZE);
+    if (status != OS_SUCCESS)
     {
-        OS_printf(KRED "ERROR: gcry_cipher_open error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-        status = OS_ERROR;
         return status;
     }
-    gcry_error = gcry_cipher_setkey(
-        tmp_hd, 
-        &(ek_ring[packet.mkid].value[0]), 
-        KEY_SIZE
+    status = inst->provider->aead_decrypt(
+        &tmp_ctx,
+        &(packet.iv[0]),                                // initialization vector
+        IV_SIZE,                                        // IV length
+        NULL,                                           // no AAD
+        0,                                              // AAD length
+        (uint8*) &(inst->sdls_frame.pdu.data[14]),            // ciphertext input
+        (uint8*) &(inst->sdls_frame.pdu.data[14]),            // in place decryption
+        pdu_keys * (2 + KEY_SIZE),                      // length of data
+        &(packet.mac[0]),                               // tag input
+        MAC_SIZE                                        // tag size
     );
-    if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    inst->provider->key_unload(&tmp_ctx);
+    if (status != OS_SUCCESS)
     {
-        OS_printf(KRED "ERROR: gcry_cipher_setkey error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
+        OS_printf(KRED "ERROR: OTAR key blocks failed to decrypt and authenticate \n" RESET);
         status = OS_ERROR;
         return status;
     }
-    gcry_error = gcry_cipher_setiv(
-        tmp_hd, 
-        &(packet.iv[0]), 
-        IV_SIZE
-    );
-    if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-    {
-        OS_printf(KRED "ERROR: gcry_cipher_setiv error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-        status = OS_ERROR;
-        return status;
-    }
-    gcry_error = gcry_cipher_decrypt(
-        tmp_hd,
-        &(sdls_frame.pdu.data[14]),                     // plaintext output
-        pdu_keys * (2 + KEY_SIZE),   			 		// length of data
-        NULL,                                           // in place decryption
-        0                                               // in data length
-    );
-    if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-    {
-        OS_printf(KRED "ERROR: gcry_cipher_decrypt error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-        status = OS_ERROR;
-        return status;
-    }
-    gcry_error = gcry_cipher_checktag(
-        tmp_hd,
-        &(packet.mac[0]),                               // tag input
-        MAC_SIZE                                        // tag size
-    );
-    if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-    {
-        OS_printf(KRED "ERROR: gcry_cipher_checktag error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-        status = OS_ERROR;
-        return status;
-    }
-    gcry_cipher_close(tmp_hd);
     
     // Read in Decrypted Data
     for (int count = 14; x < pdu_keys; x++)
     {	// Encrypted Key Blocks
-        packet.EKB[x].ekid = (sdls_frame.pdu.data[count] << 8) | (sdls_frame.pdu.data[count+1]);
+        packet.EKB[x].ekid = (inst->sdls_frame.pdu.data[count] << 8) | (inst->sdls_frame.pdu.data[count+1]);
         if (packet.EKB[x].ekid < 128)
         {
-            report.af = 1;
-            if (log_summary.rs > 0)
+            inst->report.af = 1;
+            if (inst->log_summary.rs > 0)
             {
-                Crypto_increment((uint8*)&log_summary.num_se, 4);
-                log_summary.rs--;
-                log.blk[log_count].emt = OTAR_MK_ERR_EID;
-                log.blk[log_count].emv[0] = 0x4E; // N
-                log.blk[log_count].emv[1] = 0x41; // A
-                log.blk[log_count].emv[2] = 0x53; // S
-                log.blk[log_count].emv[3] = 0x41; // A
-                log.blk[log_count++].em_len = 4;
+                Crypto_increment((uint8*)&inst->log_summary.num_se, 4);
+                inst->log_summary.rs--;
+                inst->log.blk[inst->log_count].emt = OTAR_MK_ERR_EID;
+                inst->log.blk[inst->log_count].emv[0] = 0x4E; // N
+                inst->log.blk[inst->log_count].emv[1] = 0x41; // A
+                inst->log.blk[inst->log_count].emv[2] = 0x53; // S
+                inst->log.blk[inst->log_count].emv[3] = 0x41; // A
+                inst->log.blk[inst->log_count++].em_len = 4;
             }
             OS_printf(KRED "Error: Cannot OTAR master key! \n" RESET);
             status = OS_ERROR;
@@ -1274,18 +1331,19 @@ static int32 Crypto_Key_OTAR(void)
             count = count + 2;
             for (int y = count; y < (KEY_SIZE + count); y++)
             {	// Encrypted Key
-                packet.EKB[x].ek[y-count] = sdls_frame.pdu.data[y];
+                packet.EKB[x].ek[y-count] = inst->sdls_frame.pdu.data[y];
                 #ifdef SA_DEBUG
                     OS_printf("\t packet.EKB[%d].ek[%d] = 0x%02x\n", x, y-count, packet.EKB[x].ek[y-count]);
                 #endif
 
                 // Setup Key Ring
-                ek_ring[packet.EKB[x].ekid].value[y - count] = sdls_frame.pdu.data[y];
+                inst->ek_ring[packet.EKB[x].ekid].value[y - count] = inst->sdls_frame.pdu.data[y];
             }
             count = count + KEY_SIZE;
 
             // Set state to PREACTIVE
-            ek_ring[packet.EKB[x].ekid].key_state = KEY_PREACTIVE;
+            inst->ek_ring[packet.EKB[x].ekid].key_state = KEY_PREACTIVE;
+            Crypto_Cipher_invalidate_key(inst, packet.EKB[x].ekid);
         }
     }
 
@@ -1305,19 +1363,19 @@ static int32 Crypto_Key_OTAR(void)
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_Key_update(uint8 state)
+static int32 Crypto_Key_update(crypto_instance_t* inst, uint8 state)
 // Updates the state of the all keys in the received SDLS EP PDU
 {	// Local variables
     SDLS_KEY_BLK_t packet;
     int count = 0;
-    int pdu_keys = sdls_frame.pdu.pdu_len / 2;
+    int pdu_keys = inst->sdls_frame.pdu.pdu_len / 2;
     #ifdef PDU_DEBUG
         OS_printf("Keys ");
     #endif
     // Read in PDU
     for (int x = 0; x < pdu_keys; x++)
     {
-        packet.kblk[x].kid = (sdls_frame.pdu.data[count] << 8) | (sdls_frame.pdu.data[count+1]);
+        packet.kblk[x].kid = (inst->sdls_frame.pdu.data[count] << 8) | (inst->sdls_frame.pdu.data[count+1]);
         count = count + 2;
         #ifdef PDU_DEBUG
             if (x != (pdu_keys - 1))
@@ -1359,41 +1417,42 @@ static int32 Crypto_Key_update(uint8 state)
     {
         if (packet.kblk[x].kid < 128)
         {
-            report.af = 1;
-            if (log_summary.rs > 0)
+            inst->report.af = 1;
+            if (inst->log_summary.rs > 0)
             {
-                Crypto_increment((uint8*)&log_summary.num_se, 4);
-                log_summary.rs--;
-                log.blk[log_count].emt = MKID_STATE_ERR_EID;
-                log.blk[log_count].emv[0] = 0x4E;
-                log.blk[log_count].emv[1] = 0x41;
-                log.blk[log_count].emv[2] = 0x53;
-                log.blk[log_count].emv[3] = 0x41;
-                log.blk[log_count++].em_len = 4;
+                Crypto_increment((uint8*)&inst->log_summary.num_se, 4);
+                inst->log_summary.rs--;
+                inst->log.blk[inst->log_count].emt = MKID_STATE_ERR_EID;
+                inst->log.blk[inst->log_count].emv[0] = 0x4E;
+                inst->log.blk[inst->log_count].emv[1] = 0x41;
+                inst->log.blk[inst->log_count].emv[2] = 0x53;
+                inst->log.blk[inst->log_count].emv[3] = 0x41;
+                inst->log.blk[inst->log_count++].em_len = 4;
             }
             OS_printf(KRED "Error: MKID state cannot be changed! \n" RESET);
             // TODO: Exit
         }
 
-        if (ek_ring[packet.kblk[x].kid].key_state == (state - 1))
+        if (inst->ek_ring[packet.kblk[x].kid].key_state == (state - 1))
         {
-            ek_ring[packet.kblk[x].kid].key_state = state;
+            inst->ek_ring[packet.kblk[x].kid].key_state = state;
+            Crypto_Cipher_invalidate_key(inst, packet.kblk[x].kid);
             #ifdef PDU_DEBUG
                 //OS_printf("Key ID %d state changed to ", packet.kblk[x].kid);
             #endif
         }
         else 
         {
-            if (log_summary.rs > 0)
+            if (inst->log_summary.rs > 0)
             {
-                Crypto_increment((uint8*)&log_summary.num_se, 4);
-                log_summary.rs--;
-                log.blk[log_count].emt = KEY_TRANSITION_ERR_EID;
-                log.blk[log_count].emv[0] = 0x4E;
-                log.blk[log_count].emv[1] = 0x41;
-                log.blk[log_count].emv[2] = 0x53;
-                log.blk[log_count].emv[3] = 0x41;
-                log.blk[log_count++].em_len = 4;
+                Crypto_increment((uint8*)&inst->log_summary.num_se, 4);
+                inst->log_summary.rs--;
+                inst->log.blk[inst->log_count].emt = KEY_TRANSITION_ERR_EID;
+                inst->log.blk[inst->log_count].emv[0] = 0x4E;
+                inst->log.blk[inst->log_count].emv[1] = 0x41;
+                inst->log.blk[inst->log_count].emv[2] = 0x53;
+                inst->log.blk[inst->log_count].emv[3] = 0x41;
+                inst->log.blk[inst->log_count++].em_len = 4;
             }
             OS_printf(KRED "Error: Key %d cannot transition to desired state! \n" RESET, packet.kblk[x].kid);
         }
@@ -1401,7 +1460,7 @@ static int32 Crypto_Key_update(uint8 state)
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_Key_inventory(char* ingest)
+static int32 Crypto_Key_inventory(crypto_instance_t* inst, char* ingest)
 {
     // Local variables
     SDLS_KEY_INVENTORY_t packet;
@@ -1409,16 +1468,16 @@ static int32 Crypto_Key_inventory(char* ingest)
     uint16_t range = 0;
 
     // Read in PDU
-    packet.kid_first = ((uint8)sdls_frame.pdu.data[count] << 8) | ((uint8)sdls_frame.pdu.data[count+1]);
+    packet.kid_first = ((uint8)inst->sdls_frame.pdu.data[count] << 8) | ((uint8)inst->sdls_frame.pdu.data[count+1]);
     count = count + 2;
-    packet.kid_last = ((uint8)sdls_frame.pdu.data[count] << 8) | ((uint8)sdls_frame.pdu.data[count+1]);
+    packet.kid_last = ((uint8)inst->sdls_frame.pdu.data[count] << 8) | ((uint8)inst->sdls_frame.pdu.data[count+1]);
     count = count + 2;
 
     // Prepare for Reply
     range = packet.kid_last - packet.kid_first;
-    sdls_frame.pdu.pdu_len = 2 + (range * (2 + 1));
-    sdls_frame.hdr.pkt_length = sdls_frame.pdu.pdu_len + 9;
-    count = Crypto_Prep_Reply(ingest, 128);
+    inst->sdls_frame.pdu.pdu_len = 2 + (range * (2 + 1));
+    inst->sdls_frame.hdr.pkt_length = inst->sdls_frame.pdu.pdu_len + 9;
+    count = Crypto_Prep_Reply(inst, ingest, 128);
     ingest[count++] = (range & 0xFF00) >> 8;
     ingest[count++] = (range & 0x00FF);
     for (uint16_t x = packet.kid_first; x < packet.kid_last; x++)
@@ -1426,20 +1485,19 @@ static int32 Crypto_Key_inventory(char* ingest)
         ingest[count++] = (x & 0xFF00) >> 8;
         ingest[count++] = (x & 0x00FF);
         // Key State
-        ingest[count++] = ek_ring[x].key_state;
+        ingest[count++] = inst->ek_ring[x].key_state;
     }
     return count;
 }
 
-static int32 Crypto_Key_verify(char* ingest)
+static int32 Crypto_Key_verify(crypto_instance_t* inst, char* ingest)
 {
     // Local variables
     SDLS_KEYV_CMD_t packet;
     int count = 0;
-    int pdu_keys = sdls_frame.pdu.pdu_len / SDLS_KEYV_CMD_BLK_SIZE;
+    int pdu_keys = inst->sdls_frame.pdu.pdu_len / SDLS_KEYV_CMD_BLK_SIZE;
 
-    gcry_error_t gcry_error = GPG_ERR_NO_ERROR;
-    gcry_cipher_hd_t tmp_hd;
+    crypto_provider_ctx_t tmp_ctx;
     uint8 iv_loc;
 
     //uint8 tmp_mac[MAC_SIZE];
@@ -1452,7 +1510,7 @@ static int32 Crypto_Key_verify(char* ingest)
     for (int x = 0; x < pdu_keys; x++)
     {	
         // Key ID
-        packet.blk[x].kid = ((uint8)sdls_frame.pdu.data[count] << 8) | ((uint8)sdls_frame.pdu.data[count+1]);
+        packet.blk[x].kid = ((uint8)inst->sdls_frame.pdu.data[count] << 8) | ((uint8)inst->sdls_frame.pdu.data[count+1]);
         count = count + 2;
         #ifdef PDU_DEBUG
             OS_printf("Crypto_Key_verify: Block %d Key ID is %d \n", x, packet.blk[x].kid);
@@ -1460,7 +1518,7 @@ static int32 Crypto_Key_verify(char* ingest)
         // Key Challenge
         for (int y = 0; y < CHALLENGE_SIZE; y++)
         {
-            packet.blk[x].challenge[y] = sdls_frame.pdu.data[count++];
+            packet.blk[x].challenge[y] = inst->sdls_frame.pdu.data[count++];
         }
         #ifdef PDU_DEBUG
             OS_printf("\n");
@@ -1468,9 +1526,9 @@ static int32 Crypto_Key_verify(char* ingest)
     }
     
     // Prepare for Reply
-    sdls_frame.pdu.pdu_len = pdu_keys * (2 + IV_SIZE + CHALLENGE_SIZE + CHALLENGE_MAC_SIZE);
-    sdls_frame.hdr.pkt_length = sdls_frame.pdu.pdu_len + 9;
-    count = Crypto_Prep_Reply(ingest, 128);
+    inst->sdls_frame.pdu.pdu_len = pdu_keys * (2 + IV_SIZE + CHALLENGE_SIZE + CHALLENGE_MAC_SIZE);
+    inst->sdls_frame.hdr.pkt_length = inst->sdls_frame.pdu.pdu_len + 9;
+    count = Crypto_Prep_Reply(inst, ingest, 128);
 
     for (int x = 0; x < pdu_keys; x++)
     {   // Key ID
@@ -1481,61 +1539,28 @@ static int32 Crypto_Key_verify(char* ingest)
         iv_loc = count;
         for (int y = 0; y < IV_SIZE; y++)
         {   
-            ingest[count++] = tc_frame.tc_sec_header.iv[y];
+            ingest[count++] = inst->tc_frame.tc_sec_header.iv[y];
         }
         ingest[count-1] = ingest[count-1] + x + 1;
 
         // Encrypt challenge 
-        gcry_error = gcry_cipher_open(
-            &(tmp_hd), 
-            GCRY_CIPHER_AES256, 
-            GCRY_CIPHER_MODE_GCM, 
-            GCRY_CIPHER_CBC_MAC
-        );
-        if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-        {
-            OS_printf(KRED "ERROR: gcry_cipher_open error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-        }
-        gcry_error = gcry_cipher_setkey(
-            tmp_hd, 
-            &(ek_ring[packet.blk[x].kid].value[0]),
-            KEY_SIZE
-        );
-        if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-        {
-            OS_printf(KRED "ERROR: gcry_cipher_setkey error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-        }
-        gcry_error = gcry_cipher_setiv(
-            tmp_hd, 
-            &(ingest[iv_loc]), 
-            IV_SIZE
-        );
-        if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-        {
-            OS_printf(KRED "ERROR: gcry_cipher_setiv error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-        }
-        gcry_error = gcry_cipher_encrypt(
-            tmp_hd,
-            &(ingest[count]),                               // ciphertext output
-            CHALLENGE_SIZE,			 		                // length of data
-            &(packet.blk[x].challenge[0]),                  // plaintext input
-            CHALLENGE_SIZE                                  // in data length
-        );
-        if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+        if (inst->provider->key_load(&tmp_ctx, &(inst->ek_ring[packet.blk[x].kid].value[0]), KEY_SIZE) == OS_SUCCESS)
         {
-            OS_printf(KRED "ERROR: gcry_cipher_encrypt error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
+            inst->provider->aead_encrypt(
+                &tmp_ctx,
+                (uint8*) &(ingest[iv_loc]),                 // initialization vector
+                IV_SIZE,                                    // IV length
+                NULL,                                       // no AAD
+                0,                                          // AAD length
+                &(packet.blk[x].challenge[0]),              // plaintext input
+                (uint8*) &(ingest[count]),                  // ciphertext output
+                CHALLENGE_SIZE,                             // length of data
+                (uint8*) &(ingest[count + CHALLENGE_SIZE]), // tag output
+                CHALLENGE_MAC_SIZE                          // tag size
+            );
+            inst->provider->key_unload(&tmp_ctx);
         }
         count = count + CHALLENGE_SIZE; // Don't forget to increment count!
-        
-        gcry_error = gcry_cipher_gettag(
-            tmp_hd,
-            &(ingest[count]),                               // tag output
-            CHALLENGE_MAC_SIZE                              // tag size
-        );
-        if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-        {
-            OS_printf(KRED "ERROR: gcry_cipher_gettag error code %d \n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-        }
         count = count + CHALLENGE_MAC_SIZE; // Don't forget to increment count!
 
         // Copy from tmp_mac into ingest
@@ -1543,7 +1568,6 @@ static int32 Crypto_Key_verify(char* ingest)
         //{
         //    ingest[count++] = tmp_mac[y];
         //}
-        gcry_cipher_close(tmp_hd);
     }
 
     #ifdef PDU_DEBUG
@@ -1557,7 +1581,31 @@ static int32 Crypto_Key_verify(char* ingest)
 /*
 ** Security Association Management Services
 */
-static int32 Crypto_SA_start(void)
+static void Crypto_SA_release(crypto_instance_t* inst, crypto_gvcid_map_t* map, uint16 spi)
+// Takes the channel of map from the operational SA serving it so spi can be mapped in its place,
+// that SA is stopped as by Crypto_SA_stop once it serves no channel at all
+{
+    uint16 old = map->spi;
+
+    if ((old == 0) || (old == spi) || (inst->sa[old].sa_state != SA_OPERATIONAL))
+    {
+        return;
+    }
+    CFE_PSP_MemSet(map, 0, CRYPTO_GVCID_MAP_SIZE);
+    OS_printf(KRED "Warning: SPI %d replaces operational SPI %d on a virtual channel.\n" RESET, spi, old);
+
+    for (int x = 0; x < NUM_GVCID; x++)
+    {
+        if ((inst->gvcid_tc_map[x].spi == old) || (inst->gvcid_tm_map[x].spi == old))
+        {
+            return;
+        }
+    }
+    inst->sa[old].sa_state = SA_KEYED;
+    OS_printf(KRED "Warning: SPI %d serves no channel and changed to KEYED state.\n" RESET, old);
+}
+
+static int32 Crypto_SA_start(crypto_instance_t* inst)
 {	
     // Local variables
     uint8 count = 0;
@@ -1565,79 +1613,53 @@ static int32 Crypto_SA_start(void)
     crypto_gvcid_t gvcid;
 
     // Read ingest
-    spi = ((uint8)sdls_frame.pdu.data[0] << 8) | (uint8)sdls_frame.pdu.data[1];
+    spi = ((uint8)inst->sdls_frame.pdu.data[0] << 8) | (uint8)inst->sdls_frame.pdu.data[1];
 
     // Overwrite last PID
-    sa[spi].lpid = (sdls_frame.pdu.type << 7) | (sdls_frame.pdu.uf << 6) | (sdls_frame.pdu.sg << 4) | sdls_frame.pdu.pid;
+    inst->sa[spi].lpid = (inst->sdls_frame.pdu.type << 7) | (inst->sdls_frame.pdu.uf << 6) | (inst->sdls_frame.pdu.sg << 4) | inst->sdls_frame.pdu.pid;
 
     // Check SPI exists and in 'Keyed' state
     if (spi < NUM_SA)
     {
-        if (sa[spi].sa_state == SA_KEYED)
+        if (inst->sa[spi].sa_state == SA_KEYED)
         {
             count = 2;
 
-            for(int x = 0; x <= ((sdls_frame.pdu.pdu_len - 2) / 4); x++)
+            for(int x = 0; x <= ((inst->sdls_frame.pdu.pdu_len - 2) / 4); x++)
             {   // Read in GVCID
-                gvcid.tfvn  = (sdls_frame.pdu.data[count] >> 4);
-                gvcid.scid  = (sdls_frame.pdu.data[count] << 12)     |  
-                              (sdls_frame.pdu.data[count + 1] << 4)  | 
-                              (sdls_frame.pdu.data[count + 2] >> 4);
-                gvcid.vcid  = (sdls_frame.pdu.data[count + 2] << 4)  |
-                              (sdls_frame.pdu.data[count + 3] && 0x3F);
-                gvcid.mapid = (sdls_frame.pdu.data[count + 3]);
+                gvcid.tfvn  = (inst->sdls_frame.pdu.data[count] >> 4);
+                gvcid.scid  = (inst->sdls_frame.pdu.data[count] << 12)     |  
+                              (inst->sdls_frame.pdu.data[count + 1] << 4)  | 
+                              (inst->sdls_frame.pdu.data[count + 2] >> 4);
+                gvcid.vcid  = (inst->sdls_frame.pdu.data[count + 2] << 4)  |
+                              (inst->sdls_frame.pdu.data[count + 3] && 0x3F);
+                gvcid.mapid = (inst->sdls_frame.pdu.data[count + 3]);
                 
-                // TC
-                if (gvcid.vcid != tc_frame.tc_header.vcid)
-                {   // Clear all GVCIDs for provided SPI
-                    if (gvcid.mapid == TYPE_TC)
+                // Write channel to the index, stopping any other SA it had
+                if (gvcid.mapid == TYPE_TC)
+                {   // TC
+                    if (gvcid.vcid != inst->tc_frame.tc_header.vcid)
                     {
-                        for (int i = 0; i < NUM_GVCID; i++)
-                        {   // TC
-                            sa[spi].gvcid_tc_blk[x].tfvn  = 0;
-                            sa[spi].gvcid_tc_blk[x].scid  = 0;
-                            sa[spi].gvcid_tc_blk[x].vcid  = 0;
-                            sa[spi].gvcid_tc_blk[x].mapid = 0;
-                        }
-                    }
-                    // Write channel to SA
-                    if (gvcid.mapid != TYPE_MAP)  
-                    {   // TC
-                        sa[spi].gvcid_tc_blk[gvcid.vcid].tfvn  = gvcid.tfvn;
-                        sa[spi].gvcid_tc_blk[gvcid.vcid].scid  = gvcid.scid;
-                        sa[spi].gvcid_tc_blk[gvcid.vcid].mapid = gvcid.mapid;
-                    }
-                    else
-                    {
-                        // TODO: Handle TYPE_MAP
+                        Crypto_SA_release(inst, &(inst->gvcid_tc_map[gvcid.vcid]), spi);
+                        inst->gvcid_tc_map[gvcid.vcid].spi  = spi;
+                        inst->gvcid_tc_map[gvcid.vcid].tfvn = gvcid.tfvn;
+                        inst->gvcid_tc_map[gvcid.vcid].scid = gvcid.scid;
                     }
                 }
-                // TM
-                if (gvcid.vcid != tm_frame.tm_header.vcid)
-                {   // Clear all GVCIDs for provided SPI
-                    if (gvcid.mapid == TYPE_TM)
-                    {
-                        for (int i = 0; i < NUM_GVCID; i++)
-                        {   // TM
-                            sa[spi].gvcid_tm_blk[x].tfvn  = 0;
-                            sa[spi].gvcid_tm_blk[x].scid  = 0;
-                            sa[spi].gvcid_tm_blk[x].vcid  = 0;
-                            sa[spi].gvcid_tm_blk[x].mapid = 0;
-                        }
-                    }
-                    // Write channel to SA
-                    if (gvcid.mapid != TYPE_MAP)  
-                    {   // TM
-                        sa[spi].gvcid_tm_blk[gvcid.vcid].tfvn  = gvcid.tfvn;
-                        sa[spi].gvcid_tm_blk[gvcid.vcid].scid  = gvcid.scid;
-                        sa[spi].gvcid_tm_blk[gvcid.vcid].vcid  = gvcid.vcid;
-                        sa[spi].gvcid_tm_blk[gvcid.vcid].mapid = gvcid.mapid;
-                    }
-                    else
+                else if (gvcid.mapid == TYPE_TM)
+                {   // TM
+                    if (gvcid.vcid != inst->tm_frame.tm_header.vcid)
                     {
-                        // TODO: Handle TYPE_MAP
+                        Crypto_SA_release(inst, &(inst->gvcid_tm_map[gvcid.vcid]), spi);
+                        inst->gvcid_tm_map[gvcid.vcid].spi  = spi;
+                        inst->gvcid_tm_map[gvcid.vcid].tfvn = gvcid.tfvn;
+                        inst->gvcid_tm_map[gvcid.vcid].scid = gvcid.scid;
                     }
-                }                
+                }
+                else
+                {
+                    // TODO: Handle TYPE_MAP
+                }
 
                 #ifdef PDU_DEBUG
                     OS_printf("SPI %d changed to OPERATIONAL state. \n", spi);
@@ -1659,7 +1681,7 @@ static int32 Crypto_SA_start(void)
                 #endif
             
                 // Change to operational state
-                sa[spi].sa_state = SA_OPERATIONAL;
+                inst->sa[spi].sa_state = SA_OPERATIONAL;
             }
         }
         else
@@ -1679,39 +1701,38 @@ static int32 Crypto_SA_start(void)
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_SA_stop(void)
+static int32 Crypto_SA_stop(crypto_instance_t* inst)
 {
     // Local variables
     uint16 spi = 0x0000;
 
     // Read ingest
-    spi = ((uint8)sdls_frame.pdu.data[0] << 8) | (uint8)sdls_frame.pdu.data[1];
+    spi = ((uint8)inst->sdls_frame.pdu.data[0] << 8) | (uint8)inst->sdls_frame.pdu.data[1];
     OS_printf("spi = %d \n", spi);
 
     // Overwrite last PID
-    sa[spi].lpid = (sdls_frame.pdu.type << 7) | (sdls_frame.pdu.uf << 6) | (sdls_frame.pdu.sg << 4) | sdls_frame.pdu.pid;
+    inst->sa[spi].lpid = (inst->sdls_frame.pdu.type << 7) | (inst->sdls_frame.pdu.uf << 6) | (inst->sdls_frame.pdu.sg << 4) | inst->sdls_frame.pdu.pid;
 
     // Check SPI exists and in 'Active' state
     if (spi < NUM_SA)
     {
-        if (sa[spi].sa_state == SA_OPERATIONAL)
+        if (inst->sa[spi].sa_state == SA_OPERATIONAL)
         {
             // Remove all GVC/GMAP IDs
             for (int x = 0; x < NUM_GVCID; x++)
-            {   // TC
-                sa[spi].gvcid_tc_blk[x].tfvn  = 0;
-                sa[spi].gvcid_tc_blk[x].scid  = 0;
-                sa[spi].gvcid_tc_blk[x].vcid  = 0;
-                sa[spi].gvcid_tc_blk[x].mapid = 0;
-                // TM
-                sa[spi].gvcid_tm_blk[x].tfvn  = 0;
-                sa[spi].gvcid_tm_blk[x].scid  = 0;
-                sa[spi].gvcid_tm_blk[x].vcid  = 0;
-                sa[spi].gvcid_tm_blk[x].mapid = 0;
+            {
+                if (inst->gvcid_tc_map[x].spi == spi)
+                {   // TC
+                    CFE_PSP_MemSet(&(inst->gvcid_tc_map[x]), 0, CRYPTO_GVCID_MAP_SIZE);
+                }
+                if (inst->gvcid_tm_map[x].spi == spi)
+                {   // TM
+                    CFE_PSP_MemSet(&(inst->gvcid_tm_map[x]), 0, CRYPTO_GVCID_MAP_SIZE);
+                }
             }
             
             // Change to operational state
-            sa[spi].sa_state = SA_KEYED;
+            inst->sa[spi].sa_state = SA_KEYED;
             #ifdef PDU_DEBUG
                 OS_printf("SPI %d changed to KEYED state. \n", spi);
             #endif
@@ -1733,7 +1754,7 @@ static int32 Crypto_SA_stop(void)
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_SA_rekey(void)
+static int32 Crypto_SA_rekey(crypto_instance_t* inst)
 {
     // Local variables
     uint16 spi = 0x0000;
@@ -1741,19 +1762,20 @@ static int32 Crypto_SA_rekey(void)
     int x = 0;  
 
     // Read ingest
-    spi = ((uint8)sdls_frame.pdu.data[count] << 8) | (uint8)sdls_frame.pdu.data[count+1];
+    spi = ((uint8)inst->sdls_frame.pdu.data[count] << 8) | (uint8)inst->sdls_frame.pdu.data[count+1];
     count = count + 2;
 
     // Overwrite last PID
-    sa[spi].lpid = (sdls_frame.pdu.type << 7) | (sdls_frame.pdu.uf << 6) | (sdls_frame.pdu.sg << 4) | sdls_frame.pdu.pid;
+    inst->sa[spi].lpid = (inst->sdls_frame.pdu.type << 7) | (inst->sdls_frame.pdu.uf << 6) | (inst->sdls_frame.pdu.sg << 4) | inst->sdls_frame.pdu.pid;
 
     // Check SPI exists and in 'Unkeyed' state
     if (spi < NUM_SA)
     {
-        if (sa[spi].sa_state == SA_UNKEYED)
+        if (inst->sa[spi].sa_state == SA_UNKEYED)
         {	// Encryption Key
-            sa[spi].ekid = ((uint8)sdls_frame.pdu.data[count] << 8) | (uint8)sdls_frame.pdu.data[count+1];
+            inst->sa[spi].ekid = ((uint8)inst->sdls_frame.pdu.data[count] << 8) | (uint8)inst->sdls_frame.pdu.data[count+1];
             count = count + 2;
+            Crypto_Cipher_invalidate_sa(inst, spi);
 
             // Authentication Key
             //sa[spi].akid = ((uint8)sdls_frame.pdu.data[count] << 8) | (uint8)sdls_frame.pdu.data[count+1];
@@ -1763,17 +1785,18 @@ static int32 Crypto_SA_rekey(void)
             #ifdef PDU_DEBUG
                 OS_printf("SPI %d IV updated to: 0x", spi);
             #endif
-            if (sa[spi].iv_len > 0)
+            if (inst->sa[spi].iv_len > 0)
             {   // Set IV - authenticated encryption
-                for (x = count; x < (sa[spi].iv_len + count); x++)
+                for (x = count; x < (inst->sa[spi].iv_len + count); x++)
                 {
                     // TODO: Uncomment once fixed in ESA implementation
                     // TODO: Assuming this was fixed...
-                    sa[spi].iv[x - count] = (uint8) sdls_frame.pdu.data[x];
+                    inst->sa[spi].iv[x - count] = (uint8) inst->sdls_frame.pdu.data[x];
                     #ifdef PDU_DEBUG
-                        OS_printf("%02x", sdls_frame.pdu.data[x]);
+                        OS_printf("%02x", inst->sdls_frame.pdu.data[x]);
                     #endif
                 }
+                Crypto_ARC_reset(&inst->sa[spi]);
             }
             else
             {   // Set SN
@@ -1784,9 +1807,9 @@ static int32 Crypto_SA_rekey(void)
             #endif
 
             // Change to keyed state
-            sa[spi].sa_state = SA_KEYED;
+            inst->sa[spi].sa_state = SA_KEYED;
             #ifdef PDU_DEBUG
-                OS_printf("SPI %d changed to KEYED state with encrypted Key ID %d. \n", spi, sa[spi].ekid);
+                OS_printf("SPI %d changed to KEYED state with encrypted Key ID %d. \n", spi, inst->sa[spi].ekid);
             #endif
         }
         else
@@ -1801,31 +1824,31 @@ static int32 Crypto_SA_rekey(void)
 
     #ifdef DEBUG
         OS_printf("\t spi  = %d \n", spi);
-        OS_printf("\t ekid = %d \n", sa[spi].ekid);
+        OS_printf("\t ekid = %d \n", inst->sa[spi].ekid);
         //OS_printf("\t akid = %d \n", sa[spi].akid);
     #endif
 
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_SA_expire(void)
+static int32 Crypto_SA_expire(crypto_instance_t* inst)
 {
     // Local variables
     uint16 spi = 0x0000;
 
     // Read ingest
-    spi = ((uint8)sdls_frame.pdu.data[0] << 8) | (uint8)sdls_frame.pdu.data[1];
+    spi = ((uint8)inst->sdls_frame.pdu.data[0] << 8) | (uint8)inst->sdls_frame.pdu.data[1];
     OS_printf("spi = %d \n", spi);
 
     // Overwrite last PID
-    sa[spi].lpid = (sdls_frame.pdu.type << 7) | (sdls_frame.pdu.uf << 6) | (sdls_frame.pdu.sg << 4) | sdls_frame.pdu.pid;
+    inst->sa[spi].lpid = (inst->sdls_frame.pdu.type << 7) | (inst->sdls_frame.pdu.uf << 6) | (inst->sdls_frame.pdu.sg << 4) | inst->sdls_frame.pdu.pid;
 
     // Check SPI exists and in 'Keyed' state
     if (spi < NUM_SA)
     {
-        if (sa[spi].sa_state == SA_KEYED)
+        if (inst->sa[spi].sa_state == SA_KEYED)
         {	// Change to 'Unkeyed' state
-            sa[spi].sa_state = SA_UNKEYED;
+            inst->sa[spi].sa_state = SA_UNKEYED;
             #ifdef PDU_DEBUG
                 OS_printf("SPI %d changed to UNKEYED state. \n", spi);
             #endif
@@ -1843,88 +1866,102 @@ static int32 Crypto_SA_expire(void)
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_SA_create(void)
+static int32 Crypto_SA_create(crypto_instance_t* inst)
 {
     // Local variables
     uint8 count = 6;
     uint16 spi = 0x0000;
+    uint16 abm_len = 0;
 
     // Read sdls_frame.pdu.data
-    spi = ((uint8)sdls_frame.pdu.data[0] << 8) | (uint8)sdls_frame.pdu.data[1];
+    spi = ((uint8)inst->sdls_frame.pdu.data[0] << 8) | (uint8)inst->sdls_frame.pdu.data[1];
     OS_printf("spi = %d \n", spi);
 
+    // Locate ABM length past the ECS, IV, and ACS fields before writing anything to the SA
+    count = count + inst->sdls_frame.pdu.data[5];
+    count = count + 1 + inst->sdls_frame.pdu.data[count];
+    count = count + 1 + inst->sdls_frame.pdu.data[count];
+    abm_len = ((uint8)inst->sdls_frame.pdu.data[count] << 8) | (uint8)inst->sdls_frame.pdu.data[count+1];
+    if (abm_len > ABM_SIZE)
+    {
+        OS_printf(KRED "ERROR: SPI %d ABM length %d exceeds %d bytes.\n" RESET, spi, abm_len, ABM_SIZE);
+        return OS_SUCCESS;
+    }
+    count = 6;
+
     // Overwrite last PID
-    sa[spi].lpid = (sdls_frame.pdu.type << 7) | (sdls_frame.pdu.uf << 6) | (sdls_frame.pdu.sg << 4) | sdls_frame.pdu.pid;
+    inst->sa[spi].lpid = (inst->sdls_frame.pdu.type << 7) | (inst->sdls_frame.pdu.uf << 6) | (inst->sdls_frame.pdu.sg << 4) | inst->sdls_frame.pdu.pid;
 
     // Write SA Configuration
-    sa[spi].est = ((uint8)sdls_frame.pdu.data[2] & 0x80) >> 7;
-    sa[spi].ast = ((uint8)sdls_frame.pdu.data[2] & 0x40) >> 6;
-    sa[spi].shivf_len = ((uint8)sdls_frame.pdu.data[2] & 0x3F);
-    sa[spi].shsnf_len = ((uint8)sdls_frame.pdu.data[3] & 0xFC) >> 2;
-    sa[spi].shplf_len = ((uint8)sdls_frame.pdu.data[3] & 0x03);
-    sa[spi].stmacf_len = ((uint8)sdls_frame.pdu.data[4]);
-    sa[spi].ecs_len = ((uint8)sdls_frame.pdu.data[5]);
-    for (int x = 0; x < sa[spi].ecs_len; x++)
+    inst->sa[spi].est = ((uint8)inst->sdls_frame.pdu.data[2] & 0x80) >> 7;
+    inst->sa[spi].ast = ((uint8)inst->sdls_frame.pdu.data[2] & 0x40) >> 6;
+    inst->sa[spi].shivf_len = ((uint8)inst->sdls_frame.pdu.data[2] & 0x3F);
+    inst->sa[spi].shsnf_len = ((uint8)inst->sdls_frame.pdu.data[3] & 0xFC) >> 2;
+    inst->sa[spi].shplf_len = ((uint8)inst->sdls_frame.pdu.data[3] & 0x03);
+    inst->sa[spi].stmacf_len = ((uint8)inst->sdls_frame.pdu.data[4]);
+    inst->sa[spi].ecs_len = ((uint8)inst->sdls_frame.pdu.data[5]);
+    for (int x = 0; x < inst->sa[spi].ecs_len; x++)
     {
-        sa[spi].ecs[x] = ((uint8)sdls_frame.pdu.data[count++]);
+        inst->sa[spi].ecs[x] = ((uint8)inst->sdls_frame.pdu.data[count++]);
     }
-    sa[spi].iv_len = ((uint8)sdls_frame.pdu.data[count++]);
-    for (int x = 0; x < sa[spi].iv_len; x++)
+    inst->sa[spi].iv_len = ((uint8)inst->sdls_frame.pdu.data[count++]);
+    for (int x = 0; x < inst->sa[spi].iv_len; x++)
     {
-        sa[spi].iv[x] = ((uint8)sdls_frame.pdu.data[count++]);
+        inst->sa[spi].iv[x] = ((uint8)inst->sdls_frame.pdu.data[count++]);
     }
-    sa[spi].acs_len = ((uint8)sdls_frame.pdu.data[count++]);
-    for (int x = 0; x < sa[spi].acs_len; x++)
+    Crypto_ARC_reset(&inst->sa[spi]);
+    inst->sa[spi].acs_len = ((uint8)inst->sdls_frame.pdu.data[count++]);
+    for (int x = 0; x < inst->sa[spi].acs_len; x++)
     {
-        sa[spi].acs = ((uint8)sdls_frame.pdu.data[count++]);
+        inst->sa[spi].acs = ((uint8)inst->sdls_frame.pdu.data[count++]);
     }
-    sa[spi].abm_len = (uint8)((sdls_frame.pdu.data[count] << 8) | (sdls_frame.pdu.data[count+1]));
+    inst->sa[spi].abm_len = abm_len;
     count = count + 2;
-    for (int x = 0; x < sa[spi].abm_len; x++)
+    for (int x = 0; x < inst->sa[spi].abm_len; x++)
     {
-        sa[spi].abm[x] = ((uint8)sdls_frame.pdu.data[count++]);
+        inst->sa[spi].abm[x] = ((uint8)inst->sdls_frame.pdu.data[count++]);
     }
-    sa[spi].arc_len = ((uint8)sdls_frame.pdu.data[count++]);
-    for (int x = 0; x < sa[spi].arc_len; x++)
+    inst->sa[spi].arc_len = ((uint8)inst->sdls_frame.pdu.data[count++]);
+    for (int x = 0; x < inst->sa[spi].arc_len; x++)
     {
-        sa[spi].arc[x] = ((uint8)sdls_frame.pdu.data[count++]);
+        inst->sa[spi].arc[x] = ((uint8)inst->sdls_frame.pdu.data[count++]);
     }
-    sa[spi].arcw_len = ((uint8)sdls_frame.pdu.data[count++]);
-    for (int x = 0; x < sa[spi].arcw_len; x++)
+    inst->sa[spi].arcw_len = ((uint8)inst->sdls_frame.pdu.data[count++]);
+    for (int x = 0; x < inst->sa[spi].arcw_len; x++)
     {
-        sa[spi].arcw[x] = ((uint8)sdls_frame.pdu.data[count++]);
+        inst->sa[spi].arcw[x] = ((uint8)inst->sdls_frame.pdu.data[count++]);
     }
 
     // TODO: Checks for valid data
 
     // Set state to unkeyed
-    sa[spi].sa_state = SA_UNKEYED;
+    inst->sa[spi].sa_state = SA_UNKEYED;
 
     #ifdef PDU_DEBUG
-        Crypto_saPrint(&sa[spi]);
+        Crypto_saPrint(&inst->sa[spi]);
     #endif
 
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_SA_delete(void)
+static int32 Crypto_SA_delete(crypto_instance_t* inst)
 {
     // Local variables
     uint16 spi = 0x0000;
 
     // Read ingest
-    spi = ((uint8)sdls_frame.pdu.data[0] << 8) | (uint8)sdls_frame.pdu.data[1];
+    spi = ((uint8)inst->sdls_frame.pdu.data[0] << 8) | (uint8)inst->sdls_frame.pdu.data[1];
     OS_printf("spi = %d \n", spi);
 
     // Overwrite last PID
-    sa[spi].lpid = (sdls_frame.pdu.type << 7) | (sdls_frame.pdu.uf << 6) | (sdls_frame.pdu.sg << 4) | sdls_frame.pdu.pid;
+    inst->sa[spi].lpid = (inst->sdls_frame.pdu.type << 7) | (inst->sdls_frame.pdu.uf << 6) | (inst->sdls_frame.pdu.sg << 4) | inst->sdls_frame.pdu.pid;
 
     // Check SPI exists and in 'Unkeyed' state
     if (spi < NUM_SA)
     {
-        if (sa[spi].sa_state == SA_UNKEYED)
+        if (inst->sa[spi].sa_state == SA_UNKEYED)
         {	// Change to 'None' state
-            sa[spi].sa_state = SA_NONE;
+            inst->sa[spi].sa_state = SA_NONE;
             #ifdef PDU_DEBUG
                 OS_printf("SPI %d changed to NONE state. \n", spi);
             #endif
@@ -1944,13 +1981,35 @@ static int32 Crypto_SA_delete(void)
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_SA_setARSN(void)
+static int32 Crypto_SA_find(crypto_instance_t* inst, uint8 type, uint8 tfvn, uint16 scid, uint8 vcid, uint16* spi)
+// Finds the operational SA of a virtual channel, type is TYPE_TC for TC or TYPE_TM for TM and AOS channels
+{
+    crypto_gvcid_map_t* map;
+
+    if (vcid < NUM_GVCID)
+    {
+        map = (type == TYPE_TC) ? &(inst->gvcid_tc_map[vcid]) : &(inst->gvcid_tm_map[vcid]);
+        if ((map->spi != 0) &&
+            (map->tfvn == tfvn) &&
+            (map->scid == scid) &&
+            (inst->sa[map->spi].sa_state == SA_OPERATIONAL))
+        {
+            *spi = map->spi;
+            return OS_SUCCESS;
+        }
+    }
+
+    OS_printf(KRED "Error: No operational SA for TFVN %d SCID %d VCID %d! \n" RESET, tfvn, scid, vcid);
+    return OS_ERROR;
+}
+
+static int32 Crypto_SA_setARSN(crypto_instance_t* inst)
 {
     // Local variables
     uint16 spi = 0x0000;
 
     // Read ingest
-    spi = ((uint8)sdls_frame.pdu.data[0] << 8) | (uint8)sdls_frame.pdu.data[1];
+    spi = ((uint8)inst->sdls_frame.pdu.data[0] << 8) | (uint8)inst->sdls_frame.pdu.data[1];
     OS_printf("spi = %d \n", spi);
 
     // TODO: Check SA type (authenticated, encrypted, both) and set appropriately
@@ -1962,16 +2021,17 @@ static int32 Crypto_SA_setARSN(void)
         #ifdef PDU_DEBUG
             OS_printf("SPI %d IV updated to: 0x", spi);
         #endif
-        if (sa[spi].iv_len > 0)
+        if (inst->sa[spi].iv_len > 0)
         {   // Set IV - authenticated encryption
             for (int x = 0; x < IV_SIZE; x++)
             {
-                sa[spi].iv[x] = (uint8) sdls_frame.pdu.data[x + 2];
+                inst->sa[spi].iv[x] = (uint8) inst->sdls_frame.pdu.data[x + 2];
                 #ifdef PDU_DEBUG
-                    OS_printf("%02x", sa[spi].iv[x]);
+                    OS_printf("%02x", inst->sa[spi].iv[x]);
                 #endif
             }
-            Crypto_increment((uint8*)sa[spi].iv, IV_SIZE);
+            Crypto_increment((uint8*)inst->sa[spi].iv, IV_SIZE);
+            Crypto_ARC_reset(&inst->sa[spi]);
         }
         else
         {   // Set SN
@@ -1989,29 +2049,29 @@ static int32 Crypto_SA_setARSN(void)
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_SA_setARSNW(void)
+static int32 Crypto_SA_setARSNW(crypto_instance_t* inst)
 {
     // Local variables
     uint16 spi = 0x0000;
 
     // Read ingest
-    spi = ((uint8)sdls_frame.pdu.data[0] << 8) | (uint8)sdls_frame.pdu.data[1];
+    spi = ((uint8)inst->sdls_frame.pdu.data[0] << 8) | (uint8)inst->sdls_frame.pdu.data[1];
     OS_printf("spi = %d \n", spi);
 
     // Check SPI exists
     if (spi < NUM_SA)
     {
-        sa[spi].arcw_len = (uint8) sdls_frame.pdu.data[2];
+        inst->sa[spi].arcw_len = (uint8) inst->sdls_frame.pdu.data[2];
         
         // Check for out of bounds
-        if (sa[spi].arcw_len > (ARC_SIZE))
+        if (inst->sa[spi].arcw_len > (ARC_SIZE))
         {
-            sa[spi].arcw_len = ARC_SIZE;    
+            inst->sa[spi].arcw_len = ARC_SIZE;    
         }
 
-        for(int x = 0; x < sa[spi].arcw_len; x++)
+        for(int x = 0; x < inst->sa[spi].arcw_len; x++)
         {
-            sa[spi].arcw[x] = (uint8) sdls_frame.pdu.data[x+3];
+            inst->sa[spi].arcw[x] = (uint8) inst->sdls_frame.pdu.data[x+3];
         }
     }
     else
@@ -2022,27 +2082,27 @@ static int32 Crypto_SA_setARSNW(void)
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_SA_status(char* ingest)
+static int32 Crypto_SA_status(crypto_instance_t* inst, char* ingest)
 {
     // Local variables
     int count = 0;
     uint16 spi = 0x0000;
 
     // Read ingest
-    spi = ((uint8)sdls_frame.pdu.data[0] << 8) | (uint8)sdls_frame.pdu.data[1];
+    spi = ((uint8)inst->sdls_frame.pdu.data[0] << 8) | (uint8)inst->sdls_frame.pdu.data[1];
     OS_printf("spi = %d \n", spi);
 
     // Check SPI exists
     if (spi < NUM_SA)
     {
         // Prepare for Reply
-        sdls_frame.pdu.pdu_len = 3;
-        sdls_frame.hdr.pkt_length = sdls_frame.pdu.pdu_len + 9;
-        count = Crypto_Prep_Reply(ingest, 128);
+        inst->sdls_frame.pdu.pdu_len = 3;
+        inst->sdls_frame.hdr.pkt_length = inst->sdls_frame.pdu.pdu_len + 9;
+        count = Crypto_Prep_Reply(inst, ingest, 128);
         // PDU
         ingest[count++] = (spi & 0xFF00) >> 8;
         ingest[count++] = (spi & 0x00FF);
-        ingest[count++] = sa[spi].lpid;
+        ingest[count++] = inst->sa[spi].lpid;
     }
     else
     {
@@ -2050,7 +2110,7 @@ static int32 Crypto_SA_status(char* ingest)
     }
 
     #ifdef SA_DEBUG
-        Crypto_saPrint(&sa[spi]);
+        Crypto_saPrint(&inst->sa[spi]);
     #endif
 
     return count; 
@@ -2060,108 +2120,108 @@ static int32 Crypto_SA_status(char* ingest)
 /*
 ** Security Association Monitoring and Control
 */
-static int32 Crypto_MC_ping(char* ingest)
+static int32 Crypto_MC_ping(crypto_instance_t* inst, char* ingest)
 {
     int count = 0;
 
     // Prepare for Reply
-    sdls_frame.pdu.pdu_len = 0;
-    sdls_frame.hdr.pkt_length = sdls_frame.pdu.pdu_len + 9;
-    count = Crypto_Prep_Reply(ingest, 128);
+    inst->sdls_frame.pdu.pdu_len = 0;
+    inst->sdls_frame.hdr.pkt_length = inst->sdls_frame.pdu.pdu_len + 9;
+    count = Crypto_Prep_Reply(inst, ingest, 128);
 
     return count;
 }
 
-static int32 Crypto_MC_status(char* ingest)
+static int32 Crypto_MC_status(crypto_instance_t* inst, char* ingest)
 {
     int count = 0;
 
     // TODO: Update log_summary.rs;
 
     // Prepare for Reply
-    sdls_frame.pdu.pdu_len = 2; // 4
-    sdls_frame.hdr.pkt_length = sdls_frame.pdu.pdu_len + 9;
-    count = Crypto_Prep_Reply(ingest, 128);
+    inst->sdls_frame.pdu.pdu_len = 2; // 4
+    inst->sdls_frame.hdr.pkt_length = inst->sdls_frame.pdu.pdu_len + 9;
+    count = Crypto_Prep_Reply(inst, ingest, 128);
     
     // PDU
     //ingest[count++] = (log_summary.num_se & 0xFF00) >> 8;
-    ingest[count++] = (log_summary.num_se & 0x00FF);
+    ingest[count++] = (inst->log_summary.num_se & 0x00FF);
     //ingest[count++] = (log_summary.rs & 0xFF00) >> 8;
-    ingest[count++] = (log_summary.rs & 0x00FF);
+    ingest[count++] = (inst->log_summary.rs & 0x00FF);
     
     #ifdef PDU_DEBUG
-        OS_printf("log_summary.num_se = 0x%02x \n",log_summary.num_se);
-        OS_printf("log_summary.rs = 0x%02x \n",log_summary.rs);
+        OS_printf("log_summary.num_se = 0x%02x \n",inst->log_summary.num_se);
+        OS_printf("log_summary.rs = 0x%02x \n",inst->log_summary.rs);
     #endif
 
     return count;
 }
 
-static int32 Crypto_MC_dump(char* ingest)
+static int32 Crypto_MC_dump(crypto_instance_t* inst, char* ingest)
 {
     int count = 0;
     
     // Prepare for Reply
-    sdls_frame.pdu.pdu_len = (log_count * 6);  // SDLS_MC_DUMP_RPLY_SIZE
-    sdls_frame.hdr.pkt_length = sdls_frame.pdu.pdu_len + 9;
-    count = Crypto_Prep_Reply(ingest, 128);
+    inst->sdls_frame.pdu.pdu_len = (inst->log_count * 6);  // SDLS_MC_DUMP_RPLY_SIZE
+    inst->sdls_frame.hdr.pkt_length = inst->sdls_frame.pdu.pdu_len + 9;
+    count = Crypto_Prep_Reply(inst, ingest, 128);
 
     // PDU
-    for (int x = 0; x < log_count; x++)
+    for (int x = 0; x < inst->log_count; x++)
     {
-        ingest[count++] = log.blk[x].emt;
+        ingest[count++] = inst->log.blk[x].emt;
         //ingest[count++] = (log.blk[x].em_len & 0xFF00) >> 8;
-        ingest[count++] = (log.blk[x].em_len & 0x00FF);
+        ingest[count++] = (inst->log.blk[x].em_len & 0x00FF);
         for (int y = 0; y < EMV_SIZE; y++)
         {
-            ingest[count++] = log.blk[x].emv[y];
+            ingest[count++] = inst->log.blk[x].emv[y];
         }
     }
 
     #ifdef PDU_DEBUG
-        OS_printf("log_count = %d \n", log_count);
-        OS_printf("log_summary.num_se = 0x%02x \n",log_summary.num_se);
-        OS_printf("log_summary.rs = 0x%02x \n",log_summary.rs);
+        OS_printf("log_count = %d \n", inst->log_count);
+        OS_printf("log_summary.num_se = 0x%02x \n",inst->log_summary.num_se);
+        OS_printf("log_summary.rs = 0x%02x \n",inst->log_summary.rs);
     #endif
 
     return count; 
 }
 
-static int32 Crypto_MC_erase(char* ingest)
+static int32 Crypto_MC_erase(crypto_instance_t* inst, char* ingest)
 {
     int count = 0;
 
     // Zero Logs
     for (int x = 0; x < LOG_SIZE; x++)
     {
-        log.blk[x].emt = 0;
-        log.blk[x].em_len = 0;
+        inst->log.blk[x].emt = 0;
+        inst->log.blk[x].em_len = 0;
         for (int y = 0; y < EMV_SIZE; y++)
         {
-            log.blk[x].emv[y] = 0;
+            inst->log.blk[x].emv[y] = 0;
         }
     }
 
     // Compute Summary
-    log_count = 0;
-    log_summary.num_se = 0;
-    log_summary.rs = LOG_SIZE;
+    inst->log_count = 0;
+    inst->log_summary.num_se = 0;
+    inst->log_summary.rs = LOG_SIZE;
 
     // Prepare for Reply
-    sdls_frame.pdu.pdu_len = 2; // 4
-    sdls_frame.hdr.pkt_length = sdls_frame.pdu.pdu_len + 9;
-    count = Crypto_Prep_Reply(ingest, 128);
+    inst->sdls_frame.pdu.pdu_len = 2; // 4
+    inst->sdls_frame.hdr.pkt_length = inst->sdls_frame.pdu.pdu_len + 9;
+    count = Crypto_Prep_Reply(inst, ingest, 128);
 
     // PDU
     //ingest[count++] = (log_summary.num_se & 0xFF00) >> 8;
-    ingest[count++] = (log_summary.num_se & 0x00FF);
+    ingest[count++] = (inst->log_summary.num_se & 0x00FF);
     //ingest[count++] = (log_summary.rs & 0xFF00) >> 8;
-    ingest[count++] = (log_summary.rs & 0x00FF);
+    ingest[count++] = (inst->log_summary.rs & 0x00FF);
 
     return count; 
 }
 
-static int32 Crypto_MC_selftest(char* ingest)
+static int32 Crypto_MC_selftest(crypto_instance_t* inst, char* ingest)
 {
     uint8 count = 0;
     uint8 result = ST_OK;
@@ -2169,47 +2229,47 @@ static int32 Crypto_MC_selftest(char* ingest)
     // TODO: Perform test
 
     // Prepare for Reply
-    sdls_frame.pdu.pdu_len = 1;
-    sdls_frame.hdr.pkt_length = sdls_frame.pdu.pdu_len + 9;
-    count = Crypto_Prep_Reply(ingest, 128);
+    inst->sdls_frame.pdu.pdu_len = 1;
+    inst->sdls_frame.hdr.pkt_length = inst->sdls_frame.pdu.pdu_len + 9;
+    count = Crypto_Prep_Reply(inst, ingest, 128);
 
     ingest[count++] = result;
     
     return count; 
 }
 
-static int32 Crypto_SA_readARSN(char* ingest)
+static int32 Crypto_SA_readARSN(crypto_instance_t* inst, char* ingest)
 {
     uint8 count = 0;
     uint16 spi = 0x0000;
 
     // Read ingest
-    spi = ((uint8)sdls_frame.pdu.data[0] << 8) | (uint8)sdls_frame.pdu.data[1];
+    spi = ((uint8)inst->sdls_frame.pdu.data[0] << 8) | (uint8)inst->sdls_frame.pdu.data[1];
 
     // Prepare for Reply
-    sdls_frame.pdu.pdu_len = 2 + IV_SIZE;
-    sdls_frame.hdr.pkt_length = sdls_frame.pdu.pdu_len + 9;
-    count = Crypto_Prep_Reply(ingest, 128);
+    inst->sdls_frame.pdu.pdu_len = 2 + IV_SIZE;
+    inst->sdls_frame.hdr.pkt_length = inst->sdls_frame.pdu.pdu_len + 9;
+    count = Crypto_Prep_Reply(inst, ingest, 128);
 
     // Write SPI to reply
     ingest[count++] = (spi & 0xFF00) >> 8;
     ingest[count++] = (spi & 0x00FF);
 
-    if (sa[spi].iv_len > 0)
+    if (inst->sa[spi].iv_len > 0)
     {   // Set IV - authenticated encryption
-        for (int x = 0; x < sa[spi].iv_len - 1; x++)
+        for (int x = 0; x < inst->sa[spi].iv_len - 1; x++)
         {
-            ingest[count++] = sa[spi].iv[x];
+            ingest[count++] = inst->sa[spi].iv[x];
         }
         
         // TODO: Do we need this?
-        if (sa[spi].iv[IV_SIZE - 1] > 0)
+        if (inst->sa[spi].iv[IV_SIZE - 1] > 0)
         {   // Adjust to report last received, not expected
-            ingest[count++] = sa[spi].iv[IV_SIZE - 1] - 1;
+            ingest[count++] = inst->sa[spi].iv[IV_SIZE - 1] - 1;
         }
         else
         {   
-            ingest[count++] = sa[spi].iv[IV_SIZE - 1];
+            ingest[count++] = inst->sa[spi].iv[IV_SIZE - 1];
         }
     }
     else
@@ -2219,12 +2279,12 @@ static int32 Crypto_SA_readARSN(char* ingest)
 
     #ifdef PDU_DEBUG
         OS_printf("spi = %d \n", spi);
-        if (sa[spi].iv_len > 0)
+        if (inst->sa[spi].iv_len > 0)
         {
             OS_printf("ARSN = 0x");
-            for (int x = 0; x < sa[spi].iv_len; x++)
+            for (int x = 0; x < inst->sa[spi].iv_len; x++)
             {
-                OS_printf("%02x", sa[spi].iv[x]);
+                OS_printf("%02x", inst->sa[spi].iv[x]);
             }
             OS_printf("\n");
         }
@@ -2233,101 +2293,102 @@ static int32 Crypto_SA_readARSN(char* ingest)
     return count; 
 }
 
-static int32 Crypto_MC_resetalarm(void)
+static int32 Crypto_MC_resetalarm(crypto_instance_t* inst)
 {   // Reset all alarm flags
-    report.af = 0;
-    report.bsnf = 0;
-    report.bmacf = 0;
-    report.ispif = 0;    
+    inst->report.af = 0;
+    inst->report.bsnf = 0;
+    inst->report.bmacf = 0;
+    inst->report.ispif = 0;    
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_User_IdleTrigger(char* ingest)
+static int32 Crypto_User_IdleTrigger(crypto_instance_t* inst, char* ingest)
 {
     uint8 count = 0;
 
     // Prepare for Reply
-    sdls_frame.pdu.pdu_len = 0;
-    sdls_frame.hdr.pkt_length = sdls_frame.pdu.pdu_len + 9;
-    count = Crypto_Prep_Reply(ingest, 144);
+    inst->sdls_frame.pdu.pdu_len = 0;
+    inst->sdls_frame.hdr.pkt_length = inst->sdls_frame.pdu.pdu_len + 9;
+    count = Crypto_Prep_Reply(inst, ingest, 144);
     
     return count; 
 }
                          
-static int32 Crypto_User_BadSPI(void)
+static int32 Crypto_User_BadSPI(crypto_instance_t* inst)
 {
     // Toggle Bad Sequence Number
-    if (badSPI == 0)
+    if (inst->badSPI == 0)
     {
-        badSPI = 1;
+        inst->badSPI = 1;
     }   
     else
     {
-        badSPI = 0;
+        inst->badSPI = 0;
     }
     
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_User_BadMAC(void)
+static int32 Crypto_User_BadMAC(crypto_instance_t* inst)
 {
     // Toggle Bad MAC
-    if (badMAC == 0)
+    if (inst->badMAC == 0)
     {
-        badMAC = 1;
+        inst->badMAC = 1;
     }   
     else
     {
-        badMAC = 0;
+        inst->badMAC = 0;
     }
     
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_User_BadIV(void)
+static int32 Crypto_User_BadIV(crypto_instance_t* inst)
 {
     // Toggle Bad MAC
-    if (badIV == 0)
+    if (inst->badIV == 0)
     {
-        badIV = 1;
+        inst->badIV = 1;
     }   
     else
     {
-        badIV = 0;
+        inst->badIV = 0;
     }
     
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_User_BadFECF(void)
+static int32 Crypto_User_BadFECF(crypto_instance_t* inst)
 {
     // Toggle Bad FECF
-    if (badFECF == 0)
+    if (inst->badFECF == 0)
     {
-        badFECF = 1;
+        inst->badFECF = 1;
     }   
     else
     {
-        badFECF = 0;
+        inst->badFECF = 0;
     }
     
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_User_ModifyKey(void)
+static int32 Crypto_User_ModifyKey(crypto_instance_t* inst)
 {
     // Local variables
-    uint16 kid = ((uint8)sdls_frame.pdu.data[0] << 8) | ((uint8)sdls_frame.pdu.data[1]);
-    uint8 mod = (uint8)sdls_frame.pdu.data[2];
+    uint16 kid = ((uint8)inst->sdls_frame.pdu.data[0] << 8) | ((uint8)inst->sdls_frame.pdu.data[1]);
+    uint8 mod = (uint8)inst->sdls_frame.pdu.data[2];
 
     switch (mod)
     {
         case 1: // Invalidate Key
-            ek_ring[kid].value[KEY_SIZE-1]++;
+            inst->ek_ring[kid].value[KEY_SIZE-1]++;
+            Crypto_Cipher_invalidate_key(inst, kid);
             OS_printf("Key %d value invalidated! \n", kid);
             break;
         case 2: // Modify key state
-            ek_ring[kid].key_state = (uint8)sdls_frame.pdu.data[3] & 0x0F;
+            inst->ek_ring[kid].key_state = (uint8)inst->sdls_frame.pdu.data[3] & 0x0F;
             OS_printf("Key %d state changed to %d! \n", kid, mod);
             break;
         default:
@@ -2338,30 +2399,20 @@ static int32 Crypto_User_ModifyKey(void)
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_User_ModifyActiveTM(void)
+static int32 Crypto_User_ModifyActiveTM(crypto_instance_t* inst)
 {
-    tm_frame.tm_sec_header.spi = (uint8)sdls_frame.pdu.data[0];   
+    inst->tm_frame.tm_sec_header.spi = (uint8)inst->sdls_frame.pdu.data[0];   
     return OS_SUCCESS; 
 }
 
-static int32 Crypto_User_ModifyVCID(void)
+static int32 Crypto_User_ModifyVCID(crypto_instance_t* inst)
 {
-    tm_frame.tm_header.vcid = (uint8)sdls_frame.pdu.data[0];
+    inst->tm_frame.tm_header.vcid = (uint8)inst->sdls_frame.pdu.data[0];
 
-    for (int i = 0; i < NUM_GVCID; i++)
+    if ((inst->tm_frame.tm_header.vcid < NUM_GVCID) && (inst->gvcid_tm_map[inst->tm_frame.tm_header.vcid].spi != 0))
     {
-        for (int j = 0; j < NUM_SA; j++)
-        {
-            if (sa[i].gvcid_tm_blk[j].mapid == TYPE_TM)
-            {
-                if (sa[i].gvcid_tm_blk[j].vcid == tm_frame.tm_header.vcid)
-                {
-                    tm_frame.tm_sec_header.spi = i;
-                    OS_printf("TM Frame SPI changed to %d \n",i);
-                    break;
-                }
-            }
-        }
+        inst->tm_frame.tm_sec_header.spi = inst->gvcid_tm_map[inst->tm_frame.tm_header.vcid].spi;
+        OS_printf("TM Frame SPI changed to %d \n", inst->tm_frame.tm_sec_header.spi);
     }
 
     return OS_SUCCESS;
@@ -2370,56 +2421,56 @@ static int32 Crypto_User_ModifyVCID(void)
 /*
 ** Procedures Specifications
 */
-static int32 Crypto_PDU(char* ingest)
+static int32 Crypto_PDU(crypto_instance_t* inst, char* ingest)
 {
     int32 status = OS_SUCCESS;
     
-    switch (sdls_frame.pdu.type)
+    switch (inst->sdls_frame.pdu.type)
     {
         case 0:	// Command
-            switch (sdls_frame.pdu.uf)
+            switch (inst->sdls_frame.pdu.uf)
             {
                 case 0:	// CCSDS Defined Command
-                    switch (sdls_frame.pdu.sg)
+                    switch (inst->sdls_frame.pdu.sg)
                     {
                         case SG_KEY_MGMT:  // Key Management Procedure
-                            switch (sdls_frame.pdu.pid)
+                            switch (inst->sdls_frame.pdu.pid)
                             {
                                 case PID_OTAR:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "Key OTAR\n" RESET);
                                     #endif
-                                    status = Crypto_Key_OTAR();
+                                    status = Crypto_Key_OTAR(inst);
                                     break;
                                 case PID_KEY_ACTIVATION:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "Key Activate\n" RESET);
                                     #endif
-                                    status = Crypto_Key_update(KEY_ACTIVE);
+                                    status = Crypto_Key_update(inst, KEY_ACTIVE);
                                     break;
                                 case PID_KEY_DEACTIVATION:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "Key Deactivate\n" RESET);
                                     #endif
-                                    status = Crypto_Key_update(KEY_DEACTIVATED);
+                                    status = Crypto_Key_update(inst, KEY_DEACTIVATED);
                                     break;
                                 case PID_KEY_VERIFICATION:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "Key Verify\n" RESET);
                                     #endif
-                                    status = Crypto_Key_verify(ingest);
+                                    status = Crypto_Key_verify(inst, ingest);
                                     break;
                                 case PID_KEY_DESTRUCTION:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "Key Destroy\n" RESET);
                                     #endif
-                                    status = Crypto_Key_update(KEY_DESTROYED);
+                                    status = Crypto_Key_update(inst, KEY_DESTROYED);
                                     break;
                                 case PID_KEY_INVENTORY:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "Key Inventory\n" RESET);
                                     #endif
-                                    status = Crypto_Key_inventory(ingest);
+                                    status = Crypto_Key_inventory(inst, ingest);
                                     break;
                                 default:
                                     OS_printf(KRED "Error: Crypto_PDU failed interpreting Key Management Procedure Identification Field! \n" RESET);
@@ -2427,67 +2478,67 @@ static int32 Crypto_PDU(char* ingest)
                             }
                             break;
                         case SG_SA_MGMT:  // Security Association Management Procedure
-                            switch (sdls_frame.pdu.pid)
+                            switch (inst->sdls_frame.pdu.pid)
                             {
                                 case PID_CREATE_SA:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "SA Create\n" RESET); 
                                     #endif
-                                    status = Crypto_SA_create();
+                                    status = Crypto_SA_create(inst);
                                     break;
                                 case PID_DELETE_SA:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "SA Delete\n" RESET);
                                     #endif
-                                    status = Crypto_SA_delete();
+                                    status = Crypto_SA_delete(inst);
                                     break;
                                 case PID_SET_ARSNW:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "SA setARSNW\n" RESET);
                                     #endif
-                                    status = Crypto_SA_setARSNW();
+                                    status = Crypto_SA_setARSNW(inst);
                                     break;
                                 case PID_REKEY_SA:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "SA Rekey\n" RESET); 
                                     #endif
-                                    status = Crypto_SA_rekey();
+                                    status = Crypto_SA_rekey(inst);
                                     break;
                                 case PID_EXPIRE_SA:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "SA Expire\n" RESET);
                                     #endif
-                                    status = Crypto_SA_expire();
+                                    status = Crypto_SA_expire(inst);
                                     break;
                                 case PID_SET_ARSN:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "SA SetARSN\n" RESET);
                                     #endif
-                                    status = Crypto_SA_setARSN();
+                                    status = Crypto_SA_setARSN(inst);
                                     break;
                                 case PID_START_SA:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "SA Start\n" RESET); 
                                     #endif
-                                    status = Crypto_SA_start();
+                                    status = Crypto_SA_start(inst);
                                     break;
                                 case PID_STOP_SA:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "SA Stop\n" RESET);
                                     #endif
-                                    status = Crypto_SA_stop();
+                                    status = Crypto_SA_stop(inst);
                                     break;
                                 case PID_READ_ARSN:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "SA readARSN\n" RESET);
                                     #endif
-                                    status = Crypto_SA_readARSN(ingest);
+                                    status = Crypto_SA_readARSN(inst, ingest);
                                     break;
                                 case PID_SA_STATUS:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "SA Status\n" RESET);
                                     #endif
-                                    status = Crypto_SA_status(ingest);
+                                    status = Crypto_SA_status(inst, ingest);
                                     break;
                                 default:
                                     OS_printf(KRED "Error: Crypto_PDU failed interpreting SA Procedure Identification Field! \n" RESET);
@@ -2495,43 +2546,43 @@ static int32 Crypto_PDU(char* ingest)
                             }
                             break;
                         case SG_SEC_MON_CTRL:  // Security Monitoring & Control Procedure
-                            switch (sdls_frame.pdu.pid)
+                            switch (inst->sdls_frame.pdu.pid)
                             {
                                 case PID_PING:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "MC Ping\n" RESET);
                                     #endif
-                                    status = Crypto_MC_ping(ingest);
+                                    status = Crypto_MC_ping(inst, ingest);
                                     break;
                                 case PID_LOG_STATUS:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "MC Status\n" RESET);
                                     #endif
-                                    status = Crypto_MC_status(ingest);
+                                    status = Crypto_MC_status(inst, ingest);
                                     break;
                                 case PID_DUMP_LOG:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "MC Dump\n" RESET);
                                     #endif
-                                    status = Crypto_MC_dump(ingest);
+                                    status = Crypto_MC_dump(inst, ingest);
                                     break;
                                 case PID_ERASE_LOG:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "MC Erase\n" RESET);
                                     #endif
-                                    status = Crypto_MC_erase(ingest);
+                                    status = Crypto_MC_erase(inst, ingest);
                                     break;
                                 case PID_SELF_TEST:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "MC Selftest\n" RESET);
                                     #endif
-                                    status = Crypto_MC_selftest(ingest);
+                                    status = Crypto_MC_selftest(inst, ingest);
                                     break;
                                 case PID_ALARM_FLAG:
                                     #ifdef PDU_DEBUG
                                         OS_printf(KGRN "MC Reset Alarm\n" RESET);
                                     #endif
-                                    status = Crypto_MC_resetalarm();
+                                    status = Crypto_MC_resetalarm(inst);
                                     break;
                                 default:
                                     OS_printf(KRED "Error: Crypto_PDU failed interpreting MC Procedure Identification Field! \n" RESET);
@@ -2545,58 +2596,58 @@ static int32 Crypto_PDU(char* ingest)
                     break;
                     
                 case 1: 	// User Defined Command
-                    switch (sdls_frame.pdu.sg)
+                    switch (inst->sdls_frame.pdu.sg)
                     {
                         default:
-                            switch (sdls_frame.pdu.pid)
+                            switch (inst->sdls_frame.pdu.pid)
                             {
                                 case 0: // Idle Frame Trigger
                                     #ifdef PDU_DEBUG
                                         OS_printf(KMAG "User Idle Trigger\n" RESET);
                                     #endif
-                                    status = Crypto_User_IdleTrigger(ingest);
+                                    status = Crypto_User_IdleTrigger(inst, ingest);
                                     break;
                                 case 1: // Toggle Bad SPI
                                     #ifdef PDU_DEBUG
                                         OS_printf(KMAG "User Toggle Bad SPI\n" RESET);
                                     #endif
-                                    status = Crypto_User_BadSPI();
+                                    status = Crypto_User_BadSPI(inst);
                                     break;
                                 case 2: // Toggle Bad IV
                                     #ifdef PDU_DEBUG
                                         OS_printf(KMAG "User Toggle Bad IV\n" RESET);
                                     #endif
-                                    status = Crypto_User_BadIV();\
+                                    status = Crypto_User_BadIV(inst);\
                                     break;
                                 case 3: // Toggle Bad MAC
                                     #ifdef PDU_DEBUG
                                         OS_printf(KMAG "User Toggle Bad MAC\n" RESET);
                                     #endif
-                                    status = Crypto_User_BadMAC();
+                                    status = Crypto_User_BadMAC(inst);
                                     break; 
                                 case 4: // Toggle Bad FECF
                                     #ifdef PDU_DEBUG
                                         OS_printf(KMAG "User Toggle Bad FECF\n" RESET);
                                     #endif
-                                    status = Crypto_User_BadFECF();
+                                    status = Crypto_User_BadFECF(inst);
                                     break;
                                 case 5: // Modify Key
                                     #ifdef PDU_DEBUG
                                         OS_printf(KMAG "User Modify Key\n" RESET);
                                     #endif
-                                    status = Crypto_User_ModifyKey();
+                                    status = Crypto_User_ModifyKey(inst);
                                     break;
                                 case 6: // Modify ActiveTM
                                     #ifdef PDU_DEBUG
                                         OS_printf(KMAG "User Modify Active TM\n" RESET);
                                     #endif
-                                    status = Crypto_User_ModifyActiveTM();
+                                    status = Crypto_User_ModifyActiveTM(inst);
                                     break;
                                 case 7: // Modify TM VCID
                                     #ifdef PDU_DEBUG
                                         OS_printf(KMAG "User Modify VCID\n" RESET);
                                     #endif
-                                    status = Crypto_User_ModifyVCID();
+                                    status = Crypto_User_ModifyVCID(inst);
                                     break;
                                 default:
                                     OS_printf(KRED "Error: Crypto_PDU received user defined command! \n" RESET);
@@ -2627,18 +2678,192 @@ static int32 Crypto_PDU(char* ingest)
     return status;
 }
 
-int32 Crypto_TC_ApplySecurity(char* ingest, int* len_ingest)
+int32 Crypto_Instance_TC_ApplySecurity(crypto_instance_t* inst, char* ingest, int* len_ingest, int max_ingest)
+// Accepts a TC primary header followed by its PDU, and secures it in place into the frame
+// Crypto_TC_ProcessSecurity expects; max_ingest is the size of ingest, which must have room
+// for the security header and trailer
 {
     // Local Variables
     int32 status = OS_SUCCESS;
+    uint16 scid = 0;
+    uint8 vcid = 0;
+    uint16 spi = 0;
+    uint8 svc = SA_SVC_CLEAR;
+    int pdu_loc = 0;
+    int pdu_len = *len_ingest - 5;
+    int mac_loc = 0;
+    int fl = 0;
+    int x = 0;
+    uint16 fecf = 0;
+    #ifdef TC_AAD
+        uint8 aad[ABM_SIZE];
+    #endif
+    uint8* frame = (uint8*) ingest;
+    crypto_provider_ctx_t* cipher_ctx = NULL;
 
     #ifdef DEBUG
         OS_printf(KYEL "\n----- Crypto_TC_ApplySecurity START -----\n" RESET);
     #endif
 
-    // TODO: This whole function!
-    len_ingest = len_ingest;
-    ingest[0] = ingest[0];
+    scid = ((frame[0] & 0x03) << 8) | frame[1];
+    vcid = (frame[2] & 0xFC) >> 2;
+    if (pdu_len < 0)
+    {
+        OS_printf(KRED "Error: TC frame too short! \n" RESET);
+        return OS_ERROR;
+    }
+
+    status = Crypto_SA_find(inst, TYPE_TC, frame[0] >> 6, scid, vcid, &spi);
+    if (status != OS_SUCCESS)
+    {
+        return status;
+    }
+    svc = SA_SERVICE(&inst->sa[spi]);
+
+    // Frame layout
+    if (svc != SA_SVC_CLEAR)
+    {	// Initialization Vector
+        pdu_loc = 8 + IV_SIZE;
+        mac_loc = pdu_loc + pdu_len;
+        fl = mac_loc + MAC_SIZE + FECF_SIZE - 1;
+    }
+    else
+    {	// Anti-replay sequence number - hard coded per ESA testing
+        pdu_loc = 10;
+        mac_loc = pdu_loc + pdu_len;
+        fl = mac_loc + FECF_SIZE - 1;
+    }
+    if (fl > 0x3FF)
+    {
+        OS_printf(KRED "Error: TC frame longer than 1024 bytes! \n" RESET);
+        return OS_ERROR;
+    }
+    if (fl >= max_ingest)
+    {
+        OS_printf(KRED "Error: TC frame length %d exceeds buffer size %d! \n" RESET, fl + 1, max_ingest);
+        return OS_ERROR;
+    }
+    // Cipher before the frame is touched, so a missing key leaves ingest as it was
+    if (svc != SA_SVC_CLEAR)
+    {
+        status = Crypto_Cipher_get(inst, spi, &cipher_ctx);
+        if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    // Payload Data Unit, moved first as the security header overwrites its start
+    memmove(&frame[pdu_loc], &frame[5], pdu_len);
+
+    // Primary Header
+    frame[2] = (frame[2] & 0xFC) | ((fl & 0x300) >> 8);
+    frame[3] = (uint8) (fl & 0x0FF);
+    // Segment Header - hard coded per ESA testing
+    frame[5] = 0xFF;
+    // Security Header
+    frame[6] = (uint8) ((spi & 0xFF00) >> 8);
+    frame[7] = (uint8) (spi & 0x00FF);
+
+    if (svc == SA_SVC_AEAD)
+    {	// Authenticated Encryption
+        #ifdef DEBUG
+            OS_printf(KBLU "Creating a TC - AUTHENTICATED ENCRYPTION! \n" RESET);
+        #endif
+        #ifdef INCREMENT
+            Crypto_increment(inst->sa[spi].iv, IV_SIZE);
+        #endif
+        for (x = 0; x < IV_SIZE; x++)
+        {
+            frame[8 + x] = inst->sa[spi].iv[x];
+        }
+
+        #ifdef TC_AAD
+            // Prepare additional authenticated data (AAD)
+            for (x = 0; x < inst->sa[spi].abm_len; x++)
+            {
+                aad[x] = frame[x] & inst->sa[spi].abm[x];
+            }
+        #endif
+        status = inst->provider->aead_encrypt(
+            cipher_ctx,
+            &(inst->sa[spi].iv[0]),                         // initialization vector
+            inst->sa[spi].iv_len,                           // IV length
+            #ifdef TC_AAD
+                &(aad[0]),                                  // additional authenticated data
+                inst->sa[spi].abm_len,                      // length of AAD
+            #else
+                NULL,                                       // no AAD, as Crypto_TC_ProcessSecurity
+                0,                                          // AAD length
+            #endif
+            &(frame[pdu_loc]),                              // plaintext input
+            &(frame[pdu_loc]),                              // in place encryption
+            pdu_len,                                        // length of data
+            &(frame[mac_loc]),                              // tag output
+            MAC_SIZE                                        // tag size
+        );
+        if (status != OS_SUCCESS)
+        {   // Frame already rewritten
+            *len_ingest = 0;
+            return status;
+        }
+    }
+    else if (svc == SA_SVC_AUTH)
+    {	// Authentication only
+        #ifdef DEBUG
+            OS_printf(KBLU "Creating a TC - AUTHENTICATED! \n" RESET);
+        #endif
+        #ifdef INCREMENT
+            Crypto_increment(inst->sa[spi].iv, IV_SIZE);
+        #endif
+        for (x = 0; x < IV_SIZE; x++)
+        {
+            frame[8 + x] = inst->sa[spi].iv[x];
+        }
+
+        status = Crypto_Auth_mac(inst, spi, inst->sa[spi].iv, frame, mac_loc, &(frame[mac_loc]));
+        if (status != OS_SUCCESS)
+        {   // Frame already rewritten
+            *len_ingest = 0;
+            return status;
+        }
+    }
+    else if (svc == SA_SVC_ENC)
+    {	// Encryption only, the MAC field is left zeroed
+        #ifdef DEBUG
+            OS_printf(KBLU "Creating a TC - ENCRYPTED! \n" RESET);
+        #endif
+        #ifdef INCREMENT
+            Crypto_increment(inst->sa[spi].iv, IV_SIZE);
+        #endif
+        for (x = 0; x < IV_SIZE; x++)
+        {
+            frame[8 + x] = inst->sa[spi].iv[x];
+        }
+        CFE_PSP_MemSet(&(frame[mac_loc]), 0, MAC_SIZE);
+
+        status = inst->provider->ctr(cipher_ctx, inst->sa[spi].iv, inst->sa[spi].iv_len,
+                                     &(frame[pdu_loc]), &(frame[pdu_loc]), pdu_len);
+        if (status != OS_SUCCESS)
+        {   // Frame already rewritten
+            *len_ingest = 0;
+            return status;
+        }
+    }
+    else
+    {	// Clear
+        #ifdef DEBUG
+            OS_printf(KBLU "Creating a TC - CLEAR! \n" RESET);
+        #endif
+        frame[8] = 0x00;
+        frame[9] = 0x00;
+    }
+
+    // Frame Error Control Field
+    fecf = Crypto_Calc_FECF(inst, ingest, fl - 2);
+    frame[fl - 1] = (uint8) ((fecf & 0xFF00) >> 8);
+    frame[fl] = (uint8) (fecf & 0x00FF);
+    *len_ingest = fl + 1;
 
     #ifdef DEBUG
         OS_printf(KYEL "----- Crypto_TC_ApplySecurity END -----\n" RESET);
@@ -2647,95 +2872,118 @@ int32 Crypto_TC_ApplySecurity(char* ingest, int* len_ingest)
     return status;
 }
 
-int32 Crypto_TC_ProcessSecurity( char* ingest, int* len_ingest)
+static int32 Crypto_TC_process(crypto_instance_t* inst, char* ingest, int* len_ingest, crypto_tc_batch_t* batch,
+                               uint8* out, int out_len, crypto_tc_view_t* view)
 // Loads the ingest frame into the global tc_frame while performing decrpytion
+// A batch carries the channel verified by the previous frame so its checks and cipher lookup can be skipped
+// Without a view the PDU is copied back to the start of ingest, with a view it is left where it was
+// decrypted (in place within ingest, or out when given) and only described by the view
 {
     // Local Variables
     int32 status = OS_SUCCESS;
     int x = 0;
     int y = 0;
-    gcry_cipher_hd_t tmp_hd;
-    gcry_error_t gcry_error = GPG_ERR_NO_ERROR;
+    crypto_provider_ctx_t* cipher_ctx = NULL;
+    uint8 verified = 0;
+    int32 arc_status;
+    uint8* pdu = &(inst->tc_frame.tc_pdu[0]);
+    uint16 pdu_offset = 0;
+    uint16 pdu_len = 0;
+    uint8* aad = NULL;
+    uint16 aad_len = 0;
+    uint8 svc = SA_SVC_CLEAR;
+
+    inst->tc_sdls = 0;
 
     #ifdef DEBUG
-        OS_printf(KYEL "\n----- Crypto_TC_ProcessSecurity START -----\n" RESET);
+        if (batch == NULL)
+        {
+            OS_printf(KYEL "\n----- Crypto_TC_ProcessSecurity START -----\n" RESET);
+        }
     #endif
 
     // Primary Header
-    tc_frame.tc_header.tfvn   = ((uint8)ingest[0] & 0xC0) >> 6;
-    tc_frame.tc_header.bypass = ((uint8)ingest[0] & 0x20) >> 5;
-    tc_frame.tc_header.cc     = ((uint8)ingest[0] & 0x10) >> 4;
-    tc_frame.tc_header.spare  = ((uint8)ingest[0] & 0x0C) >> 2;
-    tc_frame.tc_header.scid   = ((uint8)ingest[0] & 0x03) << 8;
-    tc_frame.tc_header.scid   = tc_frame.tc_header.scid | (uint8)ingest[1];
-    tc_frame.tc_header.vcid   = ((uint8)ingest[2] & 0xFC) >> 2;
-    tc_frame.tc_header.fl     = ((uint8)ingest[2] & 0x03) << 8;
-    tc_frame.tc_header.fl     = tc_frame.tc_header.fl | (uint8)ingest[3];
-    tc_frame.tc_header.fsn	  = (uint8)ingest[4];
+    inst->tc_frame.tc_header.tfvn   = ((uint8)ingest[0] & 0xC0) >> 6;
+    inst->tc_frame.tc_header.bypass = ((uint8)ingest[0] & 0x20) >> 5;
+    inst->tc_frame.tc_header.cc     = ((uint8)ingest[0] & 0x10) >> 4;
+    inst->tc_frame.tc_header.spare  = ((uint8)ingest[0] & 0x0C) >> 2;
+    inst->tc_frame.tc_header.scid   = ((uint8)ingest[0] & 0x03) << 8;
+    inst->tc_frame.tc_header.scid   = inst->tc_frame.tc_header.scid | (uint8)ingest[1];
+    inst->tc_frame.tc_header.vcid   = ((uint8)ingest[2] & 0xFC) >> 2;
+    inst->tc_frame.tc_header.fl     = ((uint8)ingest[2] & 0x03) << 8;
+    inst->tc_frame.tc_header.fl     = inst->tc_frame.tc_header.fl | (uint8)ingest[3];
+    inst->tc_frame.tc_header.fsn	  = (uint8)ingest[4];
 
     // Security Header
-    tc_frame.tc_sec_header.sh  = (uint8)ingest[5]; 
-    tc_frame.tc_sec_header.spi = ((uint8)ingest[6] << 8) | (uint8)ingest[7];
+    inst->tc_frame.tc_sec_header.sh  = (uint8)ingest[5]; 
+    inst->tc_frame.tc_sec_header.spi = ((uint8)ingest[6] << 8) | (uint8)ingest[7];
     #ifdef TC_DEBUG
-        OS_printf("vcid = %d \n", tc_frame.tc_header.vcid );
-        OS_printf("spi  = %d \n", tc_frame.tc_sec_header.spi);
+        OS_printf("vcid = %d \n", inst->tc_frame.tc_header.vcid );
+        OS_printf("spi  = %d \n", inst->tc_frame.tc_sec_header.spi);
     #endif
 
+    // Frame must lie within ingest
+    if (inst->tc_frame.tc_header.fl >= *len_ingest)
+    {
+        OS_printf(KRED "Error: TC frame length %d exceeds ingest length %d! \n" RESET, inst->tc_frame.tc_header.fl + 1, *len_ingest);
+        *len_ingest = 0;
+        return OS_ERROR;
+    }
+
     // Checks
     if (((uint8)ingest[18] == 0x0B) && ((uint8)ingest[19] == 0x00) && (((uint8)ingest[20] & 0xF0) == 0x40))
     {   
         // User packet check only used for ESA Testing!
     }
+    else if ((batch != NULL) && (batch->valid == 1) && 
+             (batch->scid == inst->tc_frame.tc_header.scid) &&
+             (batch->vcid == inst->tc_frame.tc_header.vcid) && 
+             (batch->spi == inst->tc_frame.tc_sec_header.spi))
+    {   // Same channel as the previous frame of the batch, already verified
+        inst->report.lspiu = inst->tc_frame.tc_sec_header.spi;
+        verified = 1;
+    }
     else
     {   // Update last spi used
-        report.lspiu = tc_frame.tc_sec_header.spi;
+        inst->report.lspiu = inst->tc_frame.tc_sec_header.spi;
 
         // Verify 
-        if (tc_frame.tc_header.scid != (SCID & 0x3FF))
+        if (inst->tc_frame.tc_header.scid != (SCID & 0x3FF))
         {
             OS_printf(KRED "Error: SCID incorrect! \n" RESET);
             status = OS_ERROR;
         }
         else
         {   
-            switch (report.lspiu)
+            switch (inst->report.lspiu)
             {	// Invalid SPIs fall through to trigger flag in FSR
                 case 0x0000:
                 case 0xFFFF:
                     status = OS_ERROR;
-                    report.ispif = 1;
+                    inst->report.ispif = 1;
                     OS_printf(KRED "Error: SPI invalid! \n" RESET);
                     break;
                 default:
                     break;
             }
         }
-        if ((report.lspiu > NUM_SA) && (status == OS_SUCCESS))
+        if ((inst->report.lspiu > NUM_SA) && (status == OS_SUCCESS))
         {
-            report.ispif = 1;
+            inst->report.ispif = 1;
             OS_printf(KRED "Error: SPI value greater than NUM_SA! \n" RESET);
             status = OS_ERROR;
         }
         if (status == OS_SUCCESS)
         {
-            if (sa[report.lspiu].gvcid_tc_blk[tc_frame.tc_header.vcid].mapid != TYPE_TC)
+            if (inst->gvcid_tc_map[inst->tc_frame.tc_header.vcid].spi != inst->report.lspiu)
             {	
-                OS_printf(KRED "Error: SA invalid type! \n" RESET);
+                OS_printf(KRED "Error: VCID not mapped to provided SPI! \n" RESET);
                 status = OS_ERROR;
             }
         }
-        // TODO: I don't think this is needed.
-        //if (status == OS_SUCCESS)
-        //{
-        //    if (sa[report.lspiu].gvcid_tc_blk[tc_frame.tc_header.vcid].vcid != tc_frame.tc_header.vcid)
-        //    {	
-        //        OS_printf(KRED "Error: VCID not mapped to provided SPI! \n" RESET);
-        //        status = OS_ERROR;
-        //    }
-        //}
         if (status == OS_SUCCESS)
         {
-            if (sa[report.lspiu].sa_state != SA_OPERATIONAL)
+            if (inst->sa[inst->report.lspiu].sa_state != SA_OPERATIONAL)
             {	
                 OS_printf(KRED "Error: SA state not operational! \n" RESET);
                 status = OS_ERROR;
@@ -2743,100 +2991,105 @@ int32 Crypto_TC_ProcessSecurity( char* ingest, int* len_ingest)
         }
         if (status != OS_SUCCESS)
         {
-            report.af = 1;
-            if (log_summary.rs > 0)
+            inst->report.af = 1;
+            if (inst->log_summary.rs > 0)
             {
-                Crypto_increment((uint8*)&log_summary.num_se, 4);
-                log_summary.rs--;
-                log.blk[log_count].emt = SPI_INVALID_EID;
-                log.blk[log_count].emv[0] = 0x4E;
-                log.blk[log_count].emv[1] = 0x41;
-                log.blk[log_count].emv[2] = 0x53;
-                log.blk[log_count].emv[3] = 0x41;
-                log.blk[log_count++].em_len = 4;
+                Crypto_increment((uint8*)&inst->log_summary.num_se, 4);
+                inst->log_summary.rs--;
+                inst->log.blk[inst->log_count].emt = SPI_INVALID_EID;
+                inst->log.blk[inst->log_count].emv[0] = 0x4E;
+                inst->log.blk[inst->log_count].emv[1] = 0x41;
+                inst->log.blk[inst->log_count].emv[2] = 0x53;
+                inst->log.blk[inst->log_count].emv[3] = 0x41;
+                inst->log.blk[inst->log_count++].em_len = 4;
             }
             *len_ingest = 0;
             return status;
         }
+        verified = 1;
     }
     
     // Determine mode via SPI
-    if ((sa[tc_frame.tc_sec_header.spi].est == 1) && 
-        (sa[tc_frame.tc_sec_header.spi].ast == 1))
-    {	// Authenticated Encryption
+    svc = SA_SERVICE(&inst->sa[inst->tc_frame.tc_sec_header.spi]);
+    if (svc != SA_SVC_CLEAR)
+    {	// Authenticated Encryption, Authentication only or Encryption only
         #ifdef DEBUG
-            OS_printf(KBLU "ENCRYPTED TC Received!\n" RESET);
+            OS_printf(KBLU "%s TC Received!\n" RESET, (svc == SA_SVC_AUTH) ? "AUTHENTICATED" : "ENCRYPTED");
         #endif
+        if (inst->tc_frame.tc_header.fl < (5 + 2 + IV_SIZE + MAC_SIZE + FECF_SIZE))
+        {   // No room for the security header and trailer
+            OS_printf(KRED "Error: TC frame length %d too short for SPI %d! \n" RESET, inst->tc_frame.tc_header.fl + 1, inst->tc_frame.tc_sec_header.spi);
+            *len_ingest = 0;
+            return OS_ERROR;
+        }
         #ifdef TC_DEBUG
             OS_printf("IV: \n");
         #endif
         for (x = 8; x < (8 + IV_SIZE); x++)
         {
-            tc_frame.tc_sec_header.iv[x-8] = (uint8)ingest[x];
+            inst->tc_frame.tc_sec_header.iv[x-8] = (uint8)ingest[x];
             #ifdef TC_DEBUG
-                OS_printf("\t iv[%d] = 0x%02x\n", x-8, tc_frame.tc_sec_header.iv[x-8]);
+                OS_printf("\t iv[%d] = 0x%02x\n", x-8, inst->tc_frame.tc_sec_header.iv[x-8]);
             #endif
         }
-        report.snval = tc_frame.tc_sec_header.iv[IV_SIZE-1];
+        inst->report.snval = inst->tc_frame.tc_sec_header.iv[IV_SIZE-1];
 
         #ifdef DEBUG
-            OS_printf("\t tc_sec_header.iv[%d] = 0x%02x \n", IV_SIZE-1, tc_frame.tc_sec_header.iv[IV_SIZE-1]);
-            OS_printf("\t sa[%d].iv[%d] = 0x%02x \n", tc_frame.tc_sec_header.spi, IV_SIZE-1, sa[tc_frame.tc_sec_header.spi].iv[IV_SIZE-1]);
+            OS_printf("\t tc_sec_header.iv[%d] = 0x%02x \n", IV_SIZE-1, inst->tc_frame.tc_sec_header.iv[IV_SIZE-1]);
+            OS_printf("\t sa[%d].iv[%d] = 0x%02x \n", inst->tc_frame.tc_sec_header.spi, IV_SIZE-1, inst->sa[inst->tc_frame.tc_sec_header.spi].iv[IV_SIZE-1]);
         #endif
 
-        // Check IV is in ARCW
-        if ( Crypto_window(tc_frame.tc_sec_header.iv, sa[tc_frame.tc_sec_header.spi].iv, IV_SIZE, 
-            sa[tc_frame.tc_sec_header.spi].arcw[sa[tc_frame.tc_sec_header.spi].arcw_len-1]) != OS_SUCCESS )
+        // Check IV against the anti-replay window, an encryption only SA has no MAC to vouch for
+        // the IV, so it has no replay protection rather than a window forged IVs could move
+        arc_status = OS_SUCCESS;
+        if (svc != SA_SVC_ENC)
+        {
+            arc_status = Crypto_ARC_check(&inst->sa[inst->tc_frame.tc_sec_header.spi], inst->tc_frame.tc_sec_header.iv);
+        }
+        if (arc_status == ARC_OUTSIDE_WINDOW)
         {
-            report.af = 1;
-            report.bsnf = 1;
-            if (log_summary.rs > 0)
+            inst->report.af = 1;
+            inst->report.bsnf = 1;
+            if (inst->log_summary.rs > 0)
             {
-                Crypto_increment((uint8*)&log_summary.num_se, 4);
-                log_summary.rs--;
-                log.blk[log_count].emt = IV_WINDOW_ERR_EID;
-                log.blk[log_count].emv[0] = 0x4E;
-                log.blk[log_count].emv[1] = 0x41;
-                log.blk[log_count].emv[2] = 0x53;
-                log.blk[log_count].emv[3] = 0x41;
-                log.blk[log_count++].em_len = 4;
+                Crypto_increment((uint8*)&inst->log_summary.num_se, 4);
+                inst->log_summary.rs--;
+                inst->log.blk[inst->log_count].emt = IV_WINDOW_ERR_EID;
+                inst->log.blk[inst->log_count].emv[0] = 0x4E;
+                inst->log.blk[inst->log_count].emv[1] = 0x41;
+                inst->log.blk[inst->log_count].emv[2] = 0x53;
+                inst->log.blk[inst->log_count].emv[3] = 0x41;
+                inst->log.blk[inst->log_count++].em_len = 4;
             }
             OS_printf(KRED "Error: IV not in window! \n" RESET);
             #ifdef OCF_DEBUG
-                Crypto_fsrPrint(&report);
+                Crypto_fsrPrint(&inst->report);
             #endif
             status = OS_ERROR;
         }
         else 
         {
-            if ( Crypto_compare_less_equal(tc_frame.tc_sec_header.iv, sa[tc_frame.tc_sec_header.spi].iv, IV_SIZE) == OS_SUCCESS )
-            {   // Replay - IV value lower than expected
-                report.af = 1;
-                report.bsnf = 1;
-                if (log_summary.rs > 0)
+            if (arc_status == ARC_REPLAY)
+            {   // Replay - IV value already received or older than the window
+                inst->report.af = 1;
+                inst->report.bsnf = 1;
+                if (inst->log_summary.rs > 0)
                 {
-                    Crypto_increment((uint8*)&log_summary.num_se, 4);
-                    log_summary.rs--;
-                    log.blk[log_count].emt = IV_REPLAY_ERR_EID;
-                    log.blk[log_count].emv[0] = 0x4E;
-                    log.blk[log_count].emv[1] = 0x41;
-                    log.blk[log_count].emv[2] = 0x53;
-                    log.blk[log_count].emv[3] = 0x41;
-                    log.blk[log_count++].em_len = 4;
+                    Crypto_increment((uint8*)&inst->log_summary.num_se, 4);
+                    inst->log_summary.rs--;
+                    inst->log.blk[inst->log_count].emt = IV_REPLAY_ERR_EID;
+                    inst->log.blk[inst->log_count].emv[0] = 0x4E;
+                    inst->log.blk[inst->log_count].emv[1] = 0x41;
+                    inst->log.blk[inst->log_count].emv[2] = 0x53;
+                    inst->log.blk[inst->log_count].emv[3] = 0x41;
+                    inst->log.blk[inst->log_count++].em_len = 4;
                 }
-                OS_printf(KRED "Error: IV replay! Value lower than expected! \n" RESET);
+                OS_printf(KRED "Error: IV replay! Value already received or too old! \n" RESET);
                 #ifdef OCF_DEBUG
-                    Crypto_fsrPrint(&report);
+                    Crypto_fsrPrint(&inst->report);
                 #endif
                 status = OS_ERROR;
             } 
-            else
-            {   // Adjust expected IV to acceptable received value
-                for (int i = 0; i < (IV_SIZE); i++)
-                {
-                    sa[tc_frame.tc_sec_header.spi].iv[i] = tc_frame.tc_sec_header.iv[i];
-                }
-            }
         }
         
         if ( status == OS_ERROR )
@@ -2845,11 +3098,11 @@ int32 Crypto_TC_ProcessSecurity( char* ingest, int* len_ingest)
             return status;
         }
 
-        x = x + Crypto_Get_tcPayloadLength();
+        x = x + Crypto_Get_tcPayloadLength(inst);
 
         #ifdef TC_DEBUG
             OS_printf("TC: \n"); 
-            for (int temp = 0; temp < Crypto_Get_tcPayloadLength(); temp++)
+            for (int temp = 0; temp < Crypto_Get_tcPayloadLength(inst); temp++)
             {	
                 OS_printf("\t ingest[%d] = 0x%02x \n", temp, (uint8)ingest[temp+20]);
             }
@@ -2861,69 +3114,66 @@ int32 Crypto_TC_ProcessSecurity( char* ingest, int* len_ingest)
         #endif
         for (y = x; y < (x + MAC_SIZE); y++)
         {
-            tc_frame.tc_sec_trailer.mac[y-x]  = (uint8)ingest[y];
+            inst->tc_frame.tc_sec_trailer.mac[y-x]  = (uint8)ingest[y];
             #ifdef TC_DEBUG
-                OS_printf("\t mac[%d] = 0x%02x\n", y-x, tc_frame.tc_sec_trailer.mac[y-x]);
+                OS_printf("\t mac[%d] = 0x%02x\n", y-x, inst->tc_frame.tc_sec_trailer.mac[y-x]);
             #endif
         }
         x = x + MAC_SIZE;
 
         // FECF
-        tc_frame.tc_sec_trailer.fecf = ((uint8)ingest[x] << 8) | ((uint8)ingest[x+1]);
-        Crypto_FECF(tc_frame.tc_sec_trailer.fecf, ingest, (tc_frame.tc_header.fl - 2));
+        inst->tc_frame.tc_sec_trailer.fecf = ((uint8)ingest[x] << 8) | ((uint8)ingest[x+1]);
+        Crypto_FECF(inst, inst->tc_frame.tc_sec_trailer.fecf, ingest, (inst->tc_frame.tc_header.fl - 2));
 
-        // Initialize the key
-        //itc_gcm128_init(&sa[tc_frame.tc_sec_header.spi].gcm_ctx, (const unsigned char*) &ek_ring[sa[tc_frame.tc_sec_header.spi].ekid]);
-
-        gcry_error = gcry_cipher_open(
-            &(tmp_hd),
-            GCRY_CIPHER_AES256, 
-            GCRY_CIPHER_MODE_GCM, 
-            GCRY_CIPHER_CBC_MAC
-        );
-        if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+        // Plaintext destination
+        pdu_len = Crypto_Get_tcPayloadLength(inst);
+        if (view != NULL)
         {
-            OS_printf(KRED "ERROR: gcry_cipher_open error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-            status = OS_ERROR;
-            return status;
-        }
-        #ifdef DEBUG
-            OS_printf("Key ID = %d, 0x", sa[tc_frame.tc_sec_header.spi].ekid);
-            for(int y = 0; y < KEY_SIZE; y++)
+            if (out == NULL)
+            {   // In place
+                pdu = (uint8*) &(ingest[20]);
+                pdu_offset = 20;
+            }
+            else if (pdu_len <= out_len)
             {
-                OS_printf("%02x", ek_ring[sa[tc_frame.tc_sec_header.spi].ekid].value[y]);
+                pdu = out;
+            }
+            else
+            {
+                OS_printf(KRED "Error: TC output buffer too small! \n" RESET);
+                *len_ingest = 0;
+                return OS_ERROR;
             }
-            OS_printf("\n");
-        #endif
-        gcry_error = gcry_cipher_setkey(
-            tmp_hd,
-            &(ek_ring[sa[tc_frame.tc_sec_header.spi].ekid].value[0]), 
-            KEY_SIZE
-        );
-        if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-        {
-            OS_printf(KRED "ERROR: gcry_cipher_setkey error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-            status = OS_ERROR;
-            return status;
         }
-        gcry_error = gcry_cipher_setiv(
-            tmp_hd,
-            &(sa[tc_frame.tc_sec_header.spi].iv[0]), 
-            sa[tc_frame.tc_sec_header.spi].iv_len
-        );
-        if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+
+        if ((batch != NULL) && (batch->valid == 1) && (batch->spi == inst->tc_frame.tc_sec_header.spi) &&
+            (batch->ctx != NULL))
+        {   // Keyed context of the previous frame
+            cipher_ctx = batch->ctx;
+        }
+        else
         {
-            OS_printf(KRED "ERROR: gcry_cipher_setiv error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-            status = OS_ERROR;
-            return status;
+            status = Crypto_Cipher_get(inst, inst->tc_frame.tc_sec_header.spi, &cipher_ctx);
+            if (status != OS_SUCCESS)
+            {
+                return status;
+            }
+            #ifdef DEBUG
+                OS_printf("Key ID = %d, 0x", inst->sa[inst->tc_frame.tc_sec_header.spi].ekid);
+                for(int y = 0; y < KEY_SIZE; y++)
+                {
+                    OS_printf("%02x", inst->ek_ring[inst->sa[inst->tc_frame.tc_sec_header.spi].ekid].value[y]);
+                }
+                OS_printf("\n");
+            #endif
         }
         #ifdef MAC_DEBUG
             OS_printf("AAD = 0x");
         #endif
         // Prepare additional authenticated data (AAD)
-        for (y = 0; y < sa[tc_frame.tc_sec_header.spi].abm_len; y++)
+        for (y = 0; y < inst->sa[inst->tc_frame.tc_sec_header.spi].abm_len; y++)
         {
-            ingest[y] = (uint8) ((uint8)ingest[y] & (uint8)sa[tc_frame.tc_sec_header.spi].abm[y]);
+            ingest[y] = (uint8) ((uint8)ingest[y] & (uint8)inst->sa[inst->tc_frame.tc_sec_header.spi].abm[y]);
             #ifdef MAC_DEBUG
                 OS_printf("%02x", (uint8) ingest[y]);
             #endif
@@ -2931,333 +3181,416 @@ int32 Crypto_TC_ProcessSecurity( char* ingest, int* len_ingest)
         #ifdef MAC_DEBUG
             OS_printf("\n");
         #endif
+        #ifdef TC_AAD
+            aad = (uint8*) ingest;
+            aad_len = inst->sa[inst->tc_frame.tc_sec_header.spi].abm_len;
+        #endif
 
-        gcry_error = gcry_cipher_decrypt(
-            tmp_hd, 
-            &(tc_frame.tc_pdu[0]),                          // plaintext output
-            Crypto_Get_tcPayloadLength(),			 		// length of data
-            &(ingest[20]),                                  // ciphertext input
-            Crypto_Get_tcPayloadLength()                    // in data length
-        );
-        if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-        {
-            OS_printf(KRED "ERROR: gcry_cipher_decrypt error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-            status = OS_ERROR;
-            return status;
-        }
-        gcry_error = gcry_cipher_checktag(
-            tmp_hd, 
-            &(tc_frame.tc_sec_trailer.mac[0]),              // tag input
-            MAC_SIZE                                        // tag size
-        );
-        if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-        {
-            OS_printf(KRED "ERROR: gcry_cipher_checktag error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-            
-            OS_printf("Actual MAC   = 0x");
-            for (int z = 0; z < MAC_SIZE; z++)
+        if (svc == SA_SVC_AUTH)
+        {   // MAC over the masked headers and the plaintext PDU
+            status = Crypto_Auth_verify(inst, inst->tc_frame.tc_sec_header.spi, inst->tc_frame.tc_sec_header.iv,
+                                        (uint8*) ingest, 20 + pdu_len, inst->tc_frame.tc_sec_trailer.mac);
+            if ((status == OS_SUCCESS) && (pdu != (uint8*) &(ingest[20])))
             {
-                OS_printf("%02x",tc_frame.tc_sec_trailer.mac[z]);
+                memcpy(pdu, &(ingest[20]), pdu_len);
             }
-            OS_printf("\n");
-            
-            gcry_error = gcry_cipher_gettag(
-                tmp_hd,
-                &(tc_frame.tc_sec_trailer.mac[0]),          // tag output
+        }
+        else if (svc == SA_SVC_ENC)
+        {   // Nothing to verify, the MAC field is ignored
+            status = inst->provider->ctr(cipher_ctx, inst->tc_frame.tc_sec_header.iv,
+                                         inst->sa[inst->tc_frame.tc_sec_header.spi].iv_len,
+                                         (uint8*) &(ingest[20]), pdu, pdu_len);
+        }
+        else
+        {
+            status = inst->provider->aead_decrypt(
+                cipher_ctx,
+                &(inst->tc_frame.tc_sec_header.iv[0]),          // initialization vector
+                inst->sa[inst->tc_frame.tc_sec_header.spi].iv_len,    // IV length
+                aad,                                        // additional authenticated data
+                aad_len,                                    // AAD length
+                (uint8*) &(ingest[20]),                     // ciphertext input
+                pdu,                                        // plaintext output
+                pdu_len,                                    // length of data
+                &(inst->tc_frame.tc_sec_trailer.mac[0]),          // tag input
                 MAC_SIZE                                    // tag size
             );
-            if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-            {
-                OS_printf(KRED "ERROR: gcry_cipher_checktag error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-            }
+        }
+        if (status == CRYPTO_PROVIDER_BAD_MAC)
+        {
+            OS_printf(KRED "ERROR: TC MAC verification failed \n" RESET);
 
-            OS_printf("Expected MAC = 0x");
+            OS_printf("Actual MAC   = 0x");
             for (int z = 0; z < MAC_SIZE; z++)
             {
-                OS_printf("%02x",tc_frame.tc_sec_trailer.mac[z]);
+                OS_printf("%02x",inst->tc_frame.tc_sec_trailer.mac[z]);
             }
             OS_printf("\n");
             status = OS_ERROR;
-            report.bmacf = 1;
+            inst->report.bmacf = 1;
             #ifdef OCF_DEBUG
-                Crypto_fsrPrint(&report);
+                Crypto_fsrPrint(&inst->report);
             #endif
             return status;
         }
-        gcry_cipher_close(tmp_hd);
+        else if (status != OS_SUCCESS)
+        {
+            return status;
+        }
         
-        // Increment the IV for next time
-        #ifdef INCREMENT
-            Crypto_increment(sa[tc_frame.tc_sec_header.spi].iv, IV_SIZE);
-        #endif
+        // Authenticated, so the IV now counts as received
+        if (svc != SA_SVC_ENC)
+        {
+            Crypto_ARC_update(&inst->sa[inst->tc_frame.tc_sec_header.spi], inst->tc_frame.tc_sec_header.iv);
+        }
     }
     else
     {	// Clear
         #ifdef DEBUG
             OS_printf(KBLU "CLEAR TC Received!\n" RESET);
         #endif
+        if (inst->tc_frame.tc_header.fl < 11)
+        {   // No room for the security header and FECF
+            OS_printf(KRED "Error: TC frame length %d too short for SPI %d! \n" RESET, inst->tc_frame.tc_header.fl + 1, inst->tc_frame.tc_sec_header.spi);
+            *len_ingest = 0;
+            return OS_ERROR;
+        }
 
-        for (y = 10; y <= (tc_frame.tc_header.fl - 2); y++)
-        {	
-            tc_frame.tc_pdu[y - 10] = (uint8)ingest[y]; 
+        pdu_len = inst->tc_frame.tc_header.fl - 11;
+        if (view == NULL)
+        {
+            for (y = 10; y <= (inst->tc_frame.tc_header.fl - 2); y++)
+            {	
+                inst->tc_frame.tc_pdu[y - 10] = (uint8)ingest[y]; 
+            }
+        }
+        else
+        {
+            if (out == NULL)
+            {   // Already in place
+                pdu = (uint8*) &(ingest[10]);
+                pdu_offset = 10;
+            }
+            else if (pdu_len <= out_len)
+            {
+                pdu = out;
+                memcpy(pdu, &(ingest[10]), pdu_len);
+            }
+            else
+            {
+                OS_printf(KRED "Error: TC output buffer too small! \n" RESET);
+                *len_ingest = 0;
+                return OS_ERROR;
+            }
+            y = inst->tc_frame.tc_header.fl - 1;
         }
         // FECF
-        tc_frame.tc_sec_trailer.fecf = ((uint8)ingest[y] << 8) | ((uint8)ingest[y+1]);
-        Crypto_FECF((int) tc_frame.tc_sec_trailer.fecf, ingest, (tc_frame.tc_header.fl - 2));
+        inst->tc_frame.tc_sec_trailer.fecf = ((uint8)ingest[y] << 8) | ((uint8)ingest[y+1]);
+        Crypto_FECF(inst, (int) inst->tc_frame.tc_sec_trailer.fecf, ingest, (inst->tc_frame.tc_header.fl - 2));
     }
     
     #ifdef TC_DEBUG
-        Crypto_tcPrint(&tc_frame);
+        Crypto_tcPrint(&inst->tc_frame);
     #endif
 
-    // Zero ingest
-    for (x = 0; x < *len_ingest; x++)
-    {
-        ingest[x] = 0;
+    if (view == NULL)
+    {   // Zero ingest
+        for (x = 0; x < *len_ingest; x++)
+        {
+            ingest[x] = 0;
+        }
     }
     
-    if ((tc_frame.tc_pdu[0] == 0x18) && (tc_frame.tc_pdu[1] == 0x80))	
+    if ((pdu[0] == 0x18) && (pdu[1] == 0x80))	
     // Crypto Lib Application ID
     {
         #ifdef DEBUG
             OS_printf(KGRN "Received SDLS command: " RESET);
         #endif
         // CCSDS Header
-        sdls_frame.hdr.pvn  	  = (tc_frame.tc_pdu[0] & 0xE0) >> 5;
-        sdls_frame.hdr.type 	  = (tc_frame.tc_pdu[0] & 0x10) >> 4;
-        sdls_frame.hdr.shdr 	  = (tc_frame.tc_pdu[0] & 0x08) >> 3;
-        sdls_frame.hdr.appID      = ((tc_frame.tc_pdu[0] & 0x07) << 8) | tc_frame.tc_pdu[1];
-        sdls_frame.hdr.seq  	  = (tc_frame.tc_pdu[2] & 0xC0) >> 6;
-        sdls_frame.hdr.pktid      = ((tc_frame.tc_pdu[2] & 0x3F) << 8) | tc_frame.tc_pdu[3];
-        sdls_frame.hdr.pkt_length = (tc_frame.tc_pdu[4] << 8) | tc_frame.tc_pdu[5];
+        inst->sdls_frame.hdr.pvn  	  = (pdu[0] & 0xE0) >> 5;
+        inst->sdls_frame.hdr.type 	  = (pdu[0] & 0x10) >> 4;
+        inst->sdls_frame.hdr.shdr 	  = (pdu[0] & 0x08) >> 3;
+        inst->sdls_frame.hdr.appID      = ((pdu[0] & 0x07) << 8) | pdu[1];
+        inst->sdls_frame.hdr.seq  	  = (pdu[2] & 0xC0) >> 6;
+        inst->sdls_frame.hdr.pktid      = ((pdu[2] & 0x3F) << 8) | pdu[3];
+        inst->sdls_frame.hdr.pkt_length = (pdu[4] << 8) | pdu[5];
         
         // CCSDS PUS
-        sdls_frame.pus.shf		  = (tc_frame.tc_pdu[6] & 0x80) >> 7;
-        sdls_frame.pus.pusv		  = (tc_frame.tc_pdu[6] & 0x70) >> 4;
-        sdls_frame.pus.ack		  = (tc_frame.tc_pdu[6] & 0x0F);
-        sdls_frame.pus.st		  = tc_frame.tc_pdu[7];
-        sdls_frame.pus.sst		  = tc_frame.tc_pdu[8];
-        sdls_frame.pus.sid		  = (tc_frame.tc_pdu[9] & 0xF0) >> 4;
-        sdls_frame.pus.spare	  = (tc_frame.tc_pdu[9] & 0x0F);
+        inst->sdls_frame.pus.shf		  = (pdu[6] & 0x80) >> 7;
+        inst->sdls_frame.pus.pusv		  = (pdu[6] & 0x70) >> 4;
+        inst->sdls_frame.pus.ack		  = (pdu[6] & 0x0F);
+        inst->sdls_frame.pus.st		  = pdu[7];
+        inst->sdls_frame.pus.sst		  = pdu[8];
+        inst->sdls_frame.pus.sid		  = (pdu[9] & 0xF0) >> 4;
+        inst->sdls_frame.pus.spare	  = (pdu[9] & 0x0F);
         
         // SDLS TLV PDU
-        sdls_frame.pdu.type 	  = (tc_frame.tc_pdu[10] & 0x80) >> 7;
-        sdls_frame.pdu.uf   	  = (tc_frame.tc_pdu[10] & 0x40) >> 6;
-        sdls_frame.pdu.sg   	  = (tc_frame.tc_pdu[10] & 0x30) >> 4;
-        sdls_frame.pdu.pid  	  = (tc_frame.tc_pdu[10] & 0x0F);
-        sdls_frame.pdu.pdu_len 	  = (tc_frame.tc_pdu[11] << 8) | tc_frame.tc_pdu[12];
-        for (x = 13; x < (13 + sdls_frame.hdr.pkt_length); x++)
+        inst->sdls_frame.pdu.type 	  = (pdu[10] & 0x80) >> 7;
+        inst->sdls_frame.pdu.uf   	  = (pdu[10] & 0x40) >> 6;
+        inst->sdls_frame.pdu.sg   	  = (pdu[10] & 0x30) >> 4;
+        inst->sdls_frame.pdu.pid  	  = (pdu[10] & 0x0F);
+        inst->sdls_frame.pdu.pdu_len 	  = (pdu[11] << 8) | pdu[12];
+        for (x = 13; x < (13 + inst->sdls_frame.hdr.pkt_length); x++)
         {
-            sdls_frame.pdu.data[x-13] = tc_frame.tc_pdu[x]; 
+            inst->sdls_frame.pdu.data[x-13] = pdu[x]; 
         }
         
         #ifdef CCSDS_DEBUG
-            Crypto_ccsdsPrint(&sdls_frame); 
+            Crypto_ccsdsPrint(&inst->sdls_frame); 
         #endif
 
-        // Determine type of PDU
-        *len_ingest = Crypto_PDU(ingest);
-    }
-    else
+        if (view != NULL)
+        {   // The reply is built in ingest, which may hold the PDU just parsed
+            for (x = 0; x < *len_ingest; x++)
+            {
+                ingest[x] = 0;
+            }
+        }
+
+        // Determine type of PDU
+        *len_ingest = Crypto_PDU(inst, ingest);
+        inst->tc_sdls = 1;
+        pdu = (uint8*) ingest;
+        pdu_offset = 0;
+        pdu_len = *len_ingest;
+        if (view != NULL)
+        {
+            view->sdls = 1;
+        }
+
+        // SDLS commands may change SA state and keys
+        verified = 0;
+    }
+    else
     {	// CCSDS Pass-through
         #ifdef DEBUG
             OS_printf(KGRN "CCSDS Pass-through \n" RESET);
         #endif
         // TODO: Remove PUS Header
-        for (x = 0; x < (tc_frame.tc_header.fl - 11); x++)
+        if (view == NULL)
         {
-            ingest[x] = tc_frame.tc_pdu[x];
-            #ifdef CCSDS_DEBUG
-                OS_printf("tc_frame.tc_pdu[%d] = 0x%02x\n", x, tc_frame.tc_pdu[x]);
-            #endif
+            for (x = 0; x < (inst->tc_frame.tc_header.fl - 11); x++)
+            {
+                ingest[x] = inst->tc_frame.tc_pdu[x];
+                #ifdef CCSDS_DEBUG
+                    OS_printf("tc_frame.tc_pdu[%d] = 0x%02x\n", x, inst->tc_frame.tc_pdu[x]);
+                #endif
+            }
+            *len_ingest = x;
+        }
+        else
+        {
+            view->sdls = 0;
         }
-        *len_ingest = x;
+    }
+
+    if (view != NULL)
+    {
+        view->buf    = pdu - pdu_offset;
+        view->offset = pdu_offset;
+        view->len    = pdu_len;
     }
 
     #ifdef OCF_DEBUG
-        Crypto_fsrPrint(&report);
+        Crypto_fsrPrint(&inst->report);
     #endif
     
+    if (batch != NULL)
+    {   // Remember this channel for the next frame of the batch
+        batch->valid = verified;
+        batch->scid  = inst->tc_frame.tc_header.scid;
+        batch->vcid  = inst->tc_frame.tc_header.vcid;
+        batch->spi   = inst->tc_frame.tc_sec_header.spi;
+        batch->ctx   = cipher_ctx;
+    }
+
     #ifdef DEBUG
-        OS_printf(KYEL "----- Crypto_TC_ProcessSecurity END -----\n" RESET);
+        if (batch == NULL)
+        {
+            OS_printf(KYEL "----- Crypto_TC_ProcessSecurity END -----\n" RESET);
+        }
     #endif
 
     return status;
 }
 
+int32 Crypto_Instance_TC_ProcessSecurity(crypto_instance_t* inst, char* ingest, int* len_ingest)
+{
+    return Crypto_TC_process(inst, ingest, len_ingest, NULL, NULL, 0, NULL);
+}
 
-int32 Crypto_TM_ApplySecurity( char* ingest, int* len_ingest)
-// Accepts CCSDS message in ingest, and packs into TM before encryption
+int32 Crypto_Instance_TC_ProcessSecurityView(crypto_instance_t* inst, char* ingest, int len_ingest, uint8* out, int out_len, crypto_tc_view_t* view)
+// Processes the frame without copying its PDU, on success view describes the plaintext
+// out may be NULL to decrypt in place within ingest, otherwise it must hold out_len bytes
 {
-    int32 status = ITC_GCM128_SUCCESS;
-    int count = 0;
-    int pdu_loc = 0;
-    int pdu_len = *len_ingest - TM_MIN_SIZE;
-    int pad_len = 0;
-    int mac_loc = 0;
-    int fecf_loc = 0;
-    uint8 tempTM[TM_SIZE];
-    int x = 0;
-    int y = 0;
-    uint8 aad[20];
-    uint16 spi = tm_frame.tm_sec_header.spi;
-    uint16 spp_crc = 0x0000;
+    int32 status;
+
+    view->buf = NULL;
+    view->offset = 0;
+    view->len = 0;
+    view->sdls = 0;
+
+    status = Crypto_TC_process(inst, ingest, &len_ingest, NULL, out, out_len, view);
+    if (status != OS_SUCCESS)
+    {
+        view->buf = NULL;
+        view->len = 0;
+    }
+    return status;
+}
+
+int32 Crypto_Instance_TC_ProcessSecurityBatch(crypto_instance_t* inst, char** ingest, int* len_ingest, int32* status, uint16 num_frames)
+// Processes num_frames frames in order, status[i] is the Crypto_TC_ProcessSecurity result of frame i
+{
+    int32 batch_status = OS_SUCCESS;
+    crypto_tc_batch_t batch;
 
-    gcry_cipher_hd_t tmp_hd;
-    gcry_error_t gcry_error = GPG_ERR_NO_ERROR;
-    CFE_PSP_MemSet(&tempTM, 0, TM_SIZE);
-    
     #ifdef DEBUG
-        OS_printf(KYEL "\n----- Crypto_TM_ApplySecurity START -----\n" RESET);
+        OS_printf(KYEL "\n----- Crypto_TC_ProcessSecurityBatch START (%d frames) -----\n" RESET, num_frames);
     #endif
 
-    // Check for idle frame trigger
-    if (((uint8)ingest[0] == 0x08) && ((uint8)ingest[1] == 0x90))
-    {   // Zero ingest
-        for (x = 0; x < *len_ingest; x++)
+    batch.valid = 0;
+    batch.ctx = NULL;
+    for (uint16 x = 0; x < num_frames; x++)
+    {
+        status[x] = Crypto_TC_process(inst, ingest[x], &len_ingest[x], &batch, NULL, 0, NULL);
+        if (status[x] != OS_SUCCESS)
         {
-            ingest[x] = 0;
+            batch_status = OS_ERROR;
         }
-        // Update TM First Header Pointer
-        tm_frame.tm_header.fhp = 0xFE;
-    }   
-    else
-    {   // Update the length of the ingest from the CCSDS header
-        *len_ingest = (ingest[4] << 8) | ingest[5];
-        ingest[5] = ingest[5] - 5;
-        // Remove outgoing secondary space packet header flag
-        ingest[0] = 0x00;
-        // Change sequence flags to 0xFFFF
-        ingest[2] = 0xFF;
-        ingest[3] = 0xFF;
-        // Add 2 bytes of CRC to space packet
-        spp_crc = Crypto_Calc_CRC16((char*) ingest, *len_ingest);
-        ingest[*len_ingest] = (spp_crc & 0xFF00) >> 8;
-        ingest[*len_ingest+1] = (spp_crc & 0x00FF);
-        *len_ingest = *len_ingest + 2;
-        // Update TM First Header Pointer
-        tm_frame.tm_header.fhp = tm_offset;
-        #ifdef TM_DEBUG
-            OS_printf("tm_offset = %d \n", tm_offset);
-        #endif
-    }             
+    }
+
+    #ifdef DEBUG
+        OS_printf(KYEL "----- Crypto_TC_ProcessSecurityBatch END -----\n" RESET);
+    #endif
+
+    return batch_status;
+}
+
+
+static int32 Crypto_TM_frame(crypto_instance_t* inst, char* ingest, int* len_ingest, int frame_len, uint8 mux)
+// Builds a frame_len byte TM frame in place over ingest, which must hold a full frame
+// The PDU is the packet in ingest with idle fill or, for mux, the next bytes of the packet queue
+{
+    int32 status = OS_SUCCESS;
+    int count = 0;
+    int pdu_loc = 0;
+    int pdu_len = 0;
+    int mac_loc = 0;
+    int fecf_loc = 0;
+    uint8* frame = (uint8*) ingest;
+    int x = 0;
+    int y = 0;
+    uint8 aad[ABM_SIZE];
+    uint16 spi = inst->tm_frame.tm_sec_header.spi;
+    uint8 svc = SA_SERVICE(&inst->sa[spi]);
+    crypto_provider_ctx_t* cipher_ctx;
 
     // Update Current Telemetry Frame in Memory
         // Counters
-        tm_frame.tm_header.mcfc++;
-        tm_frame.tm_header.vcfc++;
+        inst->tm_frame.tm_header.mcfc++;
+        inst->tm_frame.tm_header.vcfc++;
         // Operational Control Field 
-        Crypto_TM_updateOCF();
-        // Payload Data Unit
-        Crypto_TM_updatePDU(ingest, *len_ingest);
+        Crypto_TM_updateOCF(inst);
+
+    // Frame layout
+        if (svc != SA_SVC_CLEAR)
+        {   // Initialization Vector
+            pdu_loc = 8 + IV_SIZE;
+            pdu_len = frame_len - TM_MIN_SIZE + OCF_SIZE;
+        }
+        else
+        {   // Padding length bytes
+            pdu_loc = 8 + TM_PAD_SIZE;
+            pdu_len = frame_len - TM_MIN_SIZE + IV_SIZE + TM_PAD_SIZE;
+        }
+        mac_loc = pdu_loc + pdu_len;
+        fecf_loc = mac_loc + MAC_SIZE + OCF_SIZE;
+
+        // Payload Data Unit, placed first as the header overwrites the start of the packet
+        if (mux == 1)
+        {
+            Crypto_TM_muxPDU(inst, &frame[pdu_loc], pdu_len);
+        }
+        else
+        {
+            Crypto_TM_updatePDU(inst, &frame[pdu_loc], ingest, *len_ingest, pdu_len);
+        }
 
     // Check test flags
-        if (badSPI == 1)
+        if (inst->badSPI == 1)
         {
-            tm_frame.tm_sec_header.spi++; 
+            inst->tm_frame.tm_sec_header.spi++; 
         }
-        if (badIV == 1)
+        if (inst->badIV == 1)
         {
-            sa[tm_frame.tm_sec_header.spi].iv[IV_SIZE-1]++;
+            inst->sa[inst->tm_frame.tm_sec_header.spi].iv[IV_SIZE-1]++;
         }
-        if (badMAC == 1)
+        if (inst->badMAC == 1)
         {
-            tm_frame.tm_sec_trailer.mac[MAC_SIZE-1]++;
+            inst->tm_frame.tm_sec_trailer.mac[MAC_SIZE-1]++;
         }
 
-    // Initialize the temporary TM frame
+    // Serialize the rest of the frame around it
         // Header
-        tempTM[count++] = (uint8) ((tm_frame.tm_header.tfvn << 6) | ((tm_frame.tm_header.scid & 0x3F0) >> 4));
-        tempTM[count++] = (uint8) (((tm_frame.tm_header.scid & 0x00F) << 4) | (tm_frame.tm_header.vcid << 1) | (tm_frame.tm_header.ocff));
-        tempTM[count++] = (uint8) (tm_frame.tm_header.mcfc);
-        tempTM[count++] = (uint8) (tm_frame.tm_header.vcfc);
-        tempTM[count++] = (uint8) ((tm_frame.tm_header.tfsh << 7) | (tm_frame.tm_header.sf << 6) | (tm_frame.tm_header.pof << 5) | (tm_frame.tm_header.slid << 3) | ((tm_frame.tm_header.fhp & 0x700) >> 8));
-        tempTM[count++] = (uint8) (tm_frame.tm_header.fhp & 0x0FF);
-        //	tempTM[count++] = (uint8) ((tm_frame.tm_header.tfshvn << 6) | tm_frame.tm_header.tfshlen);
+        frame[count++] = (uint8) ((inst->tm_frame.tm_header.tfvn << 6) | ((inst->tm_frame.tm_header.scid & 0x3F0) >> 4));
+        frame[count++] = (uint8) (((inst->tm_frame.tm_header.scid & 0x00F) << 4) | (inst->tm_frame.tm_header.vcid << 1) | (inst->tm_frame.tm_header.ocff));
+        frame[count++] = (uint8) (inst->tm_frame.tm_header.mcfc);
+        frame[count++] = (uint8) (inst->tm_frame.tm_header.vcfc);
+        frame[count++] = (uint8) ((inst->tm_frame.tm_header.tfsh << 7) | (inst->tm_frame.tm_header.sf << 6) | (inst->tm_frame.tm_header.pof << 5) | (inst->tm_frame.tm_header.slid << 3) | ((inst->tm_frame.tm_header.fhp & 0x700) >> 8));
+        frame[count++] = (uint8) (inst->tm_frame.tm_header.fhp & 0x0FF);
+        //	frame[count++] = (uint8) ((tm_frame.tm_header.tfshvn << 6) | tm_frame.tm_header.tfshlen);
         // Security Header
-        tempTM[count++] = (uint8) ((spi & 0xFF00) >> 8);
-        tempTM[count++] = (uint8) ((spi & 0x00FF));
-        CFE_PSP_MemCpy(tm_frame.tm_sec_header.iv, sa[spi].iv, IV_SIZE);
-
-        // Padding Length
-            pad_len = Crypto_Get_tmLength(*len_ingest) - TM_MIN_SIZE + IV_SIZE + TM_PAD_SIZE - *len_ingest;
+        frame[count++] = (uint8) ((spi & 0xFF00) >> 8);
+        frame[count++] = (uint8) ((spi & 0x00FF));
+        CFE_PSP_MemCpy(inst->tm_frame.tm_sec_header.iv, inst->sa[spi].iv, IV_SIZE);
         
-        // Only add IV for authenticated encryption 
-        if ((sa[spi].est == 1) && 
-            (sa[spi].ast == 1))		
+        // Only add IV for secured frames
+        if (svc != SA_SVC_CLEAR)
         {	// Initialization Vector
             #ifdef INCREMENT
-                Crypto_increment(sa[tm_frame.tm_sec_header.spi].iv, IV_SIZE);
+                Crypto_increment(inst->sa[inst->tm_frame.tm_sec_header.spi].iv, IV_SIZE);
             #endif
-            if ((sa[spi].est == 1) || (sa[spi].ast == 1))
-            {	for (x = 0; x < IV_SIZE; x++)
-                {
-                    tempTM[count++] = sa[tm_frame.tm_sec_header.spi].iv[x];
-                }
+            for (x = 0; x < IV_SIZE; x++)
+            {
+                frame[count++] = inst->sa[inst->tm_frame.tm_sec_header.spi].iv[x];
             }
-            pdu_loc = count;
-            pad_len = pad_len - IV_SIZE - TM_PAD_SIZE + OCF_SIZE;
-            pdu_len = *len_ingest + pad_len;
         }
         else	
         {	// Include padding length bytes - hard coded per ESA testing
-            tempTM[count++] = 0x00;  // pad_len >> 8; 
-            tempTM[count++] = 0x1A;  // pad_len
-            pdu_loc = count;
-            pdu_len = *len_ingest + pad_len;
-        }
-        
-        // Payload Data Unit
-        for (x = 0; x < (pdu_len); x++)	
-        {
-            tempTM[count++] = (uint8) tm_frame.tm_pdu[x];
+            frame[count++] = 0x00;  // pad_len >> 8; 
+            frame[count++] = 0x1A;  // pad_len
         }
+        count = mac_loc;
         // Message Authentication Code
-        mac_loc = count;
         for (x = 0; x < MAC_SIZE; x++)
         {
-            tempTM[count++] = 0x00;
+            frame[count++] = 0x00;
         }
         // Operational Control Field
         for (x = 0; x < OCF_SIZE; x++)
         {
-            tempTM[count++] = (uint8) tm_frame.tm_sec_trailer.ocf[x];
+            frame[count++] = (uint8) inst->tm_frame.tm_sec_trailer.ocf[x];
         }
         // Frame Error Control Field
-        fecf_loc = count;
-        tm_frame.tm_sec_trailer.fecf = Crypto_Calc_FECF((char*) tempTM, count);	
-        tempTM[count++] = (uint8) ((tm_frame.tm_sec_trailer.fecf & 0xFF00) >> 8);
-        tempTM[count++] = (uint8) (tm_frame.tm_sec_trailer.fecf & 0x00FF);
+        count = count + FECF_SIZE;
 
     // Determine Mode
-        // Clear
-        if ((sa[spi].est == 0) && 
-            (sa[spi].ast == 0))
-        {
-            #ifdef DEBUG
-                OS_printf(KBLU "Creating a TM - CLEAR! \n" RESET);
-            #endif
-            // Copy temporary frame to ingest
-            CFE_PSP_MemCpy(ingest, tempTM, count);
-        }
         // Authenticated Encryption
-        else if ((sa[spi].est == 1) && 
-                 (sa[spi].ast == 1))
+        if (svc == SA_SVC_AEAD)
         {
             #ifdef DEBUG
                 OS_printf(KBLU "Creating a TM - AUTHENTICATED ENCRYPTION! \n" RESET);
             #endif
-
-            // Copy TM to ingest
-            CFE_PSP_MemCpy(ingest, tempTM, pdu_loc);
             
             #ifdef MAC_DEBUG
                 OS_printf("AAD = 0x");
             #endif
             // Prepare additional authenticated data
-            for (y = 0; y < sa[spi].abm_len; y++)
+            for (y = 0; y < inst->sa[spi].abm_len; y++)
             {
-                aad[y] = ingest[y] & sa[spi].abm[y];
+                aad[y] = ingest[y] & inst->sa[spi].abm[y];
                 #ifdef MAC_DEBUG
                     OS_printf("%02x", aad[y]);
                 #endif
@@ -3266,73 +3599,25 @@ int32 Crypto_TM_ApplySecurity( char* ingest, int* len_ingest)
                 OS_printf("\n");
             #endif
 
-            gcry_error = gcry_cipher_open(
-                &(tmp_hd), 
-                GCRY_CIPHER_AES256, 
-                GCRY_CIPHER_MODE_GCM, 
-                GCRY_CIPHER_CBC_MAC
-            );
-            if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-            {
-                OS_printf(KRED "ERROR: gcry_cipher_open error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-                status = OS_ERROR;
-                return status;
-            }
-            gcry_error = gcry_cipher_setkey(
-                tmp_hd, 
-                &(ek_ring[sa[spi].ekid].value[0]), 
-                KEY_SIZE
-            );
-            if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-            {
-                OS_printf(KRED "ERROR: gcry_cipher_setkey error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-                status = OS_ERROR;
-                return status;
-            }
-            gcry_error = gcry_cipher_setiv(
-                tmp_hd, 
-                &(sa[tm_frame.tm_sec_header.spi].iv[0]), 
-                sa[tm_frame.tm_sec_header.spi].iv_len
-            );
-            if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+            status = Crypto_Cipher_get(inst, spi, &cipher_ctx);
+            if (status != OS_SUCCESS)
             {
-                OS_printf(KRED "ERROR: gcry_cipher_setiv error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-                status = OS_ERROR;
-                return status;
-            }
-            gcry_error = gcry_cipher_encrypt(
-                tmp_hd,
-                &(ingest[pdu_loc]),                             // ciphertext output
-                pdu_len,			 		                    // length of data
-                &(tempTM[pdu_loc]),                             // plaintext input
-                pdu_len                                         // in data length
-            );
-            if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-            {
-                OS_printf(KRED "ERROR: gcry_cipher_decrypt error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-                status = OS_ERROR;
                 return status;
             }
-            gcry_error = gcry_cipher_authenticate(
-                tmp_hd,
+            status = inst->provider->aead_encrypt(
+                cipher_ctx,
+                &(inst->sa[spi].iv[0]),                               // initialization vector
+                inst->sa[spi].iv_len,                                 // IV length
                 &(aad[0]),                                      // additional authenticated data
-                sa[spi].abm_len 		                        // length of AAD
-            );
-            if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
-            {
-                OS_printf(KRED "ERROR: gcry_cipher_authenticate error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-                status = OS_ERROR;
-                return status;
-            }
-            gcry_error = gcry_cipher_gettag(
-                tmp_hd,
-                &(ingest[mac_loc]),                             // tag output
+                inst->sa[spi].abm_len,                                // length of AAD
+                &(frame[pdu_loc]),                              // plaintext input
+                &(frame[pdu_loc]),                              // in place encryption
+                pdu_len,                                        // length of data
+                &(frame[mac_loc]),                              // tag output
                 MAC_SIZE                                        // tag size
             );
-            if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+            if (status != OS_SUCCESS)
             {
-                OS_printf(KRED "ERROR: gcry_cipher_checktag error code %d\n" RESET,gcry_error & GPG_ERR_CODE_MASK);
-                status = OS_ERROR;
                 return status;
             }
 
@@ -3345,149 +3630,905 @@ int32 Crypto_TM_ApplySecurity( char* ingest, int* len_ingest)
                 OS_printf("\n");
             #endif
 
-            // Update OCF
-            y = 0;
-            for (x = OCF_SIZE; x > 0; x--)
-            {
-                ingest[fecf_loc - x] = tm_frame.tm_sec_trailer.ocf[y++];
-            }
-
             // Update FECF
-            tm_frame.tm_sec_trailer.fecf = Crypto_Calc_FECF((char*) ingest, fecf_loc - 1);
-            ingest[fecf_loc] = (uint8) ((tm_frame.tm_sec_trailer.fecf & 0xFF00) >> 8);
-            ingest[fecf_loc + 1] = (uint8) (tm_frame.tm_sec_trailer.fecf & 0x00FF); 
+            inst->tm_frame.tm_sec_trailer.fecf = Crypto_Calc_FECF(inst, (char*) ingest, fecf_loc - 1);
         }
-        // Authentication
-        else if ((sa[spi].est == 0) && 
-                 (sa[spi].ast == 1))
+        // Authentication only
+        else if (svc == SA_SVC_AUTH)
         {
             #ifdef DEBUG
                 OS_printf(KBLU "Creating a TM - AUTHENTICATED! \n" RESET);
             #endif
-            // TODO: Future work. Operationally same as clear.
-            CFE_PSP_MemCpy(ingest, tempTM, count);
+            // MAC over the masked headers and the plaintext PDU
+            status = Crypto_Auth_mac(inst, spi, &(frame[8]), frame, mac_loc, &(frame[mac_loc]));
+            if (status != OS_SUCCESS)
+            {
+                return status;
+            }
+            inst->tm_frame.tm_sec_trailer.fecf = Crypto_Calc_FECF(inst, (char*) ingest, fecf_loc - 1);
         }
-        // Encryption
-        else if ((sa[spi].est == 1) && 
-                 (sa[spi].ast == 0))
+        // Encryption only, the MAC field stays zeroed
+        else if (svc == SA_SVC_ENC)
         {
             #ifdef DEBUG
                 OS_printf(KBLU "Creating a TM - ENCRYPTED! \n" RESET);
             #endif
-            // TODO: Future work. Operationally same as clear.
-            CFE_PSP_MemCpy(ingest, tempTM, count);
+            status = Crypto_Cipher_get(inst, spi, &cipher_ctx);
+            if (status != OS_SUCCESS)
+            {
+                return status;
+            }
+            status = inst->provider->ctr(cipher_ctx, &(frame[8]), inst->sa[spi].iv_len,
+                                         &(frame[pdu_loc]), &(frame[pdu_loc]), pdu_len);
+            if (status != OS_SUCCESS)
+            {
+                return status;
+            }
+            inst->tm_frame.tm_sec_trailer.fecf = Crypto_Calc_FECF(inst, (char*) ingest, fecf_loc - 1);
+        }
+        else
+        {   
+            #ifdef DEBUG
+                OS_printf(KBLU "Creating a TM - CLEAR! \n" RESET);
+            #endif
+            inst->tm_frame.tm_sec_trailer.fecf = Crypto_Calc_FECF(inst, (char*) ingest, fecf_loc - 1);
         }
+        frame[fecf_loc] = (uint8) ((inst->tm_frame.tm_sec_trailer.fecf & 0xFF00) >> 8);
+        frame[fecf_loc + 1] = (uint8) (inst->tm_frame.tm_sec_trailer.fecf & 0x00FF);
 
     #ifdef TM_DEBUG
-        Crypto_tmPrint(&tm_frame);		
+        Crypto_tmPrint(&inst->tm_frame);		
     #endif	
-    
-    #ifdef DEBUG
-        OS_printf(KYEL "----- Crypto_TM_ApplySecurity END -----\n" RESET);
-    #endif
 
     *len_ingest = count;
     return status;    
 }
 
-int32 Crypto_TM_ProcessSecurity(char* ingest, int* len_ingest)
+int32 Crypto_Instance_TM_ApplySecurity(crypto_instance_t* inst, char* ingest, int* len_ingest)
+// Accepts CCSDS message in ingest, and packs into TM before encryption
+// May be mixed with Crypto_TM_NextFrame only between queued packets, both continue the same idle fill
 {
-    // Local Variables
     int32 status = OS_SUCCESS;
-
-    #ifdef DEBUG
-        OS_printf(KYEL "\n----- Crypto_TM_ProcessSecurity START -----\n" RESET);
-    #endif
-
-    // TODO: This whole function!
-    len_ingest = len_ingest;
-    ingest[0] = ingest[0];
-
+    int x = 0;
+    uint16 spp_crc = 0x0000;
+    
     #ifdef DEBUG
-        OS_printf(KYEL "----- Crypto_TM_ProcessSecurity END -----\n" RESET);
+        OS_printf(KYEL "\n----- Crypto_TM_ApplySecurity START -----\n" RESET);
     #endif
 
-    return status;
-}
-
-int32 Crypto_AOS_ApplySecurity(char* ingest, int* len_ingest)
-{
-    // Local Variables
-    int32 status = OS_SUCCESS;
+    // A frame of its own would land inside the packet Crypto_TM_NextFrame is part way through
+    if (inst->tm_mux.cont > 0)
+    {
+        OS_printf(KRED "Error: TM packet queue is part way through a packet! \n" RESET);
+        *len_ingest = 0;
+        return OS_ERROR;
+    }
 
-    #ifdef DEBUG
-        OS_printf(KYEL "\n----- Crypto_AOS_ApplySecurity START -----\n" RESET);
-    #endif
+    // Check for idle frame trigger
+    if (((uint8)ingest[0] == 0x08) && ((uint8)ingest[1] == 0x90))
+    {   // Zero ingest
+        for (x = 0; x < *len_ingest; x++)
+        {
+            ingest[x] = 0;
+        }
+        // Update TM First Header Pointer
+        inst->tm_frame.tm_header.fhp = 0xFE;
+    }   
+    else
+    {   // Update the length of the ingest from the CCSDS header
+        *len_ingest = (ingest[4] << 8) | ingest[5];
+        ingest[5] = ingest[5] - 5;
+        // Remove outgoing secondary space packet header flag
+        ingest[0] = 0x00;
+        // Change sequence flags to 0xFFFF
+        ingest[2] = 0xFF;
+        ingest[3] = 0xFF;
+        // Add 2 bytes of CRC to space packet
+        spp_crc = Crypto_Calc_CRC16((char*) ingest, *len_ingest);
+        ingest[*len_ingest] = (spp_crc & 0xFF00) >> 8;
+        ingest[*len_ingest+1] = (spp_crc & 0x00FF);
+        *len_ingest = *len_ingest + 2;
+        // Update TM First Header Pointer
+        inst->tm_frame.tm_header.fhp = inst->tm_offset;
+        #ifdef TM_DEBUG
+            OS_printf("tm_offset = %d \n", inst->tm_offset);
+        #endif
+    }             
 
-    // TODO: This whole function!
-    len_ingest = len_ingest;
-    ingest[0] = ingest[0];
+    status = Crypto_TM_frame(inst, ingest, len_ingest, Crypto_Get_tmLength(*len_ingest), 0);
 
     #ifdef DEBUG
-        OS_printf(KYEL "----- Crypto_AOS_ApplySecurity END -----\n" RESET);
+        OS_printf(KYEL "----- Crypto_TM_ApplySecurity END -----\n" RESET);
     #endif
 
     return status;
 }
 
-int32 Crypto_AOS_ProcessSecurity(char* ingest, int* len_ingest)
+int32 Crypto_Instance_TM_QueuePacket(crypto_instance_t* inst, char* packet, int len_packet)
+// Queues a complete space packet for Crypto_TM_NextFrame, packets are sent in order and may span frames
 {
-    // Local Variables
-    int32 status = OS_SUCCESS;
-
-    #ifdef DEBUG
-        OS_printf(KYEL "\n----- Crypto_AOS_ProcessSecurity START -----\n" RESET);
-    #endif
+    crypto_tm_mux_t* mux = &(inst->tm_mux);
+    uint32 tail = 0;
+    uint32 first = 0;
 
-    // TODO: This whole function!
-    len_ingest = len_ingest;
-    ingest[0] = ingest[0];
+    if ((len_packet < 7) || ((((uint8)packet[4] << 8) | (uint8)packet[5]) + 7 != len_packet))
+    {
+        OS_printf(KRED "Error: TM packet length does not match its header! \n" RESET);
+        return OS_ERROR;
+    }
+    if ((uint32) len_packet > (TM_MUX_SIZE - mux->len))
+    {
+        OS_printf(KRED "Error: TM packet queue full! \n" RESET);
+        return OS_ERROR;
+    }
 
-    #ifdef DEBUG
-        OS_printf(KYEL "----- Crypto_AOS_ProcessSecurity END -----\n" RESET);
-    #endif
+    tail = (mux->head + mux->len) % TM_MUX_SIZE;
+    first = TM_MUX_SIZE - tail;
+    if (first > (uint32) len_packet)
+    {
+        first = len_packet;
+    }
+    CFE_PSP_MemCpy(&(mux->buf[tail]), packet, first);
+    CFE_PSP_MemCpy(&(mux->buf[0]), &(packet[first]), len_packet - first);
+    mux->len = mux->len + len_packet;
 
-    return status;
+    return OS_SUCCESS;
 }
 
-int32 Crypto_ApplySecurity(char* ingest, int* len_ingest)
+int32 Crypto_Instance_TM_NextFrame(crypto_instance_t* inst, char* frame, int* len_frame)
+// Builds the next TM frame from the packet queue, idle packets fill what the queue cannot
+// frame must hold TM_FILL_SIZE bytes
 {
-    // Local Variables
     int32 status = OS_SUCCESS;
 
     #ifdef DEBUG
-        OS_printf(KYEL "\n----- Crypto_ApplySecurity START -----\n" RESET);
+        OS_printf(KYEL "\n----- Crypto_TM_NextFrame START -----\n" RESET);
     #endif
 
-    // TODO: This whole function!
-    len_ingest = len_ingest;
-    ingest[0] = ingest[0];
+    status = Crypto_TM_frame(inst, frame, len_frame, TM_FILL_SIZE, 1);
 
     #ifdef DEBUG
-        OS_printf(KYEL "----- Crypto_ApplySecurity END -----\n" RESET);
+        OS_printf(KYEL "----- Crypto_TM_NextFrame END -----\n" RESET);
     #endif
 
     return status;
 }
 
-int32 Crypto_ProcessSecurity(char* ingest, int* len_ingest)
+static int32 Crypto_TM_process(crypto_instance_t* inst, char* ingest, int len_ingest, crypto_tm_view_t* view)
+// Verifies a TM frame built by Crypto_TM_ApplySecurity and decrypts its PDU in place
+// The same layout: header, SPI, IV or pad length, PDU, MAC, OCF, FECF
 {
-    // Local Variables
     int32 status = OS_SUCCESS;
+    uint8* frame = (uint8*) ingest;
+    uint16 spi = 0;
+    uint16 fecf = 0;
+    int pdu_loc = 0;
+    int pdu_len = 0;
+    int mac_loc = 0;
+    int fecf_loc = 0;
+    int y = 0;
+    uint8 aad[ABM_SIZE];
+    uint8 svc = SA_SVC_CLEAR;
+    crypto_provider_ctx_t* cipher_ctx;
+    uint16 mapped = 0;
+    uint8 tfvn = (frame[0] & 0xC0) >> 6;
+    uint16 scid = ((frame[0] & 0x3F) << 4) | ((frame[1] & 0xF0) >> 4);
+    uint8 vcid = (frame[1] & 0x0E) >> 1;
 
-    #ifdef DEBUG
-        OS_printf(KYEL "\n----- Crypto_ProcessSecurity START -----\n" RESET);
-    #endif
+    // Security Header
+    spi = (frame[6] << 8) | frame[7];
+    if (spi >= NUM_SA)
+    {
+        OS_printf(KRED "Error: TM SPI %d invalid! \n" RESET, spi);
+        return OS_ERROR;
+    }
 
-    // TODO: This whole function!
-    len_ingest = len_ingest;
-    ingest[0] = ingest[0];
+    // Only the operational SA of the frame's channel may be used
+    if (Crypto_SA_find(inst, TYPE_TM, tfvn, scid, vcid, &mapped) != OS_SUCCESS)
+    {
+        return OS_ERROR;
+    }
+    if (mapped != spi)
+    {
+        OS_printf(KRED "Error: TM VCID %d not mapped to SPI %d! \n" RESET, vcid, spi);
+        return OS_ERROR;
+    }
+    svc = SA_SERVICE(&inst->sa[spi]);
 
-    #ifdef DEBUG
-        OS_printf(KYEL "----- Crypto_ProcessSecurity END -----\n" RESET);
-    #endif
+    // Frame layout
+    if (svc != SA_SVC_CLEAR)
+    {
+        pdu_loc = 8 + IV_SIZE;
+        pdu_len = len_ingest - TM_MIN_SIZE + OCF_SIZE;
+    }
+    else
+    {
+        pdu_loc = 8 + TM_PAD_SIZE;
+        pdu_len = len_ingest - TM_MIN_SIZE + IV_SIZE + TM_PAD_SIZE;
+    }
+    if (pdu_len <= 0)
+    {
+        OS_printf(KRED "Error: TM frame too short! \n" RESET);
+        return OS_ERROR;
+    }
+    mac_loc = pdu_loc + pdu_len;
+    fecf_loc = mac_loc + MAC_SIZE + OCF_SIZE;
+
+    // Frame Error Control Field
+    fecf = (frame[fecf_loc] << 8) | frame[fecf_loc + 1];
+    if (fecf != Crypto_Calc_FECF(inst, ingest, fecf_loc - 1))
+    {
+        OS_printf(KRED "Error: TM FECF incorrect! \n" RESET);
+        return OS_ERROR;
+    }
+
+    // Check IV against the anti-replay window before the MAC, as Crypto_TC_process does, an
+    // encryption only SA has no MAC to vouch for the IV and so no replay protection
+    if ((svc == SA_SVC_AEAD) || (svc == SA_SVC_AUTH))
+    {
+        status = Crypto_ARC_check(&inst->sa[spi], &(frame[8]));
+        if (status == ARC_OUTSIDE_WINDOW)
+        {
+            OS_printf(KRED "Error: TM IV not in window! \n" RESET);
+            return OS_ERROR;
+        }
+        else if (status == ARC_REPLAY)
+        {
+            OS_printf(KRED "Error: TM IV replay! Value already received or too old! \n" RESET);
+            return OS_ERROR;
+        }
+    }
+
+    // Authenticated Encryption
+    if (svc == SA_SVC_AEAD)
+    {
+        #ifdef DEBUG
+            OS_printf(KBLU "ENCRYPTED TM Received!\n" RESET);
+        #endif
+        for (y = 0; y < inst->sa[spi].abm_len; y++)
+        {
+            aad[y] = frame[y] & inst->sa[spi].abm[y];
+        }
+
+        status = Crypto_Cipher_get(inst, spi, &cipher_ctx);
+        if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+        status = inst->provider->aead_decrypt(
+            cipher_ctx,
+            &(frame[8]),                                    // initialization vector
+            inst->sa[spi].iv_len,                           // IV length
+            &(aad[0]),                                      // additional authenticated data
+            inst->sa[spi].abm_len,                          // length of AAD
+            &(frame[pdu_loc]),                              // ciphertext input
+            &(frame[pdu_loc]),                              // in place decryption
+            pdu_len,                                        // length of data
+            &(frame[mac_loc]),                              // tag input
+            MAC_SIZE                                        // tag size
+        );
+        if (status == CRYPTO_PROVIDER_BAD_MAC)
+        {
+            OS_printf(KRED "ERROR: TM MAC verification failed \n" RESET);
+            return OS_ERROR;
+        }
+        else if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+    }
+    // Authentication only
+    else if (svc == SA_SVC_AUTH)
+    {
+        #ifdef DEBUG
+            OS_printf(KBLU "AUTHENTICATED TM Received!\n" RESET);
+        #endif
+        status = Crypto_Auth_verify(inst, spi, &(frame[8]), frame, mac_loc, &(frame[mac_loc]));
+        if (status == CRYPTO_PROVIDER_BAD_MAC)
+        {
+            OS_printf(KRED "ERROR: TM MAC verification failed \n" RESET);
+            return OS_ERROR;
+        }
+        else if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+    }
+    // Encryption only
+    else if (svc == SA_SVC_ENC)
+    {
+        #ifdef DEBUG
+            OS_printf(KBLU "ENCRYPTED TM Received!\n" RESET);
+        #endif
+        status = Crypto_Cipher_get(inst, spi, &cipher_ctx);
+        if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+        status = inst->provider->ctr(cipher_ctx, &(frame[8]), inst->sa[spi].iv_len,
+                                     &(frame[pdu_loc]), &(frame[pdu_loc]), pdu_len);
+        if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+    }
+    #ifdef DEBUG
+    else
+    {
+        OS_printf(KBLU "CLEAR TM Received!\n" RESET);
+    }
+    #endif
+
+    // Authenticated, so the IV now counts as received
+    if ((svc == SA_SVC_AEAD) || (svc == SA_SVC_AUTH))
+    {
+        Crypto_ARC_update(&inst->sa[spi], &(frame[8]));
+    }
+
+    view->buf    = frame;
+    view->offset = pdu_loc;
+    view->len    = pdu_len;
+    view->spi    = spi;
+    view->vcid   = (frame[1] & 0x0E) >> 1;
+    view->fhp    = ((frame[4] & 0x07) << 8) | frame[5];
 
     return status;
 }
 
+int32 Crypto_Instance_TM_ProcessSecurity(crypto_instance_t* inst, char* ingest, int* len_ingest)
+// Verifies and decrypts the TM frame in ingest, the PDU is returned at the start of ingest
+{
+    int32 status = OS_SUCCESS;
+    crypto_tm_view_t view;
+
+    #ifdef DEBUG
+        OS_printf(KYEL "\n----- Crypto_TM_ProcessSecurity START -----\n" RESET);
+    #endif
+
+    status = Crypto_TM_process(inst, ingest, *len_ingest, &view);
+    if (status == OS_SUCCESS)
+    {
+        memmove(ingest, &(ingest[view.offset]), view.len);
+        *len_ingest = view.len;
+    }
+    else
+    {
+        *len_ingest = 0;
+    }
+
+    #ifdef DEBUG
+        OS_printf(KYEL "----- Crypto_TM_ProcessSecurity END -----\n" RESET);
+    #endif
+
+    return status;
+}
+
+int32 Crypto_Instance_TM_ProcessSecurityView(crypto_instance_t* inst, char* ingest, int len_ingest, crypto_tm_view_t* view)
+// Verifies and decrypts the TM frame in place, on success view describes the PDU within ingest
+{
+    int32 status;
+
+    view->buf = NULL;
+    view->len = 0;
+    status = Crypto_TM_process(inst, ingest, len_ingest, view);
+    if (status != OS_SUCCESS)
+    {
+        view->buf = NULL;
+        view->len = 0;
+    }
+    return status;
+}
+
+int32 Crypto_Instance_AOS_ApplySecurity(crypto_instance_t* inst, char* ingest, int* len_ingest)
+// Secures the AOS_FRAME_SIZE byte frame in ingest in place; the caller fills the primary header,
+// insert zone and the M_PDU at AOS_PDU_LOC, the security header and trailer are written here
+{
+    // Local Variables
+    int32 status = OS_SUCCESS;
+    uint8* frame = (uint8*) ingest;
+    uint16 scid = 0;
+    uint8 vcid = 0;
+    uint16 spi = 0;
+    uint8 svc = SA_SVC_CLEAR;
+    int x = 0;
+    uint8 aad[ABM_SIZE];
+    crypto_provider_ctx_t* cipher_ctx = NULL;
+    #ifdef AOS_FECF
+        uint16 fecf = 0;
+    #endif
+
+    #ifdef DEBUG
+        OS_printf(KYEL "\n----- Crypto_AOS_ApplySecurity START -----\n" RESET);
+    #endif
+
+    if (*len_ingest != AOS_FRAME_SIZE)
+    {
+        OS_printf(KRED "Error: AOS frame length %d is not %d! \n" RESET, *len_ingest, AOS_FRAME_SIZE);
+        return OS_ERROR;
+    }
+    if ((frame[0] >> 6) != AOS_TFVN)
+    {
+        OS_printf(KRED "Error: Not an AOS frame! \n" RESET);
+        return OS_ERROR;
+    }
+    scid = ((frame[0] & 0x3F) << 2) | (frame[1] >> 6);
+    vcid = frame[1] & 0x3F;
+
+    status = Crypto_SA_find(inst, TYPE_TM, AOS_TFVN, scid, vcid, &spi);
+    if (status != OS_SUCCESS)
+    {
+        return status;
+    }
+
+    // Security Header
+    frame[AOS_SPI_LOC] = (uint8) ((spi & 0xFF00) >> 8);
+    frame[AOS_SPI_LOC + 1] = (uint8) (spi & 0x00FF);
+    svc = SA_SERVICE(&inst->sa[spi]);
+
+    if (svc == SA_SVC_AEAD)
+    {	// Authenticated Encryption
+        #ifdef INCREMENT
+            Crypto_increment(inst->sa[spi].iv, IV_SIZE);
+        #endif
+        CFE_PSP_MemCpy(&(frame[AOS_SPI_LOC + 2]), inst->sa[spi].iv, IV_SIZE);
+
+        // Prepare additional authenticated data (AAD)
+        for (x = 0; x < inst->sa[spi].abm_len; x++)
+        {
+            aad[x] = frame[x] & inst->sa[spi].abm[x];
+        }
+
+        status = Crypto_Cipher_get(inst, spi, &cipher_ctx);
+        if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+        status = inst->provider->aead_encrypt(
+            cipher_ctx,
+            &(inst->sa[spi].iv[0]),                         // initialization vector
+            inst->sa[spi].iv_len,                           // IV length
+            &(aad[0]),                                      // additional authenticated data
+            inst->sa[spi].abm_len,                          // length of AAD
+            &(frame[AOS_PDU_LOC]),                          // plaintext input
+            &(frame[AOS_PDU_LOC]),                          // in place encryption
+            AOS_PDU_SIZE,                                   // length of data
+            &(frame[AOS_MAC_LOC]),                          // tag output
+            MAC_SIZE                                        // tag size
+        );
+        if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+    }
+    else if (svc == SA_SVC_AUTH)
+    {	// Authentication only, MAC over the masked headers and the plaintext M_PDU
+        #ifdef INCREMENT
+            Crypto_increment(inst->sa[spi].iv, IV_SIZE);
+        #endif
+        CFE_PSP_MemCpy(&(frame[AOS_SPI_LOC + 2]), inst->sa[spi].iv, IV_SIZE);
+
+        status = Crypto_Auth_mac(inst, spi, inst->sa[spi].iv, frame, AOS_MAC_LOC, &(frame[AOS_MAC_LOC]));
+        if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+    }
+    else if (svc == SA_SVC_ENC)
+    {	// Encryption only, the MAC field is left zeroed
+        #ifdef INCREMENT
+            Crypto_increment(inst->sa[spi].iv, IV_SIZE);
+        #endif
+        CFE_PSP_MemCpy(&(frame[AOS_SPI_LOC + 2]), inst->sa[spi].iv, IV_SIZE);
+        CFE_PSP_MemSet(&(frame[AOS_MAC_LOC]), 0, MAC_SIZE);
+
+        status = Crypto_Cipher_get(inst, spi, &cipher_ctx);
+        if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+        status = inst->provider->ctr(cipher_ctx, inst->sa[spi].iv, inst->sa[spi].iv_len,
+                                     &(frame[AOS_PDU_LOC]), &(frame[AOS_PDU_LOC]), AOS_PDU_SIZE);
+        if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+    }
+    else
+    {	// Clear
+        CFE_PSP_MemSet(&(frame[AOS_SPI_LOC + 2]), 0, IV_SIZE);
+        CFE_PSP_MemSet(&(frame[AOS_MAC_LOC]), 0, MAC_SIZE);
+    }
+
+    // Operational Control Field
+    #ifdef AOS_OCF
+        Crypto_TM_updateOCF(inst);
+        CFE_PSP_MemCpy(&(frame[AOS_OCF_LOC]), inst->tm_frame.tm_sec_trailer.ocf, OCF_SIZE);
+    #endif
+    // Frame Error Control Field
+    #ifdef AOS_FECF
+        fecf = Crypto_Calc_FECF(inst, ingest, AOS_FECF_LOC - 1);
+        frame[AOS_FECF_LOC] = (uint8) ((fecf & 0xFF00) >> 8);
+        frame[AOS_FECF_LOC + 1] = (uint8) (fecf & 0x00FF);
+    #endif
+
+    #ifdef DEBUG
+        OS_printf(KYEL "----- Crypto_AOS_ApplySecurity END -----\n" RESET);
+    #endif
+
+    return status;
+}
+
+static int32 Crypto_AOS_process(crypto_instance_t* inst, char* ingest, int len_ingest, crypto_aos_view_t* view)
+// Verifies an AOS frame built by Crypto_AOS_ApplySecurity and decrypts its M_PDU in place
+{
+    int32 status = OS_SUCCESS;
+    uint8* frame = (uint8*) ingest;
+    uint16 spi = 0;
+    uint16 mapped = 0;
+    uint16 scid = 0;
+    uint8 vcid = 0;
+    uint8 svc = SA_SVC_CLEAR;
+    int y = 0;
+    uint8 aad[ABM_SIZE];
+    crypto_provider_ctx_t* cipher_ctx;
+    #ifdef AOS_FECF
+        uint16 fecf = 0;
+    #endif
+
+    if (len_ingest != AOS_FRAME_SIZE)
+    {
+        OS_printf(KRED "Error: AOS frame length %d is not %d! \n" RESET, len_ingest, AOS_FRAME_SIZE);
+        return OS_ERROR;
+    }
+    if ((frame[0] >> 6) != AOS_TFVN)
+    {
+        OS_printf(KRED "Error: Not an AOS frame! \n" RESET);
+        return OS_ERROR;
+    }
+
+    // Security Header
+    spi = (frame[AOS_SPI_LOC] << 8) | frame[AOS_SPI_LOC + 1];
+    if (spi >= NUM_SA)
+    {
+        OS_printf(KRED "Error: AOS SPI %d invalid! \n" RESET, spi);
+        return OS_ERROR;
+    }
+
+    // Only the operational SA of the frame's channel may be used
+    scid = ((frame[0] & 0x3F) << 2) | (frame[1] >> 6);
+    vcid = frame[1] & 0x3F;
+    if (Crypto_SA_find(inst, TYPE_TM, AOS_TFVN, scid, vcid, &mapped) != OS_SUCCESS)
+    {
+        return OS_ERROR;
+    }
+    if (mapped != spi)
+    {
+        OS_printf(KRED "Error: AOS VCID %d not mapped to SPI %d! \n" RESET, vcid, spi);
+        return OS_ERROR;
+    }
+
+    // Frame Error Control Field
+    #ifdef AOS_FECF
+        fecf = (frame[AOS_FECF_LOC] << 8) | frame[AOS_FECF_LOC + 1];
+        if (fecf != Crypto_Calc_FECF(inst, ingest, AOS_FECF_LOC - 1))
+        {
+            OS_printf(KRED "Error: AOS FECF incorrect! \n" RESET);
+            return OS_ERROR;
+        }
+    #endif
+
+    // Check IV against the anti-replay window before the MAC, as Crypto_TC_process does, an
+    // encryption only SA has no MAC to vouch for the IV and so no replay protection
+    svc = SA_SERVICE(&inst->sa[spi]);
+    if ((svc == SA_SVC_AEAD) || (svc == SA_SVC_AUTH))
+    {
+        status = Crypto_ARC_check(&inst->sa[spi], &(frame[AOS_SPI_LOC + 2]));
+        if (status == ARC_OUTSIDE_WINDOW)
+        {
+            OS_printf(KRED "Error: AOS IV not in window! \n" RESET);
+            return OS_ERROR;
+        }
+        else if (status == ARC_REPLAY)
+        {
+            OS_printf(KRED "Error: AOS IV replay! Value already received or too old! \n" RESET);
+            return OS_ERROR;
+        }
+    }
+
+    // Authenticated Encryption
+    if (svc == SA_SVC_AEAD)
+    {
+        #ifdef DEBUG
+            OS_printf(KBLU "ENCRYPTED AOS Received!\n" RESET);
+        #endif
+        for (y = 0; y < inst->sa[spi].abm_len; y++)
+        {
+            aad[y] = frame[y] & inst->sa[spi].abm[y];
+        }
+
+        status = Crypto_Cipher_get(inst, spi, &cipher_ctx);
+        if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+        status = inst->provider->aead_decrypt(
+            cipher_ctx,
+            &(frame[AOS_SPI_LOC + 2]),                      // initialization vector
+            inst->sa[spi].iv_len,                           // IV length
+            &(aad[0]),                                      // additional authenticated data
+            inst->sa[spi].abm_len,                          // length of AAD
+            &(frame[AOS_PDU_LOC]),                          // ciphertext input
+            &(frame[AOS_PDU_LOC]),                          // in place decryption
+            AOS_PDU_SIZE,                                   // length of data
+            &(frame[AOS_MAC_LOC]),                          // tag input
+            MAC_SIZE                                        // tag size
+        );
+        if (status == CRYPTO_PROVIDER_BAD_MAC)
+        {
+            OS_printf(KRED "ERROR: AOS MAC verification failed \n" RESET);
+            return OS_ERROR;
+        }
+        else if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+    }
+    // Authentication only
+    else if (svc == SA_SVC_AUTH)
+    {
+        #ifdef DEBUG
+            OS_printf(KBLU "AUTHENTICATED AOS Received!\n" RESET);
+        #endif
+        status = Crypto_Auth_verify(inst, spi, &(frame[AOS_SPI_LOC + 2]), frame, AOS_MAC_LOC, &(frame[AOS_MAC_LOC]));
+        if (status == CRYPTO_PROVIDER_BAD_MAC)
+        {
+            OS_printf(KRED "ERROR: AOS MAC verification failed \n" RESET);
+            return OS_ERROR;
+        }
+        else if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+    }
+    // Encryption only
+    else if (svc == SA_SVC_ENC)
+    {
+        #ifdef DEBUG
+            OS_printf(KBLU "ENCRYPTED AOS Received!\n" RESET);
+        #endif
+        status = Crypto_Cipher_get(inst, spi, &cipher_ctx);
+        if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+        status = inst->provider->ctr(cipher_ctx, &(frame[AOS_SPI_LOC + 2]), inst->sa[spi].iv_len,
+                                     &(frame[AOS_PDU_LOC]), &(frame[AOS_PDU_LOC]), AOS_PDU_SIZE);
+        if (status != OS_SUCCESS)
+        {
+            return status;
+        }
+    }
+    #ifdef DEBUG
+    else
+    {   // Clear
+        OS_printf(KBLU "CLEAR AOS Received!\n" RESET);
+    }
+    #endif
+
+    // Authenticated, so the IV now counts as received
+    if ((svc == SA_SVC_AEAD) || (svc == SA_SVC_AUTH))
+    {
+        Crypto_ARC_update(&inst->sa[spi], &(frame[AOS_SPI_LOC + 2]));
+    }
+
+    view->buf    = frame;
+    view->offset = AOS_PDU_LOC + AOS_MPDU_HEADER_SIZE;
+    view->len    = AOS_PDU_SIZE - AOS_MPDU_HEADER_SIZE;
+    view->spi    = spi;
+    view->vcid   = frame[1] & 0x3F;
+    view->fhp    = ((frame[AOS_PDU_LOC] & 0x07) << 8) | frame[AOS_PDU_LOC + 1];
+
+    return status;
+}
+
+int32 Crypto_Instance_AOS_ProcessSecurity(crypto_instance_t* inst, char* ingest, int* len_ingest)
+// Verifies and decrypts the AOS frame in ingest, the packet zone is returned at the start of ingest
+{
+    int32 status = OS_SUCCESS;
+    crypto_aos_view_t view;
+
+    #ifdef DEBUG
+        OS_printf(KYEL "\n----- Crypto_AOS_ProcessSecurity START -----\n" RESET);
+    #endif
+
+    status = Crypto_AOS_process(inst, ingest, *len_ingest, &view);
+    if (status == OS_SUCCESS)
+    {
+        memmove(ingest, &(ingest[view.offset]), view.len);
+        *len_ingest = view.len;
+    }
+    else
+    {
+        *len_ingest = 0;
+    }
+
+    #ifdef DEBUG
+        OS_printf(KYEL "----- Crypto_AOS_ProcessSecurity END -----\n" RESET);
+    #endif
+
+    return status;
+}
+
+int32 Crypto_Instance_AOS_ProcessSecurityView(crypto_instance_t* inst, char* ingest, int len_ingest, crypto_aos_view_t* view)
+// Verifies and decrypts the AOS frame in place, on success view describes the packet zone within ingest
+{
+    int32 status;
+
+    view->buf = NULL;
+    view->len = 0;
+    status = Crypto_AOS_process(inst, ingest, len_ingest, view);
+    if (status != OS_SUCCESS)
+    {
+        view->buf = NULL;
+        view->len = 0;
+    }
+    return status;
+}
+
+int32 Crypto_Instance_ApplySecurity(crypto_instance_t* inst, char* ingest, int* len_ingest)
+// Applies security to a frame of any type, classified by its Transfer Frame Version Number
+// A TC ingest (CRYPTO_GROUND) must have room for a TC_MAX_FRAME_SIZE frame
+{
+    // Local Variables
+    int32 status = OS_SUCCESS;
+
+    #ifdef DEBUG
+        OS_printf(KYEL "\n----- Crypto_ApplySecurity START -----\n" RESET);
+    #endif
+
+    if (*len_ingest <= 0)
+    {
+        OS_printf(KRED "Error: Empty frame! \n" RESET);
+        return OS_ERROR;
+    }
+
+    switch (((uint8) ingest[0] & 0xC0) >> 6)
+    {
+        case TC_TM_TFVN:
+            #ifdef CRYPTO_GROUND
+                status = Crypto_Instance_TC_ApplySecurity(inst, ingest, len_ingest, TC_MAX_FRAME_SIZE);
+            #else
+                status = Crypto_Instance_TM_ApplySecurity(inst, ingest, len_ingest);
+            #endif
+            break;
+        case AOS_TFVN:
+            status = Crypto_Instance_AOS_ApplySecurity(inst, ingest, len_ingest);
+            break;
+        default:
+            OS_printf(KRED "Error: Transfer frame version %d not supported! \n" RESET, ((uint8) ingest[0] & 0xC0) >> 6);
+            status = OS_ERROR;
+            break;
+    }
+
+    #ifdef DEBUG
+        OS_printf(KYEL "----- Crypto_ApplySecurity END -----\n" RESET);
+    #endif
+
+    return status;
+}
+
+int32 Crypto_Instance_ProcessSecurity(crypto_instance_t* inst, char* ingest, int* len_ingest)
+// Processes security of a frame of any type, classified by its Transfer Frame Version Number
+{
+    // Local Variables
+    int32 status = OS_SUCCESS;
+
+    #ifdef DEBUG
+        OS_printf(KYEL "\n----- Crypto_ProcessSecurity START -----\n" RESET);
+    #endif
+
+    if (*len_ingest <= 0)
+    {
+        OS_printf(KRED "Error: Empty frame! \n" RESET);
+        return OS_ERROR;
+    }
+
+    switch (((uint8) ingest[0] & 0xC0) >> 6)
+    {
+        case TC_TM_TFVN:
+            #ifdef CRYPTO_GROUND
+                status = Crypto_Instance_TM_ProcessSecurity(inst, ingest, len_ingest);
+            #else
+                status = Crypto_Instance_TC_ProcessSecurity(inst, ingest, len_ingest);
+            #endif
+            break;
+        case AOS_TFVN:
+            status = Crypto_Instance_AOS_ProcessSecurity(inst, ingest, len_ingest);
+            break;
+        default:
+            OS_printf(KRED "Error: Transfer frame version %d not supported! \n" RESET, ((uint8) ingest[0] & 0xC0) >> 6);
+            status = OS_ERROR;
+            break;
+    }
+
+    #ifdef DEBUG
+        OS_printf(KYEL "----- Crypto_ProcessSecurity END -----\n" RESET);
+    #endif
+
+    return status;
+}
+
+/*
+** Default Instance
+*/
+int32 Crypto_TC_ApplySecurity(char* ingest, int* len_ingest, int max_ingest)
+{
+    return Crypto_Instance_TC_ApplySecurity(&crypto_default, ingest, len_ingest, max_ingest);
+}
+
+int32 Crypto_TC_ProcessSecurity(char* ingest, int* len_ingest)
+{
+    return Crypto_Instance_TC_ProcessSecurity(&crypto_default, ingest, len_ingest);
+}
+
+int32 Crypto_TC_ProcessSecurityBatch(char** ingest, int* len_ingest, int32* status, uint16 num_frames)
+{
+    return Crypto_Instance_TC_ProcessSecurityBatch(&crypto_default, ingest, len_ingest, status, num_frames);
+}
+
+int32 Crypto_TC_ProcessSecurityView(char* ingest, int len_ingest, uint8* out, int out_len, crypto_tc_view_t* view)
+{
+    return Crypto_Instance_TC_ProcessSecurityView(&crypto_default, ingest, len_ingest, out, out_len, view);
+}
+
+int32 Crypto_TM_ApplySecurity(char* ingest, int* len_ingest)
+{
+    return Crypto_Instance_TM_ApplySecurity(&crypto_default, ingest, len_ingest);
+}
+
+int32 Crypto_TM_ProcessSecurityView(char* ingest, int len_ingest, crypto_tm_view_t* view)
+{
+    return Crypto_Instance_TM_ProcessSecurityView(&crypto_default, ingest, len_ingest, view);
+}
+
+int32 Crypto_TM_QueuePacket(char* packet, int len_packet)
+{
+    return Crypto_Instance_TM_QueuePacket(&crypto_default, packet, len_packet);
+}
+
+int32 Crypto_TM_NextFrame(char* frame, int* len_frame)
+{
+    return Crypto_Instance_TM_NextFrame(&crypto_default, frame, len_frame);
+}
+
+int32 Crypto_TM_ProcessSecurity(char* ingest, int* len_ingest)
+{
+    return Crypto_Instance_TM_ProcessSecurity(&crypto_default, ingest, len_ingest);
+}
+
+int32 Crypto_AOS_ApplySecurity(char* ingest, int* len_ingest)
+{
+    return Crypto_Instance_AOS_ApplySecurity(&crypto_default, ingest, len_ingest);
+}
+
+int32 Crypto_AOS_ProcessSecurity(char* ingest, int* len_ingest)
+{
+    return Crypto_Instance_AOS_ProcessSecurity(&crypto_default, ingest, len_ingest);
+}
+
+int32 Crypto_AOS_ProcessSecurityView(char* ingest, int len_ingest, crypto_aos_view_t* view)
+{
+    return Crypto_Instance_AOS_ProcessSecurityView(&crypto_default, ingest, len_ingest, view);
+}
+
+int32 Crypto_ApplySecurity(char* ingest, int* len_ingest)
+{
+    return Crypto_Instance_ApplySecurity(&crypto_default, ingest, len_ingest);
+}
+
+int32 Crypto_ProcessSecurity(char* ingest, int* len_ingest)
+{
+    return Crypto_Instance_ProcessSecurity(&crypto_default, ingest, len_ingest);
+}
+
 #endif
\ No newline at end of file
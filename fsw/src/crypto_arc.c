@@ -0,0 +1,157 @@
+/* Copyright (C) 2009 - 2017 National Aeronautics and Space Administration. All Foreign Rights are Reserved to the U.S. Government.
+
+This software is provided "as is" without any warranty of any, kind either express, implied, or statutory, including, but not
+limited to, any warranty that the software will conform to, specifications any implied warranties of merchantability, fitness
+for a particular purpose, and freedom from infringement, and any warranty that the documentation will conform to the program, or
+any warranty that the software will be error free.
+
+In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or consequential damages,
+arising out of, resulting from, or in any0 way connected with the software or its documentation.  Whether or not based upon warranty,
+contract, tort or otherwise, and whether or not loss was sustained from, or arose out of the results of, or use of, the software,
+documentation or services provided hereunder
+
+ITC Team
+NASA IV&V
+ivv-itc@lists.nasa.gov
+*/
+#ifndef _crypto_arc_c_
+#define _crypto_arc_c_
+
+/*
+** Includes
+*/
+#include "crypto.h"
+
+/*
+** Static Prototypes
+*/
+static int32  Crypto_ARC_high_cmp(uint8 *actual, uint8 *expected);
+
+/*
+** Anti-Replay Functions
+*/
+int32 Crypto_increment(uint8 *num, int length)
+// Adds one to a big endian counter, OS_ERROR when it wraps
+{
+    int i;
+    /* go from right (least significant) to left (most signifcant) */
+    for(i = length - 1; i >= 0; --i)
+    {
+        ++(num[i]); /* increment current byte */
+
+        if(num[i] != 0) /* if byte did not overflow, we're done! */
+           break;
+    }
+
+    if(i < 0) /* this means num[0] was incremented and overflowed */
+        return OS_ERROR;
+    else
+        return OS_SUCCESS;
+}
+
+uint64 Crypto_ARC_low(uint8 *iv)
+// Low 64 bits of a big endian IV, the part the anti-replay window counts in
+{
+    uint64 value = 0;
+
+    for (int i = ARC_HIGH_SIZE; i < IV_SIZE; i++)
+    {
+        value = (value << 8) | iv[i];
+    }
+    return value;
+}
+
+static int32 Crypto_ARC_high_cmp(uint8 *actual, uint8 *expected)
+// Compares the IV bytes above the low 64 bits, <0, 0 or >0
+{
+    for (int i = 0; i < ARC_HIGH_SIZE; i++)
+    {
+        if (actual[i] != expected[i])
+        {
+            return (actual[i] < expected[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+void Crypto_ARC_shift(SecurityAssociation_t* sa, uint64 shift)
+// Moves the window forward by shift counter values, new values start unseen
+{
+    uint64 words = shift / 64;
+    uint64 bits = shift % 64;
+
+    for (int i = ARC_WINDOW_WORDS - 1; i >= 0; i--)
+    {
+        uint64 value = 0;
+        if ((uint64) i >= words)
+        {
+            value = sa->arc_bitmap[i - words] << bits;
+            if ((bits > 0) && ((uint64) i > words))
+            {
+                value |= sa->arc_bitmap[i - words - 1] >> (64 - bits);
+            }
+        }
+        sa->arc_bitmap[i] = value;
+    }
+}
+
+void Crypto_ARC_reset(SecurityAssociation_t* sa)
+// Treats every counter below the expected IV as received, used whenever sa->iv is set directly
+{
+    for (int i = 0; i < ARC_WINDOW_WORDS; i++)
+    {
+        sa->arc_bitmap[i] = 0xFFFFFFFFFFFFFFFFULL;
+    }
+}
+
+int32 Crypto_ARC_check(SecurityAssociation_t* sa, uint8 *iv)
+// Sliding window anti-replay check (RFC 4303 style) of a received IV against the SA
+// Accepts up to arcw values at or past the expected IV, and unseen values up to ARC_WINDOW_BITS below it
+{
+    int32 status = OS_SUCCESS;
+    int32 high = Crypto_ARC_high_cmp(iv, sa->iv);
+    uint64 actual = Crypto_ARC_low(iv);
+    uint64 expected = Crypto_ARC_low(sa->iv);
+    uint64 offset;
+
+    if ((high > 0) || ((high == 0) && (actual >= expected)))
+    {   // At or ahead of the expected value
+        if ((high > 0) || ((actual - expected) >= sa->arcw[sa->arcw_len-1]))
+        {
+            status = ARC_OUTSIDE_WINDOW;
+        }
+    }
+    else if ((high < 0) || ((offset = expected - 1 - actual) >= ARC_WINDOW_BITS))
+    {   // Older than the window tracks
+        status = ARC_REPLAY;
+    }
+    else if (sa->arc_bitmap[offset / 64] & (1ULL << (offset % 64)))
+    {   // Already received
+        status = ARC_REPLAY;
+    }
+    return status;
+}
+
+void Crypto_ARC_update(SecurityAssociation_t* sa, uint8 *iv)
+// Records an authenticated IV accepted by Crypto_ARC_check
+{
+    uint64 actual = Crypto_ARC_low(iv);
+    uint64 expected = Crypto_ARC_low(sa->iv);
+    uint64 offset;
+
+    if ((Crypto_ARC_high_cmp(iv, sa->iv) > 0) || (actual >= expected))
+    {   // Advance expected IV past the received value, with or without INCREMENT, so a sender
+        // that repeats its IV is caught by the window rather than matching sa->iv again
+        CFE_PSP_MemCpy(sa->iv, iv, IV_SIZE);
+        Crypto_increment(sa->iv, IV_SIZE);
+        Crypto_ARC_shift(sa, Crypto_ARC_low(sa->iv) - expected);
+        sa->arc_bitmap[0] |= 1;
+    }
+    else
+    {   // Late frame inside the window
+        offset = expected - 1 - actual;
+        sa->arc_bitmap[offset / 64] |= (1ULL << (offset % 64));
+    }
+}
+
+#endif
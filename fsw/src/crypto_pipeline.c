@@ -0,0 +1,363 @@
+/* Copyright (C) 2009 - 2017 National Aeronautics and Space Administration. All Foreign Rights are Reserved to the U.S. Government.
+
+This software is provided "as is" without any warranty of any, kind either express, implied, or statutory, including, but not
+limited to, any warranty that the software will conform to, specifications any implied warranties of merchantability, fitness
+for a particular purpose, and freedom from infringement, and any warranty that the documentation will conform to the program, or
+any warranty that the software will be error free.
+
+In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or consequential damages,
+arising out of, resulting from, or in any0 way connected with the software or its documentation.  Whether or not based upon warranty,
+contract, tort or otherwise, and whether or not loss was sustained from, or arose out of the results of, or use of, the software,
+documentation or services provided hereunder
+
+ITC Team
+NASA IV&V
+ivv-itc@lists.nasa.gov
+*/
+#ifndef _crypto_pipeline_c_
+#define _crypto_pipeline_c_
+
+/*
+** Includes
+*/
+#include "crypto.h"
+
+#ifdef TC_PIPELINE
+
+#include <time.h>
+
+/*
+** Static Prototypes
+*/
+static uint64 Crypto_TC_Pipeline_now(void);
+static uint8  Crypto_TC_Pipeline_hash(crypto_tc_pipeline_t* pl, const char* ingest);
+static void   Crypto_TC_Pipeline_enter(crypto_tc_pipeline_t* pl);
+static void   Crypto_TC_Pipeline_leave(crypto_tc_pipeline_t* pl);
+static void   Crypto_TC_Pipeline_stop(crypto_tc_pipeline_t* pl);
+static void   Crypto_TC_Pipeline_resume(crypto_tc_pipeline_t* pl);
+static void*  Crypto_TC_Pipeline_worker(void* arg);
+
+/*
+** Assisting Functions
+*/
+static uint64 Crypto_TC_Pipeline_now(void)
+// Monotonic time in nanoseconds
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64) ts.tv_sec * 1000000000ULL) + (uint64) ts.tv_nsec;
+}
+
+static uint8 Crypto_TC_Pipeline_hash(crypto_tc_pipeline_t* pl, const char* ingest)
+// Maps the SPI of a TC frame onto a worker
+{
+    uint32 key = ((uint8)ingest[6] << 8) | (uint8)ingest[7];
+
+    // Fibonacci hashing spreads neighbouring SPIs, then scale onto the pool
+    key = key * 0x9E3779B1;
+    return (uint8) (((uint64) key * pl->num_workers) >> 32);
+}
+
+static void Crypto_TC_Pipeline_enter(crypto_tc_pipeline_t* pl)
+// Marks a worker busy with a frame, waits while SA state is being copied
+{
+    pthread_mutex_lock(&pl->sync_lock);
+    while (pl->sync == 1)
+    {
+        pthread_cond_wait(&pl->sync_cond, &pl->sync_lock);
+    }
+    pl->busy++;
+    pthread_mutex_unlock(&pl->sync_lock);
+}
+
+static void Crypto_TC_Pipeline_leave(crypto_tc_pipeline_t* pl)
+// Marks a worker done with its frame
+{
+    pthread_mutex_lock(&pl->sync_lock);
+    pl->busy--;
+    if (pl->busy == 0)
+    {
+        pthread_cond_broadcast(&pl->sync_cond);
+    }
+    pthread_mutex_unlock(&pl->sync_lock);
+}
+
+static void Crypto_TC_Pipeline_stop(crypto_tc_pipeline_t* pl)
+// Waits until no worker is inside a frame and keeps them out until resumed
+{
+    pthread_mutex_lock(&pl->sync_lock);
+    while (pl->sync == 1)
+    {
+        pthread_cond_wait(&pl->sync_cond, &pl->sync_lock);
+    }
+    pl->sync = 1;
+    while (pl->busy > 0)
+    {
+        pthread_cond_wait(&pl->sync_cond, &pl->sync_lock);
+    }
+    pthread_mutex_unlock(&pl->sync_lock);
+}
+
+static void Crypto_TC_Pipeline_resume(crypto_tc_pipeline_t* pl)
+// Lets the workers take frames again
+{
+    pthread_mutex_lock(&pl->sync_lock);
+    pl->sync = 0;
+    pthread_cond_broadcast(&pl->sync_cond);
+    pthread_mutex_unlock(&pl->sync_lock);
+}
+
+static void* Crypto_TC_Pipeline_worker(void* arg)
+// Drains one worker queue through its own crypto instance
+{
+    crypto_tc_pipeline_worker_t* w = (crypto_tc_pipeline_worker_t*) arg;
+    crypto_tc_pipeline_t* pl = (crypto_tc_pipeline_t*) w->pipeline;
+    crypto_tc_pipeline_slot_t* slot;
+    int32 status;
+    int len;
+    uint64 start;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&w->lock);
+        while ((w->count == 0) && (w->stop == 0))
+        {
+            pthread_cond_wait(&w->not_empty, &w->lock);
+        }
+        if (w->count == 0)
+        {   // Stopped and drained
+            pthread_mutex_unlock(&w->lock);
+            break;
+        }
+        // The head slot stays owned by this worker until head advances
+        slot = &w->queue[w->head];
+        pthread_mutex_unlock(&w->lock);
+
+        len = slot->len;
+        start = Crypto_TC_Pipeline_now();
+        Crypto_TC_Pipeline_enter(pl);
+        status = Crypto_Instance_TC_ProcessSecurity(&w->inst, slot->frame, &len);
+        Crypto_TC_Pipeline_leave(pl);
+        if (w->inst.tc_sdls == 1)
+        {   // Key and SA management must reach every worker before its frame is released
+            Crypto_TC_Pipeline_stop(pl);
+            for (uint8 x = 0; x < pl->num_workers; x++)
+            {
+                if (x != w->id)
+                {
+                    Crypto_Instance_SDLS_replay(&pl->worker[x].inst, &w->inst);
+                }
+            }
+            Crypto_TC_Pipeline_resume(pl);
+        }
+        if (pl->cb != NULL)
+        {
+            pl->cb(pl->cb_arg, w->id, status, &w->inst.tc_frame, slot->frame, len);
+        }
+
+        pthread_mutex_lock(&w->lock);
+        w->stats.busy_ns += Crypto_TC_Pipeline_now() - start;
+        w->stats.bytes += slot->len;
+        w->stats.frames++;
+        if (status != OS_SUCCESS)
+        {
+            w->stats.errors++;
+        }
+        w->head = (w->head + 1) % TC_PIPELINE_QUEUE_DEPTH;
+        w->count--;
+        pthread_cond_signal(&w->not_full);
+        if (w->count == 0)
+        {
+            pthread_cond_broadcast(&w->drained);
+        }
+        pthread_mutex_unlock(&w->lock);
+    }
+
+    return NULL;
+}
+
+/*
+** Pipeline Functions
+*/
+int32 Crypto_TC_Pipeline_Init(crypto_tc_pipeline_t* pl, uint8 num_workers, uint8 provider_id,
+                              crypto_tc_pipeline_cb_t cb, void* cb_arg)
+// Starts num_workers threads, each with an independent crypto instance
+{
+    int32 status = OS_SUCCESS;
+    crypto_tc_pipeline_worker_t* w;
+
+    if ((num_workers == 0) || (num_workers > TC_PIPELINE_MAX_WORKERS))
+    {
+        OS_printf(KRED "Error: TC pipeline supports 1 to %d workers! \n" RESET, TC_PIPELINE_MAX_WORKERS);
+        status = OS_ERROR;
+        return status;
+    }
+
+    pl->num_workers = 0;
+    pl->cb = cb;
+    pl->cb_arg = cb_arg;
+    pl->start_ns = Crypto_TC_Pipeline_now();
+    pl->busy = 0;
+    pl->sync = 0;
+    pthread_mutex_init(&pl->sync_lock, NULL);
+    pthread_cond_init(&pl->sync_cond, NULL);
+
+    for (uint8 x = 0; x < num_workers; x++)
+    {
+        w = &pl->worker[x];
+        status = Crypto_Instance_Init(&w->inst, provider_id);
+        if (status != OS_SUCCESS)
+        {
+            break;
+        }
+        w->head = 0;
+        w->tail = 0;
+        w->count = 0;
+        w->id = x;
+        w->stop = 0;
+        w->pipeline = pl;
+        CFE_PSP_MemSet(&w->stats, 0, sizeof(crypto_tc_pipeline_stats_t));
+        pthread_mutex_init(&w->lock, NULL);
+        pthread_cond_init(&w->not_empty, NULL);
+        pthread_cond_init(&w->not_full, NULL);
+        pthread_cond_init(&w->drained, NULL);
+        if (pthread_create(&w->thread, NULL, Crypto_TC_Pipeline_worker, w) != 0)
+        {
+            OS_printf(KRED "Error: TC pipeline worker %d failed to start! \n" RESET, x);
+            Crypto_Instance_Free(&w->inst);
+            status = OS_ERROR;
+            break;
+        }
+        pl->num_workers++;
+    }
+
+    if (status != OS_SUCCESS)
+    {   // Stop the workers that did start
+        Crypto_TC_Pipeline_Free(pl);
+    }
+
+    return status;
+}
+
+int32 Crypto_TC_Pipeline_Load(crypto_tc_pipeline_t* pl, const crypto_instance_t* src)
+// Gives every worker the SAs, keys and channel index of src, safe while frames are in flight
+{
+    int32 status = OS_SUCCESS;
+
+    Crypto_TC_Pipeline_stop(pl);
+    for (uint8 x = 0; x < pl->num_workers; x++)
+    {
+        Crypto_Instance_SA_copy(&pl->worker[x].inst, src);
+    }
+    Crypto_TC_Pipeline_resume(pl);
+
+    return status;
+}
+
+int32 Crypto_TC_Pipeline_Submit(crypto_tc_pipeline_t* pl, const char* ingest, int len_ingest)
+// Queues a copy of a TC frame on the worker of its channel, blocks while that queue is full
+{
+    int32 status = OS_SUCCESS;
+    crypto_tc_pipeline_worker_t* w;
+
+    // Primary header and SPI are needed to pick a worker
+    if ((len_ingest < 8) || (len_ingest > TC_PIPELINE_FRAME_SIZE))
+    {
+        OS_printf(KRED "Error: TC pipeline frame length %d invalid! \n" RESET, len_ingest);
+        status = OS_ERROR;
+        return status;
+    }
+
+    w = &pl->worker[Crypto_TC_Pipeline_hash(pl, ingest)];
+
+    pthread_mutex_lock(&w->lock);
+    while (w->count == TC_PIPELINE_QUEUE_DEPTH)
+    {
+        pthread_cond_wait(&w->not_full, &w->lock);
+    }
+    CFE_PSP_MemCpy(w->queue[w->tail].frame, ingest, len_ingest);
+    w->queue[w->tail].len = len_ingest;
+    w->tail = (w->tail + 1) % TC_PIPELINE_QUEUE_DEPTH;
+    w->count++;
+    pthread_cond_signal(&w->not_empty);
+    pthread_mutex_unlock(&w->lock);
+
+    return status;
+}
+
+int32 Crypto_TC_Pipeline_Flush(crypto_tc_pipeline_t* pl)
+// Waits until every queued frame has been processed
+{
+    int32 status = OS_SUCCESS;
+    crypto_tc_pipeline_worker_t* w;
+
+    for (uint8 x = 0; x < pl->num_workers; x++)
+    {
+        w = &pl->worker[x];
+        pthread_mutex_lock(&w->lock);
+        while (w->count > 0)
+        {
+            pthread_cond_wait(&w->drained, &w->lock);
+        }
+        pthread_mutex_unlock(&w->lock);
+    }
+
+    return status;
+}
+
+int32 Crypto_TC_Pipeline_Stats(crypto_tc_pipeline_t* pl, uint8 worker, crypto_tc_pipeline_stats_t* stats)
+// Snapshot of the throughput counters of one worker
+{
+    int32 status = OS_SUCCESS;
+    crypto_tc_pipeline_worker_t* w;
+
+    if (worker >= pl->num_workers)
+    {
+        status = OS_ERROR;
+        return status;
+    }
+
+    w = &pl->worker[worker];
+    pthread_mutex_lock(&w->lock);
+    *stats = w->stats;
+    pthread_mutex_unlock(&w->lock);
+    stats->elapsed_ns = Crypto_TC_Pipeline_now() - pl->start_ns;
+
+    return status;
+}
+
+int32 Crypto_TC_Pipeline_Free(crypto_tc_pipeline_t* pl)
+// Processes what is still queued, then stops the workers and releases their instances
+{
+    int32 status = OS_SUCCESS;
+    crypto_tc_pipeline_worker_t* w;
+
+    for (uint8 x = 0; x < pl->num_workers; x++)
+    {
+        w = &pl->worker[x];
+        pthread_mutex_lock(&w->lock);
+        w->stop = 1;
+        pthread_cond_signal(&w->not_empty);
+        pthread_mutex_unlock(&w->lock);
+    }
+    for (uint8 x = 0; x < pl->num_workers; x++)
+    {
+        w = &pl->worker[x];
+        pthread_join(w->thread, NULL);
+        Crypto_Instance_Free(&w->inst);
+        pthread_cond_destroy(&w->drained);
+        pthread_cond_destroy(&w->not_full);
+        pthread_cond_destroy(&w->not_empty);
+        pthread_mutex_destroy(&w->lock);
+    }
+    pl->num_workers = 0;
+    pthread_cond_destroy(&pl->sync_cond);
+    pthread_mutex_destroy(&pl->sync_lock);
+
+    return status;
+}
+
+#endif
+
+#endif
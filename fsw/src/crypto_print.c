@@ -200,4 +200,30 @@ void Crypto_saPrint(SecurityAssociation_t* sa)
     OS_printf("\t arcw[0]    = 0x%02x \n", sa->arcw[0]);
 }
 
+#ifdef TC_PIPELINE
+void Crypto_tcPipelinePrint(crypto_tc_pipeline_t* pl)
+// Prints the throughput of every TC pipeline worker
+{
+    crypto_tc_pipeline_stats_t stats;
+
+    OS_printf("TC pipeline workers: \n");
+    for (uint8 x = 0; x < pl->num_workers; x++)
+    {
+        Crypto_TC_Pipeline_Stats(pl, x, &stats);
+        OS_printf("\t worker[%d] frames = %u, errors = %u, bytes = %llu", x, 
+                    stats.frames, stats.errors, (unsigned long long) stats.bytes);
+        if (stats.busy_ns > 0)
+        {   // Bytes per nanosecond scaled to Mbit/s
+            OS_printf(", %.1f Mbps busy", (double) stats.bytes * 8000.0 / (double) stats.busy_ns);
+        }
+        if (stats.elapsed_ns > 0)
+        {
+            OS_printf(", %.1f Mbps wall", (double) stats.bytes * 8000.0 / (double) stats.elapsed_ns);
+        }
+        OS_printf("\n");
+    }
+    OS_printf("\n");
+}
+#endif
+
 #endif
\ No newline at end of file
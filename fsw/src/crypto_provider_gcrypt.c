@@ -0,0 +1,266 @@
+/* Copyright (C) 2009 - 2017 National Aeronautics and Space Administration. All Foreign Rights are Reserved to the U.S. Government.
+
+This software is provided "as is" without any warranty of any, kind either express, implied, or statutory, including, but not
+limited to, any warranty that the software will conform to, specifications any implied warranties of merchantability, fitness
+for a particular purpose, and freedom from infringement, and any warranty that the documentation will conform to the program, or
+any warranty that the software will be error free.
+
+In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or consequential damages,
+arising out of, resulting from, or in any0 way connected with the software or its documentation.  Whether or not based upon warranty,
+contract, tort or otherwise, and whether or not loss was sustained from, or arose out of the results of, or use of, the software,
+documentation or services provided hereunder
+
+ITC Team
+NASA IV&V
+ivv-itc@lists.nasa.gov
+*/
+#ifndef _crypto_provider_gcrypt_c_
+#define _crypto_provider_gcrypt_c_
+
+/*
+** Includes
+*/
+#include "crypto.h"
+
+/*
+** Static Prototypes
+*/
+static int32 Crypto_Gcrypt_init(void);
+static int32 Crypto_Gcrypt_key_load(crypto_provider_ctx_t* ctx, const uint8* key, uint16 key_len);
+static void  Crypto_Gcrypt_key_unload(crypto_provider_ctx_t* ctx);
+static int32 Crypto_Gcrypt_aead_encrypt(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                                        const uint8* aad, uint32 aad_len, const uint8* in, uint8* out, uint32 len,
+                                        uint8* mac, uint16 mac_len);
+static int32 Crypto_Gcrypt_aead_decrypt(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                                        const uint8* aad, uint32 aad_len, const uint8* in, uint8* out, uint32 len,
+                                        const uint8* mac, uint16 mac_len);
+static int32 Crypto_Gcrypt_mac(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                               const uint8* data, uint32 len, uint8* mac, uint16 mac_len);
+static int32 Crypto_Gcrypt_ctr(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                               const uint8* in, uint8* out, uint32 len);
+static int32 Crypto_Gcrypt_start(gcry_cipher_hd_t hd, const uint8* iv, uint16 iv_len, const uint8* aad, uint32 aad_len);
+
+/*
+** Provider Table
+*/
+const crypto_provider_t crypto_provider_gcrypt =
+{
+    "libgcrypt",
+    Crypto_Gcrypt_init,
+    Crypto_Gcrypt_key_load,
+    Crypto_Gcrypt_key_unload,
+    Crypto_Gcrypt_aead_encrypt,
+    Crypto_Gcrypt_aead_decrypt,
+    Crypto_Gcrypt_mac,
+    Crypto_Gcrypt_ctr
+};
+
+// Logs a libgcrypt error and maps it to OS_ERROR
+#define GCRY_CHECK(call, err)                                                                   \
+    do {                                                                                        \
+        if(((err) & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)                                     \
+        {                                                                                       \
+            OS_printf(KRED "ERROR: " call " error code %d\n" RESET, (err) & GPG_ERR_CODE_MASK); \
+            return OS_ERROR;                                                                    \
+        }                                                                                       \
+    } while (0)
+
+/*
+** Provider Functions
+*/
+static int32 Crypto_Gcrypt_init(void)
+{
+    int32 status = OS_SUCCESS;
+
+    if (!gcry_check_version(GCRYPT_VERSION))
+    {
+        OS_printf(KRED "ERROR: gcrypt version mismatch! \n" RESET);
+    }
+    if (gcry_control(GCRYCTL_SELFTEST) != GPG_ERR_NO_ERROR)
+    {
+        OS_printf(KRED "ERROR: gcrypt self test failed\n" RESET);
+    }
+    gcry_control(GCRYCTL_INITIALIZATION_FINISHED, 0);
+
+    return status;
+}
+
+static int32 Crypto_Gcrypt_key_load(crypto_provider_ctx_t* ctx, const uint8* key, uint16 key_len)
+{
+    gcry_error_t gcry_error = GPG_ERR_NO_ERROR;
+    int algo;
+
+    switch (key_len)
+    {
+        case 16: algo = GCRY_CIPHER_AES128; break;
+        case 24: algo = GCRY_CIPHER_AES192; break;
+        case 32: algo = GCRY_CIPHER_AES256; break;
+        default:
+            OS_printf(KRED "ERROR: unsupported key length %d\n" RESET, key_len);
+            return OS_ERROR;
+    }
+
+    gcry_error = gcry_cipher_open(
+        &(ctx->gcry.gcm),
+        algo,
+        GCRY_CIPHER_MODE_GCM,
+        GCRY_CIPHER_CBC_MAC
+    );
+    GCRY_CHECK("gcry_cipher_open", gcry_error);
+
+    gcry_error = gcry_cipher_open(&(ctx->gcry.ctr), algo, GCRY_CIPHER_MODE_CTR, 0);
+    if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    {
+        OS_printf(KRED "ERROR: gcry_cipher_open error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
+        gcry_cipher_close(ctx->gcry.gcm);
+        return OS_ERROR;
+    }
+
+    gcry_error = gcry_cipher_setkey(ctx->gcry.gcm, key, key_len);
+    if((gcry_error & GPG_ERR_CODE_MASK) == GPG_ERR_NO_ERROR)
+    {
+        gcry_error = gcry_cipher_setkey(ctx->gcry.ctr, key, key_len);
+    }
+    if((gcry_error & GPG_ERR_CODE_MASK) != GPG_ERR_NO_ERROR)
+    {
+        OS_printf(KRED "ERROR: gcry_cipher_setkey error code %d\n" RESET, gcry_error & GPG_ERR_CODE_MASK);
+        gcry_cipher_close(ctx->gcry.gcm);
+        gcry_cipher_close(ctx->gcry.ctr);
+        return OS_ERROR;
+    }
+
+    return OS_SUCCESS;
+}
+
+static void Crypto_Gcrypt_key_unload(crypto_provider_ctx_t* ctx)
+{
+    gcry_cipher_close(ctx->gcry.gcm);
+    gcry_cipher_close(ctx->gcry.ctr);
+}
+
+static int32 Crypto_Gcrypt_start(gcry_cipher_hd_t hd, const uint8* iv, uint16 iv_len, const uint8* aad, uint32 aad_len)
+// Clears the previous message from a keyed handle and loads IV and AAD.
+// AAD has to go in before any data or libgcrypt rejects it.
+{
+    gcry_error_t gcry_error = GPG_ERR_NO_ERROR;
+
+    gcry_error = gcry_cipher_reset(hd);
+    GCRY_CHECK("gcry_cipher_reset", gcry_error);
+
+    gcry_error = gcry_cipher_setiv(hd, iv, iv_len);
+    GCRY_CHECK("gcry_cipher_setiv", gcry_error);
+
+    if (aad_len > 0)
+    {
+        gcry_error = gcry_cipher_authenticate(hd, aad, aad_len);
+        GCRY_CHECK("gcry_cipher_authenticate", gcry_error);
+    }
+    return OS_SUCCESS;
+}
+
+static int32 Crypto_Gcrypt_aead_encrypt(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                                        const uint8* aad, uint32 aad_len, const uint8* in, uint8* out, uint32 len,
+                                        uint8* mac, uint16 mac_len)
+{
+    gcry_error_t gcry_error = GPG_ERR_NO_ERROR;
+
+    if (Crypto_Gcrypt_start(ctx->gcry.gcm, iv, iv_len, aad, aad_len) != OS_SUCCESS)
+    {
+        return OS_ERROR;
+    }
+
+    if (in == out)
+    {   // In place encryption
+        gcry_error = gcry_cipher_encrypt(ctx->gcry.gcm, out, len, NULL, 0);
+    }
+    else
+    {
+        gcry_error = gcry_cipher_encrypt(ctx->gcry.gcm, out, len, in, len);
+    }
+    GCRY_CHECK("gcry_cipher_encrypt", gcry_error);
+
+    gcry_error = gcry_cipher_gettag(ctx->gcry.gcm, mac, mac_len);
+    GCRY_CHECK("gcry_cipher_gettag", gcry_error);
+
+    return OS_SUCCESS;
+}
+
+static int32 Crypto_Gcrypt_aead_decrypt(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                                        const uint8* aad, uint32 aad_len, const uint8* in, uint8* out, uint32 len,
+                                        const uint8* mac, uint16 mac_len)
+{
+    gcry_error_t gcry_error = GPG_ERR_NO_ERROR;
+
+    if (Crypto_Gcrypt_start(ctx->gcry.gcm, iv, iv_len, aad, aad_len) != OS_SUCCESS)
+    {
+        return OS_ERROR;
+    }
+
+    if (in == out)
+    {   // In place decryption
+        gcry_error = gcry_cipher_decrypt(ctx->gcry.gcm, out, len, NULL, 0);
+    }
+    else
+    {
+        gcry_error = gcry_cipher_decrypt(ctx->gcry.gcm, out, len, in, len);
+    }
+    GCRY_CHECK("gcry_cipher_decrypt", gcry_error);
+
+    gcry_error = gcry_cipher_checktag(ctx->gcry.gcm, mac, mac_len);
+    if((gcry_error & GPG_ERR_CODE_MASK) == GPG_ERR_CHECKSUM)
+    {
+        return CRYPTO_PROVIDER_BAD_MAC;
+    }
+    GCRY_CHECK("gcry_cipher_checktag", gcry_error);
+
+    return OS_SUCCESS;
+}
+
+static int32 Crypto_Gcrypt_mac(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                               const uint8* data, uint32 len, uint8* mac, uint16 mac_len)
+{
+    gcry_error_t gcry_error = GPG_ERR_NO_ERROR;
+
+    if (Crypto_Gcrypt_start(ctx->gcry.gcm, iv, iv_len, data, len) != OS_SUCCESS)
+    {
+        return OS_ERROR;
+    }
+
+    gcry_error = gcry_cipher_gettag(ctx->gcry.gcm, mac, mac_len);
+    GCRY_CHECK("gcry_cipher_gettag", gcry_error);
+
+    return OS_SUCCESS;
+}
+
+static int32 Crypto_Gcrypt_ctr(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                               const uint8* in, uint8* out, uint32 len)
+// GCM's counter blocks: the 96-bit IV followed by a 32-bit block counter starting at 2
+{
+    gcry_error_t gcry_error = GPG_ERR_NO_ERROR;
+    uint8 ctr[16] = {0};
+
+    if (iv_len != 12)
+    {
+        OS_printf(KRED "ERROR: AES-CTR needs a 12 byte IV, got %d\n" RESET, iv_len);
+        return OS_ERROR;
+    }
+    CFE_PSP_MemCpy(ctr, iv, iv_len);
+    ctr[15] = 0x02;
+
+    gcry_error = gcry_cipher_setctr(ctx->gcry.ctr, ctr, sizeof(ctr));
+    GCRY_CHECK("gcry_cipher_setctr", gcry_error);
+
+    if (in == out)
+    {
+        gcry_error = gcry_cipher_encrypt(ctx->gcry.ctr, out, len, NULL, 0);
+    }
+    else
+    {
+        gcry_error = gcry_cipher_encrypt(ctx->gcry.ctr, out, len, in, len);
+    }
+    GCRY_CHECK("gcry_cipher_encrypt", gcry_error);
+
+    return OS_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,161 @@
+/* Copyright (C) 2009 - 2017 National Aeronautics and Space Administration. All Foreign Rights are Reserved to the U.S. Government.
+
+This software is provided "as is" without any warranty of any, kind either express, implied, or statutory, including, but not
+limited to, any warranty that the software will conform to, specifications any implied warranties of merchantability, fitness
+for a particular purpose, and freedom from infringement, and any warranty that the documentation will conform to the program, or
+any warranty that the software will be error free.
+
+In no event shall NASA be liable for any damages, including, but not limited to direct, indirect, special or consequential damages,
+arising out of, resulting from, or in any0 way connected with the software or its documentation.  Whether or not based upon warranty,
+contract, tort or otherwise, and whether or not loss was sustained from, or arose out of the results of, or use of, the software,
+documentation or services provided hereunder
+
+ITC Team
+NASA IV&V
+ivv-itc@lists.nasa.gov
+*/
+#ifndef _crypto_provider_itc_c_
+#define _crypto_provider_itc_c_
+
+/*
+** Includes
+*/
+#include "crypto.h"
+
+/*
+** Static Prototypes
+*/
+static int32 Crypto_ITC_init(void);
+static int32 Crypto_ITC_key_load(crypto_provider_ctx_t* ctx, const uint8* key, uint16 key_len);
+static void  Crypto_ITC_key_unload(crypto_provider_ctx_t* ctx);
+static int32 Crypto_ITC_aead_encrypt(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                                     const uint8* aad, uint32 aad_len, const uint8* in, uint8* out, uint32 len,
+                                     uint8* mac, uint16 mac_len);
+static int32 Crypto_ITC_aead_decrypt(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                                     const uint8* aad, uint32 aad_len, const uint8* in, uint8* out, uint32 len,
+                                     const uint8* mac, uint16 mac_len);
+static int32 Crypto_ITC_mac(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                            const uint8* data, uint32 len, uint8* mac, uint16 mac_len);
+static int32 Crypto_ITC_ctr(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                            const uint8* in, uint8* out, uint32 len);
+static int32 Crypto_ITC_check(uint16 iv_len, uint16 mac_len);
+
+/*
+** Provider Table
+*/
+const crypto_provider_t crypto_provider_itc =
+{
+    "itc",
+    Crypto_ITC_init,
+    Crypto_ITC_key_load,
+    Crypto_ITC_key_unload,
+    Crypto_ITC_aead_encrypt,
+    Crypto_ITC_aead_decrypt,
+    Crypto_ITC_mac,
+    Crypto_ITC_ctr
+};
+
+/*
+** Provider Functions
+*/
+static int32 Crypto_ITC_init(void)
+{   // Nothing to set up; the AES/GHASH engines are chosen per key by cpuid
+    return OS_SUCCESS;
+}
+
+static int32 Crypto_ITC_check(uint16 iv_len, uint16 mac_len)
+// itc_gcm128 only takes 96-bit IVs and full 128-bit tags
+{
+    if ((iv_len != 12) || (mac_len != 16))
+    {
+        OS_printf(KRED "ERROR: itc_gcm128 needs a 12 byte IV and 16 byte MAC, got %d and %d\n" RESET, iv_len, mac_len);
+        return OS_ERROR;
+    }
+    return OS_SUCCESS;
+}
+
+static int32 Crypto_ITC_key_load(crypto_provider_ctx_t* ctx, const uint8* key, uint16 key_len)
+{
+    if (itc_gcm128_init_key(&(ctx->itc), key, key_len) != ITC_GCM128_SUCCESS)
+    {
+        OS_printf(KRED "ERROR: unsupported key length %d\n" RESET, key_len);
+        return OS_ERROR;
+    }
+    return OS_SUCCESS;
+}
+
+static void Crypto_ITC_key_unload(crypto_provider_ctx_t* ctx)
+{   // Don't leave the key schedule behind
+    CFE_PSP_MemSet(&(ctx->itc), 0, sizeof(ctx->itc));
+}
+
+static int32 Crypto_ITC_aead_encrypt(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                                     const uint8* aad, uint32 aad_len, const uint8* in, uint8* out, uint32 len,
+                                     uint8* mac, uint16 mac_len)
+{
+    int itc_error = ITC_GCM128_SUCCESS;
+
+    if (Crypto_ITC_check(iv_len, mac_len) != OS_SUCCESS)
+    {
+        return OS_ERROR;
+    }
+
+    itc_error = itc_gcm128_encrypt_and_tag(&(ctx->itc), iv, aad_len, aad, len, in, out, mac);
+    if (itc_error != ITC_GCM128_SUCCESS)
+    {
+        OS_printf(KRED "ERROR: itc_gcm128_encrypt_and_tag error code %d\n" RESET, itc_error);
+        return OS_ERROR;
+    }
+    return OS_SUCCESS;
+}
+
+static int32 Crypto_ITC_aead_decrypt(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                                     const uint8* aad, uint32 aad_len, const uint8* in, uint8* out, uint32 len,
+                                     const uint8* mac, uint16 mac_len)
+{
+    int itc_error = ITC_GCM128_SUCCESS;
+
+    if (Crypto_ITC_check(iv_len, mac_len) != OS_SUCCESS)
+    {
+        return OS_ERROR;
+    }
+
+    itc_error = itc_gcm128_decrypt(&(ctx->itc), iv, aad_len, aad, len, in, mac, out);
+    if (itc_error == ITC_GCM128_BAD_TAG)
+    {
+        return CRYPTO_PROVIDER_BAD_MAC;
+    }
+    if (itc_error != ITC_GCM128_SUCCESS)
+    {
+        OS_printf(KRED "ERROR: itc_gcm128_decrypt error code %d\n" RESET, itc_error);
+        return OS_ERROR;
+    }
+    return OS_SUCCESS;
+}
+
+static int32 Crypto_ITC_mac(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                            const uint8* data, uint32 len, uint8* mac, uint16 mac_len)
+{   // GMAC is GCM with everything in the AAD
+    return Crypto_ITC_aead_encrypt(ctx, iv, iv_len, data, len, NULL, NULL, 0, mac, mac_len);
+}
+
+static int32 Crypto_ITC_ctr(crypto_provider_ctx_t* ctx, const uint8* iv, uint16 iv_len,
+                            const uint8* in, uint8* out, uint32 len)
+{
+    int itc_error = ITC_GCM128_SUCCESS;
+
+    if (Crypto_ITC_check(iv_len, 16) != OS_SUCCESS)
+    {
+        return OS_ERROR;
+    }
+
+    itc_error = itc_gcm128_ctr(&(ctx->itc), iv, len, in, out);
+    if (itc_error != ITC_GCM128_SUCCESS)
+    {
+        OS_printf(KRED "ERROR: itc_gcm128_ctr error code %d\n" RESET, itc_error);
+        return OS_ERROR;
+    }
+    return OS_SUCCESS;
+}
+
+#endif
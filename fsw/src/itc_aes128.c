@@ -23,10 +23,13 @@
 #include <stddef.h>
 #include "itc_aes128.h"
 
+#if defined(ITC_AES128_AESNI)
+#include <cpuid.h>
+#include <wmmintrin.h>
+#endif
+
 #define NB            4    /* Number of columns in state */
-#define NK            4    /* Number of 32-bit words in key */
-#define KEY_LENGTH   16    /* Key length in bytes */
-#define NR           10    /* Number of rounds */
+#define BLOCK_LENGTH 16    /* Block (and round key) length in bytes */
 
 /* Comments:
 ** - Many of the areas that could use loops have been unrolled manually.
@@ -39,6 +42,7 @@
 *
 *******************************************************************************/
 
+#if !defined(ITC_AES128_BITSLICE)
 static const unsigned char sbox[256] = 
 {
     0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
@@ -78,6 +82,7 @@ static const unsigned char inverse_sbox[256] =
     0xa0, 0xe0, 0x3b, 0x4d, 0xae, 0x2a, 0xf5, 0xb0, 0xc8, 0xeb, 0xbb, 0x3c, 0x83, 0x53, 0x99, 0x61,
     0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d
 };
+#endif
 
 /* note: rcon[0] is never used */
 static const unsigned char rcon[11] = 
@@ -85,7 +90,110 @@ static const unsigned char rcon[11] =
     0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 
 };
 
-/* TODO: could add lookup tables for multiplication (tables for 2,3,9,11,13,14) */
+#if defined(ITC_AES128_TTABLE)
+/* Combined round tables: te0[x] is the MixColumns column for sbox[x], {2, 1, 1, 3} * S(x),
+** and td0[x] the InvMixColumns column for inverse_sbox[x], {14, 9, 13, 11} * S^-1(x).
+** The other three tables of the classic layout are byte rotations of these, which
+** keeps the cache footprint at 2KB.
+*/
+static const uint32_t te0[256] =
+{
+    0xc66363a5, 0xf87c7c84, 0xee777799, 0xf67b7b8d, 0xfff2f20d, 0xd66b6bbd, 0xde6f6fb1, 0x91c5c554,
+    0x60303050, 0x02010103, 0xce6767a9, 0x562b2b7d, 0xe7fefe19, 0xb5d7d762, 0x4dababe6, 0xec76769a,
+    0x8fcaca45, 0x1f82829d, 0x89c9c940, 0xfa7d7d87, 0xeffafa15, 0xb25959eb, 0x8e4747c9, 0xfbf0f00b,
+    0x41adadec, 0xb3d4d467, 0x5fa2a2fd, 0x45afafea, 0x239c9cbf, 0x53a4a4f7, 0xe4727296, 0x9bc0c05b,
+    0x75b7b7c2, 0xe1fdfd1c, 0x3d9393ae, 0x4c26266a, 0x6c36365a, 0x7e3f3f41, 0xf5f7f702, 0x83cccc4f,
+    0x6834345c, 0x51a5a5f4, 0xd1e5e534, 0xf9f1f108, 0xe2717193, 0xabd8d873, 0x62313153, 0x2a15153f,
+    0x0804040c, 0x95c7c752, 0x46232365, 0x9dc3c35e, 0x30181828, 0x379696a1, 0x0a05050f, 0x2f9a9ab5,
+    0x0e070709, 0x24121236, 0x1b80809b, 0xdfe2e23d, 0xcdebeb26, 0x4e272769, 0x7fb2b2cd, 0xea75759f,
+    0x1209091b, 0x1d83839e, 0x582c2c74, 0x341a1a2e, 0x361b1b2d, 0xdc6e6eb2, 0xb45a5aee, 0x5ba0a0fb,
+    0xa45252f6, 0x763b3b4d, 0xb7d6d661, 0x7db3b3ce, 0x5229297b, 0xdde3e33e, 0x5e2f2f71, 0x13848497,
+    0xa65353f5, 0xb9d1d168, 0x00000000, 0xc1eded2c, 0x40202060, 0xe3fcfc1f, 0x79b1b1c8, 0xb65b5bed,
+    0xd46a6abe, 0x8dcbcb46, 0x67bebed9, 0x7239394b, 0x944a4ade, 0x984c4cd4, 0xb05858e8, 0x85cfcf4a,
+    0xbbd0d06b, 0xc5efef2a, 0x4faaaae5, 0xedfbfb16, 0x864343c5, 0x9a4d4dd7, 0x66333355, 0x11858594,
+    0x8a4545cf, 0xe9f9f910, 0x04020206, 0xfe7f7f81, 0xa05050f0, 0x783c3c44, 0x259f9fba, 0x4ba8a8e3,
+    0xa25151f3, 0x5da3a3fe, 0x804040c0, 0x058f8f8a, 0x3f9292ad, 0x219d9dbc, 0x70383848, 0xf1f5f504,
+    0x63bcbcdf, 0x77b6b6c1, 0xafdada75, 0x42212163, 0x20101030, 0xe5ffff1a, 0xfdf3f30e, 0xbfd2d26d,
+    0x81cdcd4c, 0x180c0c14, 0x26131335, 0xc3ecec2f, 0xbe5f5fe1, 0x359797a2, 0x884444cc, 0x2e171739,
+    0x93c4c457, 0x55a7a7f2, 0xfc7e7e82, 0x7a3d3d47, 0xc86464ac, 0xba5d5de7, 0x3219192b, 0xe6737395,
+    0xc06060a0, 0x19818198, 0x9e4f4fd1, 0xa3dcdc7f, 0x44222266, 0x542a2a7e, 0x3b9090ab, 0x0b888883,
+    0x8c4646ca, 0xc7eeee29, 0x6bb8b8d3, 0x2814143c, 0xa7dede79, 0xbc5e5ee2, 0x160b0b1d, 0xaddbdb76,
+    0xdbe0e03b, 0x64323256, 0x743a3a4e, 0x140a0a1e, 0x924949db, 0x0c06060a, 0x4824246c, 0xb85c5ce4,
+    0x9fc2c25d, 0xbdd3d36e, 0x43acacef, 0xc46262a6, 0x399191a8, 0x319595a4, 0xd3e4e437, 0xf279798b,
+    0xd5e7e732, 0x8bc8c843, 0x6e373759, 0xda6d6db7, 0x018d8d8c, 0xb1d5d564, 0x9c4e4ed2, 0x49a9a9e0,
+    0xd86c6cb4, 0xac5656fa, 0xf3f4f407, 0xcfeaea25, 0xca6565af, 0xf47a7a8e, 0x47aeaee9, 0x10080818,
+    0x6fbabad5, 0xf0787888, 0x4a25256f, 0x5c2e2e72, 0x381c1c24, 0x57a6a6f1, 0x73b4b4c7, 0x97c6c651,
+    0xcbe8e823, 0xa1dddd7c, 0xe874749c, 0x3e1f1f21, 0x964b4bdd, 0x61bdbddc, 0x0d8b8b86, 0x0f8a8a85,
+    0xe0707090, 0x7c3e3e42, 0x71b5b5c4, 0xcc6666aa, 0x904848d8, 0x06030305, 0xf7f6f601, 0x1c0e0e12,
+    0xc26161a3, 0x6a35355f, 0xae5757f9, 0x69b9b9d0, 0x17868691, 0x99c1c158, 0x3a1d1d27, 0x279e9eb9,
+    0xd9e1e138, 0xebf8f813, 0x2b9898b3, 0x22111133, 0xd26969bb, 0xa9d9d970, 0x078e8e89, 0x339494a7,
+    0x2d9b9bb6, 0x3c1e1e22, 0x15878792, 0xc9e9e920, 0x87cece49, 0xaa5555ff, 0x50282878, 0xa5dfdf7a,
+    0x038c8c8f, 0x59a1a1f8, 0x09898980, 0x1a0d0d17, 0x65bfbfda, 0xd7e6e631, 0x844242c6, 0xd06868b8,
+    0x824141c3, 0x299999b0, 0x5a2d2d77, 0x1e0f0f11, 0x7bb0b0cb, 0xa85454fc, 0x6dbbbbd6, 0x2c16163a
+};
+
+static const uint32_t td0[256] =
+{
+    0x51f4a750, 0x7e416553, 0x1a17a4c3, 0x3a275e96, 0x3bab6bcb, 0x1f9d45f1, 0xacfa58ab, 0x4be30393,
+    0x2030fa55, 0xad766df6, 0x88cc7691, 0xf5024c25, 0x4fe5d7fc, 0xc52acbd7, 0x26354480, 0xb562a38f,
+    0xdeb15a49, 0x25ba1b67, 0x45ea0e98, 0x5dfec0e1, 0xc32f7502, 0x814cf012, 0x8d4697a3, 0x6bd3f9c6,
+    0x038f5fe7, 0x15929c95, 0xbf6d7aeb, 0x955259da, 0xd4be832d, 0x587421d3, 0x49e06929, 0x8ec9c844,
+    0x75c2896a, 0xf48e7978, 0x99583e6b, 0x27b971dd, 0xbee14fb6, 0xf088ad17, 0xc920ac66, 0x7dce3ab4,
+    0x63df4a18, 0xe51a3182, 0x97513360, 0x62537f45, 0xb16477e0, 0xbb6bae84, 0xfe81a01c, 0xf9082b94,
+    0x70486858, 0x8f45fd19, 0x94de6c87, 0x527bf8b7, 0xab73d323, 0x724b02e2, 0xe31f8f57, 0x6655ab2a,
+    0xb2eb2807, 0x2fb5c203, 0x86c57b9a, 0xd33708a5, 0x302887f2, 0x23bfa5b2, 0x02036aba, 0xed16825c,
+    0x8acf1c2b, 0xa779b492, 0xf307f2f0, 0x4e69e2a1, 0x65daf4cd, 0x0605bed5, 0xd134621f, 0xc4a6fe8a,
+    0x342e539d, 0xa2f355a0, 0x058ae132, 0xa4f6eb75, 0x0b83ec39, 0x4060efaa, 0x5e719f06, 0xbd6e1051,
+    0x3e218af9, 0x96dd063d, 0xdd3e05ae, 0x4de6bd46, 0x91548db5, 0x71c45d05, 0x0406d46f, 0x605015ff,
+    0x1998fb24, 0xd6bde997, 0x894043cc, 0x67d99e77, 0xb0e842bd, 0x07898b88, 0xe7195b38, 0x79c8eedb,
+    0xa17c0a47, 0x7c420fe9, 0xf8841ec9, 0x00000000, 0x09808683, 0x322bed48, 0x1e1170ac, 0x6c5a724e,
+    0xfd0efffb, 0x0f853856, 0x3daed51e, 0x362d3927, 0x0a0fd964, 0x685ca621, 0x9b5b54d1, 0x24362e3a,
+    0x0c0a67b1, 0x9357e70f, 0xb4ee96d2, 0x1b9b919e, 0x80c0c54f, 0x61dc20a2, 0x5a774b69, 0x1c121a16,
+    0xe293ba0a, 0xc0a02ae5, 0x3c22e043, 0x121b171d, 0x0e090d0b, 0xf28bc7ad, 0x2db6a8b9, 0x141ea9c8,
+    0x57f11985, 0xaf75074c, 0xee99ddbb, 0xa37f60fd, 0xf701269f, 0x5c72f5bc, 0x44663bc5, 0x5bfb7e34,
+    0x8b432976, 0xcb23c6dc, 0xb6edfc68, 0xb8e4f163, 0xd731dcca, 0x42638510, 0x13972240, 0x84c61120,
+    0x854a247d, 0xd2bb3df8, 0xaef93211, 0xc729a16d, 0x1d9e2f4b, 0xdcb230f3, 0x0d8652ec, 0x77c1e3d0,
+    0x2bb3166c, 0xa970b999, 0x119448fa, 0x47e96422, 0xa8fc8cc4, 0xa0f03f1a, 0x567d2cd8, 0x223390ef,
+    0x87494ec7, 0xd938d1c1, 0x8ccaa2fe, 0x98d40b36, 0xa6f581cf, 0xa57ade28, 0xdab78e26, 0x3fadbfa4,
+    0x2c3a9de4, 0x5078920d, 0x6a5fcc9b, 0x547e4662, 0xf68d13c2, 0x90d8b8e8, 0x2e39f75e, 0x82c3aff5,
+    0x9f5d80be, 0x69d0937c, 0x6fd52da9, 0xcf2512b3, 0xc8ac993b, 0x10187da7, 0xe89c636e, 0xdb3bbb7b,
+    0xcd267809, 0x6e5918f4, 0xec9ab701, 0x834f9aa8, 0xe6956e65, 0xaaffe67e, 0x21bccf08, 0xef15e8e6,
+    0xbae79bd9, 0x4a6f36ce, 0xea9f09d4, 0x29b07cd6, 0x31a4b2af, 0x2a3f2331, 0xc6a59430, 0x35a266c0,
+    0x744ebc37, 0xfc82caa6, 0xe090d0b0, 0x33a7d815, 0xf104984a, 0x41ecdaf7, 0x7fcd500e, 0x1791f62f,
+    0x764dd68d, 0x43efb04d, 0xccaa4d54, 0xe49604df, 0x9ed1b5e3, 0x4c6a881b, 0xc12c1fb8, 0x4665517f,
+    0x9d5eea04, 0x018c355d, 0xfa877473, 0xfb0b412e, 0xb3671d5a, 0x92dbd252, 0xe9105633, 0x6dd64713,
+    0x9ad7618c, 0x37a10c7a, 0x59f8148e, 0xeb133c89, 0xcea927ee, 0xb761c935, 0xe11ce5ed, 0x7a47b13c,
+    0x9cd2df59, 0x55f2733f, 0x1814ce79, 0x73c737bf, 0x53f7cdea, 0x5ffdaa5b, 0xdf3d6f14, 0x7844db86,
+    0xcaaff381, 0xb968c43e, 0x3824342c, 0xc2a3405f, 0x161dc372, 0xbce2250c, 0x283c498b, 0xff0d9541,
+    0x39a80171, 0x080cb3de, 0xd8b4e49c, 0x6456c190, 0x7bcb8461, 0xd532b670, 0x486c5c74, 0xd0b85742
+};
+
+#define ROTR8(x)     (((x) >> 8) | ((x) << 24))
+#define TE1(x)       ROTR8(te0[x])
+#define TE2(x)       ROTR8(TE1(x))
+#define TE3(x)       ROTR8(TE2(x))
+#define TD1(x)       ROTR8(td0[x])
+#define TD2(x)       ROTR8(TD1(x))
+#define TD3(x)       ROTR8(TD2(x))
+
+#define LOAD32(p)     (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | ((uint32_t)(p)[2] << 8) | (uint32_t)(p)[3])
+#define STORE32(p, v) do { (p)[0] = (unsigned char)((v) >> 24); (p)[1] = (unsigned char)((v) >> 16); \
+                           (p)[2] = (unsigned char)((v) >> 8);  (p)[3] = (unsigned char)(v); } while(0)
+
+static void expand_word_keys(struct itc_aes128_context *ctx);
+#endif
+
+#if defined(ITC_AES128_BITSLICE)
+static void bitslice_sub_word(unsigned char *word);
+static void expand_bitsliced_keys(struct itc_aes128_context *ctx);
+#endif
+
+#if defined(ITC_AES128_AESNI)
+static int  aesni_supported(void);
+static void aesni_init(struct itc_aes128_context *ctx);
+static void aesni_encrypt(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output);
+static void aesni_decrypt(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output);
+#endif
 
 /* Rotate a word (4 bytes) to the left by 1: {1, 2, 3, 4 } => {2, 3, 4, 1}
 ** Used for key expansion.
@@ -100,46 +208,90 @@ static void rotate_word_left(unsigned char *word)
     word[3] = temp;
 }
 
+/* Apply the S-box to each byte of a word. Used for key expansion. */
+static void sub_word(unsigned char *word)
+{
+#if defined(ITC_AES128_BITSLICE)
+    bitslice_sub_word(word);
+#else
+    word[0] = sbox[word[0]];
+    word[1] = sbox[word[1]];
+    word[2] = sbox[word[2]];
+    word[3] = sbox[word[3]];
+#endif
+}
+
 void itc_aes128_init(struct itc_aes128_context *ctx, const unsigned char *key)
+{
+    (void) itc_aes128_init_key(ctx, key, 16);
+}
+
+int itc_aes128_init_key(struct itc_aes128_context *ctx, const unsigned char *key, size_t key_length)
 {
     unsigned char temp[4];
     int rcon_iteration = 0;
-    int currentSize;
+    int currentSize, scheduleSize, keySize;
 
     assert(key != NULL);
     assert(ctx != NULL);
 
+    if(key_length != 16 && key_length != 24 && key_length != 32)
+        return ITC_AES128_BAD_KEY_LENGTH;
+
+    /* Nr = Nk + 6 */
+    keySize = (int) key_length;
+    ctx->nr = (keySize / 4) + 6;
+    scheduleSize = BLOCK_LENGTH * (ctx->nr + 1);
+
     /* first part is the key itself */
-    memcpy(ctx->key_schedule, key, KEY_LENGTH * sizeof(unsigned char));
+    memcpy(ctx->key_schedule, key, key_length * sizeof(unsigned char));
 
-    currentSize = KEY_LENGTH;
-    while(currentSize < KS_LENGTH)
+    currentSize = keySize;
+    while(currentSize < scheduleSize)
     {
         /* store previous 4 bytes in temp array */
         memcpy(temp, ctx->key_schedule + (currentSize - 4), 4 * sizeof(unsigned char));
 
-        /* every 16 bytes, apply core schedule */
-        if(currentSize % KEY_LENGTH == 0)
+        /* every key length bytes, apply core schedule */
+        if(currentSize % keySize == 0)
         {
             rotate_word_left(temp);
-
-            temp[0] = sbox[temp[0]];
-            temp[1] = sbox[temp[1]];
-            temp[2] = sbox[temp[2]];
-            temp[3] = sbox[temp[3]];
-
+            sub_word(temp);
             temp[0] ^= rcon[++rcon_iteration];
         }
+        /* 256-bit keys also substitute the word halfway through each key length */
+        else if(keySize == 32 && currentSize % keySize == 16)
+        {
+            sub_word(temp);
+        }
 
-        /* next 4 bytes of key are the temp array XOR'd with 4 byte block 16 bytes back */
-        ctx->key_schedule[currentSize + 0] = ctx->key_schedule[currentSize - KEY_LENGTH + 0] ^ temp[0];
-        ctx->key_schedule[currentSize + 1] = ctx->key_schedule[currentSize - KEY_LENGTH + 1] ^ temp[1];
-        ctx->key_schedule[currentSize + 2] = ctx->key_schedule[currentSize - KEY_LENGTH + 2] ^ temp[2];
-        ctx->key_schedule[currentSize + 3] = ctx->key_schedule[currentSize - KEY_LENGTH + 3] ^ temp[3];
+        /* next 4 bytes of key are the temp array XOR'd with 4 byte block one key length back */
+        ctx->key_schedule[currentSize + 0] = ctx->key_schedule[currentSize - keySize + 0] ^ temp[0];
+        ctx->key_schedule[currentSize + 1] = ctx->key_schedule[currentSize - keySize + 1] ^ temp[1];
+        ctx->key_schedule[currentSize + 2] = ctx->key_schedule[currentSize - keySize + 2] ^ temp[2];
+        ctx->key_schedule[currentSize + 3] = ctx->key_schedule[currentSize - keySize + 3] ^ temp[3];
         currentSize += 4;
     }
+
+#if defined(ITC_AES128_TTABLE)
+    expand_word_keys(ctx);
+#elif defined(ITC_AES128_BITSLICE)
+    expand_bitsliced_keys(ctx);
+#endif
+
+#if defined(ITC_AES128_AESNI)
+    ctx->use_aesni = aesni_supported();
+    if(ctx->use_aesni)
+    {
+        aesni_init(ctx);
+    }
+#endif
+
+    return ITC_AES128_SUCCESS;
 }
 
+#if defined(ITC_AES128_BYTE)
+
 /*******************************************************************************
 *
 *                             State Array Mapping
@@ -426,12 +578,8 @@ static void aes_inverse_round(unsigned char state[4][4], const unsigned char *ke
 }
 
 /* TODO: use restrict keyword? */
-void itc_aes128_encrypt(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output)
+static void encrypt_block(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output)
 {
-    assert(ctx != NULL);
-    assert(input != NULL);
-    assert(output != NULL);
-
     unsigned char state[4][4];
     int i;
 
@@ -461,15 +609,15 @@ void itc_aes128_encrypt(const struct itc_aes128_context *ctx, const unsigned cha
     add_round_key(state, ctx->key_schedule);
 
     /* perform the first (n-1) rounds */
-    for(i = 1; i < NR; ++i)
+    for(i = 1; i < ctx->nr; ++i)
     {
-        aes_round(state, ctx->key_schedule + ((i * KEY_LENGTH) * sizeof(unsigned char)) );
+        aes_round(state, ctx->key_schedule + ((i * BLOCK_LENGTH) * sizeof(unsigned char)) );
     }
 
     /* ...and then last special round */
     sub_bytes(state);
     shift_rows(state);
-    add_round_key(state, ctx->key_schedule + ((NR * KEY_LENGTH) * sizeof(unsigned char)) );
+    add_round_key(state, ctx->key_schedule + ((ctx->nr * BLOCK_LENGTH) * sizeof(unsigned char)) );
     
     /********************** End AES Encryption Algorithm ***********************/
 
@@ -494,12 +642,8 @@ void itc_aes128_encrypt(const struct itc_aes128_context *ctx, const unsigned cha
 }
 
 
-void itc_aes128_decrypt(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output)
+static void decrypt_block(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output)
 {
-    assert(ctx != NULL);
-    assert(input != NULL);
-    assert(output != NULL);
-
     unsigned char state[4][4];
     int i;
 
@@ -524,12 +668,12 @@ void itc_aes128_decrypt(const struct itc_aes128_context *ctx, const unsigned cha
     }
 
     /********************* Start AES Decryption Algorithm **********************/
-    add_round_key(state, ctx->key_schedule + ((NR * KEY_LENGTH) * sizeof(unsigned char)));
+    add_round_key(state, ctx->key_schedule + ((ctx->nr * BLOCK_LENGTH) * sizeof(unsigned char)));
 
     /* perform rounds in reverse */
-    for(i = NR-1; i > 0; --i)
+    for(i = ctx->nr-1; i > 0; --i)
     {
-        aes_inverse_round(state, ctx->key_schedule + ((i * KEY_LENGTH) * sizeof(unsigned char)) );
+        aes_inverse_round(state, ctx->key_schedule + ((i * BLOCK_LENGTH) * sizeof(unsigned char)) );
     }
     inverse_shift_rows(state);
     inverse_sub_bytes(state);
@@ -559,4 +703,626 @@ void itc_aes128_decrypt(const struct itc_aes128_context *ctx, const unsigned cha
     }
 }
 
-#endif /* ITC_AES128_C */
\ No newline at end of file
+#endif /* ITC_AES128_BYTE */
+
+#if defined(ITC_AES128_TTABLE)
+/*******************************************************************************
+*
+*                          32-bit Word Implementation
+*
+* The state is held as four big endian column words. Each middle round is 16
+* table lookups and XORs; the final round uses the plain S-boxes.
+*
+*******************************************************************************/
+
+static void expand_word_keys(struct itc_aes128_context *ctx)
+{
+    int i, j;
+
+    for(i = 0; i < (ctx->nr + 1) * NB; ++i)
+    {
+        ctx->enc_words[i] = LOAD32(ctx->key_schedule + (4 * i));
+    }
+
+    /* equivalent inverse cipher: round keys in reverse order, InvMixColumns applied
+    ** to the middle rounds. td0[sbox[b]] is {14, 9, 13, 11} * b */
+    for(i = 0; i <= ctx->nr; ++i)
+    {
+        for(j = 0; j < NB; ++j)
+        {
+            uint32_t w = ctx->enc_words[((ctx->nr - i) * NB) + j];
+
+            if(i > 0 && i < ctx->nr)
+            {
+                w = td0[sbox[w >> 24]] ^ TD1(sbox[(w >> 16) & 0xff]) ^
+                    TD2(sbox[(w >> 8) & 0xff]) ^ TD3(sbox[w & 0xff]);
+            }
+            ctx->dec_words[(i * NB) + j] = w;
+        }
+    }
+}
+
+static void encrypt_block(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output)
+{
+    const uint32_t *rk = ctx->enc_words;
+    uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+    int i;
+
+    s0 = LOAD32(input)      ^ rk[0];
+    s1 = LOAD32(input + 4)  ^ rk[1];
+    s2 = LOAD32(input + 8)  ^ rk[2];
+    s3 = LOAD32(input + 12) ^ rk[3];
+
+    /* perform the first (n-1) rounds */
+    for(i = 1; i < ctx->nr; ++i)
+    {
+        rk += NB;
+        t0 = te0[s0 >> 24] ^ TE1((s1 >> 16) & 0xff) ^ TE2((s2 >> 8) & 0xff) ^ TE3(s3 & 0xff) ^ rk[0];
+        t1 = te0[s1 >> 24] ^ TE1((s2 >> 16) & 0xff) ^ TE2((s3 >> 8) & 0xff) ^ TE3(s0 & 0xff) ^ rk[1];
+        t2 = te0[s2 >> 24] ^ TE1((s3 >> 16) & 0xff) ^ TE2((s0 >> 8) & 0xff) ^ TE3(s1 & 0xff) ^ rk[2];
+        t3 = te0[s3 >> 24] ^ TE1((s0 >> 16) & 0xff) ^ TE2((s1 >> 8) & 0xff) ^ TE3(s2 & 0xff) ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+
+    /* ...and then last special round without MixColumns */
+    rk += NB;
+    t0 = ((uint32_t)sbox[s0 >> 24] << 24) ^ ((uint32_t)sbox[(s1 >> 16) & 0xff] << 16) ^
+         ((uint32_t)sbox[(s2 >> 8) & 0xff] << 8) ^ (uint32_t)sbox[s3 & 0xff] ^ rk[0];
+    t1 = ((uint32_t)sbox[s1 >> 24] << 24) ^ ((uint32_t)sbox[(s2 >> 16) & 0xff] << 16) ^
+         ((uint32_t)sbox[(s3 >> 8) & 0xff] << 8) ^ (uint32_t)sbox[s0 & 0xff] ^ rk[1];
+    t2 = ((uint32_t)sbox[s2 >> 24] << 24) ^ ((uint32_t)sbox[(s3 >> 16) & 0xff] << 16) ^
+         ((uint32_t)sbox[(s0 >> 8) & 0xff] << 8) ^ (uint32_t)sbox[s1 & 0xff] ^ rk[2];
+    t3 = ((uint32_t)sbox[s3 >> 24] << 24) ^ ((uint32_t)sbox[(s0 >> 16) & 0xff] << 16) ^
+         ((uint32_t)sbox[(s1 >> 8) & 0xff] << 8) ^ (uint32_t)sbox[s2 & 0xff] ^ rk[3];
+
+    STORE32(output,      t0);
+    STORE32(output + 4,  t1);
+    STORE32(output + 8,  t2);
+    STORE32(output + 12, t3);
+}
+
+static void decrypt_block(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output)
+{
+    const uint32_t *rk = ctx->dec_words;
+    uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+    int i;
+
+    s0 = LOAD32(input)      ^ rk[0];
+    s1 = LOAD32(input + 4)  ^ rk[1];
+    s2 = LOAD32(input + 8)  ^ rk[2];
+    s3 = LOAD32(input + 12) ^ rk[3];
+
+    for(i = 1; i < ctx->nr; ++i)
+    {
+        rk += NB;
+        t0 = td0[s0 >> 24] ^ TD1((s3 >> 16) & 0xff) ^ TD2((s2 >> 8) & 0xff) ^ TD3(s1 & 0xff) ^ rk[0];
+        t1 = td0[s1 >> 24] ^ TD1((s0 >> 16) & 0xff) ^ TD2((s3 >> 8) & 0xff) ^ TD3(s2 & 0xff) ^ rk[1];
+        t2 = td0[s2 >> 24] ^ TD1((s1 >> 16) & 0xff) ^ TD2((s0 >> 8) & 0xff) ^ TD3(s3 & 0xff) ^ rk[2];
+        t3 = td0[s3 >> 24] ^ TD1((s2 >> 16) & 0xff) ^ TD2((s1 >> 8) & 0xff) ^ TD3(s0 & 0xff) ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+
+    rk += NB;
+    t0 = ((uint32_t)inverse_sbox[s0 >> 24] << 24) ^ ((uint32_t)inverse_sbox[(s3 >> 16) & 0xff] << 16) ^
+         ((uint32_t)inverse_sbox[(s2 >> 8) & 0xff] << 8) ^ (uint32_t)inverse_sbox[s1 & 0xff] ^ rk[0];
+    t1 = ((uint32_t)inverse_sbox[s1 >> 24] << 24) ^ ((uint32_t)inverse_sbox[(s0 >> 16) & 0xff] << 16) ^
+         ((uint32_t)inverse_sbox[(s3 >> 8) & 0xff] << 8) ^ (uint32_t)inverse_sbox[s2 & 0xff] ^ rk[1];
+    t2 = ((uint32_t)inverse_sbox[s2 >> 24] << 24) ^ ((uint32_t)inverse_sbox[(s1 >> 16) & 0xff] << 16) ^
+         ((uint32_t)inverse_sbox[(s0 >> 8) & 0xff] << 8) ^ (uint32_t)inverse_sbox[s3 & 0xff] ^ rk[2];
+    t3 = ((uint32_t)inverse_sbox[s3 >> 24] << 24) ^ ((uint32_t)inverse_sbox[(s2 >> 16) & 0xff] << 16) ^
+         ((uint32_t)inverse_sbox[(s1 >> 8) & 0xff] << 8) ^ (uint32_t)inverse_sbox[s0 & 0xff] ^ rk[3];
+
+    STORE32(output,      t0);
+    STORE32(output + 4,  t1);
+    STORE32(output + 8,  t2);
+    STORE32(output + 12, t3);
+}
+
+#endif /* ITC_AES128_TTABLE */
+
+#if defined(ITC_AES128_BITSLICE)
+/*******************************************************************************
+*
+*                           Bitsliced Implementation
+*
+* The 16 state bytes are transposed into eight 16-bit slices: bit j of slice i
+* is bit i of state byte j (j in the column-wise order of the state mapping).
+* SubBytes is evaluated as a boolean circuit on all 16 bytes at once
+* (Boyar and Peralta, "A depth-16 circuit for the AES S-box"), ShiftRows and
+* MixColumns become rotations of the slices. There are no table lookups or
+* data dependent branches, so timing does not depend on key or data.
+*
+*******************************************************************************/
+
+#define ROTR16(x, n)   ((uint16_t)(((x) >> (n)) | ((x) << (16 - (n)))))
+/* bit (4 * col + row) <- bit (4 * col + row + n mod 4): the next rows of the same column */
+#define ROW_ROT1(x)    ((uint16_t)((((x) >> 1) & 0x7777) | (((x) << 3) & 0x8888)))
+#define ROW_ROT2(x)    ((uint16_t)((((x) >> 2) & 0x3333) | (((x) << 2) & 0xcccc)))
+
+static void bitslice_load(uint16_t q[8], const unsigned char *block)
+{
+    int i, j;
+
+    for(i = 0; i < 8; ++i)
+    {
+        q[i] = 0;
+        for(j = 0; j < 16; ++j)
+        {
+            q[i] |= (uint16_t)(((block[j] >> i) & 1) << j);
+        }
+    }
+}
+
+static void bitslice_store(const uint16_t q[8], unsigned char *block)
+{
+    int i, j;
+
+    for(j = 0; j < 16; ++j)
+    {
+        unsigned char b = 0;
+        for(i = 0; i < 8; ++i)
+        {
+            b |= (unsigned char)(((q[i] >> j) & 1) << i);
+        }
+        block[j] = b;
+    }
+}
+
+static void bitslice_sbox(uint16_t q[8])
+{
+    uint16_t x0, x1, x2, x3, x4, x5, x6, x7;
+    uint16_t y1, y2, y3, y4, y5, y6, y7, y8, y9;
+    uint16_t y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+    uint16_t y20, y21;
+    uint16_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+    uint16_t z10, z11, z12, z13, z14, z15, z16, z17;
+    uint16_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    uint16_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    uint16_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    uint16_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    uint16_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+    uint16_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    uint16_t t60, t61, t62, t63, t64, t65, t66, t67;
+    uint16_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7];
+    x1 = q[6];
+    x2 = q[5];
+    x3 = q[4];
+    x4 = q[3];
+    x5 = q[2];
+    x6 = q[1];
+    x7 = q[0];
+
+    /* top linear transformation */
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9 = x0 ^ x3;
+    y8 = x0 ^ x5;
+    t0 = x1 ^ x2;
+    y1 = t0 ^ x7;
+    y4 = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2 = y1 ^ x0;
+    y5 = y1 ^ x6;
+    y3 = y5 ^ y8;
+    t1 = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6 = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7 = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    /* non-linear section: inversion in GF(2^8) */
+    t2 = y12 & y15;
+    t3 = y3 & y6;
+    t4 = t3 ^ t2;
+    t5 = y4 & x7;
+    t6 = t5 ^ t2;
+    t7 = y13 & y16;
+    t8 = y5 & y1;
+    t9 = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15;
+    z1 = t37 & y6;
+    z2 = t33 & x7;
+    z3 = t43 & y16;
+    z4 = t40 & y1;
+    z5 = t29 & y7;
+    z6 = t42 & y11;
+    z7 = t45 & y17;
+    z8 = t41 & y10;
+    z9 = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    /* bottom linear transformation, including the affine constant 0x63 */
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0 = t59 ^ t63;
+    s6 = (uint16_t)(t56 ^ ~t62);
+    s7 = (uint16_t)(t48 ^ ~t60);
+    t67 = t64 ^ t65;
+    s3 = t53 ^ t66;
+    s4 = t51 ^ t66;
+    s5 = t47 ^ t65;
+    s1 = (uint16_t)(t64 ^ ~s3);
+    s2 = (uint16_t)(t55 ^ ~t67);
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+/* Inverse of the S-box affine transform: b'(i) = b(i+2) ^ b(i+5) ^ b(i+7) ^ 0x05(i) */
+static void bitslice_inverse_affine(uint16_t q[8])
+{
+    uint16_t t[8];
+    int i;
+
+    for(i = 0; i < 8; ++i)
+    {
+        t[i] = q[(i + 2) & 7] ^ q[(i + 5) & 7] ^ q[(i + 7) & 7];
+    }
+    for(i = 0; i < 8; ++i)
+    {
+        q[i] = t[i];
+    }
+    q[0] = (uint16_t)~q[0];
+    q[2] = (uint16_t)~q[2];
+}
+
+/* S^-1 = A^-1 o inv = A^-1 o (A^-1 o S), using that inversion is an involution */
+static void bitslice_inverse_sbox(uint16_t q[8])
+{
+    bitslice_inverse_affine(q);
+    bitslice_sbox(q);
+    bitslice_inverse_affine(q);
+}
+
+static void bitslice_sub_word(unsigned char *word)
+{
+    unsigned char block[16] = { 0 };
+    uint16_t q[8];
+
+    memcpy(block, word, 4);
+    bitslice_load(q, block);
+    bitslice_sbox(q);
+    bitslice_store(q, block);
+    memcpy(word, block, 4);
+}
+
+static void bitslice_shift_rows(uint16_t q[8])
+{
+    int i;
+
+    /* row r of the new state takes column (c + r), a right rotation by 4r bits */
+    for(i = 0; i < 8; ++i)
+    {
+        q[i] = (q[i] & 0x1111) | ROTR16(q[i] & 0x2222, 4) | ROTR16(q[i] & 0x4444, 8) | ROTR16(q[i] & 0x8888, 12);
+    }
+}
+
+static void bitslice_inverse_shift_rows(uint16_t q[8])
+{
+    int i;
+
+    for(i = 0; i < 8; ++i)
+    {
+        q[i] = (q[i] & 0x1111) | ROTR16(q[i] & 0x2222, 12) | ROTR16(q[i] & 0x4444, 8) | ROTR16(q[i] & 0x8888, 4);
+    }
+}
+
+/* multiply every byte by x (2) modulo x^8 + x^4 + x^3 + x + 1 */
+static void bitslice_xtime(const uint16_t a[8], uint16_t out[8])
+{
+    out[0] = a[7];
+    out[1] = a[0] ^ a[7];
+    out[2] = a[1];
+    out[3] = a[2] ^ a[7];
+    out[4] = a[3] ^ a[7];
+    out[5] = a[4];
+    out[6] = a[5];
+    out[7] = a[6];
+}
+
+/* out(r) = 2 a(r) ^ 3 a(r+1) ^ a(r+2) ^ a(r+3) = 2 t(r) ^ a(r+1) ^ t(r+2), t = a ^ rot1(a) */
+static void bitslice_mix_columns(uint16_t q[8])
+{
+    uint16_t r1[8], t[8], xt[8];
+    int i;
+
+    for(i = 0; i < 8; ++i)
+    {
+        r1[i] = ROW_ROT1(q[i]);
+        t[i] = q[i] ^ r1[i];
+    }
+    bitslice_xtime(t, xt);
+    for(i = 0; i < 8; ++i)
+    {
+        q[i] = xt[i] ^ r1[i] ^ ROW_ROT2(t[i]);
+    }
+}
+
+/* InvMixColumns = MixColumns o {5, 0, 4, 0}: a(r) ^ 4 (a(r) ^ a(r+2)) first */
+static void bitslice_inverse_mix_columns(uint16_t q[8])
+{
+    uint16_t u[8], x2[8], x4[8];
+    int i;
+
+    for(i = 0; i < 8; ++i)
+    {
+        u[i] = q[i] ^ ROW_ROT2(q[i]);
+    }
+    bitslice_xtime(u, x2);
+    bitslice_xtime(x2, x4);
+    for(i = 0; i < 8; ++i)
+    {
+        q[i] ^= x4[i];
+    }
+    bitslice_mix_columns(q);
+}
+
+static void bitslice_add_round_key(uint16_t q[8], const uint16_t key[8])
+{
+    int i;
+
+    for(i = 0; i < 8; ++i)
+    {
+        q[i] ^= key[i];
+    }
+}
+
+static void expand_bitsliced_keys(struct itc_aes128_context *ctx)
+{
+    int i;
+
+    for(i = 0; i <= ctx->nr; ++i)
+    {
+        bitslice_load(ctx->bitsliced_keys[i], ctx->key_schedule + (i * BLOCK_LENGTH));
+    }
+}
+
+static void encrypt_block(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output)
+{
+    uint16_t q[8];
+    int i;
+
+    bitslice_load(q, input);
+    bitslice_add_round_key(q, ctx->bitsliced_keys[0]);
+
+    for(i = 1; i < ctx->nr; ++i)
+    {
+        bitslice_sbox(q);
+        bitslice_shift_rows(q);
+        bitslice_mix_columns(q);
+        bitslice_add_round_key(q, ctx->bitsliced_keys[i]);
+    }
+
+    bitslice_sbox(q);
+    bitslice_shift_rows(q);
+    bitslice_add_round_key(q, ctx->bitsliced_keys[ctx->nr]);
+    bitslice_store(q, output);
+}
+
+static void decrypt_block(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output)
+{
+    uint16_t q[8];
+    int i;
+
+    bitslice_load(q, input);
+    bitslice_add_round_key(q, ctx->bitsliced_keys[ctx->nr]);
+
+    for(i = ctx->nr - 1; i > 0; --i)
+    {
+        bitslice_inverse_shift_rows(q);
+        bitslice_inverse_sbox(q);
+        bitslice_add_round_key(q, ctx->bitsliced_keys[i]);
+        bitslice_inverse_mix_columns(q);
+    }
+
+    bitslice_inverse_shift_rows(q);
+    bitslice_inverse_sbox(q);
+    bitslice_add_round_key(q, ctx->bitsliced_keys[0]);
+    bitslice_store(q, output);
+}
+
+#endif /* ITC_AES128_BITSLICE */
+
+#if defined(ITC_AES128_AESNI)
+/*******************************************************************************
+*
+*                              AES-NI Implementation
+*
+* Used whenever cpuid reports the AES instructions; the decision is stored in
+* the context by itc_aes128_init so GCM and CMAC pick it up without changes.
+*
+*******************************************************************************/
+
+static int aesni_supported(void)
+{
+    static int supported = -1;
+
+    if(supported < 0)
+    {
+        unsigned int eax, ebx, ecx, edx;
+
+        supported = (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_AES) && (edx & bit_SSE2)) ? 1 : 0;
+    }
+    return supported;
+}
+
+/* round keys come from the byte schedule built by itc_aes128_init_key */
+__attribute__((target("aes,sse2")))
+static void aesni_init(struct itc_aes128_context *ctx)
+{
+    __m128i *rk = ctx->aesni_enc_keys;
+    const int nr = ctx->nr;
+    int i;
+
+    for(i = 0; i <= nr; ++i)
+    {
+        rk[i] = _mm_loadu_si128((const __m128i *) (ctx->key_schedule + (i * BLOCK_LENGTH)));
+    }
+
+    /* equivalent inverse cipher keys for AESDEC */
+    ctx->aesni_dec_keys[0] = rk[nr];
+    for(i = 1; i < nr; ++i)
+    {
+        ctx->aesni_dec_keys[i] = _mm_aesimc_si128(rk[nr - i]);
+    }
+    ctx->aesni_dec_keys[nr] = rk[0];
+}
+
+__attribute__((target("aes,sse2")))
+static void aesni_encrypt(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output)
+{
+    const __m128i *rk = ctx->aesni_enc_keys;
+    __m128i block;
+    int i;
+
+    block = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input), rk[0]);
+    for(i = 1; i < ctx->nr; ++i)
+    {
+        block = _mm_aesenc_si128(block, rk[i]);
+    }
+    block = _mm_aesenclast_si128(block, rk[ctx->nr]);
+    _mm_storeu_si128((__m128i *) output, block);
+}
+
+__attribute__((target("aes,sse2")))
+static void aesni_decrypt(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output)
+{
+    const __m128i *rk = ctx->aesni_dec_keys;
+    __m128i block;
+    int i;
+
+    block = _mm_xor_si128(_mm_loadu_si128((const __m128i *) input), rk[0]);
+    for(i = 1; i < ctx->nr; ++i)
+    {
+        block = _mm_aesdec_si128(block, rk[i]);
+    }
+    block = _mm_aesdeclast_si128(block, rk[ctx->nr]);
+    _mm_storeu_si128((__m128i *) output, block);
+}
+
+#endif /* ITC_AES128_AESNI */
+
+/*******************************************************************************
+*
+*                                 Entry Points
+*
+*******************************************************************************/
+
+void itc_aes128_encrypt(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output)
+{
+    assert(ctx != NULL);
+    assert(input != NULL);
+    assert(output != NULL);
+
+#if defined(ITC_AES128_AESNI)
+    if(ctx->use_aesni)
+    {
+        aesni_encrypt(ctx, input, output);
+        return;
+    }
+#endif
+    encrypt_block(ctx, input, output);
+}
+
+void itc_aes128_decrypt(const struct itc_aes128_context *ctx, const unsigned char *input, unsigned char *output)
+{
+    assert(ctx != NULL);
+    assert(input != NULL);
+    assert(output != NULL);
+
+#if defined(ITC_AES128_AESNI)
+    if(ctx->use_aesni)
+    {
+        aesni_decrypt(ctx, input, output);
+        return;
+    }
+#endif
+    decrypt_block(ctx, input, output);
+}
+
+#endif /* ITC_AES128_C */
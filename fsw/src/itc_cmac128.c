@@ -3,6 +3,11 @@
 #include "itc_cmac128.h"
 
 void itc_cmac128_init(struct itc_cmac128_context * ctx, const unsigned char * key)
+{
+    (void) itc_cmac128_init_key(ctx, key, 16);
+}
+
+int itc_cmac128_init_key(struct itc_cmac128_context * ctx, const unsigned char * key, size_t key_length)
 {
     assert(ctx != NULL);
     assert(key != NULL);
@@ -11,7 +16,10 @@ void itc_cmac128_init(struct itc_cmac128_context * ctx, const unsigned char * ke
     unsigned char temp[16];
     size_t i;
 
-    itc_aes128_init(&(ctx->aes_ctx), key);
+    if(itc_aes128_init_key(&(ctx->aes_ctx), key, key_length) != ITC_AES128_SUCCESS)
+    {
+        return ITC_CMAC128_BAD_KEY_LENGTH;
+    }
 
     // Calculate intermediate value 'L'
     itc_aes128_encrypt(&(ctx->aes_ctx), zero_block, temp);
@@ -39,6 +47,8 @@ void itc_cmac128_init(struct itc_cmac128_context * ctx, const unsigned char * ke
     {
         ctx->k2[15] ^= 0x87;
     }
+
+    return ITC_CMAC128_SUCCESS;
 }
 
 int itc_cmac128_generate_tag( struct itc_cmac128_context *ctx, 
@@ -23,6 +23,18 @@
 #include <string.h>
 #include "itc_gcm128.h"
 
+#if defined(ITC_GCM128_CLMUL)
+#include <cpuid.h>
+#include <tmmintrin.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+/* stitched AES-CTR + GHASH kernel needs both AES-NI and PCLMULQDQ */
+#if defined(ITC_GCM128_CLMUL) && defined(ITC_AES128_AESNI)
+#define GCM_STITCHED
+#endif
+
 /* Representation of 128-bit blocks:
  *   To be as portable as possible, a 128-bit block will be represented as 
  *   a 16-byte unsigned char array.
@@ -41,6 +53,9 @@ enum itc_gcm128_mode
     ITC_GCM128_DECRYPT
 };
 
+/* update processes data in batches of this many bytes: CTR first, then one GHASH call */
+#define GCM_BATCH_LENGTH 128
+
 /* compare in constant time. Return zero if equal, non-zero otherwise */
 static int compare(const unsigned char * a, const unsigned char * b, size_t length)
 {
@@ -63,71 +78,498 @@ static void pack_uint32_big_endian(uint32 x, unsigned char *dest)
     dest[3] = (unsigned char) ((x)       & 0xff);
 }
 
-/* get the value of a certain bit ( 0 through 127) from a 128-bit block */
-static unsigned char get_bit(const unsigned char *block, unsigned char bit)
+/* 
+  GHASH multiplication by H (Shoup's method).
+  The context holds the products of H with every ITC_GCM128_TABLE_BITS-wide value,
+  split into high (hh) and low (hl) 64-bit halves of the block. x is consumed one
+  table index at a time from its last bits to its first, multiplying the running
+  product by x^ITC_GCM128_TABLE_BITS (a right shift in GCM bit order) in between.
+  The bits shifted out are folded back in with a reduction table.
+ */
+#if ITC_GCM128_TABLE_BITS == 8
+static const uint16 last8[256] = {
+    0x0000, 0x01c2, 0x0384, 0x0246, 0x0708, 0x06ca, 0x048c, 0x054e,
+    0x0e10, 0x0fd2, 0x0d94, 0x0c56, 0x0918, 0x08da, 0x0a9c, 0x0b5e,
+    0x1c20, 0x1de2, 0x1fa4, 0x1e66, 0x1b28, 0x1aea, 0x18ac, 0x196e,
+    0x1230, 0x13f2, 0x11b4, 0x1076, 0x1538, 0x14fa, 0x16bc, 0x177e,
+    0x3840, 0x3982, 0x3bc4, 0x3a06, 0x3f48, 0x3e8a, 0x3ccc, 0x3d0e,
+    0x3650, 0x3792, 0x35d4, 0x3416, 0x3158, 0x309a, 0x32dc, 0x331e,
+    0x2460, 0x25a2, 0x27e4, 0x2626, 0x2368, 0x22aa, 0x20ec, 0x212e,
+    0x2a70, 0x2bb2, 0x29f4, 0x2836, 0x2d78, 0x2cba, 0x2efc, 0x2f3e,
+    0x7080, 0x7142, 0x7304, 0x72c6, 0x7788, 0x764a, 0x740c, 0x75ce,
+    0x7e90, 0x7f52, 0x7d14, 0x7cd6, 0x7998, 0x785a, 0x7a1c, 0x7bde,
+    0x6ca0, 0x6d62, 0x6f24, 0x6ee6, 0x6ba8, 0x6a6a, 0x682c, 0x69ee,
+    0x62b0, 0x6372, 0x6134, 0x60f6, 0x65b8, 0x647a, 0x663c, 0x67fe,
+    0x48c0, 0x4902, 0x4b44, 0x4a86, 0x4fc8, 0x4e0a, 0x4c4c, 0x4d8e,
+    0x46d0, 0x4712, 0x4554, 0x4496, 0x41d8, 0x401a, 0x425c, 0x439e,
+    0x54e0, 0x5522, 0x5764, 0x56a6, 0x53e8, 0x522a, 0x506c, 0x51ae,
+    0x5af0, 0x5b32, 0x5974, 0x58b6, 0x5df8, 0x5c3a, 0x5e7c, 0x5fbe,
+    0xe100, 0xe0c2, 0xe284, 0xe346, 0xe608, 0xe7ca, 0xe58c, 0xe44e,
+    0xef10, 0xeed2, 0xec94, 0xed56, 0xe818, 0xe9da, 0xeb9c, 0xea5e,
+    0xfd20, 0xfce2, 0xfea4, 0xff66, 0xfa28, 0xfbea, 0xf9ac, 0xf86e,
+    0xf330, 0xf2f2, 0xf0b4, 0xf176, 0xf438, 0xf5fa, 0xf7bc, 0xf67e,
+    0xd940, 0xd882, 0xdac4, 0xdb06, 0xde48, 0xdf8a, 0xddcc, 0xdc0e,
+    0xd750, 0xd692, 0xd4d4, 0xd516, 0xd058, 0xd19a, 0xd3dc, 0xd21e,
+    0xc560, 0xc4a2, 0xc6e4, 0xc726, 0xc268, 0xc3aa, 0xc1ec, 0xc02e,
+    0xcb70, 0xcab2, 0xc8f4, 0xc936, 0xcc78, 0xcdba, 0xcffc, 0xce3e,
+    0x9180, 0x9042, 0x9204, 0x93c6, 0x9688, 0x974a, 0x950c, 0x94ce,
+    0x9f90, 0x9e52, 0x9c14, 0x9dd6, 0x9898, 0x995a, 0x9b1c, 0x9ade,
+    0x8da0, 0x8c62, 0x8e24, 0x8fe6, 0x8aa8, 0x8b6a, 0x892c, 0x88ee,
+    0x83b0, 0x8272, 0x8034, 0x81f6, 0x84b8, 0x857a, 0x873c, 0x86fe,
+    0xa9c0, 0xa802, 0xaa44, 0xab86, 0xaec8, 0xaf0a, 0xad4c, 0xac8e,
+    0xa7d0, 0xa612, 0xa454, 0xa596, 0xa0d8, 0xa11a, 0xa35c, 0xa29e,
+    0xb5e0, 0xb422, 0xb664, 0xb7a6, 0xb2e8, 0xb32a, 0xb16c, 0xb0ae,
+    0xbbf0, 0xba32, 0xb874, 0xb9b6, 0xbcf8, 0xbd3a, 0xbf7c, 0xbebe
+};
+#else
+static const uint16 last4[16] = {
+    0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+    0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+#endif
+
+static uint64 load_uint64_big_endian(const unsigned char *src)
 {
-    assert(bit < 128);
+    return ((uint64)src[0] << 56) | ((uint64)src[1] << 48) |
+           ((uint64)src[2] << 40) | ((uint64)src[3] << 32) |
+           ((uint64)src[4] << 24) | ((uint64)src[5] << 16) |
+           ((uint64)src[6] << 8)  | ((uint64)src[7]);
+}
 
-    if(  ( block[bit/8] & (0x01 << (7-(bit%8))) ) > 0)
-        return 1;
-    else
-        return 0;
+static void pack_uint64_big_endian(uint64 x, unsigned char *dest)
+{
+    pack_uint32_big_endian((uint32)(x >> 32), dest);
+    pack_uint32_big_endian((uint32)x, dest + 4);
 }
 
-/*
-static void set_bit(unsigned char *block, unsigned char bit, unsigned char value)
+/* fill ctx->hh/hl from ctx->h. Entry 1 << (ITC_GCM128_TABLE_BITS-1) is H itself */
+static void gcm_init_table(struct itc_gcm128_context *ctx)
 {
-    assert(bit < 128);
-    assert(value < 2);
+    uint64 vh, vl;
+    size_t i, j;
+
+    vh = load_uint64_big_endian(ctx->h);
+    vl = load_uint64_big_endian(ctx->h + 8);
 
-    block[bit/8] |= ( value << (7-(bit%8)) );
+    ctx->hh[0] = 0;
+    ctx->hl[0] = 0;
+    ctx->hh[ITC_GCM128_TABLE_SIZE / 2] = vh;
+    ctx->hl[ITC_GCM128_TABLE_SIZE / 2] = vl;
+
+    /* single-bit entries: each is the previous one times x (v >> 1, reduced) */
+    for(i = ITC_GCM128_TABLE_SIZE / 4; i > 0; i >>= 1)
+    {
+        uint64 reduce = (vl & 1) ? ((uint64)0xe1 << 56) : 0;
+        vl = (vh << 63) | (vl >> 1);
+        vh = (vh >> 1) ^ reduce;
+        ctx->hh[i] = vh;
+        ctx->hl[i] = vl;
+    }
+
+    /* remaining entries are XORs of the single-bit ones */
+    for(i = 2; i < ITC_GCM128_TABLE_SIZE; i <<= 1)
+    {
+        for(j = 1; j < i; ++j)
+        {
+            ctx->hh[i + j] = ctx->hh[i] ^ ctx->hh[j];
+            ctx->hl[i + j] = ctx->hl[i] ^ ctx->hl[j];
+        }
+    }
 }
-*/
 
+/* x = x * H. x must point to a valid 16-byte array */
+static void gcm_multiply_h(const struct itc_gcm128_context *ctx, unsigned char * x)
+{
+    assert(ctx != NULL);
+    assert(x != NULL);
+
+    uint64 zh, zl;
+    unsigned char rem;
+    int i;
+
+#if ITC_GCM128_TABLE_BITS == 8
+    zh = ctx->hh[x[15]];
+    zl = ctx->hl[x[15]];
+
+    for(i = 14; i >= 0; --i)
+    {
+        rem = (unsigned char)(zl & 0xff);
+        zl = (zh << 56) | (zl >> 8);
+        zh = (zh >> 8) ^ ((uint64)last8[rem] << 48);
+        zh ^= ctx->hh[x[i]];
+        zl ^= ctx->hl[x[i]];
+    }
+#else
+    unsigned char lo, hi;
+
+    lo = x[15] & 0x0f;
+    zh = ctx->hh[lo];
+    zl = ctx->hl[lo];
+
+    for(i = 15; i >= 0; --i)
+    {
+        lo = x[i] & 0x0f;
+        hi = (x[i] >> 4) & 0x0f;
+
+        if(i != 15)
+        {
+            rem = (unsigned char)(zl & 0x0f);
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ ((uint64)last4[rem] << 48);
+            zh ^= ctx->hh[lo];
+            zl ^= ctx->hl[lo];
+        }
+
+        rem = (unsigned char)(zl & 0x0f);
+        zl = (zh << 60) | (zl >> 4);
+        zh = (zh >> 4) ^ ((uint64)last4[rem] << 48);
+        zh ^= ctx->hh[hi];
+        zl ^= ctx->hl[hi];
+    }
+#endif
+
+    pack_uint64_big_endian(zh, x);
+    pack_uint64_big_endian(zl, x + 8);
+}
+
+#if defined(ITC_GCM128_CLMUL)
 /* 
-  GCM multiplication. x, y, and result must point to valid 16-byte arrays
-  It is OK to re-use x or y buffer as the result buffer
-  TODO: there are ways to speed up using tables (more memory but faster)
+  PCLMULQDQ GHASH.
+  Blocks are byte-reversed on load so each one is a 128-bit integer whose bit order
+  is the reverse of the GCM polynomial order. Products are accumulated unreduced
+  (4 multiplies per block) and folded back modulo
+  x^128 + x^7 + x^2 + x + 1 once per batch, using
+    Y' = (Y ^ X1)*H^n ^ X2*H^(n-1) ^ ... ^ Xn*H
+  with n = 8, 4 or 1.
  */
-static void gcm_multiply(const unsigned char * x, const unsigned char * y, unsigned char * result)
+static int clmul_supported(void)
 {
-    assert(x != NULL);
-    assert(y != NULL);
-    assert(result != NULL);
+    static int supported = -1;
+
+    if(supported < 0)
+    {
+        unsigned int eax, ebx, ecx, edx;
 
-    unsigned char z[16] = { 0 };
-    unsigned char v[16];
+        supported = (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_PCLMUL) && (ecx & bit_SSSE3)) ? 1 : 0;
+    }
+    return supported;
+}
+
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i clmul_load(const unsigned char * block)
+{
+    const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)block), reverse);
+}
+
+__attribute__((target("pclmul,ssse3")))
+static inline void clmul_store(__m128i x, unsigned char * block)
+{
+    const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    _mm_storeu_si128((__m128i *)block, _mm_shuffle_epi8(x, reverse));
+}
 
-    memcpy(v, y, 16 * sizeof(unsigned char));
+/* lo/mid/hi ^= unreduced partial products of a*b */
+__attribute__((target("pclmul,ssse3")))
+static inline void clmul_accumulate(__m128i a, __m128i b, __m128i *lo, __m128i *mid, __m128i *hi)
+{
+    *lo  = _mm_xor_si128(*lo,  _mm_clmulepi64_si128(a, b, 0x00));
+    *mid = _mm_xor_si128(*mid, _mm_clmulepi64_si128(a, b, 0x10));
+    *mid = _mm_xor_si128(*mid, _mm_clmulepi64_si128(a, b, 0x01));
+    *hi  = _mm_xor_si128(*hi,  _mm_clmulepi64_si128(a, b, 0x11));
+}
 
-    int i, j;
-    unsigned char v_lsb;
-    for(i = 0; i < 128; ++i)
+/* combine accumulated partial products into a 256-bit value and reduce it to 128 bits */
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i clmul_reduce(__m128i lo, __m128i mid, __m128i hi)
+{
+    __m128i t1, t2, t3;
+
+    lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+    /* the reflected product is one bit short: shift hi:lo left by 1 */
+    t1 = _mm_srli_epi32(lo, 31);
+    t2 = _mm_srli_epi32(hi, 31);
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+    t3 = _mm_srli_si128(t1, 12);
+    t2 = _mm_slli_si128(t2, 4);
+    t1 = _mm_slli_si128(t1, 4);
+    lo = _mm_or_si128(lo, t1);
+    hi = _mm_or_si128(hi, t2);
+    hi = _mm_or_si128(hi, t3);
+
+    /* first phase of the reduction */
+    t1 = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+    t2 = _mm_srli_si128(t1, 4);
+    lo = _mm_xor_si128(lo, _mm_slli_si128(t1, 12));
+
+    /* second phase of the reduction */
+    t1 = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+    t1 = _mm_xor_si128(t1, t2);
+    lo = _mm_xor_si128(lo, t1);
+
+    return _mm_xor_si128(hi, lo);
+}
+
+__attribute__((target("pclmul,ssse3")))
+static void clmul_init(struct itc_gcm128_context *ctx)
+{
+    __m128i lo, mid, hi;
+    int i;
+
+    ctx->h_powers[0] = clmul_load(ctx->h);
+    for(i = 1; i < 8; ++i)
+    {
+        lo = mid = hi = _mm_setzero_si128();
+        clmul_accumulate(ctx->h_powers[i-1], ctx->h_powers[0], &lo, &mid, &hi);
+        ctx->h_powers[i] = clmul_reduce(lo, mid, hi);
+    }
+}
+
+/* hash n (1 to 8) full blocks into y */
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i clmul_ghash_blocks(const struct itc_gcm128_context *ctx, __m128i y,
+                                          const unsigned char * data, int n)
+{
+    __m128i lo, mid, hi;
+    int i;
+
+    lo = mid = hi = _mm_setzero_si128();
+    clmul_accumulate(_mm_xor_si128(y, clmul_load(data)), ctx->h_powers[n-1], &lo, &mid, &hi);
+    for(i = 1; i < n; ++i)
+    {
+        clmul_accumulate(clmul_load(data + 16*i), ctx->h_powers[n-1-i], &lo, &mid, &hi);
+    }
+    return clmul_reduce(lo, mid, hi);
+}
+
+__attribute__((target("pclmul,ssse3")))
+static void clmul_ghash(struct itc_gcm128_context *ctx, const unsigned char * data, size_t length)
+{
+    __m128i y = clmul_load(ctx->ghash);
+
+    for(; length >= 128; length -= 128, data += 128)
+        y = clmul_ghash_blocks(ctx, y, data, 8);
+
+    for(; length >= 64; length -= 64, data += 64)
+        y = clmul_ghash_blocks(ctx, y, data, 4);
+
+    for(; length >= 16; length -= 16, data += 16)
+        y = clmul_ghash_blocks(ctx, y, data, 1);
+
+    if(length > 0)
+    {
+        /* pad partial block with zeros */
+        unsigned char last[16] = { 0 };
+        memcpy(last, data, length);
+        y = clmul_ghash_blocks(ctx, y, last, 1);
+    }
+
+    clmul_store(y, ctx->ghash);
+}
+#endif /* ITC_GCM128_CLMUL */
+
+#if defined(GCM_STITCHED)
+/*
+  Stitched AES-CTR + GHASH over whole 128-byte batches.
+  Each batch encrypts 8 counter blocks in parallel, one AES round at a time, and
+  issues one block's worth of carry-less multiplies between rounds so the AES and
+  PCLMULQDQ units work at the same time. When encrypting, the blocks hashed are the
+  previous batch's ciphertext (the current one is not ready yet); when decrypting
+  they are the current batch's input, loaded before the output is written.
+  Returns the number of bytes processed (a multiple of GCM_BATCH_LENGTH).
+ */
+__attribute__((target("aes,pclmul,sse4.1")))
+static size_t stitched_crypt(struct itc_gcm128_context *ctx, enum itc_gcm128_mode mode,
+                             size_t length, const unsigned char * input, unsigned char * output)
+{
+    const __m128i *rk = ctx->aes_ctx.aesni_enc_keys;
+    const int rounds = ctx->aes_ctx.nr;
+    const __m128i base = _mm_loadu_si128((const __m128i *)ctx->iv_ctr);
+    uint32 ctr = ((uint32)ctx->iv_ctr[12] << 24) | ((uint32)ctx->iv_ctr[13] << 16) |
+                 ((uint32)ctx->iv_ctr[14] << 8)  |  (uint32)ctx->iv_ctr[15];
+    __m128i y = clmul_load(ctx->ghash);
+    __m128i blocks[8], hash_in[8], lo, mid, hi;
+    const unsigned char *pending = NULL;
+    size_t done;
+    int i, r, hashing;
+
+    for(done = 0; length - done >= GCM_BATCH_LENGTH; done += GCM_BATCH_LENGTH)
     {
-        if(get_bit(x, i) == 1)
+        const unsigned char *in_p = input + done;
+        unsigned char *out_p = output + done;
+
+        /* next 8 counter blocks (32-bit big-endian counter in the last word) */
+        for(i = 0; i < 8; ++i)
+        {
+            ++ctr;
+            blocks[i] = _mm_xor_si128(_mm_insert_epi32(base, (int)__builtin_bswap32(ctr), 3), rk[0]);
+        }
+
+        /* ciphertext to hash alongside this batch */
+        hashing = (mode == ITC_GCM128_DECRYPT) || (pending != NULL);
+        if(hashing)
         {
-            for(j = 0; j < 16; ++j)
+            const unsigned char *h_p = (mode == ITC_GCM128_DECRYPT) ? in_p : pending;
+            for(i = 0; i < 8; ++i)
+            {
+                hash_in[i] = clmul_load(h_p + 16*i);
+            }
+            hash_in[0] = _mm_xor_si128(hash_in[0], y);
+        }
+
+        lo = mid = hi = _mm_setzero_si128();
+        for(r = 1; r < rounds; ++r)
+        {
+            for(i = 0; i < 8; ++i)
+            {
+                blocks[i] = _mm_aesenc_si128(blocks[i], rk[r]);
+            }
+            if(hashing && r <= 8)
             {
-                z[j] ^= v[j];
+                clmul_accumulate(hash_in[r-1], ctx->h_powers[8-r], &lo, &mid, &hi);
             }
         }
 
-        v_lsb = (v[15] & 0x01);
+        for(i = 0; i < 8; ++i)
+        {
+            blocks[i] = _mm_aesenclast_si128(blocks[i], rk[rounds]);
+            blocks[i] = _mm_xor_si128(blocks[i], _mm_loadu_si128((const __m128i *)(in_p + 16*i)));
+            _mm_storeu_si128((__m128i *)(out_p + 16*i), blocks[i]);
+        }
+
+        if(hashing)
+        {
+            y = clmul_reduce(lo, mid, hi);
+        }
+        pending = out_p;
+    }
+
+    /* last encrypted batch has not been hashed yet */
+    if(mode == ITC_GCM128_ENCRYPT && pending != NULL)
+    {
+        y = clmul_ghash_blocks(ctx, y, pending, 8);
+    }
+
+    clmul_store(y, ctx->ghash);
+    pack_uint32_big_endian(ctr, ctx->iv_ctr + 12);
+
+    return done;
+}
+
+/*
+  AES-CTR alone over whole 128-byte batches, 8 counter blocks in parallel.
+  The block loops are unrolled explicitly so the 8 blocks stay in registers at -O2.
+  Returns the number of bytes processed (a multiple of GCM_BATCH_LENGTH).
+ */
+__attribute__((target("aes,sse4.1")))
+static size_t aesni_ctr(struct itc_gcm128_context *ctx, size_t length, const unsigned char * input, unsigned char * output)
+{
+    const __m128i *rk = ctx->aes_ctx.aesni_enc_keys;
+    const int rounds = ctx->aes_ctx.nr;
+    const __m128i base = _mm_loadu_si128((const __m128i *)ctx->iv_ctr);
+    uint32 ctr = ((uint32)ctx->iv_ctr[12] << 24) | ((uint32)ctx->iv_ctr[13] << 16) |
+                 ((uint32)ctx->iv_ctr[14] << 8)  |  (uint32)ctx->iv_ctr[15];
+    __m128i blocks[8];
+    size_t done;
+    int i, r;
+
+    for(done = 0; length - done >= GCM_BATCH_LENGTH; done += GCM_BATCH_LENGTH)
+    {
+        const unsigned char *in_p = input + done;
+        unsigned char *out_p = output + done;
 
-        /* v >> 1 */
-        for(j = 15; j > 0; --j)
+        #pragma GCC unroll 8
+        for(i = 0; i < 8; ++i)
+        {
+            ++ctr;
+            blocks[i] = _mm_xor_si128(_mm_insert_epi32(base, (int)__builtin_bswap32(ctr), 3), rk[0]);
+        }
+        for(r = 1; r < rounds; ++r)
+        {
+            #pragma GCC unroll 8
+            for(i = 0; i < 8; ++i)
+            {
+                blocks[i] = _mm_aesenc_si128(blocks[i], rk[r]);
+            }
+        }
+        #pragma GCC unroll 8
+        for(i = 0; i < 8; ++i)
         {
-            v[j] = (v[j] >> 1) | ( (v[j-1] & 0x01) << 7 );
+            blocks[i] = _mm_aesenclast_si128(blocks[i], rk[rounds]);
+            blocks[i] = _mm_xor_si128(blocks[i], _mm_loadu_si128((const __m128i *)(in_p + 16*i)));
+            _mm_storeu_si128((__m128i *)(out_p + 16*i), blocks[i]);
         }
-        v[0] >>= 1;
+    }
 
-        if(v_lsb)
+    pack_uint32_big_endian(ctr, ctx->iv_ctr + 12);
+
+    return done;
+}
+#endif /* GCM_STITCHED */
+
+/* fold data into ctx->ghash. A final partial block is treated as zero-padded */
+static void gcm_ghash(struct itc_gcm128_context *ctx, const unsigned char * data, size_t length)
+{
+    size_t i, temp_length;
+
+#if defined(ITC_GCM128_CLMUL)
+    if(ctx->use_clmul)
+    {
+        clmul_ghash(ctx, data, length);
+        return;
+    }
+#endif
+
+    while(length > 0)
+    {
+        temp_length = (length < 16) ? length : 16;
+
+        /* if temp_length is < 16, algorithm says to pad with zeros to fill block */
+        /* zero's would have no effect on the XOR op, so just skip it instead */
+        for(i = 0; i < temp_length; ++i)
         {
-            v[0] ^= 0xe1;
+            ctx->ghash[i] ^= data[i];
         }
+
+        gcm_multiply_h(ctx, ctx->ghash);
+
+        data += temp_length;
+        length -= temp_length;
     }
+}
 
-    memcpy(result, z, 16 * sizeof(unsigned char));
+/* CTR-mode transform of length bytes, advancing the counter one block at a time */
+static void gcm_ctr(struct itc_gcm128_context *ctx, size_t length, const unsigned char * input, unsigned char * output)
+{
+    unsigned char ectr[16];
+    size_t i, temp_length;
+
+    while(length > 0)
+    {
+        temp_length = (length < 16) ? length : 16;
+
+        /* increment ctr here; take advantage of unsigned int wrap-around on overflow */
+        for(i = 16; i > 12; --i)
+        {
+            /* increment byte; if equals zero (overflowed), then also have to increment next byte to account for carry */
+            if( ++(ctx->iv_ctr[i-1]) != 0)
+               break;
+        }
+
+        itc_aes128_encrypt(&(ctx->aes_ctx), ctx->iv_ctr, ectr);
+
+        for(i = 0; i < temp_length; ++i)
+        {
+            output[i] = ectr[i] ^ input[i];
+        }
+
+        input += temp_length;
+        output += temp_length;
+        length -= temp_length;
+    }
 }
 
 /* same function for either encrypt or decrypt */
@@ -148,8 +590,6 @@ static int gcm128_crypt_start( struct itc_gcm128_context *ctx,
     memset(ctx->ghash, 0x00, sizeof(ctx->ghash));
     ctx->aad_length = 0;
     ctx->length = 0;
-    size_t i, temp_length;
-    const unsigned char * p;
 
     /* generate initial counter block (ICB): IV || 31 0's || 1 */
     memcpy(ctx->iv_ctr, iv, 12 * sizeof(unsigned char));
@@ -160,24 +600,7 @@ static int gcm128_crypt_start( struct itc_gcm128_context *ctx,
 
     /* process the AAD */
     ctx->aad_length = (uint32)aad_length;
-    p = aad;
-
-    while(aad_length > 0)
-    {
-        temp_length = (aad_length < 16) ? aad_length : 16;
-
-        /* if temp_length is < 16, algorithm says to pad with zeros to fill block */
-        /* zero's would have no effect on the XOR op, so just skip it instead */
-        for(i = 0; i < temp_length; ++i)
-        {
-            ctx->ghash[i] ^= p[i];
-        }
-        
-        gcm_multiply(ctx->ghash, ctx->h, ctx->ghash);
-
-        p += temp_length;
-        aad_length -= temp_length;
-    }
+    gcm_ghash(ctx, aad, aad_length);
 
     return ITC_GCM128_SUCCESS;
 }
@@ -188,8 +611,7 @@ static int gcm128_crypt_update( struct itc_gcm128_context *ctx,
                                  const unsigned char * input,
                                  unsigned char * output )
 {
-    unsigned char ectr[16];
-    size_t i, temp_length;
+    size_t temp_length;
     const unsigned char *in_p = input;
     unsigned char *out_p = output;
     assert(ctx != NULL);
@@ -208,33 +630,30 @@ static int gcm128_crypt_update( struct itc_gcm128_context *ctx,
     */
 
     ctx->length += (uint32)length;
-    while(length > 0)
-    {
-        temp_length = (length < 16) ? length : 16;
-
-        /* increment ctr here; take advantage of unsigned int wrap-around on overflow */
-        for(i = 16; i > 12; --i)
-        {
-            /* increment byte; if equals zero (overflowed), then also have to increment next byte to account for carry */
-            if( ++(ctx->iv_ctr[i-1]) != 0)
-               break;
-        }
 
-        itc_aes128_encrypt(&(ctx->aes_ctx), ctx->iv_ctr, ectr);        
+#if defined(GCM_STITCHED)
+    if(ctx->use_clmul && ctx->aes_ctx.use_aesni && length >= GCM_BATCH_LENGTH)
+    {
+        temp_length = stitched_crypt(ctx, mode, length, in_p, out_p);
+        in_p += temp_length;
+        out_p += temp_length;
+        length -= temp_length;
+    }
+#endif
 
-        for(i = 0; i < temp_length; ++i)
-        {
-            /* check if DECRYPT first in case in_p == out_p */
-            if(mode == ITC_GCM128_DECRYPT) /* in_p is ciphertext */
-                ctx->ghash[i] ^= in_p[i]; 
+    /* remainder (or everything, without the stitched kernel) */
+    while(length > 0)
+    {
+        temp_length = (length < GCM_BATCH_LENGTH) ? length : GCM_BATCH_LENGTH;
 
-            out_p[i] = ectr[i] ^ in_p[i];
+        /* GHASH always runs over the ciphertext; hash DECRYPT input first in case in_p == out_p */
+        if(mode == ITC_GCM128_DECRYPT)
+            gcm_ghash(ctx, in_p, temp_length);
 
-            if(mode == ITC_GCM128_ENCRYPT) /* out_p is ciphertext */
-                ctx->ghash[i] ^= out_p[i];
-        }
+        gcm_ctr(ctx, temp_length, in_p, out_p);
 
-        gcm_multiply(ctx->ghash, ctx->h, ctx->ghash);
+        if(mode == ITC_GCM128_ENCRYPT)
+            gcm_ghash(ctx, out_p, temp_length);
 
         in_p += temp_length;
         out_p += temp_length;
@@ -275,10 +694,7 @@ static void gcm128_crypt_finish(struct itc_gcm128_context *ctx, unsigned char *
     pack_uint32_big_endian(data_length, buffer+12);
     
     /* finish hash */
-    for(i = 0; i < 16; ++i)
-        ctx->ghash[i] ^= buffer[i];
-
-    gcm_multiply(ctx->ghash, ctx->h, ctx->ghash);
+    gcm_ghash(ctx, buffer, sizeof(buffer));
 
     for(i = 0; i < 16; ++i)
     {
@@ -287,16 +703,35 @@ static void gcm128_crypt_finish(struct itc_gcm128_context *ctx, unsigned char *
 }
 
 void itc_gcm128_init(struct itc_gcm128_context *ctx, const unsigned char * key)
+{
+    (void) itc_gcm128_init_key(ctx, key, 16);
+}
+
+int itc_gcm128_init_key(struct itc_gcm128_context *ctx, const unsigned char * key, size_t key_length)
 {
     assert(ctx != NULL);
     assert(key != NULL);
     static const unsigned char zero_block[16] = { 0 };
 
     /* initialize AES context */
-    itc_aes128_init(&(ctx->aes_ctx), key);
+    if(itc_aes128_init_key(&(ctx->aes_ctx), key, key_length) != ITC_AES128_SUCCESS)
+        return ITC_GCM128_BAD_KEY_LENGTH;
 
     /* calculate GHASH subkey (H) */
     itc_aes128_encrypt(&(ctx->aes_ctx), zero_block, ctx->h);
+
+    /* precompute multiples of H for GHASH */
+    gcm_init_table(ctx);
+
+#if defined(ITC_GCM128_CLMUL)
+    ctx->use_clmul = clmul_supported();
+    if(ctx->use_clmul)
+    {
+        clmul_init(ctx);
+    }
+#endif
+
+    return ITC_GCM128_SUCCESS;
 }
 
 int itc_gcm128_encrypt_start( struct itc_gcm128_context *ctx, 
@@ -380,6 +815,40 @@ int itc_gcm128_decrypt_finish(struct itc_gcm128_context *ctx, const unsigned cha
 
 }
 
+int itc_gcm128_ctr( struct itc_gcm128_context *ctx,
+                    const unsigned char * iv,
+                    size_t length,
+                    const unsigned char * input,
+                    unsigned char * output )
+{
+    size_t done = 0;
+    assert(ctx != NULL);
+    assert(iv != NULL);
+    if(length > 0)
+    {
+        assert(input != NULL);
+        assert(output != NULL);
+    }
+
+    if(length > 0xffffffff)
+        return ITC_GCM128_OUT_OF_RANGE;
+
+    /* ICB as in gcm128_crypt_start; gcm_ctr increments before use, so data starts at IV || 2 */
+    memset(ctx->iv_ctr, 0x00, sizeof(ctx->iv_ctr));
+    memcpy(ctx->iv_ctr, iv, 12 * sizeof(unsigned char));
+    ctx->iv_ctr[15] = 0x01;
+
+#if defined(GCM_STITCHED)
+    if(ctx->aes_ctx.use_aesni)
+    {
+        done = aesni_ctr(ctx, length, input, output);
+    }
+#endif
+    gcm_ctr(ctx, length - done, input + done, output + done);
+
+    return ITC_GCM128_SUCCESS;
+}
+
 int itc_gcm128_decrypt( struct itc_gcm128_context *ctx, 
                         const unsigned char * iv,                      
                         size_t aad_length,
@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "crypto.h"
+
+#define FRAME_SIZE      AOS_FRAME_SIZE
+#define BENCH_FRAMES    20000
+#define SPI_CLEAR       1
+#define SPI_AEAD        2
+#define SPI_AUTH        3
+#define SPI_ENC         4
+#define VCID_CLEAR      1
+#define VCID_AEAD       2
+#define VCID_AUTH       3
+#define VCID_ENC        4
+
+static crypto_instance_t flight;
+static crypto_instance_t ground;
+static char data[FRAME_SIZE];
+static char frames[16][FRAME_SIZE];
+static char work[FRAME_SIZE];
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+//maps an AOS virtual channel of the test spacecraft to an operational SA
+static void map_vcid(crypto_instance_t *inst, uint16 spi, uint8 vcid)
+{
+    inst->sa[spi].sa_state = SA_OPERATIONAL;
+    inst->gvcid_tm_map[vcid].spi  = spi;
+    inst->gvcid_tm_map[vcid].tfvn = AOS_TFVN;
+    inst->gvcid_tm_map[vcid].scid = SCID & 0xFF;
+}
+
+//writes the unsecured frame: primary header and an M_PDU of test data with the given first header pointer
+static void fill_frame(char *frame, uint8 vcid, uint16 fhp)
+{
+    memset(frame, 0, FRAME_SIZE);
+    frame[0] = (char) ((AOS_TFVN << 6) | ((SCID & 0xFC) >> 2));
+    frame[1] = (char) (((SCID & 0x03) << 6) | vcid);
+    memcpy(&frame[AOS_PDU_LOC + AOS_MPDU_HEADER_SIZE], data, AOS_PDU_SIZE - AOS_MPDU_HEADER_SIZE);
+    frame[AOS_PDU_LOC] = (char) ((fhp & 0x700) >> 8);
+    frame[AOS_PDU_LOC + 1] = (char) (fhp & 0xFF);
+}
+
+//zero if the secured frame verifies and carries the original packet zone and first header pointer
+static int run_roundtrip_test(uint16 spi, uint8 vcid)
+{
+    crypto_aos_view_t view;
+    char *frame = frames[0];
+    int len = FRAME_SIZE;
+
+    fill_frame(frame, vcid, 123);
+    if(Crypto_Instance_AOS_ApplySecurity(&flight, frame, &len) != OS_SUCCESS)
+    {
+        printf("SPI %d: frame apply failed\n", spi);
+        return -1;
+    }
+    if(Crypto_Instance_AOS_ProcessSecurityView(&ground, frame, FRAME_SIZE, &view) != OS_SUCCESS)
+    {
+        printf("SPI %d: frame did not verify\n", spi);
+        return -1;
+    }
+    if(view.spi != spi || view.vcid != vcid || view.fhp != 123 || memcmp(&view.buf[view.offset], data, view.len) != 0)
+    {
+        printf("SPI %d: packet zone mismatch (fhp %d)\n", spi, view.fhp);
+        return -1;
+    }
+    printf("SPI %d: round trip ok, packet zone %d bytes\n", spi, view.len);
+    return 0;
+}
+
+//zero if a modified frame is rejected
+static int run_tamper_test(uint16 spi, uint8 vcid)
+{
+    crypto_aos_view_t view;
+    char *frame = frames[0];
+    int len = FRAME_SIZE;
+    uint16 fecf;
+
+    fill_frame(frame, vcid, 0);
+    Crypto_Instance_AOS_ApplySecurity(&flight, frame, &len);
+
+    // flip a data bit and repair the FECF so only the MAC can catch it
+    frame[AOS_PDU_LOC + 100] ^= 0x01;
+    fecf = Crypto_CRC16_update(CRC16_CCITT_INIT, (uint8 *) frame, AOS_FECF_LOC);
+    frame[AOS_FECF_LOC] = (char) (fecf >> 8);
+    frame[AOS_FECF_LOC + 1] = (char) (fecf & 0xFF);
+    if(Crypto_Instance_AOS_ProcessSecurityView(&ground, frame, FRAME_SIZE, &view) == OS_SUCCESS)
+    {
+        printf("SPI %d: tampered frame accepted\n", spi);
+        return -1;
+    }
+    printf("SPI %d: tampered frame rejected\n", spi);
+    return 0;
+}
+
+//zero if a frame is accepted once and its replay is rejected
+static int run_replay_test(uint16 spi, uint8 vcid)
+{
+    crypto_aos_view_t view;
+    char *frame = frames[0];
+    int len = FRAME_SIZE;
+
+    fill_frame(frame, vcid, 0);
+    Crypto_Instance_AOS_ApplySecurity(&flight, frame, &len);
+    memcpy(work, frame, FRAME_SIZE);
+    if(Crypto_Instance_AOS_ProcessSecurityView(&ground, frame, FRAME_SIZE, &view) != OS_SUCCESS)
+    {
+        printf("SPI %d: frame did not verify\n", spi);
+        return -1;
+    }
+    if(Crypto_Instance_AOS_ProcessSecurityView(&ground, work, FRAME_SIZE, &view) == OS_SUCCESS)
+    {
+        printf("SPI %d: replayed frame accepted\n", spi);
+        return -1;
+    }
+    fill_frame(frame, vcid, 0);
+    len = FRAME_SIZE;
+    Crypto_Instance_AOS_ApplySecurity(&flight, frame, &len);
+    if(Crypto_Instance_AOS_ProcessSecurityView(&ground, frame, FRAME_SIZE, &view) != OS_SUCCESS)
+    {
+        printf("SPI %d: frame after the replay rejected\n", spi);
+        return -1;
+    }
+    printf("SPI %d: replayed frame rejected\n", spi);
+    return 0;
+}
+
+//zero if frames are rejected unless their SPI is the operational SA of their channel
+static int run_channel_test(void)
+{
+    crypto_aos_view_t view;
+    char *frame = frames[0];
+    int len;
+    int i;
+    // VCID and SPI written over a clear frame: a foreign SA, an unmapped VCID and an SA that is not set up
+    const uint8 vcid[] = {VCID_CLEAR, 5, VCID_CLEAR};
+    const uint16 spi[] = {SPI_AEAD, 20, 10};
+    uint16 fecf;
+
+    for(i = 0; i < 3; ++i)
+    {
+        fill_frame(frame, VCID_CLEAR, 0);
+        len = FRAME_SIZE;
+        Crypto_Instance_AOS_ApplySecurity(&flight, frame, &len);
+        frame[1] = (char) ((frame[1] & 0xC0) | vcid[i]);
+        frame[AOS_SPI_LOC] = (char) (spi[i] >> 8);
+        frame[AOS_SPI_LOC + 1] = (char) (spi[i] & 0xFF);
+        fecf = Crypto_CRC16_update(CRC16_CCITT_INIT, (uint8 *) frame, AOS_FECF_LOC);
+        frame[AOS_FECF_LOC] = (char) (fecf >> 8);
+        frame[AOS_FECF_LOC + 1] = (char) (fecf & 0xFF);
+        if(Crypto_Instance_AOS_ProcessSecurityView(&ground, frame, FRAME_SIZE, &view) == OS_SUCCESS)
+        {
+            printf("channel: frame on VCID %d SPI %d accepted\n", vcid[i], spi[i]);
+            return -1;
+        }
+    }
+    printf("channel: foreign SPIs and unmapped VCIDs rejected\n");
+    return 0;
+}
+
+static void run_benchmark(const char *name, uint8 vcid)
+{
+    crypto_aos_view_t view;
+    double start, apply, stop;
+    int i, len, errors = 0;
+    uint16 spi = ground.gvcid_tm_map[vcid].spi;
+
+    // each frame is secured then verified from a fresh copy of the unsecured frame,
+    // so the copies are counted in both rates; the ground SA is rewound to each
+    // frame's IV so the last 16 frames can be verified over and over
+    fill_frame(frames[0], vcid, 0);
+
+    start = now_sec();
+    for(i = 0; i < BENCH_FRAMES; ++i)
+    {
+        len = FRAME_SIZE;
+        memcpy(frames[i & 15], frames[0], FRAME_SIZE);
+        if(Crypto_Instance_AOS_ApplySecurity(&flight, frames[i & 15], &len) != OS_SUCCESS)
+        {
+            ++errors;
+        }
+    }
+    apply = now_sec();
+    for(i = 0; i < BENCH_FRAMES; ++i)
+    {
+        memcpy(work, frames[i & 15], FRAME_SIZE);
+        memcpy(ground.sa[spi].iv, &work[AOS_SPI_LOC + 2], IV_SIZE);
+        Crypto_ARC_reset(&ground.sa[spi]);
+        if(Crypto_Instance_AOS_ProcessSecurityView(&ground, work, FRAME_SIZE, &view) != OS_SUCCESS)
+        {
+            ++errors;
+        }
+    }
+    stop = now_sec();
+
+    printf("%-8s apply %8.1f Mbit/s  process %8.1f Mbit/s%s\n", name,
+        (double) BENCH_FRAMES * FRAME_SIZE * 8 / (apply - start) / 1e6,
+        (double) BENCH_FRAMES * FRAME_SIZE * 8 / (stop - apply) / 1e6, errors ? "  (ERRORS)" : "");
+}
+
+int main(void)
+{
+    int testsPassed = 0, testsFailed = 0;
+    int i;
+
+    srand(1);
+    for(i = 0; i < FRAME_SIZE; ++i)
+    {
+        data[i] = (char) rand();
+    }
+
+    Crypto_Instance_Init(&flight, CRYPTO_PROVIDER);
+    Crypto_Instance_Init(&ground, CRYPTO_PROVIDER);
+    map_vcid(&flight, SPI_CLEAR, VCID_CLEAR);
+    map_vcid(&flight, SPI_AEAD, VCID_AEAD);
+    map_vcid(&flight, SPI_AUTH, VCID_AUTH);
+    map_vcid(&flight, SPI_ENC, VCID_ENC);
+    map_vcid(&ground, SPI_CLEAR, VCID_CLEAR);
+    map_vcid(&ground, SPI_AEAD, VCID_AEAD);
+    map_vcid(&ground, SPI_AUTH, VCID_AUTH);
+    map_vcid(&ground, SPI_ENC, VCID_ENC);
+    // authentication only SA
+    flight.sa[SPI_AUTH].est = 0;
+    ground.sa[SPI_AUTH].est = 0;
+    // encryption only SA
+    flight.sa[SPI_ENC].ast = 0;
+    ground.sa[SPI_ENC].ast = 0;
+
+    if(run_roundtrip_test(SPI_CLEAR, VCID_CLEAR)) ++testsFailed; else ++testsPassed;
+    if(run_roundtrip_test(SPI_AEAD, VCID_AEAD)) ++testsFailed; else ++testsPassed;
+    if(run_roundtrip_test(SPI_AUTH, VCID_AUTH)) ++testsFailed; else ++testsPassed;
+    if(run_roundtrip_test(SPI_ENC, VCID_ENC)) ++testsFailed; else ++testsPassed;
+    if(run_tamper_test(SPI_AEAD, VCID_AEAD)) ++testsFailed; else ++testsPassed;
+    if(run_tamper_test(SPI_AUTH, VCID_AUTH)) ++testsFailed; else ++testsPassed;
+    if(run_replay_test(SPI_AEAD, VCID_AEAD)) ++testsFailed; else ++testsPassed;
+    if(run_replay_test(SPI_AUTH, VCID_AUTH)) ++testsFailed; else ++testsPassed;
+    if(run_channel_test()) ++testsFailed; else ++testsPassed;
+
+    printf("\nBenchmark (%d byte AOS frames):\n", FRAME_SIZE);
+    run_benchmark("clear", VCID_CLEAR);
+    run_benchmark("aes-gcm", VCID_AEAD);
+    run_benchmark("gmac", VCID_AUTH);
+    run_benchmark("aes-ctr", VCID_ENC);
+
+    printf("\nFinished running tests. %d/%d cases passed.\n", testsPassed, testsPassed + testsFailed);
+
+    return testsFailed;
+}
@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crypto.h"
+
+#define FORWARD_WINDOW  250
+
+static SecurityAssociation_t sa;
+
+//fresh SA expecting counter 0 with every older value already received
+static void setup(void)
+{
+    memset(&sa, 0, sizeof(sa));
+    sa.arcw_len = 1;
+    sa.arcw[0] = FORWARD_WINDOW;
+    Crypto_ARC_reset(&sa);
+}
+
+static void set_iv(uint8 *iv, uint8 high, uint64 counter)
+{
+    int i;
+
+    memset(iv, 0, IV_SIZE);
+    iv[0] = high;
+    for(i = IV_SIZE - 1; i >= ARC_HIGH_SIZE; --i)
+    {
+        iv[i] = (uint8) (counter & 0xFF);
+        counter >>= 8;
+    }
+}
+
+static int32 check(uint64 counter)
+{
+    uint8 iv[IV_SIZE];
+
+    set_iv(iv, 0, counter);
+    return Crypto_ARC_check(&sa, iv);
+}
+
+//checks and records a counter the way frame processing does
+static int32 receive(uint64 counter)
+{
+    uint8 iv[IV_SIZE];
+    int32 status;
+
+    set_iv(iv, 0, counter);
+    status = Crypto_ARC_check(&sa, iv);
+    if(status == OS_SUCCESS)
+    {
+        Crypto_ARC_update(&sa, iv);
+    }
+    return status;
+}
+
+//zero if every counter in [first, last] is accepted once and then rejected as a replay
+static int receive_once(uint64 first, uint64 last)
+{
+    uint64 x;
+
+    for(x = first; x <= last; ++x)
+    {
+        if(receive(x) != OS_SUCCESS)
+        {
+            printf("counter %llu rejected\n", (unsigned long long) x);
+            return -1;
+        }
+        if(receive(x) != ARC_REPLAY)
+        {
+            printf("counter %llu accepted twice\n", (unsigned long long) x);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+//zero if only arcw values at or past the expected counter are accepted
+static int run_forward_test(void)
+{
+    uint8 iv[IV_SIZE];
+
+    setup();
+    if(check(FORWARD_WINDOW - 1) != OS_SUCCESS || check(FORWARD_WINDOW) != ARC_OUTSIDE_WINDOW)
+    {
+        printf("forward: window edge wrong\n");
+        return -1;
+    }
+    set_iv(iv, 1, 0);
+    if(Crypto_ARC_check(&sa, iv) != ARC_OUTSIDE_WINDOW)
+    {
+        printf("forward: higher IV bytes accepted\n");
+        return -1;
+    }
+    if(receive(0) != OS_SUCCESS || check(0) != ARC_REPLAY)
+    {
+        printf("forward: expected counter not recorded\n");
+        return -1;
+    }
+    printf("forward: window limit ok\n");
+    return 0;
+}
+
+//zero if late counters inside the window are accepted once after shifts below, at and past a word
+static int run_late_test(void)
+{
+    setup();
+    if(receive_once(0, 9)) return -1;
+    // shift by 11, less than a bitmap word
+    if(receive_once(20, 20) || receive_once(10, 19)) return -1;
+    // shift by 64, one whole word
+    if(receive_once(84, 84) || receive_once(21, 83)) return -1;
+    // shift by 200, across a word boundary
+    if(receive_once(284, 284) || receive_once(85, 283)) return -1;
+    if(sa.arc_bitmap[0] != 0xFFFFFFFFFFFFFFFFULL)
+    {
+        printf("late: bitmap not full after every counter was received\n");
+        return -1;
+    }
+    printf("late: in window counters accepted once\n");
+    return 0;
+}
+
+//zero if counters that fall out of the window are rejected even when never received
+static int run_old_test(void)
+{
+    uint64 x;
+
+    setup();
+    // skip counter 0, then move the window past it in steps the forward window allows
+    for(x = 200; x <= ARC_WINDOW_BITS + 200; x += 200)
+    {
+        if(receive(x) != OS_SUCCESS)
+        {
+            printf("old: step to %llu rejected\n", (unsigned long long) x);
+            return -1;
+        }
+    }
+    // x - 200 was the last counter received, so the expected one is x - 199
+    x = x - 199;
+    if(check(x - ARC_WINDOW_BITS) != OS_SUCCESS || check(x - ARC_WINDOW_BITS - 1) != ARC_REPLAY || check(0) != ARC_REPLAY)
+    {
+        printf("old: window bottom wrong\n");
+        return -1;
+    }
+    printf("old: counters below the window rejected\n");
+    return 0;
+}
+
+//zero if a sender that does not increment its IV, as without INCREMENT, gets each IV accepted
+//once and sa->iv still moves past it
+static int run_repeat_test(void)
+{
+    int x;
+
+    setup();
+    for(x = 0; x < 3; ++x)
+    {
+        if(receive(7) != ((x == 0) ? OS_SUCCESS : ARC_REPLAY))
+        {
+            printf("repeat: copy %d of the same IV %s\n", x, (x == 0) ? "rejected" : "accepted");
+            return -1;
+        }
+        if(Crypto_ARC_low(sa.iv) != 8)
+        {
+            printf("repeat: expected IV %llu, not the one after the received IV\n", (unsigned long long) Crypto_ARC_low(sa.iv));
+            return -1;
+        }
+    }
+    printf("repeat: repeated IV rejected\n");
+    return 0;
+}
+
+//zero if Crypto_ARC_shift moves the bitmap by 0, part of a word, a word and past the window
+static int run_shift_test(void)
+{
+    int i;
+
+    setup();
+    sa.arc_bitmap[0] = 0x8000000000000001ULL;
+    Crypto_ARC_shift(&sa, 0);
+    if(sa.arc_bitmap[0] != 0x8000000000000001ULL || sa.arc_bitmap[1] != 0xFFFFFFFFFFFFFFFFULL)
+    {
+        printf("shift: 0 changed the window\n");
+        return -1;
+    }
+    Crypto_ARC_shift(&sa, 1);
+    if(sa.arc_bitmap[0] != 0x0000000000000002ULL || sa.arc_bitmap[1] != 0xFFFFFFFFFFFFFFFFULL)
+    {
+        printf("shift: 1 did not carry into the next word\n");
+        return -1;
+    }
+    Crypto_ARC_shift(&sa, 64);
+    if(sa.arc_bitmap[0] != 0 || sa.arc_bitmap[1] != 0x0000000000000002ULL || sa.arc_bitmap[2] != 0xFFFFFFFFFFFFFFFFULL)
+    {
+        printf("shift: 64 did not move a whole word\n");
+        return -1;
+    }
+    Crypto_ARC_shift(&sa, ARC_WINDOW_BITS + 1);
+    for(i = 0; i < ARC_WINDOW_WORDS; ++i)
+    {
+        if(sa.arc_bitmap[i] != 0)
+        {
+            printf("shift: past the window left word %d set\n", i);
+            return -1;
+        }
+    }
+    printf("shift: 0, 1, 64 and %d ok\n", ARC_WINDOW_BITS + 1);
+    return 0;
+}
+
+int main(void)
+{
+    int testsPassed = 0, testsFailed = 0;
+
+    if(run_forward_test()) ++testsFailed; else ++testsPassed;
+    if(run_late_test()) ++testsFailed; else ++testsPassed;
+    if(run_old_test()) ++testsFailed; else ++testsPassed;
+    if(run_shift_test()) ++testsFailed; else ++testsPassed;
+    if(run_repeat_test()) ++testsFailed; else ++testsPassed;
+
+    printf("\nFinished running tests. %d/%d cases passed.\n", testsPassed, testsPassed + testsFailed);
+
+    return testsFailed;
+}
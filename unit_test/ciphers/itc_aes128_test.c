@@ -2,21 +2,23 @@
 #include "itc_aes128.h"
 
 //represents a test vector for AES 128-bit encryption:
-//    - the 128-bit key
+//    - the 128, 192 or 256-bit key, and its length in bytes
 //    - the input plaintext
 //    - the expected ciphertext
 struct aes128_test_vector
 {
-    unsigned char key[16];
+    unsigned char key[32];
+    size_t key_length;
     unsigned char plaintext[16];
     unsigned char ciphertext[16];
 };
 
-#define NUM_TESTS    4
+#define NUM_TESTS    7
 
 static const struct aes128_test_vector test_vector_1 = 
 {
     { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c }, // key
+    16,
     { 0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a }, // plaintext
     { 0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97 }  // ciphertext
 };
@@ -24,6 +26,7 @@ static const struct aes128_test_vector test_vector_1 =
 static const struct aes128_test_vector test_vector_2 = 
 {
     { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c }, // key
+    16,
     { 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51 }, // plaintext
     { 0xf5, 0xd3, 0xd5, 0x85, 0x03, 0xb9, 0x69, 0x9d, 0xe7, 0x85, 0x89, 0x5a, 0x96, 0xfd, 0xba, 0xaf }  // ciphertext
 };
@@ -31,6 +34,7 @@ static const struct aes128_test_vector test_vector_2 =
 static const struct aes128_test_vector test_vector_3 = 
 {
     { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c }, // key
+    16,
     { 0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef }, // plaintext
     { 0x43, 0xb1, 0xcd, 0x7f, 0x59, 0x8e, 0xce, 0x23, 0x88, 0x1b, 0x00, 0xe3, 0xed, 0x03, 0x06, 0x88 }  // ciphertext
 };
@@ -38,12 +42,42 @@ static const struct aes128_test_vector test_vector_3 =
 static const struct aes128_test_vector test_vector_4 = 
 {
     { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c }, // key
+    16,
     { 0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10 }, // plaintext
     { 0x7b, 0x0c, 0x78, 0x5e, 0x27, 0xe8, 0xad, 0x3f, 0x82, 0x23, 0x20, 0x71, 0x04, 0x72, 0x5d, 0xd4 }  // ciphertext
 };
 
 
+// FIPS-197 Appendix C example vectors
+static const struct aes128_test_vector test_vector_5 = 
+{
+    { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f }, // key
+    16,
+    { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff }, // plaintext
+    { 0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a }  // ciphertext
+};
+
+static const struct aes128_test_vector test_vector_6 = 
+{
+    { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+      0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17 }, // key
+    24,
+    { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff }, // plaintext
+    { 0xdd, 0xa9, 0x7c, 0xa4, 0x86, 0x4c, 0xdf, 0xe0, 0x6e, 0xaf, 0x70, 0xa0, 0xec, 0x0d, 0x71, 0x91 }  // ciphertext
+};
+
+static const struct aes128_test_vector test_vector_7 = 
+{
+    { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+      0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f }, // key
+    32,
+    { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff }, // plaintext
+    { 0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf, 0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89 }  // ciphertext
+};
+
+
 void print128(const unsigned char * block); //prints 128-bit key/block & a newline
+void print_key(const unsigned char * key, size_t length); //prints 128/192/256-bit key & a newline
 //returns 0 if equal; non-zero if different
 int compare128(const unsigned char * a, const unsigned char * b); 
 
@@ -55,6 +89,9 @@ int main(void)
     test_vectors[1] = &test_vector_2;
     test_vectors[2] = &test_vector_3;
     test_vectors[3] = &test_vector_4;
+    test_vectors[4] = &test_vector_5;
+    test_vectors[5] = &test_vector_6;
+    test_vectors[6] = &test_vector_7;
 
     int i;
     int pass_count = 0;
@@ -71,7 +108,7 @@ int main(void)
 
         printf("Checking Test Vector %d:\n", i+1);
 
-        itc_aes128_init(&ctx, test_vectors[i]->key);
+        itc_aes128_init_key(&ctx, test_vectors[i]->key, test_vectors[i]->key_length);
         itc_aes128_encrypt(&ctx, test_vectors[i]->plaintext, output);
         pass = !compare128(test_vectors[i]->ciphertext, output);
         if(pass)
@@ -80,7 +117,7 @@ int main(void)
             ++fail_count;
 
         printf("  Key:                 ");
-        print128(test_vectors[i]->key);
+        print_key(test_vectors[i]->key, test_vectors[i]->key_length);
         printf("  Plaintext:           ");
         print128(test_vectors[i]->plaintext);
         printf("  Output:              ");
@@ -102,7 +139,7 @@ int main(void)
 
         printf("Checking Test Vector %d:\n", i+1);
 
-        itc_aes128_init(&ctx, test_vectors[i]->key);
+        itc_aes128_init_key(&ctx, test_vectors[i]->key, test_vectors[i]->key_length);
         itc_aes128_decrypt(&ctx, test_vectors[i]->ciphertext, output);
         pass = !compare128(test_vectors[i]->plaintext, output);
         
@@ -112,7 +149,7 @@ int main(void)
             ++fail_count;
 
         printf("  Key:                ");
-        print128(test_vectors[i]->key);
+        print_key(test_vectors[i]->key, test_vectors[i]->key_length);
         printf("  Ciphertext:         ");
         print128(test_vectors[i]->ciphertext);
         printf("  Output:             ");
@@ -138,6 +175,16 @@ void print128(const unsigned char * block)
     printf("\n");
 }
 
+void print_key(const unsigned char * key, size_t length)
+{
+    size_t i;
+    for(i = 0; i < length; ++i)
+    {
+        printf("%02x ", key[i]);
+    }
+    printf("\n");
+}
+
 int compare128(const unsigned char * a, const unsigned char * b)
 {
     int i;
@@ -6,7 +6,7 @@
 #include <limits.h>
 #include "itc_gcm128.h"
 
-#define MAX_LINE_SIZE    2048  // Max line size. If it is longer in a file, bad things will happen.
+#define MAX_LINE_SIZE    4096  // Max line size. If it is longer in a file, bad things will happen.
 
 // todo: API tests (check error returns for bad input)
 // todo: decryption tests
@@ -25,7 +25,8 @@ enum test_mode
 
 struct gcm128_test_vector
 {
-    unsigned char key[16];
+    unsigned char key[32];
+    size_t key_length;
     unsigned char iv[12];
     size_t aad_length;
     unsigned char * aad;
@@ -64,10 +65,11 @@ static void uninit_test_vector(struct gcm128_test_vector *tv)
 }
 
 // allocates space for aad/plaintext/ciphertext
-static int init_test_vector(struct gcm128_test_vector *tv, size_t aad_length, size_t data_length)
+static int init_test_vector(struct gcm128_test_vector *tv, size_t key_length, size_t aad_length, size_t data_length)
 {
     assert(tv != NULL);
 
+    tv->key_length = key_length;
     tv->aad_length = aad_length;
     tv->data_length = data_length;
     tv->aad = NULL;
@@ -293,7 +295,7 @@ static int get_next_test(FILE *fp, struct gcm128_test_vector *tv, enum test_mode
                 break;
             }
 
-            if(parse_hex(tempLine, "Key = ", tv->key, sizeof(tv->key)) != sizeof(tv->key))
+            if(parse_hex(tempLine, "Key = ", tv->key, (int) tv->key_length) != (int) tv->key_length)
             {
                 printf("could not parse key\n");
                 break;
@@ -430,7 +432,7 @@ static int run_encryption_test(struct gcm128_test_vector *tv)
 
     unsigned char * computed_ciphertext = NULL;
 
-    itc_gcm128_init(&ctx, tv->key);
+    itc_gcm128_init_key(&ctx, tv->key, tv->key_length);
 
     err = itc_gcm128_encrypt_start(&ctx, tv->iv, tv->aad_length, tv->aad);
     if(err != ITC_GCM128_SUCCESS)
@@ -495,6 +497,21 @@ static int run_encryption_test(struct gcm128_test_vector *tv)
             returnCode = -1;
             goto exit;
         }
+
+        //encryption only uses the same keystream
+        err = itc_gcm128_ctr(&ctx, tv->iv, tv->data_length, tv->plaintext, computed_ciphertext);
+        if(err != ITC_GCM128_SUCCESS)
+        {
+            printf("Error during call to itc_gcm128_ctr()\n");
+            returnCode = -1;
+            goto exit;
+        }
+        if(compare_hex(tv->ciphertext, computed_ciphertext, tv->data_length))
+        {
+            printf("Test FAILED! CTR ciphertext does not match.\n");
+            returnCode = -1;
+            goto exit;
+        }
     }
 
     printf("Test PASSED!\n\n");
@@ -514,7 +531,7 @@ static int run_decryption_test(struct gcm128_test_vector *tv)
 
     unsigned char * computed_plaintext = NULL;
 
-    itc_gcm128_init(&ctx, tv->key);
+    itc_gcm128_init_key(&ctx, tv->key, tv->key_length);
 
     err = itc_gcm128_decrypt_start(&ctx, tv->iv, tv->aad_length, tv->aad);
     if(err != ITC_GCM128_SUCCESS)
@@ -624,14 +641,14 @@ static void run_tests(const char *filepath, enum test_mode mode)
     printf("Test attributes for file %s:\n\tKey Length: %ld\n\tIV  Length: %ld\n\tPT  Length: %ld\n\tAAD Length: %ld\n\tTag Length: %ld\n",
             filepath, keyLength, ivLength, ptLength, aadLength, tagLength);
 
-    if(keyLength != 128 || ivLength != 96 || tagLength != 128)
+    if((keyLength != 128 && keyLength != 192 && keyLength != 256) || ivLength != 96 || tagLength != 128)
     {
         printf("Test attributes not valid. Ignoring file.\n");
         goto exit;
     }
 
     //divide by 8 to get length in bytes
-    if(init_test_vector(&test, aadLength/8, ptLength/8))
+    if(init_test_vector(&test, keyLength/8, aadLength/8, ptLength/8))
     {
         printf("Could not initialized test struct\n");
         goto exit;
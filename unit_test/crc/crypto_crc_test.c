@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "crypto_crc.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC
+#endif
+
+#define FRAME_SIZE      1145    /* TM frame covered by the FECF */
+#define MAX_TEST_SIZE   4096
+#define BENCH_ROUNDS    20000
+
+typedef uint16 (*crc16_fn)(uint16, const uint8 *, uint32);
+typedef uint32 (*crc32_fn)(uint32, const uint8 *, uint32);
+
+static unsigned char buffer[MAX_TEST_SIZE + 16];
+
+static unsigned long long now_ticks(void)
+{
+#ifdef HAVE_RDTSC
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+//zero if the check value of "123456789" is correct
+static int run_check_value_test(void)
+{
+    const char *check = "123456789";
+    uint16 crc = Crypto_CRC16_update(CRC16_CCITT_INIT, (const uint8 *) check, 9);
+    uint32 crc32 = Crypto_CRC32_update(CRC32_INIT, (const uint8 *) check, 9);
+
+    printf("Check value: 0x%04x (expected 0x29b1)\n", crc);
+    printf("Check value: 0x%08x (expected 0xcbf43926)\n", crc32);
+    return (crc == 0x29B1 && crc32 == 0xCBF43926) ? 0 : -1;
+}
+
+//zero if the table engine matches the bitwise engine for every length and alignment
+static int run_compare_test(void)
+{
+    uint32 len, offset, split;
+    uint16 expected, actual;
+
+    for(len = 0; len <= 256; ++len)
+    {
+        for(offset = 0; offset < 8; ++offset)
+        {
+            expected = Crypto_CRC16_bitwise(CRC16_CCITT_INIT, buffer + offset, len);
+            actual = Crypto_CRC16_table(CRC16_CCITT_INIT, buffer + offset, len);
+            if(expected != actual)
+            {
+                printf("Mismatch: len %u offset %u expected 0x%04x got 0x%04x\n", len, offset, expected, actual);
+                return -1;
+            }
+
+            // continuing from a previous value must give the same answer
+            split = len / 3;
+            actual = Crypto_CRC16_table(CRC16_CCITT_INIT, buffer + offset, split);
+            actual = Crypto_CRC16_table(actual, buffer + offset + split, len - split);
+            if(expected != actual)
+            {
+                printf("Mismatch: len %u offset %u split %u\n", len, offset, split);
+                return -1;
+            }
+        }
+    }
+
+    expected = Crypto_CRC16_bitwise(CRC16_CCITT_INIT, buffer, MAX_TEST_SIZE);
+    actual = Crypto_CRC16_table(CRC16_CCITT_INIT, buffer, MAX_TEST_SIZE);
+    printf("Compare table against bitwise: %s\n", expected == actual ? "match" : "MISMATCH");
+    return (expected == actual) ? 0 : -1;
+}
+
+#ifdef CRYPTO_CRC_CLMUL
+//zero if the folding engines match the table engines for every length and alignment
+static int run_clmul_test(void)
+{
+    uint32 len, offset;
+    uint16 expected16, actual16;
+    uint32 expected32, actual32;
+
+    for(len = 0; len <= 1200; ++len)
+    {
+        for(offset = 0; offset < 16; offset += 3)
+        {
+            expected16 = Crypto_CRC16_table(CRC16_CCITT_INIT, buffer + offset, len);
+            actual16 = Crypto_CRC16_clmul(CRC16_CCITT_INIT, buffer + offset, len);
+            expected32 = Crypto_CRC32_table(CRC32_INIT, buffer + offset, len);
+            actual32 = Crypto_CRC32_clmul(CRC32_INIT, buffer + offset, len);
+            if(expected16 != actual16 || expected32 != actual32)
+            {
+                printf("Mismatch: len %u offset %u crc16 0x%04x/0x%04x crc32 0x%08x/0x%08x\n",
+                    len, offset, expected16, actual16, expected32, actual32);
+                return -1;
+            }
+        }
+    }
+
+    // running values must chain across calls
+    actual32 = Crypto_CRC32_clmul(CRC32_INIT, buffer, 1000);
+    actual32 = Crypto_CRC32_clmul(actual32, buffer + 1000, MAX_TEST_SIZE - 1000);
+    expected32 = Crypto_CRC32_table(CRC32_INIT, buffer, MAX_TEST_SIZE);
+    printf("Compare clmul against table: %s\n", expected32 == actual32 ? "match" : "MISMATCH");
+    return (expected32 == actual32) ? 0 : -1;
+}
+#endif
+
+static void print_rate(const char *name, uint32 len, unsigned long long start, unsigned long long stop)
+{
+#ifdef HAVE_RDTSC
+    printf("%-16s %5u bytes: %8.3f bytes/cycle\n", name, len,
+        (double) len * BENCH_ROUNDS / (double) (stop - start));
+#else
+    printf("%-16s %5u bytes: %8.3f bytes/ns\n", name, len,
+        (double) len * BENCH_ROUNDS / (double) (stop - start));
+#endif
+}
+
+static void run_benchmark16(const char *name, crc16_fn fn, uint32 len)
+{
+    volatile uint16 sink = 0;
+    unsigned long long start;
+    int i;
+
+    start = now_ticks();
+    for(i = 0; i < BENCH_ROUNDS; ++i)
+    {
+        sink ^= fn(CRC16_CCITT_INIT, buffer, len);
+    }
+    print_rate(name, len, start, now_ticks());
+    (void) sink;
+}
+
+static void run_benchmark32(const char *name, crc32_fn fn, uint32 len)
+{
+    volatile uint32 sink = 0;
+    unsigned long long start;
+    int i;
+
+    start = now_ticks();
+    for(i = 0; i < BENCH_ROUNDS; ++i)
+    {
+        sink ^= fn(CRC32_INIT, buffer, len);
+    }
+    print_rate(name, len, start, now_ticks());
+    (void) sink;
+}
+
+int main(void)
+{
+    int testsPassed = 0, testsFailed = 0;
+    int i;
+
+    srand(1);
+    for(i = 0; i < (int) sizeof(buffer); ++i)
+    {
+        buffer[i] = (unsigned char) rand();
+    }
+
+    Crypto_CRC_Init();
+    printf("Carry-less multiply engines %s\n", Crypto_CRC_clmul_active() ? "active" : "not supported");
+
+    if(run_check_value_test()) ++testsFailed; else ++testsPassed;
+    if(run_compare_test()) ++testsFailed; else ++testsPassed;
+#ifdef CRYPTO_CRC_CLMUL
+    if(Crypto_CRC_clmul_active())
+    {
+        if(run_clmul_test()) ++testsFailed; else ++testsPassed;
+    }
+#endif
+
+    printf("\nBenchmark (TM frame FECF):\n");
+    run_benchmark16("crc16 bitwise", Crypto_CRC16_bitwise, FRAME_SIZE);
+    run_benchmark16("crc16 slice-by-8", Crypto_CRC16_table, FRAME_SIZE);
+    run_benchmark32("crc32 slice-by-8", Crypto_CRC32_table, FRAME_SIZE);
+#ifdef CRYPTO_CRC_CLMUL
+    if(Crypto_CRC_clmul_active())
+    {
+        run_benchmark16("crc16 clmul", Crypto_CRC16_clmul, FRAME_SIZE);
+        run_benchmark32("crc32 clmul", Crypto_CRC32_clmul, FRAME_SIZE);
+    }
+#endif
+
+    printf("\nFinished running tests. %d/%d cases passed.\n", testsPassed, testsPassed + testsFailed);
+
+    return testsFailed;
+}
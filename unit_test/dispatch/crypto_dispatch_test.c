@@ -0,0 +1,252 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crypto.h"
+
+// Built twice: as is the instance under test is the spacecraft, with CRYPTO_GROUND it is the ground
+#ifdef CRYPTO_GROUND
+    #define LOCAL       ground
+    #define PEER        flight
+    #define ROLE        "ground"
+#else
+    #define LOCAL       flight
+    #define PEER        ground
+    #define ROLE        "flight"
+#endif
+
+#define SPI_CLEAR       1
+#define SPI_AEAD        2
+#define TC_VCID         1
+#define TM_VCID         0
+#define AOS_VCID        2
+#define AOS_CLEAR_VCID  3
+#define PDU_SIZE        64
+#define PACKET_SIZE     800
+#define FRAME_SIZE      AOS_FRAME_SIZE  /* larger than a TM frame */
+
+static crypto_instance_t flight;
+static crypto_instance_t ground;
+static uint8 pdu[PDU_SIZE];
+static char packet[PACKET_SIZE];
+static char frame[FRAME_SIZE];
+static char work[FRAME_SIZE];
+
+//puts every frame type of both instances on the AEAD SA
+static void setup(void)
+{
+    crypto_instance_t *inst[2] = {&flight, &ground};
+    int x;
+
+    for(x = 0; x < 2; ++x)
+    {
+        Crypto_Instance_Init(inst[x], CRYPTO_PROVIDER);
+        inst[x]->sa[SPI_AEAD].sa_state = SA_OPERATIONAL;
+        inst[x]->gvcid_tc_map[TC_VCID].spi = SPI_AEAD;
+        inst[x]->gvcid_tm_map[AOS_VCID].spi = SPI_AEAD;
+        inst[x]->gvcid_tm_map[AOS_VCID].tfvn = AOS_TFVN;
+        inst[x]->gvcid_tm_map[AOS_VCID].scid = SCID & 0xFF;
+        inst[x]->gvcid_tm_map[AOS_CLEAR_VCID].spi = SPI_CLEAR;
+        inst[x]->gvcid_tm_map[AOS_CLEAR_VCID].tfvn = AOS_TFVN;
+        inst[x]->gvcid_tm_map[AOS_CLEAR_VCID].scid = SCID & 0xFF;
+    }
+    flight.tm_frame.tm_sec_header.spi = SPI_AEAD;
+    ground.gvcid_tm_map[TM_VCID].spi = SPI_AEAD;
+    ground.gvcid_tm_map[TM_VCID].tfvn = TC_TM_TFVN;
+    ground.gvcid_tm_map[TM_VCID].scid = SCID & 0x3FF;
+}
+
+//writes a TC primary header followed by the test PDU, returns its length
+static int fill_tc(char *buf)
+{
+    buf[0] = (char) ((SCID >> 8) & 0x03);
+    buf[1] = (char) (SCID & 0xFF);
+    buf[2] = (char) (TC_VCID << 2);
+    buf[3] = 0;
+    buf[4] = 0;
+    memcpy(&buf[5], pdu, PDU_SIZE);
+    return 5 + PDU_SIZE;
+}
+
+//writes an unsecured AOS frame of vcid
+static void fill_aos(char *buf, uint8 vcid)
+{
+    memset(buf, 0, AOS_FRAME_SIZE);
+    buf[0] = (char) ((AOS_TFVN << 6) | ((SCID & 0xFC) >> 2));
+    buf[1] = (char) (((SCID & 0x03) << 6) | vcid);
+    memcpy(&buf[AOS_PDU_LOC + AOS_MPDU_HEADER_SIZE], pdu, PDU_SIZE);
+}
+
+//zero if a TFVN 00 frame is secured as TM on the spacecraft, or as TC on the ground
+static int run_tfvn00_apply_test(void)
+{
+    static char tc[TC_MAX_FRAME_SIZE];
+    crypto_tm_view_t view;
+    int len;
+
+    setup();
+    #ifdef CRYPTO_GROUND
+        len = fill_tc(tc);
+        if(Crypto_Instance_ApplySecurity(&LOCAL, tc, &len) != OS_SUCCESS ||
+           Crypto_Instance_TC_ProcessSecurity(&PEER, tc, &len) != OS_SUCCESS ||
+           memcmp(tc, pdu, PDU_SIZE) != 0)
+        {
+            printf(ROLE " apply: TFVN 00 frame not secured as TC\n");
+            return -1;
+        }
+        (void) view;
+    #else
+        memcpy(frame, packet, PACKET_SIZE);
+        len = PACKET_SIZE;
+        if(Crypto_Instance_ApplySecurity(&LOCAL, frame, &len) != OS_SUCCESS ||
+           Crypto_Instance_TM_ProcessSecurityView(&PEER, frame, TM_FILL_SIZE, &view) != OS_SUCCESS ||
+           view.spi != SPI_AEAD)
+        {
+            printf(ROLE " apply: TFVN 00 frame not secured as TM\n");
+            return -1;
+        }
+        (void) tc;
+    #endif
+    printf(ROLE " apply: TFVN 00 routed\n");
+    return 0;
+}
+
+//zero if a TFVN 00 frame is processed as TC on the spacecraft, or as TM on the ground
+static int run_tfvn00_process_test(void)
+{
+    static char tc[TC_MAX_FRAME_SIZE];
+    int len;
+
+    setup();
+    #ifdef CRYPTO_GROUND
+        memcpy(frame, packet, PACKET_SIZE);
+        len = PACKET_SIZE;
+        if(Crypto_Instance_TM_ApplySecurity(&PEER, frame, &len) != OS_SUCCESS)
+        {
+            printf(ROLE " process: TM frame not built\n");
+            return -1;
+        }
+        len = TM_FILL_SIZE;
+        if(Crypto_Instance_ProcessSecurity(&LOCAL, frame, &len) != OS_SUCCESS)
+        {
+            printf(ROLE " process: TFVN 00 frame not processed as TM\n");
+            return -1;
+        }
+        (void) tc;
+    #else
+        len = fill_tc(tc);
+        if(Crypto_Instance_TC_ApplySecurity(&PEER, tc, &len, sizeof(tc)) != OS_SUCCESS)
+        {
+            printf(ROLE " process: TC frame not built\n");
+            return -1;
+        }
+        if(Crypto_Instance_ProcessSecurity(&LOCAL, tc, &len) != OS_SUCCESS || memcmp(tc, pdu, PDU_SIZE) != 0)
+        {
+            printf(ROLE " process: TFVN 00 frame not processed as TC\n");
+            return -1;
+        }
+    #endif
+    printf(ROLE " process: TFVN 00 routed\n");
+    return 0;
+}
+
+//zero if a TFVN 01 frame is secured and processed as AOS
+static int run_tfvn01_test(void)
+{
+    int len = AOS_FRAME_SIZE;
+
+    setup();
+    fill_aos(frame, AOS_VCID);
+    if(Crypto_Instance_ApplySecurity(&LOCAL, frame, &len) != OS_SUCCESS)
+    {
+        printf(ROLE " aos: TFVN 01 frame not secured\n");
+        return -1;
+    }
+    len = AOS_FRAME_SIZE;
+    if(Crypto_Instance_ProcessSecurity(&PEER, frame, &len) != OS_SUCCESS)
+    {
+        printf(ROLE " aos: TFVN 01 frame not processed\n");
+        return -1;
+    }
+    printf(ROLE " aos: TFVN 01 routed both ways\n");
+    return 0;
+}
+
+//zero if empty frames and frames of the unassigned versions are refused untouched, even when
+//they are otherwise clear AOS frames the AOS functions would take
+static int run_unsupported_test(void)
+{
+    uint16 fecf;
+    int len;
+    int tfvn;
+
+    setup();
+    for(tfvn = 2; tfvn < 4; ++tfvn)
+    {
+        fill_aos(frame, AOS_CLEAR_VCID);
+        frame[0] = (char) ((tfvn << 6) | (frame[0] & 0x3F));
+        memcpy(work, frame, AOS_FRAME_SIZE);
+        len = AOS_FRAME_SIZE;
+        if(Crypto_Instance_ApplySecurity(&LOCAL, work, &len) == OS_SUCCESS ||
+           memcmp(work, frame, AOS_FRAME_SIZE) != 0)
+        {
+            printf(ROLE " unsupported: TFVN %d frame secured\n", tfvn);
+            return -1;
+        }
+
+        fill_aos(frame, AOS_CLEAR_VCID);
+        len = AOS_FRAME_SIZE;
+        Crypto_Instance_AOS_ApplySecurity(&PEER, frame, &len);
+        frame[0] = (char) ((tfvn << 6) | (frame[0] & 0x3F));
+        fecf = Crypto_CRC16_update(CRC16_CCITT_INIT, (uint8 *) frame, AOS_FECF_LOC);
+        frame[AOS_FECF_LOC] = (char) (fecf >> 8);
+        frame[AOS_FECF_LOC + 1] = (char) (fecf & 0xFF);
+        memcpy(work, frame, AOS_FRAME_SIZE);
+        len = AOS_FRAME_SIZE;
+        if(Crypto_Instance_ProcessSecurity(&LOCAL, work, &len) == OS_SUCCESS ||
+           memcmp(work, frame, AOS_FRAME_SIZE) != 0)
+        {
+            printf(ROLE " unsupported: TFVN %d frame processed\n", tfvn);
+            return -1;
+        }
+    }
+    len = 0;
+    if(Crypto_Instance_ApplySecurity(&LOCAL, work, &len) == OS_SUCCESS ||
+       Crypto_Instance_ProcessSecurity(&LOCAL, work, &len) == OS_SUCCESS)
+    {
+        printf(ROLE " unsupported: empty frame accepted\n");
+        return -1;
+    }
+    printf(ROLE " unsupported: TFVN 10, 11 and empty frames refused\n");
+    return 0;
+}
+
+int main(void)
+{
+    int testsPassed = 0, testsFailed = 0;
+    int i;
+
+    for(i = 0; i < PDU_SIZE; ++i)
+    {
+        pdu[i] = (uint8) (i * 7 + 1);
+    }
+    for(i = 0; i < PACKET_SIZE; ++i)
+    {
+        packet[i] = (char) (i * 13 + 5);
+    }
+    packet[0] = 0x08;
+    packet[1] = 0x01;
+    packet[4] = (char) ((PACKET_SIZE - 7) >> 8);
+    packet[5] = (char) ((PACKET_SIZE - 7) & 0xFF);
+
+    if(run_tfvn00_apply_test()) ++testsFailed; else ++testsPassed;
+    if(run_tfvn00_process_test()) ++testsFailed; else ++testsPassed;
+    if(run_tfvn01_test()) ++testsFailed; else ++testsPassed;
+    if(run_unsupported_test()) ++testsFailed; else ++testsPassed;
+
+    Crypto_Instance_Free(&flight);
+    Crypto_Instance_Free(&ground);
+
+    printf("\nFinished running tests. %d/%d cases passed.\n", testsPassed, testsPassed + testsFailed);
+
+    return testsFailed;
+}
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "crypto.h"
+
+#define NUM_WORKERS     4
+#define PAYLOAD_SIZE    64
+#define BURST           8
+#define SPI_CLEAR       1
+#define SPI_AEAD        2
+#define VCID_CLEAR      0
+#define VCID_AEAD       1
+
+static crypto_tc_pipeline_t pl;
+static crypto_instance_t ground;
+static crypto_instance_t config;
+static pthread_mutex_t count_lock = PTHREAD_MUTEX_INITIALIZER;
+static int accepted[NUM_SA];
+static int rejected[NUM_SA];
+
+//counts the outcome of each frame by SPI
+static void count_frame(void* arg, uint8 worker, int32 status, const TC_t* tc_frame, char* ingest, int len_ingest)
+{
+    (void) arg;
+    (void) worker;
+    (void) ingest;
+    (void) len_ingest;
+
+    pthread_mutex_lock(&count_lock);
+    if(status == OS_SUCCESS)
+    {
+        accepted[tc_frame->tc_sec_header.spi]++;
+    }
+    else
+    {
+        rejected[tc_frame->tc_sec_header.spi]++;
+    }
+    pthread_mutex_unlock(&count_lock);
+}
+
+static void clear_counts(void)
+{
+    memset(accepted, 0, sizeof(accepted));
+    memset(rejected, 0, sizeof(rejected));
+}
+
+//builds a TC frame on the ground instance and queues it on the pipeline
+static int32 submit_frame(uint8 vcid, const uint8 *pdu, int pdu_len)
+{
+    char frame[TC_PIPELINE_FRAME_SIZE];
+    int len = 5 + pdu_len;
+
+    frame[0] = (char) ((SCID >> 8) & 0x03);
+    frame[1] = (char) (SCID & 0xFF);
+    frame[2] = (char) (vcid << 2);
+    frame[3] = 0;
+    frame[4] = 0;
+    memcpy(&frame[5], pdu, pdu_len);
+    if(Crypto_Instance_TC_ApplySecurity(&ground, frame, &len, sizeof(frame)) != OS_SUCCESS)
+    {
+        return OS_ERROR;
+    }
+    return Crypto_TC_Pipeline_Submit(&pl, frame, len);
+}
+
+static void submit_burst(void)
+{
+    uint8 pdu[PAYLOAD_SIZE];
+
+    for(int i = 0; i < BURST; ++i)
+    {
+        memset(pdu, i, PAYLOAD_SIZE);
+        submit_frame(VCID_AEAD, pdu, PAYLOAD_SIZE);
+    }
+    Crypto_TC_Pipeline_Flush(&pl);
+}
+
+//zero if frames of an SA are only accepted once Crypto_TC_Pipeline_Load started it on the workers
+static int run_load_test(void)
+{
+    SecurityAssociation_t sa = ground.sa[SPI_AEAD];
+
+    clear_counts();
+    submit_burst();
+    // resend from the same IV so the loaded SA sees the frames in its window
+    ground.sa[SPI_AEAD] = sa;
+    if(accepted[SPI_AEAD] != 0)
+    {
+        printf("load: %d frames accepted before the SA was loaded\n", accepted[SPI_AEAD]);
+        return -1;
+    }
+
+    Crypto_TC_Pipeline_Load(&pl, &config);
+    clear_counts();
+    submit_burst();
+    if(accepted[SPI_AEAD] != BURST)
+    {
+        printf("load: %d/%d frames accepted after the SA was loaded\n", accepted[SPI_AEAD], BURST);
+        return -1;
+    }
+    printf("load: SA %d started on %d workers\n", SPI_AEAD, NUM_WORKERS);
+    return 0;
+}
+
+//zero if an SA stop sent on one worker also stops the SA on the worker that owns it
+static int run_sdls_test(void)
+{
+    // SA stop for SPI_AEAD: CCSDS header, PUS header, TLV tag and length, SPI
+    uint8 cmd[] = {0x18, 0x80, 0xC0, 0x00, 0x00, 0x02,
+                   0x19, 0x80, 0x00, 0x00,
+                   (SG_SA_MGMT << 4) | PID_STOP_SA, 0x00, 0x10,
+                   0x00, SPI_AEAD};
+    int w;
+
+    clear_counts();
+    submit_frame(VCID_CLEAR, cmd, sizeof(cmd));
+    Crypto_TC_Pipeline_Flush(&pl);
+    if(accepted[SPI_CLEAR] != 1)
+    {
+        printf("sdls: command frame rejected\n");
+        return -1;
+    }
+    for(w = 0; w < NUM_WORKERS; ++w)
+    {
+        if(pl.worker[w].inst.sa[SPI_AEAD].sa_state != SA_KEYED || pl.worker[w].inst.gvcid_tc_map[VCID_AEAD].spi == SPI_AEAD)
+        {
+            printf("sdls: worker %d still has SA %d operational\n", w, SPI_AEAD);
+            return -1;
+        }
+    }
+
+    submit_burst();
+    if(accepted[SPI_AEAD] != 0)
+    {
+        printf("sdls: %d frames accepted on a stopped SA\n", accepted[SPI_AEAD]);
+        return -1;
+    }
+    printf("sdls: SA %d stopped on %d workers\n", SPI_AEAD, NUM_WORKERS);
+    return 0;
+}
+
+int main(void)
+{
+    int testsPassed = 0, testsFailed = 0;
+
+    // ground sends on the AEAD SA, the workers only learn of it from the loaded configuration
+    Crypto_Instance_Init(&ground, CRYPTO_PROVIDER);
+    ground.sa[SPI_AEAD].sa_state = SA_OPERATIONAL;
+    ground.gvcid_tc_map[VCID_AEAD].spi = SPI_AEAD;
+    Crypto_Instance_Init(&config, CRYPTO_PROVIDER);
+    config.sa[SPI_AEAD].sa_state = SA_OPERATIONAL;
+    config.gvcid_tc_map[VCID_AEAD].spi = SPI_AEAD;
+
+    if(Crypto_TC_Pipeline_Init(&pl, NUM_WORKERS, CRYPTO_PROVIDER, count_frame, NULL) != OS_SUCCESS)
+    {
+        printf("pipeline failed to start\n");
+        return 1;
+    }
+
+    if(run_load_test()) ++testsFailed; else ++testsPassed;
+    if(run_sdls_test()) ++testsFailed; else ++testsPassed;
+
+    Crypto_TC_Pipeline_Free(&pl);
+    Crypto_Instance_Free(&config);
+    Crypto_Instance_Free(&ground);
+
+    printf("\nFinished running tests. %d/%d cases passed.\n", testsPassed, testsPassed + testsFailed);
+
+    return testsFailed;
+}
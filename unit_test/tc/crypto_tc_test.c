@@ -0,0 +1,524 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crypto.h"
+
+#define FRAME_SIZE      1024
+#define PAYLOAD_SIZE    64
+#define SPI_CLEAR       1
+#define SPI_AEAD        2
+#define SPI_AUTH        3
+#define SPI_ENC         4
+#define VCID_CLEAR      0
+#define VCID_AEAD       1
+#define VCID_AUTH       2
+#define VCID_UNMAPPED   3
+#define VCID_ENC        4
+#define MAX_PDU_SIZE    (TC_MAX_FRAME_SIZE - 8 - IV_SIZE - MAC_SIZE - FECF_SIZE)
+
+static crypto_instance_t flight;
+static crypto_instance_t ground;
+static uint8 payload[PAYLOAD_SIZE];
+
+//secures pdu on the ground instance as a TC frame of vcid in a frame of size bytes, returns the frame length
+static int build_frame_size(char *frame, int size, uint8 vcid, const uint8 *pdu, int pdu_len)
+{
+    int len = 5 + pdu_len;
+
+    frame[0] = (char) ((SCID >> 8) & 0x03);
+    frame[1] = (char) (SCID & 0xFF);
+    frame[2] = (char) (vcid << 2);
+    frame[3] = 0;
+    frame[4] = 0;
+    memcpy(&frame[5], pdu, pdu_len);
+    if(Crypto_Instance_TC_ApplySecurity(&ground, frame, &len, size) != OS_SUCCESS)
+    {
+        return -1;
+    }
+    return len;
+}
+
+//secures pdu on the ground instance as a TC frame of vcid, returns the frame length
+static int build_frame(char *frame, uint8 vcid, const uint8 *pdu, int pdu_len)
+{
+    return build_frame_size(frame, FRAME_SIZE, vcid, pdu, pdu_len);
+}
+
+static void setup_sa(crypto_instance_t *inst, uint16 spi, uint8 vcid)
+{
+    inst->sa[spi].sa_state = SA_OPERATIONAL;
+    inst->gvcid_tc_map[vcid].spi = spi;
+    inst->gvcid_tc_map[vcid].tfvn = TC_TM_TFVN;
+    inst->gvcid_tc_map[vcid].scid = SCID & 0x3FF;
+}
+
+static void setup(void)
+{
+    Crypto_Instance_Init(&flight, CRYPTO_PROVIDER);
+    Crypto_Instance_Init(&ground, CRYPTO_PROVIDER);
+    setup_sa(&flight, SPI_AEAD, VCID_AEAD);
+    setup_sa(&ground, SPI_AEAD, VCID_AEAD);
+    setup_sa(&flight, SPI_AUTH, VCID_AUTH);
+    setup_sa(&ground, SPI_AUTH, VCID_AUTH);
+    setup_sa(&flight, SPI_ENC, VCID_ENC);
+    setup_sa(&ground, SPI_ENC, VCID_ENC);
+    // authentication only SA
+    flight.sa[SPI_AUTH].est = 0;
+    ground.sa[SPI_AUTH].est = 0;
+    // encryption only SA
+    flight.sa[SPI_ENC].ast = 0;
+    ground.sa[SPI_ENC].ast = 0;
+}
+
+//zero if every frame of a mixed batch gets its own status
+static int run_batch_test(void)
+{
+    static char frames[6][FRAME_SIZE];
+    char *ingest[6];
+    int len[6];
+    int32 status[6];
+    const int32 expect[6] = {OS_SUCCESS, OS_ERROR, OS_ERROR, OS_SUCCESS, OS_ERROR, OS_SUCCESS};
+    int x;
+
+    setup();
+    len[0] = build_frame(frames[0], VCID_AEAD, payload, PAYLOAD_SIZE);
+    // bad MAC on the channel just verified
+    len[1] = build_frame(frames[1], VCID_AEAD, payload, PAYLOAD_SIZE);
+    frames[1][len[1] - 3] ^= 0x01;
+    // replay of the first frame
+    memcpy(frames[2], frames[0], len[0]);
+    len[2] = len[0];
+    // another channel
+    len[3] = build_frame(frames[3], VCID_CLEAR, payload, PAYLOAD_SIZE);
+    // a channel no SA serves
+    memcpy(frames[4], frames[3], len[3]);
+    frames[4][2] = (char) ((VCID_UNMAPPED << 2) | (frames[4][2] & 0x03));
+    len[4] = len[3];
+    // back on the first channel
+    len[5] = build_frame(frames[5], VCID_AEAD, payload, PAYLOAD_SIZE);
+    for(x = 0; x < 6; ++x)
+    {
+        ingest[x] = frames[x];
+    }
+
+    if(Crypto_Instance_TC_ProcessSecurityBatch(&flight, ingest, len, status, 6) == OS_SUCCESS)
+    {
+        printf("batch: failing frames not reported\n");
+        return -1;
+    }
+    for(x = 0; x < 6; ++x)
+    {
+        if(status[x] != expect[x])
+        {
+            printf("batch: frame %d status %d, expected %d\n", x, status[x], expect[x]);
+            return -1;
+        }
+    }
+    if(memcmp(frames[5], payload, PAYLOAD_SIZE) != 0)
+    {
+        printf("batch: last frame PDU mismatch\n");
+        return -1;
+    }
+    printf("batch: per frame status ok\n");
+    return 0;
+}
+
+//zero if the channel cached by a batch is dropped once an SDLS command changed the SAs
+static int run_batch_sdls_test(void)
+{
+    static char frames[2][FRAME_SIZE];
+    char *ingest[2];
+    int len[2];
+    int32 status[2];
+    // SA stop for the SA that carries the command
+    uint8 cmd[] = {0x18, 0x80, 0xC0, 0x00, 0x00, 0x02,
+                   0x19, 0x80, 0x00, 0x00,
+                   (SG_SA_MGMT << 4) | PID_STOP_SA, 0x00, 0x10,
+                   0x00, SPI_CLEAR};
+
+    setup();
+    len[0] = build_frame(frames[0], VCID_CLEAR, cmd, sizeof(cmd));
+    len[1] = build_frame(frames[1], VCID_CLEAR, payload, PAYLOAD_SIZE);
+    ingest[0] = frames[0];
+    ingest[1] = frames[1];
+
+    Crypto_Instance_TC_ProcessSecurityBatch(&flight, ingest, len, status, 2);
+    if(status[0] != OS_SUCCESS || status[1] == OS_SUCCESS)
+    {
+        printf("batch sdls: status %d %d, frame after SA stop accepted\n", status[0], status[1]);
+        return -1;
+    }
+    printf("batch sdls: channel dropped after SA stop\n");
+    return 0;
+}
+
+//zero if both view modes decrypt a good frame and reject frames whose length does not fit
+static int run_view_length_test(void)
+{
+    char frame[FRAME_SIZE];
+    char work[FRAME_SIZE];
+    uint8 out[FRAME_SIZE];
+    crypto_tc_view_t view;
+    int len;
+    int mode;
+
+    setup();
+    for(mode = 0; mode < 2; ++mode)
+    {
+        uint8 *dest = (mode == 0) ? NULL : out;
+
+        len = build_frame(frame, VCID_AEAD, payload, PAYLOAD_SIZE);
+        memcpy(work, frame, len);
+        if(Crypto_Instance_TC_ProcessSecurityView(&flight, work, len, dest, FRAME_SIZE, &view) != OS_SUCCESS ||
+           view.len != PAYLOAD_SIZE || memcmp(&view.buf[view.offset], payload, PAYLOAD_SIZE) != 0)
+        {
+            printf("view %d: good frame not decrypted\n", mode);
+            return -1;
+        }
+
+        // frame length claims more bytes than were received
+        len = build_frame(frame, VCID_AEAD, payload, PAYLOAD_SIZE);
+        memcpy(work, frame, len);
+        if(Crypto_Instance_TC_ProcessSecurityView(&flight, work, len - 1, dest, FRAME_SIZE, &view) == OS_SUCCESS)
+        {
+            printf("view %d: truncated frame accepted\n", mode);
+            return -1;
+        }
+
+        // 31 byte frame, shorter than the security header and trailer
+        memcpy(work, frame, 31);
+        work[2] = (char) (work[2] & 0xFC);
+        work[3] = 30;
+        if(Crypto_Instance_TC_ProcessSecurityView(&flight, work, 31, dest, FRAME_SIZE, &view) == OS_SUCCESS)
+        {
+            printf("view %d: short frame accepted\n", mode);
+            return -1;
+        }
+    }
+
+    // output buffer one byte too small
+    len = build_frame(frame, VCID_AEAD, payload, PAYLOAD_SIZE);
+    memcpy(work, frame, len);
+    if(Crypto_Instance_TC_ProcessSecurityView(&flight, work, len, out, PAYLOAD_SIZE - 1, &view) == OS_SUCCESS)
+    {
+        printf("view: PDU written past the output buffer\n");
+        return -1;
+    }
+    printf("view: frame lengths checked in place and with an output buffer\n");
+    return 0;
+}
+
+//zero if frames secured on every kind of SA are accepted with their PDU intact
+static int run_round_trip_test(void)
+{
+    char frame[FRAME_SIZE];
+    const uint8 vcid[4] = {VCID_CLEAR, VCID_AEAD, VCID_AUTH, VCID_ENC};
+    // whether the PDU travels encrypted
+    const int hidden[4] = {0, 1, 0, 1};
+    const int pdu_loc[4] = {10, 8 + IV_SIZE, 8 + IV_SIZE, 8 + IV_SIZE};
+    int len;
+    int x;
+
+    setup();
+    for(x = 0; x < 4; ++x)
+    {
+        len = build_frame(frame, vcid[x], payload, PAYLOAD_SIZE);
+        if(len < 0)
+        {
+            printf("round trip: VCID %d not secured\n", vcid[x]);
+            return -1;
+        }
+        if((memcmp(&frame[pdu_loc[x]], payload, PAYLOAD_SIZE) != 0) != hidden[x])
+        {
+            printf("round trip: VCID %d PDU %s\n", vcid[x], hidden[x] ? "sent in the clear" : "altered");
+            return -1;
+        }
+        if(Crypto_Instance_TC_ProcessSecurity(&flight, frame, &len) != OS_SUCCESS ||
+           memcmp(frame, payload, PAYLOAD_SIZE) != 0)
+        {
+            printf("round trip: VCID %d frame not recovered\n", vcid[x]);
+            return -1;
+        }
+    }
+    printf("round trip: clear, AEAD, auth and enc frames recovered\n");
+    return 0;
+}
+
+//zero if frames over 1024 bytes or larger than the buffer are refused before it is written
+static int run_apply_length_test(void)
+{
+    static uint8 pdu[MAX_PDU_SIZE + 1];
+    char frame[FRAME_SIZE];
+    int len;
+
+    setup();
+    memset(pdu, 0x5A, sizeof(pdu));
+    // one byte over the 10 bit frame length
+    memset(frame, 0, sizeof(frame));
+    if(build_frame(frame, VCID_AEAD, pdu, MAX_PDU_SIZE + 1) >= 0 || frame[6] != 0x5A)
+    {
+        printf("apply length: frame over 1024 bytes secured\n");
+        return -1;
+    }
+    // buffer one byte short of the secured frame
+    if(build_frame_size(frame, TC_MAX_FRAME_SIZE - 1, VCID_AEAD, pdu, MAX_PDU_SIZE) >= 0 || frame[6] != 0x5A)
+    {
+        printf("apply length: frame written past the buffer\n");
+        return -1;
+    }
+    // the largest frame fits exactly
+    len = build_frame_size(frame, TC_MAX_FRAME_SIZE, VCID_AEAD, pdu, MAX_PDU_SIZE);
+    if(len != TC_MAX_FRAME_SIZE || Crypto_Instance_TC_ProcessSecurity(&flight, frame, &len) != OS_SUCCESS ||
+       memcmp(frame, pdu, MAX_PDU_SIZE) != 0)
+    {
+        printf("apply length: largest frame not secured\n");
+        return -1;
+    }
+    printf("apply length: frame and buffer sizes checked\n");
+    return 0;
+}
+
+//zero if forged IVs on an encryption only SA cannot move its window past the genuine frames,
+//and the SA keeps taking frames beyond its forward window
+static int run_enc_window_test(void)
+{
+    char forged[FRAME_SIZE];
+    char frame[FRAME_SIZE];
+    uint8 iv[IV_SIZE];
+    int forged_len;
+    int len;
+    int x;
+
+    setup();
+    forged_len = build_frame(forged, VCID_ENC, payload, PAYLOAD_SIZE);
+    // each forgery claims an IV at the far edge of the forward window, until the window would
+    // have moved further than it tracks
+    for(x = 0; x <= ARC_WINDOW_BITS / 4; ++x)
+    {
+        memcpy(iv, flight.sa[SPI_ENC].iv, IV_SIZE);
+        Crypto_increment(iv, IV_SIZE);
+        Crypto_increment(iv, IV_SIZE);
+        Crypto_increment(iv, IV_SIZE);
+        Crypto_increment(iv, IV_SIZE);
+        memcpy(frame, forged, forged_len);
+        memcpy(&frame[8], iv, IV_SIZE);
+        len = forged_len;
+        Crypto_Instance_TC_ProcessSecurity(&flight, frame, &len);
+    }
+    for(x = 0; x < 8; ++x)
+    {
+        len = build_frame(frame, VCID_ENC, payload, PAYLOAD_SIZE);
+        if(Crypto_Instance_TC_ProcessSecurity(&flight, frame, &len) != OS_SUCCESS ||
+           memcmp(frame, payload, PAYLOAD_SIZE) != 0)
+        {
+            printf("enc window: genuine frame %d refused\n", x);
+            return -1;
+        }
+    }
+    printf("enc window: forged IVs left the encryption only SA usable\n");
+    return 0;
+}
+
+//starts spi on TC VCID 16 * n through the clear channel, GVCID fields as Crypto_SA_start reads them
+static int32 start_sa(uint16 spi, uint8 n)
+{
+    char frame[FRAME_SIZE];
+    uint8 cmd[] = {0x18, 0x80, 0xC0, 0x00, 0x00, 0x06,
+                   0x19, 0x80, 0x00, 0x00,
+                   (SG_SA_MGMT << 4) | PID_START_SA, 0x00, 0x04,
+                   0x00, (uint8) spi,
+                   (SCID >> 12) & 0x0F, (SCID >> 4) & 0xFF, ((SCID & 0x0F) << 4) | n, TYPE_TC};
+    int len;
+
+    len = build_frame(frame, VCID_CLEAR, cmd, sizeof(cmd));
+    return Crypto_Instance_TC_ProcessSecurity(&flight, frame, &len);
+}
+
+//zero if starting an SA on a channel another operational SA serves takes only that channel, and
+//stops the other SA once it is left with none
+static int run_sa_start_test(void)
+{
+    char frame[FRAME_SIZE];
+    int len;
+
+    setup();
+    // SPI 2 also serves VCID 1, SPI 3 serves VCID 32 only, SPI 4 is stopped
+    setup_sa(&flight, SPI_AEAD, 16);
+    setup_sa(&flight, SPI_AUTH, 32);
+    flight.gvcid_tc_map[VCID_AUTH].spi = 0;
+    flight.gvcid_tc_map[VCID_ENC].spi = 0;
+    flight.sa[SPI_ENC].sa_state = SA_KEYED;
+
+    if(start_sa(5, 1) != OS_SUCCESS || flight.sa[5].sa_state != SA_OPERATIONAL || flight.gvcid_tc_map[16].spi != 5)
+    {
+        printf("sa start: SPI 5 not started on VCID 16\n");
+        return -1;
+    }
+    if(flight.sa[SPI_AEAD].sa_state != SA_OPERATIONAL || flight.gvcid_tc_map[VCID_AEAD].spi != SPI_AEAD)
+    {
+        printf("sa start: SPI %d lost the channel it kept\n", SPI_AEAD);
+        return -1;
+    }
+    len = build_frame(frame, VCID_AEAD, payload, PAYLOAD_SIZE);
+    if(Crypto_Instance_TC_ProcessSecurity(&flight, frame, &len) != OS_SUCCESS)
+    {
+        printf("sa start: frame on the kept channel refused\n");
+        return -1;
+    }
+
+    if(start_sa(SPI_ENC, 2) != OS_SUCCESS || flight.sa[SPI_ENC].sa_state != SA_OPERATIONAL ||
+       flight.gvcid_tc_map[32].spi != SPI_ENC)
+    {
+        printf("sa start: SPI %d not started on VCID 32\n", SPI_ENC);
+        return -1;
+    }
+    if(flight.sa[SPI_AUTH].sa_state != SA_KEYED)
+    {
+        printf("sa start: SPI %d left operational without a channel\n", SPI_AUTH);
+        return -1;
+    }
+    printf("sa start: displaced SAs released their channels\n");
+    return 0;
+}
+
+static int32 fail_key_load(crypto_provider_ctx_t *ctx, const uint8 *key, uint16 key_len)
+{
+    return OS_ERROR;
+}
+
+static int32 fail_aead_encrypt(crypto_provider_ctx_t *ctx, const uint8 *iv, uint16 iv_len,
+                               const uint8 *aad, uint32 aad_len, const uint8 *in, uint8 *out, uint32 len,
+                               uint8 *mac, uint16 mac_len)
+{
+    return OS_ERROR;
+}
+
+//zero if a key that cannot be loaded leaves the frame untouched, and a failed encryption reports no frame
+static int run_apply_fail_test(void)
+{
+    char frame[FRAME_SIZE];
+    char before[FRAME_SIZE];
+    const crypto_provider_t *provider;
+    crypto_provider_t failing;
+    int len;
+
+    setup();
+    provider = ground.provider;
+    failing = *provider;
+    failing.key_load = fail_key_load;
+    ground.provider = &failing;
+
+    frame[0] = (char) ((SCID >> 8) & 0x03);
+    frame[1] = (char) (SCID & 0xFF);
+    frame[2] = (char) (VCID_AEAD << 2);
+    frame[3] = 0;
+    frame[4] = 0;
+    memcpy(&frame[5], payload, PAYLOAD_SIZE);
+    memcpy(before, frame, FRAME_SIZE);
+    len = 5 + PAYLOAD_SIZE;
+    if(Crypto_Instance_TC_ApplySecurity(&ground, frame, &len, FRAME_SIZE) == OS_SUCCESS ||
+       len != 5 + PAYLOAD_SIZE || memcmp(frame, before, FRAME_SIZE) != 0)
+    {
+        ground.provider = provider;
+        printf("apply fail: frame changed without a key\n");
+        return -1;
+    }
+
+    failing.key_load = provider->key_load;
+    failing.aead_encrypt = fail_aead_encrypt;
+    if(Crypto_Instance_TC_ApplySecurity(&ground, frame, &len, FRAME_SIZE) == OS_SUCCESS || len != 0)
+    {
+        ground.provider = provider;
+        printf("apply fail: length %d kept after a failed encryption\n", len);
+        return -1;
+    }
+    ground.provider = provider;
+    printf("apply fail: frame kept or dropped\n");
+    return 0;
+}
+
+//creates spi through the clear channel with an abm_len byte ABM, the remaining fields as in the default AEAD SA
+static int32 create_sa(uint16 spi, uint8 abm_len)
+{
+    char frame[FRAME_SIZE];
+    uint8 cmd[64] = {0x18, 0x80, 0xC0, 0x00, 0x00, 0x00,
+                     0x19, 0x80, 0x00, 0x00,
+                     (SG_SA_MGMT << 4) | PID_CREATE_SA, 0x00, 0x00};
+    int n = 13;
+    int len;
+    int x;
+
+    cmd[n++] = 0x00;
+    cmd[n++] = (uint8) spi;
+    cmd[n++] = 0xC0 | IV_SIZE;
+    cmd[n++] = 0x00;
+    cmd[n++] = MAC_SIZE;
+    cmd[n++] = 1;
+    cmd[n++] = 0x01;
+    cmd[n++] = IV_SIZE;
+    for(x = 0; x < IV_SIZE; ++x)
+    {
+        cmd[n++] = 0;
+    }
+    cmd[n++] = 1;
+    cmd[n++] = 0x00;
+    cmd[n++] = 0x00;
+    cmd[n++] = abm_len;
+    for(x = 0; x < abm_len; ++x)
+    {
+        cmd[n++] = 0xFF;
+    }
+    cmd[n++] = 0;
+    cmd[n++] = 1;
+    cmd[n++] = 5;
+    cmd[5] = (uint8) (n - 13);
+
+    len = build_frame(frame, VCID_CLEAR, cmd, n);
+    return Crypto_Instance_TC_ProcessSecurity(&flight, frame, &len);
+}
+
+//zero if an SA create with an ABM longer than ABM_SIZE leaves the SA untouched
+static int run_sa_create_test(void)
+{
+    setup();
+    if(create_sa(7, ABM_SIZE) != OS_SUCCESS || flight.sa[7].sa_state != SA_UNKEYED || flight.sa[7].abm_len != ABM_SIZE)
+    {
+        printf("sa create: SPI 7 not created with a %d byte ABM\n", ABM_SIZE);
+        return -1;
+    }
+    if(create_sa(8, ABM_SIZE + 1) != OS_SUCCESS || flight.sa[8].sa_state != SA_NONE || flight.sa[8].abm_len != 0)
+    {
+        printf("sa create: SPI 8 created with a %d byte ABM\n", ABM_SIZE + 1);
+        return -1;
+    }
+    printf("sa create: oversized ABM refused\n");
+    return 0;
+}
+
+int main(void)
+{
+    int testsPassed = 0, testsFailed = 0;
+    int i;
+
+    for(i = 0; i < PAYLOAD_SIZE; ++i)
+    {
+        payload[i] = (uint8) (i * 7 + 1);
+    }
+
+    if(run_batch_test()) ++testsFailed; else ++testsPassed;
+    if(run_batch_sdls_test()) ++testsFailed; else ++testsPassed;
+    if(run_view_length_test()) ++testsFailed; else ++testsPassed;
+    if(run_round_trip_test()) ++testsFailed; else ++testsPassed;
+    if(run_apply_length_test()) ++testsFailed; else ++testsPassed;
+    if(run_enc_window_test()) ++testsFailed; else ++testsPassed;
+    if(run_sa_start_test()) ++testsFailed; else ++testsPassed;
+    if(run_apply_fail_test()) ++testsFailed; else ++testsPassed;
+    if(run_sa_create_test()) ++testsFailed; else ++testsPassed;
+
+    Crypto_Instance_Free(&flight);
+    Crypto_Instance_Free(&ground);
+
+    printf("\nFinished running tests. %d/%d cases passed.\n", testsPassed, testsPassed + testsFailed);
+
+    return testsFailed;
+}
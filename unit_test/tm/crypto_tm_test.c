@@ -0,0 +1,517 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "crypto.h"
+
+#define FRAME_SIZE      TM_FILL_SIZE
+#define PACKET_SIZE     800
+#define BENCH_FRAMES    20000
+#define SPI_CLEAR       1
+#define SPI_AEAD        2
+#define SPI_AUTH        3
+#define SPI_ENC         4
+#define MUX_FRAMES      16
+
+static crypto_instance_t flight;
+static crypto_instance_t ground;
+static char packet[PACKET_SIZE];
+static char frames[16][FRAME_SIZE + 16];
+static char work[FRAME_SIZE + 16];
+static uint8 stream[MUX_FRAMES * FRAME_SIZE];
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static void setup_link(void)
+{
+    int spi;
+
+    Crypto_Instance_Init(&flight, CRYPTO_PROVIDER);
+    Crypto_Instance_Init(&ground, CRYPTO_PROVIDER);
+    for(spi = SPI_AEAD; spi <= SPI_ENC; ++spi)
+    {
+        flight.sa[spi].sa_state = SA_OPERATIONAL;
+        ground.sa[spi].sa_state = SA_OPERATIONAL;
+    }
+    // authentication only SA
+    flight.sa[SPI_AUTH].est = 0;
+    ground.sa[SPI_AUTH].est = 0;
+    // encryption only SA
+    flight.sa[SPI_ENC].ast = 0;
+    ground.sa[SPI_ENC].ast = 0;
+    // ground takes VCID 0 frames on the SA the flight side uses
+    ground.gvcid_tm_map[0].tfvn = TC_TM_TFVN;
+    ground.gvcid_tm_map[0].scid = SCID & 0x3FF;
+}
+
+//sends VCID 0 frames on spi
+static void use_spi(uint16 spi)
+{
+    flight.tm_frame.tm_sec_header.spi = spi;
+    ground.gvcid_tm_map[0].spi = spi;
+}
+
+//builds one frame on the flight instance from the test packet
+static int32 build_frame(char *frame)
+{
+    int len = PACKET_SIZE;
+
+    if(Crypto_Instance_TM_QueuePacket(&flight, packet, len) != OS_SUCCESS)
+    {
+        return OS_ERROR;
+    }
+    return Crypto_Instance_TM_NextFrame(&flight, frame, &len);
+}
+
+//zero if every frame verifies and carries the queued packet at its first header pointer
+static int run_roundtrip_test(uint16 spi)
+{
+    crypto_tm_view_t view;
+    char *frame = frames[0];
+
+    use_spi(spi);
+    if(build_frame(frame) != OS_SUCCESS)
+    {
+        printf("SPI %d: frame build failed\n", spi);
+        return -1;
+    }
+    if(Crypto_Instance_TM_ProcessSecurityView(&ground, frame, FRAME_SIZE, &view) != OS_SUCCESS)
+    {
+        printf("SPI %d: frame did not verify\n", spi);
+        return -1;
+    }
+    if(view.spi != spi || memcmp(&view.buf[view.offset + view.fhp], packet, 16) != 0)
+    {
+        printf("SPI %d: PDU mismatch (fhp %d)\n", spi, view.fhp);
+        return -1;
+    }
+    printf("SPI %d: round trip ok, PDU %d bytes\n", spi, view.len);
+    return 0;
+}
+
+//zero if a modified frame is rejected
+static int run_tamper_test(uint16 spi)
+{
+    crypto_tm_view_t view;
+    char *frame = frames[0];
+    uint16 fecf;
+
+    use_spi(spi);
+    build_frame(frame);
+
+    // flip a data bit and repair the FECF so only the MAC can catch it
+    frame[100] ^= 0x01;
+    fecf = Crypto_CRC16_update(CRC16_CCITT_INIT, (uint8 *) frame, FRAME_SIZE - 2);
+    frame[FRAME_SIZE - 2] = (char) (fecf >> 8);
+    frame[FRAME_SIZE - 1] = (char) (fecf & 0xFF);
+    if(Crypto_Instance_TM_ProcessSecurityView(&ground, frame, FRAME_SIZE, &view) == OS_SUCCESS)
+    {
+        printf("SPI %d: tampered frame accepted\n", spi);
+        return -1;
+    }
+    printf("SPI %d: tampered frame rejected\n", spi);
+    return 0;
+}
+
+//zero if a frame is accepted once and its replay is rejected
+static int run_replay_test(uint16 spi)
+{
+    crypto_tm_view_t view;
+
+    setup_link();
+    use_spi(spi);
+    build_frame(frames[0]);
+    memcpy(work, frames[0], FRAME_SIZE);
+    if(Crypto_Instance_TM_ProcessSecurityView(&ground, frames[0], FRAME_SIZE, &view) != OS_SUCCESS)
+    {
+        printf("SPI %d: frame did not verify\n", spi);
+        return -1;
+    }
+    if(Crypto_Instance_TM_ProcessSecurityView(&ground, work, FRAME_SIZE, &view) == OS_SUCCESS)
+    {
+        printf("SPI %d: replayed frame accepted\n", spi);
+        return -1;
+    }
+    build_frame(frames[0]);
+    if(Crypto_Instance_TM_ProcessSecurityView(&ground, frames[0], FRAME_SIZE, &view) != OS_SUCCESS)
+    {
+        printf("SPI %d: frame after the replay rejected\n", spi);
+        return -1;
+    }
+    printf("SPI %d: replayed frame rejected\n", spi);
+    return 0;
+}
+
+//space packet of len bytes with APID 1 and a data pattern from seed
+static void make_packet(char *buf, int len, int seed)
+{
+    int i;
+
+    for(i = 6; i < len; ++i)
+    {
+        buf[i] = (char) (i * 13 + seed);
+    }
+    buf[0] = 0x08;
+    buf[1] = 0x01;
+    buf[2] = (char) 0xC0;
+    buf[3] = (char) seed;
+    buf[4] = (char) ((len - 7) >> 8);
+    buf[5] = (char) ((len - 7) & 0xFF);
+}
+
+//builds the next multiplexed frame and verifies it on the ground, view describes its PDU
+static int32 next_frame(char *frame, crypto_tm_view_t *view)
+{
+    int len = FRAME_SIZE;
+
+    if(Crypto_Instance_TM_NextFrame(&flight, frame, &len) != OS_SUCCESS)
+    {
+        return OS_ERROR;
+    }
+    return Crypto_Instance_TM_ProcessSecurityView(&ground, frame, FRAME_SIZE, view);
+}
+
+//rewrites the SPI of a frame and repairs its FECF
+static void set_frame_spi(char *frame, uint16 spi)
+{
+    uint16 fecf;
+
+    frame[6] = (char) (spi >> 8);
+    frame[7] = (char) (spi & 0xFF);
+    fecf = Crypto_CRC16_update(CRC16_CCITT_INIT, (uint8 *) frame, FRAME_SIZE - 2);
+    frame[FRAME_SIZE - 2] = (char) (fecf >> 8);
+    frame[FRAME_SIZE - 1] = (char) (fecf & 0xFF);
+}
+
+//zero if frames are rejected unless their SPI is the operational SA of their channel
+static int run_channel_test(void)
+{
+    crypto_tm_view_t view;
+    const uint16 forged[] = {10, 6, SPI_AEAD};
+    int i;
+
+    setup_link();
+    use_spi(SPI_CLEAR);
+    for(i = 0; i < 3; ++i)
+    {
+        // SA_NONE, SA_UNKEYED and an operational SA of another channel
+        build_frame(frames[0]);
+        set_frame_spi(frames[0], forged[i]);
+        if(Crypto_Instance_TM_ProcessSecurityView(&ground, frames[0], FRAME_SIZE, &view) == OS_SUCCESS)
+        {
+            printf("channel: frame on SPI %d accepted for VCID 0\n", forged[i]);
+            return -1;
+        }
+    }
+    flight.tm_frame.tm_header.vcid = 5;
+    build_frame(frames[0]);
+    if(Crypto_Instance_TM_ProcessSecurityView(&ground, frames[0], FRAME_SIZE, &view) == OS_SUCCESS)
+    {
+        printf("channel: frame on unmapped VCID 5 accepted\n");
+        return -1;
+    }
+    flight.tm_frame.tm_header.vcid = 0;
+    build_frame(frames[0]);
+    if(Crypto_Instance_TM_ProcessSecurityView(&ground, frames[0], FRAME_SIZE, &view) != OS_SUCCESS)
+    {
+        printf("channel: frame on the mapped SA rejected\n");
+        return -1;
+    }
+    printf("channel: foreign SPIs and unmapped VCIDs rejected\n");
+    return 0;
+}
+
+//zero if a packet longer than a PDU continues at the start of the next frame
+static int run_mux_split_test(void)
+{
+    static char big[1500];
+    crypto_tm_view_t view;
+    int first;
+
+    setup_link();
+    use_spi(SPI_CLEAR);
+    make_packet(big, sizeof(big), 1);
+    Crypto_Instance_TM_QueuePacket(&flight, big, sizeof(big));
+
+    if(next_frame(frames[0], &view) != OS_SUCCESS || view.fhp != 0 ||
+       memcmp(&view.buf[view.offset], big, view.len) != 0)
+    {
+        printf("mux split: first frame does not start the packet\n");
+        return -1;
+    }
+    first = view.len;
+    if(next_frame(frames[1], &view) != OS_SUCCESS || view.fhp != sizeof(big) - first ||
+       memcmp(&view.buf[view.offset], &big[first], sizeof(big) - first) != 0)
+    {
+        printf("mux split: second frame does not continue the packet (fhp %d)\n", view.fhp);
+        return -1;
+    }
+    printf("mux split: %d byte packet spans two frames\n", (int) sizeof(big));
+    return 0;
+}
+
+//zero if frames without a packet start and frames of only idle data get the reserved FHP values
+static int run_mux_fhp_test(void)
+{
+    static char big[2600];
+    crypto_tm_view_t view;
+    uint16 fhp[4];
+    int i;
+
+    setup_link();
+    use_spi(SPI_CLEAR);
+    make_packet(big, sizeof(big), 2);
+    Crypto_Instance_TM_QueuePacket(&flight, big, sizeof(big));
+    for(i = 0; i < 4; ++i)
+    {
+        if(next_frame(frames[i], &view) != OS_SUCCESS)
+        {
+            printf("mux fhp: frame %d did not verify\n", i);
+            return -1;
+        }
+        fhp[i] = view.fhp;
+    }
+    if(fhp[0] != 0 || fhp[1] != TM_FHP_NO_HEADER || fhp[2] != sizeof(big) - 2 * view.len || fhp[3] != TM_FHP_IDLE)
+    {
+        printf("mux fhp: got 0x%x 0x%x 0x%x 0x%x\n", fhp[0], fhp[1], fhp[2], fhp[3]);
+        return -1;
+    }
+    printf("mux fhp: no header and idle frames marked\n");
+    return 0;
+}
+
+//zero if the queue rejects packets that do not match their header or do not fit
+static int run_mux_queue_test(void)
+{
+    crypto_tm_view_t view;
+    int queued = 0;
+
+    setup_link();
+    use_spi(SPI_CLEAR);
+    if(Crypto_Instance_TM_QueuePacket(&flight, packet, PACKET_SIZE - 1) == OS_SUCCESS ||
+       Crypto_Instance_TM_QueuePacket(&flight, packet, 6) == OS_SUCCESS)
+    {
+        printf("mux queue: packet with wrong length accepted\n");
+        return -1;
+    }
+    while(Crypto_Instance_TM_QueuePacket(&flight, packet, PACKET_SIZE) == OS_SUCCESS)
+    {
+        ++queued;
+    }
+    if(queued != TM_MUX_SIZE / PACKET_SIZE)
+    {
+        printf("mux queue: %d packets queued, expected %d\n", queued, TM_MUX_SIZE / PACKET_SIZE);
+        return -1;
+    }
+    next_frame(frames[0], &view);
+    if(Crypto_Instance_TM_QueuePacket(&flight, packet, PACKET_SIZE) != OS_SUCCESS)
+    {
+        printf("mux queue: no room after a frame was sent\n");
+        return -1;
+    }
+    printf("mux queue: full queue and length mismatch rejected\n");
+    return 0;
+}
+
+//zero if a TM_ApplySecurity frame is refused while a queued packet is only partly sent
+static int run_mux_apply_test(void)
+{
+    static char big[1500];
+    crypto_tm_view_t view;
+    int len;
+
+    setup_link();
+    use_spi(SPI_CLEAR);
+    make_packet(big, sizeof(big), 3);
+    Crypto_Instance_TM_QueuePacket(&flight, big, sizeof(big));
+    next_frame(frames[0], &view);
+    memcpy(work, packet, PACKET_SIZE);
+    len = PACKET_SIZE;
+    if(Crypto_Instance_TM_ApplySecurity(&flight, work, &len) == OS_SUCCESS)
+    {
+        printf("mux apply: frame built inside a queued packet\n");
+        return -1;
+    }
+    next_frame(frames[1], &view);
+    memcpy(work, packet, PACKET_SIZE);
+    len = PACKET_SIZE;
+    if(Crypto_Instance_TM_ApplySecurity(&flight, work, &len) != OS_SUCCESS)
+    {
+        printf("mux apply: frame refused after the queued packet was sent\n");
+        return -1;
+    }
+    printf("mux apply: mixed use refused while a packet is cut\n");
+    return 0;
+}
+
+//zero if walking the packets of several frames from the first header pointer recovers every
+//queued packet, and each frame's FHP points at the first packet that starts in it
+static int run_mux_reassembly_test(void)
+{
+    static const int sizes[] = {300, 1500, 64, 2600, 700, 7, 1100};
+    static char pkts[7][2600];
+    crypto_tm_view_t view;
+    int start[MUX_FRAMES];
+    uint16 fhp[MUX_FRAMES];
+    static uint8 user[MUX_FRAMES * FRAME_SIZE];
+    int first[MUX_FRAMES];
+    int num_frames = 0;
+    int pdu_len = 0;
+    int len = 0;
+    int pos, next, expect, f, k = 0;
+
+    setup_link();
+    use_spi(SPI_AEAD);
+    for(f = 0; f < 7; ++f)
+    {
+        make_packet(pkts[f], sizes[f], f + 10);
+    }
+
+    // queue packets as room appears, then drain the queue plus one idle frame
+    for(f = 0; (f < 7) || (flight.tm_mux.len > 0) || (fhp[num_frames - 1] != TM_FHP_IDLE); )
+    {
+        if((f < 7) && (Crypto_Instance_TM_QueuePacket(&flight, pkts[f], sizes[f]) == OS_SUCCESS))
+        {
+            ++f;
+            continue;
+        }
+        if(num_frames == MUX_FRAMES || next_frame(frames[0], &view) != OS_SUCCESS)
+        {
+            printf("mux reassembly: frame %d failed\n", num_frames);
+            return -1;
+        }
+        pdu_len = view.len;
+        start[num_frames] = len;
+        fhp[num_frames++] = view.fhp;
+        memcpy(&stream[len], &view.buf[view.offset], view.len);
+        len += view.len;
+    }
+
+    // walk the packets from the first header pointer, idle packets included
+    memset(user, 0, len);
+    memset(first, 0xFF, sizeof(first));
+    for(pos = fhp[0]; pos + 6 <= len; pos = next)
+    {
+        next = pos + (((stream[pos + 4] << 8) | stream[pos + 5]) + 7);
+        f = pos / pdu_len;
+        if(first[f] < 0)
+        {
+            first[f] = pos - start[f];
+        }
+        if((((stream[pos] & 0x07) << 8) | stream[pos + 1]) == TM_IDLE_APID)
+        {
+            continue;
+        }
+        if((k == 7) || (next > len) || (next - pos != sizes[k]) || (memcmp(&stream[pos], pkts[k], sizes[k]) != 0))
+        {
+            printf("mux reassembly: packet %d corrupt at stream offset %d\n", k, pos);
+            return -1;
+        }
+        memset(&user[pos], 1, sizes[k]);
+        ++k;
+    }
+
+    // each FHP names the first packet starting in its frame, or marks frames without one
+    for(f = 0; f < num_frames; ++f)
+    {
+        expect = (first[f] < 0) ? TM_FHP_NO_HEADER : first[f];
+        if(memchr(&user[start[f]], 1, pdu_len) == NULL)
+        {
+            expect = TM_FHP_IDLE;
+        }
+        if(fhp[f] != expect)
+        {
+            printf("mux reassembly: frame %d FHP 0x%x, expected 0x%x\n", f, fhp[f], expect);
+            return -1;
+        }
+    }
+    if(k != 7)
+    {
+        printf("mux reassembly: %d of 7 packets recovered\n", k);
+        return -1;
+    }
+    printf("mux reassembly: 7 packets over %d frames\n", num_frames);
+    return 0;
+}
+
+static void run_benchmark(const char *name, uint16 spi)
+{
+    crypto_tm_view_t view;
+    double start, stop;
+    int i, errors = 0;
+
+    // AES-GCM frames are decrypted in place, so each one is restored from its
+    // transmitted copy before verification, and its IV made the expected one again
+    // so the repeat is not refused as a replay; both are counted in the rate
+    use_spi(spi);
+    for(i = 0; i < 16; ++i)
+    {
+        build_frame(frames[i]);
+    }
+
+    start = now_sec();
+    for(i = 0; i < BENCH_FRAMES; ++i)
+    {
+        memcpy(work, frames[i & 15], FRAME_SIZE);
+        memcpy(ground.sa[spi].iv, &work[8], IV_SIZE);
+        Crypto_ARC_reset(&ground.sa[spi]);
+        if(Crypto_Instance_TM_ProcessSecurityView(&ground, work, FRAME_SIZE, &view) != OS_SUCCESS)
+        {
+            ++errors;
+        }
+    }
+    stop = now_sec();
+
+    printf("%-8s %8.0f frames/s %8.1f Mbit/s%s\n", name, BENCH_FRAMES / (stop - start),
+        (double) BENCH_FRAMES * FRAME_SIZE * 8 / (stop - start) / 1e6, errors ? "  (ERRORS)" : "");
+}
+
+int main(void)
+{
+    int testsPassed = 0, testsFailed = 0;
+    int i;
+
+    srand(1);
+    for(i = 0; i < PACKET_SIZE; ++i)
+    {
+        packet[i] = (char) rand();
+    }
+    packet[0] = 0x08;
+    packet[1] = 0x01;
+    packet[4] = (char) ((PACKET_SIZE - 7) >> 8);
+    packet[5] = (char) ((PACKET_SIZE - 7) & 0xFF);
+
+    setup_link();
+
+    if(run_roundtrip_test(SPI_CLEAR)) ++testsFailed; else ++testsPassed;
+    if(run_roundtrip_test(SPI_AEAD)) ++testsFailed; else ++testsPassed;
+    if(run_roundtrip_test(SPI_AUTH)) ++testsFailed; else ++testsPassed;
+    if(run_roundtrip_test(SPI_ENC)) ++testsFailed; else ++testsPassed;
+    if(run_tamper_test(SPI_AEAD)) ++testsFailed; else ++testsPassed;
+    if(run_tamper_test(SPI_AUTH)) ++testsFailed; else ++testsPassed;
+    if(run_replay_test(SPI_AEAD)) ++testsFailed; else ++testsPassed;
+    if(run_replay_test(SPI_AUTH)) ++testsFailed; else ++testsPassed;
+    if(run_channel_test()) ++testsFailed; else ++testsPassed;
+    if(run_mux_split_test()) ++testsFailed; else ++testsPassed;
+    if(run_mux_fhp_test()) ++testsFailed; else ++testsPassed;
+    if(run_mux_queue_test()) ++testsFailed; else ++testsPassed;
+    if(run_mux_apply_test()) ++testsFailed; else ++testsPassed;
+    if(run_mux_reassembly_test()) ++testsFailed; else ++testsPassed;
+
+    setup_link();
+
+    printf("\nBenchmark (ground verification of %d byte TM frames):\n", FRAME_SIZE);
+    run_benchmark("clear", SPI_CLEAR);
+    run_benchmark("aes-gcm", SPI_AEAD);
+    run_benchmark("gmac", SPI_AUTH);
+    run_benchmark("aes-ctr", SPI_ENC);
+
+    printf("\nFinished running tests. %d/%d cases passed.\n", testsPassed, testsPassed + testsFailed);
+
+    return testsFailed;
+}